@@ -0,0 +1,107 @@
+#pragma once
+
+#include "SDL_events.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ShadowEngine {
+
+    /// <summary>
+    /// Records the SDL event stream of a session to a file, or plays one back in place of SDL_PollEvent.
+    /// </summary>
+    /// Events are stored per frame, alongside the fixed delta time the session ran at,
+    /// so that a replayed session sees exactly the same input on exactly the same frames.
+    ///
+    /// File layout (little endian):
+    ///   Header  { char magic[4] = "SHIR"; uint32_t version; uint32_t eventSize; double fixedDeltaMs; }
+    ///   Frame   { uint32_t frame; uint32_t count; SDL_Event events[count]; }   - frames that had events, and a
+    ///                                                                           checkpoint with none every second
+    ///   Trailer { uint32_t frames; uint32_t count = 0xFFFFFFFF; }
+    ///
+    /// Frames are flushed as they are written, and the trailer is optional; a session that was killed or exited
+    /// without destroying the recorder replays up to the last frame that reached the file.
+    class InputReplay {
+    public:
+        enum class Mode { Off, Record, Replay };
+
+        InputReplay() = default;
+        InputReplay(const InputReplay&) = delete;
+        InputReplay& operator=(const InputReplay&) = delete;
+
+        ~InputReplay();
+
+        /// <summary>
+        /// Start writing every polled event to the given file.
+        /// </summary>
+        void Record(const std::string& path, double fixedDeltaMs);
+
+        /// <summary>
+        /// Load a recording, to be fed back by Poll.
+        /// </summary>
+        void Replay(const std::string& path);
+
+        /// <summary>
+        /// Drop-in for SDL_PollEvent.
+        /// </summary>
+        /// When recording, events come from SDL and are written out.
+        /// When replaying, live input is discarded and the recorded events for the current frame are returned.
+        /// <returns>Whether an event was written into event</returns>
+        bool Poll(SDL_Event* event);
+
+        /// <summary>
+        /// Drop-in for SDL_GetKeyboardState.
+        /// </summary>
+        /// When replaying, this is the state built up from the replayed key events, not the live keyboard.
+        const Uint8* GetKeyboardState(int* numkeys = nullptr) const;
+
+        /// <summary>
+        /// Drop-in for SDL_GetModState, replayed like GetKeyboardState.
+        /// </summary>
+        SDL_Keymod GetModState() const;
+
+        /// <summary>
+        /// Mark the end of a frame. Must be called once per iteration of the main loop.
+        /// </summary>
+        void EndFrame();
+
+        /// <summary>
+        /// Whether a replay has run out of recorded frames.
+        /// </summary>
+        bool Finished() const { return mode == Mode::Replay && frame >= totalFrames; }
+
+        Mode GetMode() const { return mode; }
+        double GetFixedDelta() const { return fixedDelta; }
+        uint32_t GetFrame() const { return frame; }
+
+    private:
+        struct FrameEvents {
+            uint32_t frame;
+            std::vector<SDL_Event> events;
+        };
+
+        static bool IsReplayable(const SDL_Event& event);
+
+        void WriteFrame();
+
+        Mode mode = Mode::Off;
+        double fixedDelta = 0;
+        uint32_t frame = 0;
+
+        // Recording state
+        std::ofstream output;
+        std::vector<SDL_Event> pending;
+
+        // Replay state
+        std::vector<FrameEvents> frames;
+        uint32_t totalFrames = 0;
+        size_t nextFrame = 0;
+        size_t nextEvent = 0;
+        std::array<Uint8, SDL_NUM_SCANCODES> keys {};
+        SDL_Keymod modifiers = KMOD_NONE;
+    };
+
+}
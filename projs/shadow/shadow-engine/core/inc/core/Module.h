@@ -13,7 +13,7 @@ namespace ShadowEngine {
     /// </summary>
     class Module : public SHObject
     {
-        SHObject_Base(Module)
+        SHObject_Base(Module, SHObject)
 
     public:
 
@@ -63,6 +63,8 @@ namespace ShadowEngine {
      * Allows the engine to access state from the renderer independent of implementation.
      */
     class RendererModule : public Module {
+        SHObject_Base(RendererModule, Module)
+
     public:
         // Begin the render pass using the given commands.
         // Will call out through the regular modules to gather geometry to render.
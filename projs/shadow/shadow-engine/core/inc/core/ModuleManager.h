@@ -2,8 +2,9 @@
 #define UMBRA_MODULEMANAGER_H
 
 #include <memory>
-#include <list>
+#include <vector>
 #include "Module.h"
+#include <shadow/util/StringId.h>
 
 namespace ShadowEngine {
 
@@ -11,6 +12,8 @@ namespace ShadowEngine {
     public:
         std::shared_ptr<Module> module;
         std::string domain;
+        // The module's name, hashed once when it is pushed.
+        shadowutil::StringId name;
 
         // Reinterpret this module as if it were a Renderer Module.
         // A shortcut for `std::static_pointer_cast<std::shared_ptr<RendererModule>>(ShadowEngine::ModuleManager::instance->GetModule("renderer"))
@@ -22,7 +25,8 @@ namespace ShadowEngine {
         static API ModuleManager *instance;
         static ModuleManager* getInstance() { return instance; }
 
-        std::list<ModuleRef> modules;
+        // Walked in order several times a frame; kept contiguous.
+        std::vector<ModuleRef> modules;
         ModuleRef renderer;
 
         ModuleManager();
@@ -31,13 +35,13 @@ namespace ShadowEngine {
 
         void PushModule(const std::shared_ptr<Module>& module, const std::string& domain);
 
-        Module &GetModule(const std::string& name);
+        Module &GetModule(shadowutil::StringId name);
 
         template<typename T>
         T *GetModuleByType() {
             for (auto &module: modules) {
-                if (module.module->GetTypeId() == T::TypeId())
-                    return dynamic_cast<T *>(module.module.get());
+                if (module.module->template IsA<T>())
+                    return static_cast<T *>(module.module.get());
             }
             //SH_CORE_ERROR("Can't find the module {0}", T::Type());
             return nullptr;
@@ -13,7 +13,7 @@
 namespace ShadowEngine {
 
     class SDL2Module : public Module {
-        SHObject_Base(SDL2Module)
+        SHObject_Base(SDL2Module, Module)
 
     public:
         ShadowEngine::ShadowWindow* _window;
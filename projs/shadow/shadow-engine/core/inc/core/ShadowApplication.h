@@ -1,6 +1,7 @@
 #pragma once
 #include "ShadowWindow.h"
 #include "ModuleManager.h"
+#include "InputReplay.h"
 #include "exports.h"
 #include "imgui.h"
 #include "imgui_impl_sdl.h"
@@ -40,6 +41,11 @@ namespace ShadowEngine {
 
         std::string game = "";
 
+		/// <summary>
+		/// Records or replays the input of this session, if requested on the command line.
+		/// </summary>
+		InputReplay input;
+
         void loadGame();
 
 	public:
@@ -65,6 +71,11 @@ namespace ShadowEngine {
 
         ShadowEngine::ModuleManager& GetModuleManager() { return moduleManager; };
 
+		/// <summary>
+		/// The session's input. Poll keyboard state through this rather than SDL, so that it is replayed too.
+		/// </summary>
+		InputReplay& GetInput() { return input; };
+
         void Init();
         void Start();
 
@@ -16,5 +16,9 @@ public:
     static API double timeSinceStart;
     static API double startTime;
 
+    // When non-zero, every update advances time by exactly this many milliseconds instead of following the clock.
+    // Used to make recorded and replayed sessions deterministic.
+    static API double fixedDelta;
+
 	static void UpdateTime();
 };
@@ -13,7 +13,7 @@ namespace ShadowEngine::Debug {
 
     class DebugModule : public Module {
 
-        SHObject_Base(DebugModule)
+        SHObject_Base(DebugModule, Module)
 
         bool active;
 
@@ -0,0 +1,186 @@
+#include "core/InputReplay.h"
+#include "spdlog/spdlog.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace ShadowEngine {
+
+    constexpr char replayMagic[4] = { 'S', 'H', 'I', 'R' };
+    constexpr uint32_t replayVersion = 1;
+    constexpr uint32_t trailerMarker = 0xFFFFFFFF;
+    // How often a frame with no events is still written, so that a recording without its trailer knows roughly how long it ran.
+    constexpr uint32_t checkpointFrames = 60;
+
+    template <typename T>
+    void write(std::ofstream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T read(std::ifstream& in) {
+        T value {};
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        if (!in)
+            throw std::runtime_error("Input recording is truncated");
+        return value;
+    }
+
+    InputReplay::~InputReplay() {
+        if (mode != Mode::Record)
+            return;
+
+        write(output, frame);
+        write(output, trailerMarker);
+        output.close();
+        spdlog::info("Input recording finished after " + std::to_string(frame) + " frames");
+    }
+
+    void InputReplay::Record(const std::string& path, double fixedDeltaMs) {
+        output.open(path, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+            throw std::runtime_error("Unable to open input recording for writing: " + path);
+
+        mode = Mode::Record;
+        fixedDelta = fixedDeltaMs;
+
+        output.write(replayMagic, sizeof(replayMagic));
+        write(output, replayVersion);
+        write(output, static_cast<uint32_t>(sizeof(SDL_Event)));
+        write(output, fixedDelta);
+
+        spdlog::info("Recording input to " + path);
+    }
+
+    void InputReplay::Replay(const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        if (!input.is_open())
+            throw std::runtime_error("Unable to open input recording: " + path);
+
+        char magic[4];
+        input.read(magic, sizeof(magic));
+        if (!input || std::memcmp(magic, replayMagic, sizeof(magic)) != 0)
+            throw std::runtime_error(path + " is not an input recording");
+        if (read<uint32_t>(input) != replayVersion)
+            throw std::runtime_error("Input recording " + path + " has an unsupported version");
+        if (read<uint32_t>(input) != sizeof(SDL_Event))
+            throw std::runtime_error("Input recording " + path + " was made with an incompatible SDL build");
+
+        fixedDelta = read<double>(input);
+
+        while (true) {
+            uint32_t header[2];
+            input.read(reinterpret_cast<char*>(header), sizeof(header));
+            if (input && header[1] == trailerMarker) {
+                totalFrames = header[0];
+                break;
+            }
+
+            std::vector<SDL_Event> events(input ? header[1] : 0);
+            if (input)
+                input.read(reinterpret_cast<char*>(events.data()), static_cast<std::streamsize>(events.size() * sizeof(SDL_Event)));
+
+            // No trailer; the session ended without closing the recording. Replay every frame that was written whole.
+            if (!input) {
+                totalFrames = frames.empty() ? 0 : frames.back().frame + 1;
+                spdlog::warn("Input recording " + path + " has no trailer; replaying the " + std::to_string(totalFrames) + " frames that were saved");
+                break;
+            }
+
+            frames.push_back({ header[0], std::move(events) });
+        }
+
+        mode = Mode::Replay;
+        spdlog::info("Replaying " + std::to_string(totalFrames) + " frames of input from " + path);
+    }
+
+    bool InputReplay::Poll(SDL_Event* event) {
+        switch (mode) {
+            case Mode::Off:
+                return SDL_PollEvent(event);
+
+            case Mode::Record:
+                if (!SDL_PollEvent(event))
+                    return false;
+                if (IsReplayable(*event))
+                    pending.push_back(*event);
+                return true;
+
+            case Mode::Replay: {
+                // Live input would make the session diverge; drain it, but still let the user close the window.
+                SDL_Event live;
+                while (SDL_PollEvent(&live)) {
+                    if (live.type == SDL_QUIT) {
+                        *event = live;
+                        return true;
+                    }
+                }
+
+                if (nextFrame >= frames.size() || frames[nextFrame].frame != frame)
+                    return false;
+
+                const auto& recorded = frames[nextFrame].events;
+                if (nextEvent >= recorded.size())
+                    return false;
+
+                *event = recorded[nextEvent++];
+                if (event->type == SDL_KEYDOWN || event->type == SDL_KEYUP) {
+                    keys[event->key.keysym.scancode] = event->type == SDL_KEYDOWN;
+                    modifiers = static_cast<SDL_Keymod>(event->key.keysym.mod);
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const Uint8* InputReplay::GetKeyboardState(int* numkeys) const {
+        if (mode != Mode::Replay)
+            return SDL_GetKeyboardState(numkeys);
+
+        if (numkeys != nullptr)
+            *numkeys = static_cast<int>(keys.size());
+        return keys.data();
+    }
+
+    SDL_Keymod InputReplay::GetModState() const {
+        return mode == Mode::Replay ? modifiers : SDL_GetModState();
+    }
+
+    void InputReplay::WriteFrame() {
+        write(output, frame);
+        write(output, static_cast<uint32_t>(pending.size()));
+        output.write(reinterpret_cast<const char*>(pending.data()), static_cast<std::streamsize>(pending.size() * sizeof(SDL_Event)));
+        output.flush();
+        pending.clear();
+    }
+
+    void InputReplay::EndFrame() {
+        if (mode == Mode::Record && (!pending.empty() || frame % checkpointFrames == checkpointFrames - 1))
+            WriteFrame();
+
+        if (mode == Mode::Replay && nextFrame < frames.size() && frames[nextFrame].frame == frame) {
+            ++nextFrame;
+            nextEvent = 0;
+        }
+
+        ++frame;
+    }
+
+    bool InputReplay::IsReplayable(const SDL_Event& event) {
+        // These carry pointers that are meaningless in another process.
+        switch (event.type) {
+            case SDL_DROPFILE:
+            case SDL_DROPTEXT:
+            case SDL_DROPBEGIN:
+            case SDL_DROPCOMPLETE:
+            case SDL_SYSWMEVENT:
+            case SDL_TEXTEDITING_EXT:
+                return false;
+            default:
+                return event.type < SDL_USEREVENT;
+        }
+    }
+
+}
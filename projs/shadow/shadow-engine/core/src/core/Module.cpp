@@ -7,5 +7,6 @@
 namespace ShadowEngine {
 
     SHObject_Base_Impl(Module)
+    SHObject_Base_Impl(RendererModule)
 
 } // ShadowEngine
\ No newline at end of file
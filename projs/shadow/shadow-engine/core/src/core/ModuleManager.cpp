@@ -22,22 +22,22 @@ ShadowEngine::ModuleManager::~ModuleManager()
 
 void ShadowEngine::ModuleManager::PushModule(const std::shared_ptr<Module>& module, const std::string& domain)
 {
-    ModuleRef r = {module, domain};
+    ModuleRef r = {module, domain, shadowutil::StringId::intern(module->GetName())};
     modules.emplace_back(r);
     if (domain == "renderer")
         renderer = r;
     module->PreInit();
 }
 
-ShadowEngine::Module& ShadowEngine::ModuleManager::GetModule(const std::string& name)
+ShadowEngine::Module& ShadowEngine::ModuleManager::GetModule(shadowutil::StringId name)
 {
     for (auto& module : modules)
     {
-        if (module.module->GetName() == name)
+        if (module.name == name)
             return *module.module;
     }
     //SH_ASSERT(false, "Can't find the module");
-    throw std::runtime_error("Can't find the module");
+    throw std::runtime_error("Can't find the module " + name.str());
 }
 
 void ShadowEngine::ModuleManager::Init()
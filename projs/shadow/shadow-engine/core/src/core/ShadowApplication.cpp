@@ -10,6 +10,11 @@
 #include <imgui_impl_sdl.h>
 #include <vlkx/vulkan/VulkanModule.h>
 #include <spdlog/spdlog.h>
+#include <shadow/util/FlightRecorder.h>
+#include <shadow/util/AsyncIO.h>
+#include <shadow/util/VFS.h>
+#include <charconv>
+#include <filesystem>
 
 #define CATCH(x) \
     try { x } catch (std::exception& e) { spdlog::error(e.what()); exit(0); }
@@ -22,10 +27,25 @@ namespace ShadowEngine {
 
     std::unique_ptr<vlkx::RenderCommand> renderCommands;
 
+    // The number following a command line flag, or the fallback if it isn't one.
+    static double parseNumber(const std::string& flag, std::string_view text, double fallback) {
+        double value;
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc() || end != text.data() + text.size()) {
+            spdlog::warn("Ignoring " + flag + " " + std::string(text) + "; it is not a number");
+            return fallback;
+        }
+        return value;
+    }
+
     ShadowApplication::ShadowApplication(int argc, char* argv[])
 	{
 		instance = this;
 
+        std::string record;
+        std::string replay;
+        double fixedDelta = 1000.0 / 60.0;
+
 		if(argc > 1)
 		{
 			for (size_t i = 0; i < argc; i++)
@@ -38,9 +58,44 @@ namespace ShadowEngine {
                 if(param == "-game")
                 {
                     this->game = argv[i+1];
+                }
+                if(param == "-frame-budget" && i + 1 < argc)
+                {
+                    auto config = shadowutil::FlightRecorder::getConfig();
+                    config.budgetMs = parseNumber(param, argv[i+1], config.budgetMs);
+                    shadowutil::FlightRecorder::configure(config);
+                }
+                if(param == "-no-flight-recorder")
+                {
+                    auto config = shadowutil::FlightRecorder::getConfig();
+                    config.enabled = false;
+                    shadowutil::FlightRecorder::configure(config);
+                }
+                if(param == "-record" && i + 1 < argc)
+                {
+                    record = argv[i+1];
+                }
+                if(param == "-replay" && i + 1 < argc)
+                {
+                    replay = argv[i+1];
+                }
+                if(param == "-fixed-delta" && i + 1 < argc)
+                {
+                    fixedDelta = parseNumber(param, argv[i+1], fixedDelta);
                 }
 			}
 		}
+
+        // A recorded session always runs on a fixed timestep, so that it can be replayed frame-accurately.
+        CATCH(
+            if (!replay.empty()) {
+                input.Replay(replay);
+                Time::fixedDelta = input.GetFixedDelta();
+            } else if (!record.empty()) {
+                input.Record(record, fixedDelta);
+                Time::fixedDelta = fixedDelta;
+            }
+        )
 	}
 
 	ShadowApplication::~ShadowApplication()
@@ -69,6 +124,21 @@ namespace ShadowEngine {
 
 	void ShadowApplication::Init()
 	{
+        // Shipped packages are mounted beneath the loose directory they ship in, so that edited files override them.
+        // vlkx-resources is the engine's, copied next to the runtime by its build; resources is the game's.
+        const auto mount = [](const std::string& root) {
+            auto& vfs = shadowutil::VFS::get();
+            if (std::filesystem::exists(root + "/pkg/index.vxi"))
+                vfs.mountIndex(root + "/pkg/index.vxi", root, 0);
+            if (std::filesystem::is_directory(root))
+                vfs.mountDirectory(root, root, 1);
+        };
+        CATCH(
+            mount("vlkx-resources");
+            mount("resources");
+            spdlog::info("Mounted " + std::to_string(shadowutil::VFS::get().size()) + " files");
+        )
+
         moduleManager.PushModule(std::make_shared<SDL2Module>(),"core");
         auto renderer = std::make_shared<VulkanModule>();
         renderer->EnableEditor();
@@ -87,20 +157,46 @@ namespace ShadowEngine {
         SDL_Event event;
 		while (running)
 		{
-            while (SDL_PollEvent(&event)) {  // poll until all events are handled!
-                moduleManager.Event(&event);
-                if (event.type == SDL_QUIT)
-                    running = false;
+            shadowutil::FlightRecorder::beginFrame();
+
+            {
+                shadowutil::FlightRecorder::Zone zone("Events");
+                while (input.Poll(&event)) {  // poll until all events are handled!
+                    moduleManager.Event(&event);
+                    if (event.type == SDL_QUIT)
+                        running = false;
+                }
+            }
+
+            {
+                // Hand finished background reads to whoever asked for them, before anything renders.
+                shadowutil::FlightRecorder::Zone zone("AsyncIO");
+                shadowutil::AsyncIO::get().poll();
             }
 
-            moduleManager.PreRender();
+            {
+                shadowutil::FlightRecorder::Zone zone("PreRender");
+                moduleManager.PreRender();
+            }
 
-            moduleManager.renderer->BeginRenderPass(renderCommands);
+            {
+                shadowutil::FlightRecorder::Zone zone("Render");
+                moduleManager.renderer->BeginRenderPass(renderCommands);
+            }
 
-            moduleManager.AfterFrameEnd();
+            {
+                shadowutil::FlightRecorder::Zone zone("AfterFrameEnd");
+                moduleManager.AfterFrameEnd();
+            }
 
             renderCommands->nextFrame();
             Time::UpdateTime();
+
+            input.EndFrame();
+            if (input.Finished())
+                running = false;
+
+            shadowutil::FlightRecorder::endFrame();
 		}
 
         moduleManager.Destroy();
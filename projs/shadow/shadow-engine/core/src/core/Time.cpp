@@ -8,9 +8,16 @@ API double Time::deltaTime_ms = 0;
 API double Time::deltaTime = 0;
 API double Time::startTime = 0;
 API double Time::timeSinceStart = 0;
+API double Time::fixedDelta = 0;
 
 void Time::UpdateTime()
 {
+    if (fixedDelta > 0) {
+        deltaTime = fixedDelta;
+        timeSinceStart += fixedDelta;
+        return;
+    }
+
     using namespace std::chrono;
     auto now = system_clock::now();
     auto now_ms = time_point_cast<milliseconds>(now);
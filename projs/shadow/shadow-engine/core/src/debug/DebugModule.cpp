@@ -6,6 +6,8 @@
 #include "imgui.h"
 #include "core/Time.h"
 #include "core/ModuleManager.h"
+#include "shadow/util/FlightRecorder.h"
+#include "vlkx/vulkan/abstraction/Image.h"
 
 SHObject_Base_Impl(ShadowEngine::Debug::DebugModule)
 
@@ -15,6 +17,13 @@ void ShadowEngine::Debug::DebugModule::OverlayRender() {
         ImGui::Text("delta time in ms: %lf", Time::deltaTime_ms);
         ImGui::Text("delta time in s: %lf", Time::deltaTime);
         ImGui::Text("LAST time in: %d", Time::LAST);
+        ImGui::Text("last frame: %.2lf ms (budget %.2lf ms)", shadowutil::FlightRecorder::getLastFrameMs(), shadowutil::FlightRecorder::getConfig().budgetMs);
+        ImGui::Text("spike traces written: %u", shadowutil::FlightRecorder::getSpikeCount());
+
+        const auto textures = shadowutil::RefCounter<vlkx::TextureImage>::getStats();
+        ImGui::Text("texture cache: %llu hits, %llu misses, %llu evictions, %zu kept (%.1f MB)",
+                    (unsigned long long) textures.hits, (unsigned long long) textures.misses, (unsigned long long) textures.evictions,
+                    textures.cachedObjects, textures.cachedBytes / (1024.0 * 1024.0));
     }
 
     ImGui::End();
@@ -0,0 +1,190 @@
+#include "catch2/catch.hpp"
+#include "core/InputReplay.h"
+#include "SDL.h"
+#include <cstring>
+#include <filesystem>
+#include <map>
+
+using ShadowEngine::InputReplay;
+
+namespace {
+    namespace fs = std::filesystem;
+
+    // The event queue is all the recorder needs from SDL, so tests feed it by pushing events.
+    struct Events {
+        Events() { SDL_Init(SDL_INIT_EVENTS); }
+        ~Events() { SDL_QuitSubSystem(SDL_INIT_EVENTS); }
+    };
+
+    std::string temp(const std::string& name) {
+        return (fs::temp_directory_path() / ("shadow-replay-" + name)).string();
+    }
+
+    std::string read(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return { std::istreambuf_iterator<char>(in), {} };
+    }
+
+    void write(const std::string& path, const std::string& contents) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    }
+
+    SDL_Event key(Uint32 type, SDL_Scancode scancode, Uint16 mod = KMOD_NONE) {
+        SDL_Event event;
+        std::memset(&event, 0, sizeof(event));
+        event.type = type;
+        event.key.keysym.scancode = scancode;
+        event.key.keysym.mod = mod;
+        return event;
+    }
+
+    SDL_Event motion(int x, int y) {
+        SDL_Event event;
+        std::memset(&event, 0, sizeof(event));
+        event.type = SDL_MOUSEMOTION;
+        event.motion.x = x;
+        event.motion.y = y;
+        return event;
+    }
+
+    // What arrived on a frame, as (type, scancode or x) pairs.
+    using Seen = std::map<uint32_t, std::vector<std::pair<Uint32, int>>>;
+
+    void note(Seen& seen, uint32_t frame, const SDL_Event& event) {
+        seen[frame].emplace_back(event.type, event.type == SDL_MOUSEMOTION ? event.motion.x : int(event.key.keysym.scancode));
+    }
+
+    constexpr uint32_t sessionFrames = 150;
+
+    // A session with input scattered over it, including frames far apart and several events on one frame.
+    std::map<uint32_t, std::vector<SDL_Event>> script() {
+        return {
+            { 0, { key(SDL_KEYDOWN, SDL_SCANCODE_W) } },
+            { 1, { motion(10, 20), motion(11, 21) } },
+            { 7, { key(SDL_KEYUP, SDL_SCANCODE_W), key(SDL_KEYDOWN, SDL_SCANCODE_A, KMOD_LSHIFT) } },
+            { 61, { motion(300, 40) } },
+            { 130, { key(SDL_KEYUP, SDL_SCANCODE_A), key(SDL_KEYDOWN, SDL_SCANCODE_SPACE) } },
+            { 149, { key(SDL_KEYUP, SDL_SCANCODE_SPACE) } },
+        };
+    }
+
+    // Runs a session through the recorder, returning what the game saw.
+    Seen record(const std::string& path) {
+        const auto events = script();
+        Seen seen;
+        InputReplay recorder;
+        recorder.Record(path, 1000.0 / 60);
+        for (uint32_t frame = 0; frame < sessionFrames; frame++) {
+            if (const auto it = events.find(frame); it != events.end())
+                for (auto event : it->second) SDL_PushEvent(&event);
+
+            // Dropped files carry a pointer, so they reach the game but are never recorded.
+            if (frame == 3) {
+                SDL_Event drop;
+                std::memset(&drop, 0, sizeof(drop));
+                drop.type = SDL_DROPFILE;
+                SDL_PushEvent(&drop);
+            }
+
+            SDL_Event event;
+            while (recorder.Poll(&event))
+                if (event.type != SDL_DROPFILE) note(seen, frame, event);
+            recorder.EndFrame();
+        }
+        return seen;
+    }
+}
+
+TEST_CASE("Recorded input replays on the same frames", "[replay]") {
+    const Events sdl;
+    const auto path = temp("session.bin");
+    const Seen recorded = record(path);
+    REQUIRE(recorded.size() == script().size());
+
+    InputReplay replay;
+    replay.Replay(path);
+    REQUIRE(replay.GetMode() == InputReplay::Mode::Replay);
+    REQUIRE(replay.GetFixedDelta() == 1000.0 / 60);
+
+    // Live input during a replay is ignored.
+    SDL_Event live = key(SDL_KEYDOWN, SDL_SCANCODE_D);
+    SDL_PushEvent(&live);
+
+    Seen replayed;
+    bool heldW = false, heldAWithShift = false;
+    uint32_t frames = 0;
+    for (; !replay.Finished(); frames++) {
+        REQUIRE(replay.GetFrame() == frames);
+        SDL_Event event;
+        while (replay.Poll(&event)) note(replayed, frames, event);
+
+        if (frames == 0) heldW = replay.GetKeyboardState()[SDL_SCANCODE_W];
+        if (frames == 7) heldAWithShift = replay.GetKeyboardState()[SDL_SCANCODE_A] && replay.GetModState() == KMOD_LSHIFT;
+        REQUIRE_FALSE(replay.GetKeyboardState()[SDL_SCANCODE_D]);
+        replay.EndFrame();
+    }
+
+    REQUIRE(frames == sessionFrames);
+    REQUIRE(replayed == recorded);
+    REQUIRE(heldW);
+    REQUIRE(heldAWithShift);
+    REQUIRE_FALSE(replay.GetKeyboardState()[SDL_SCANCODE_SPACE]);
+}
+
+TEST_CASE("A recording cut short replays the frames that were saved whole", "[replay]") {
+    const Events sdl;
+    const auto path = temp("cut.bin");
+    const Seen recorded = record(path);
+    const std::string whole = read(path);
+
+    // Without its trailer, and with the last frame's events cut in half: frame 149 is lost, frame 130 is kept.
+    const auto cutPath = temp("cut-short.bin");
+    write(cutPath, whole.substr(0, whole.size() - 8 - sizeof(SDL_Event) / 2));
+
+    InputReplay replay;
+    replay.Replay(cutPath);
+    Seen replayed;
+    uint32_t frames = 0;
+    for (; !replay.Finished(); frames++) {
+        SDL_Event event;
+        while (replay.Poll(&event)) note(replayed, frames, event);
+        replay.EndFrame();
+    }
+
+    REQUIRE(frames == 131);
+    Seen expected = recorded;
+    expected.erase(149);
+    REQUIRE(replayed == expected);
+}
+
+TEST_CASE("Recordings that aren't whole or aren't ours are rejected", "[replay]") {
+    const Events sdl;
+    const auto path = temp("good.bin");
+    record(path);
+    const std::string good = read(path);
+
+    const auto rejects = [](const std::string& contents, const std::string& why) {
+        const auto bad = temp("bad.bin");
+        write(bad, contents);
+        InputReplay replay;
+        REQUIRE_THROWS_WITH(replay.Replay(bad), Catch::Contains(why));
+        REQUIRE(replay.GetMode() == InputReplay::Mode::Off);
+    };
+
+    rejects("", "not an input recording");
+    rejects("SHI", "not an input recording");
+    rejects("XHIR" + good.substr(4), "not an input recording");
+    rejects(good.substr(0, 10), "truncated");
+    rejects(good.substr(0, 16), "truncated");
+
+    std::string version = good;
+    version[4] = 2;
+    rejects(version, "unsupported version");
+
+    std::string eventSize = good;
+    eventSize[8] = 1;
+    rejects(eventSize, "incompatible SDL build");
+
+    InputReplay missing;
+    REQUIRE_THROWS_WITH(missing.Replay(temp("missing.bin")), Catch::Contains("Unable to open"));
+}
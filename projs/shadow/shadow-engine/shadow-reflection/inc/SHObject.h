@@ -1,33 +1,181 @@
 #pragma once
+#include <array>
 #include <string>
-#include <typeinfo>
+#include <string_view>
+#include <type_traits>
 
 #include "exports.h"
+#include <shadow/util/Hash.h>
 
 namespace ShadowEngine {
 
+	namespace detail {
+		template<typename T>
+		constexpr std::string_view RawTypeName() {
+#if defined(_MSC_VER)
+			return __FUNCSIG__;
+#else
+			return __PRETTY_FUNCTION__;
+#endif
+		}
+
+		// The decorated function name is "<prefix><type name><suffix>", and the prefix and suffix only depend on the compiler.
+		// Measure them once against a known type.
+		constexpr std::string_view probeName = RawTypeName<double>();
+		constexpr size_t probePrefix = probeName.find("double");
+		constexpr size_t probeSuffix = probeName.size() - probePrefix - std::string_view("double").size();
+
+		constexpr std::string_view StripKeyword(std::string_view name, std::string_view keyword) {
+			return name.substr(0, keyword.size()) == keyword ? name.substr(keyword.size()) : name;
+		}
+	}
+
+	/**
+	 * \brief The fully qualified name of T, computed at compile time.
+	 * MSVC's "class " and "struct " prefixes are removed, so the name (and anything hashed from it) is the same on every compiler.
+	 */
+	template<typename T>
+	constexpr std::string_view TypeName() {
+		constexpr std::string_view raw = detail::RawTypeName<T>();
+		constexpr std::string_view name = raw.substr(detail::probePrefix, raw.size() - detail::probePrefix - detail::probeSuffix);
+		return detail::StripKeyword(detail::StripKeyword(name, "class "), "struct ");
+	}
+
+	/**
+	 * \brief The stable ID of T; the FNV-1a hash of its fully qualified name.
+	 * The same type gets the same ID in every module, process and build.
+	 */
+	template<typename T>
+	constexpr uint64_t TypeIdOf() {
+		return shadowutil::fnv1a64(TypeName<T>());
+	}
+
+	class SHObject;
+	class FieldLayout;
+
+	/**
+	 * \brief Everything the engine knows about a reflected type.
+	 */
+	struct TypeInfo {
+		uint64_t id;
+		std::string_view name;
+		size_t size;
+		/// Creates a default-constructed instance, or nullptr if the type is abstract or has no default constructor.
+		SHObject* (*factory)();
+		/// How many classes are between this type and SHObject. SHObject itself is 0.
+		size_t depth;
+		/// The IDs of this type's base chain, indexed by depth; ancestors[0] is SHObject and ancestors[depth] is this type.
+		const uint64_t* ancestors;
+		/// The reflected fields of the type (see Serialization.h), or nullptr if it does not reflect them.
+		const FieldLayout& (*fields)();
+	};
+
+	namespace detail {
+		template<typename T>
+		SHObject* Construct() {
+			if constexpr (std::is_default_constructible_v<T> && !std::is_abstract_v<T>)
+				return new T();
+			else
+				return nullptr;
+		}
+
+		// True only for the class that declared SHObject_Fields; derived classes that don't reflect their own fields are excluded.
+		template<typename T>
+		concept HasFields = requires { typename T::SHObjectFieldsOwner; } && std::is_same_v<typename T::SHObjectFieldsOwner, T>;
+
+		template<typename T>
+		constexpr auto FieldsOf() -> const FieldLayout& (*)() {
+			if constexpr (HasFields<T>)
+				return &T::Fields;
+			else
+				return nullptr;
+		}
+
+		template<typename T>
+		constexpr std::array<uint64_t, T::TypeDepth() + 1> Ancestors() {
+			std::array<uint64_t, T::TypeDepth() + 1> ids {};
+			if constexpr (T::TypeDepth() > 0) {
+				const auto bases = Ancestors<typename T::SHObjectBase>();
+				for (size_t i = 0; i < bases.size(); i++)
+					ids[i] = bases[i];
+			}
+			ids[T::TypeDepth()] = T::TypeId();
+			return ids;
+		}
+	}
+
+	/**
+	 * \brief A global map of every SHObject type that has been linked in, by ID.
+	 * Types are added automatically by SHObject_Base_Impl when the module containing them is loaded, and removed when it is unloaded.
+	 */
+	class TypeRegistry {
+	public:
+		/**
+		 * \brief Add a type to the registry.
+		 * The registry keeps a pointer to info, which must stay alive until it is unregistered.
+		 * Registering the same type again, as a reloaded module does, replaces the entry.
+		 * Throws if a different type with the same ID is already registered.
+		 */
+		API static void Register(const TypeInfo& info);
+
+		/**
+		 * \brief Remove a type from the registry, if info is still its entry.
+		 * A reloaded module registers its types before the old module unloads, so the old module's registrar must not
+		 * remove the entry that replaced its own.
+		 */
+		API static void Unregister(const TypeInfo& info);
+
+		/**
+		 * \brief Look up a type by ID or name.
+		 * The info belongs to the module that registered the type. It is valid until that module unloads, whatever
+		 * else registers or unregisters in the meantime.
+		 * \return the type's info, or nullptr if it is not registered
+		 */
+		API static const TypeInfo* Find(uint64_t id);
+		API static const TypeInfo* Find(std::string_view name);
+
+		/**
+		 * \brief Create a new instance of the type with the given ID.
+		 * \return the new object, or nullptr if the type is unknown or cannot be default constructed
+		 */
+		API static SHObject* Create(uint64_t id);
+	};
+
+	/**
+	 * \brief Registers T for as long as it exists. Used by SHObject_Base_Impl.
+	 */
+	template<typename T>
+	class TypeRegistrar {
+	public:
+		TypeRegistrar() {
+			TypeRegistry::Register(T::StaticTypeInfo());
+		}
+
+		~TypeRegistrar() {
+			TypeRegistry::Unregister(T::StaticTypeInfo());
+		}
+	};
+
 	/**
 	 * \brief This is the base class for every class in the Engine that uses runtime reflection.
 
 	 * Currently it provides a runtime TypeID and TypeName witch can be accesed as static and as class memebers.
-	 * The ID is a int type number witch is generated incramently, on the first call to get a type.
+	 * The ID is a hash of the fully qualified class name, so it is known at compile time, and is the same
+		across the engine, the game module, and every run of the program.
 
 	 * Each class that inherits from this or it's parent inheris form it must implement the
 		SHObject::GetType and SHObject::GetTypeId methodes and make it's own static methodes.
 		To make it easier a standard implementation of these can be used with the SHObject_Base() macro
-		witch implements all of these functions. It uses the typeid().name of the class.
+		witch implements all of these functions, and the SHObject_Base_Impl() macro which registers the type.
 
 	 */
 	class SHObject
 	{
-    public:
-		/**
-		 * \brief Generates a new UID for each call
-		 * \return the next Unique ID that was just generated
-		 */
-		API static uint64_t GenerateId() noexcept;
-
 	public:
+		static constexpr uint64_t TypeId()		{ return TypeIdOf<SHObject>(); }
+		static constexpr size_t TypeDepth()		{ return 0; }
+		API static const TypeInfo& StaticTypeInfo();
+
 		/**
 		 * \brief Returns the top level class type name of the object
 		 * \return The class Class name as a string
@@ -38,24 +186,87 @@ namespace ShadowEngine {
 		 * \return UID of the class
 		 */
 		virtual const uint64_t GetTypeId() const = 0;
+		/**
+		 * \brief Gets the registration info of the top level type, including its base chain
+		 */
+		virtual const TypeInfo& GetTypeInfo() const = 0;
+
+		/**
+		 * \brief Checks whether this object is a T, or derives from T.
+		 * This is constant time; it checks one slot of the ancestor table rather than walking the hierarchy.
+		 * Only the chain named in SHObject_Base is known, so T must be on it.
+		 */
+		template<typename T>
+		bool IsA() const {
+			constexpr size_t depth = T::TypeDepth();
+			const TypeInfo& info = GetTypeInfo();
+			return info.depth >= depth && info.ancestors[depth] == T::TypeId();
+		}
 
 		virtual ~SHObject() = default;
 	};
 
+	/**
+	 * \brief Casts an SHObject to T, if it is one.
+	 * Use this instead of dynamic_cast; after the IsA check, it is a plain static_cast.
+	 * \return The object as a T, or nullptr if it is not a T
+	 */
+	template<typename T, typename U>
+	T* shadow_cast(U* object) {
+		return object != nullptr && object->template IsA<T>() ? static_cast<T*>(object) : nullptr;
+	}
+
+	template<typename T, typename U>
+	const T* shadow_cast(const U* object) {
+		return object != nullptr && object->template IsA<T>() ? static_cast<const T*>(object) : nullptr;
+	}
+
+#define SHObject_Concat_Inner(a, b) a##b
+#define SHObject_Concat(a, b) SHObject_Concat_Inner(a, b)
 
 	/**
 	 * \brief Macro to make the override functions of SHObject. This should be added in each derived class
 	 * \param type The type of the class
+	 * \param base The class it derives from; SHObject for the root of a hierarchy
 	 */
-#define SHObject_Base(type)	\
+#define SHObject_Base(type, base)	\
 public: \
+	using SHObjectBase = base;						 \
 	static const std::string& Type();				 \
-	static uint64_t TypeId();						 \
+	static constexpr uint64_t TypeId()				{ return ::ShadowEngine::TypeIdOf<type>(); } \
+	static constexpr size_t TypeDepth()				{ return base::TypeDepth() + 1; } \
+	static const ::ShadowEngine::TypeInfo& StaticTypeInfo(); \
 	const std::string& GetType() const override		{ return Type();  } \
 	const uint64_t GetTypeId() const override		{ return  type::TypeId(); } \
+	const ::ShadowEngine::TypeInfo& GetTypeInfo() const override { return StaticTypeInfo(); } \
 private:
 
+	/**
+	 * \brief Macro to implement the functions declared by SHObject_Base, and add the type to the TypeRegistry.
+	 * This should be added to the source file of each derived class.
+	 * \param type The type of the class
+	 */
 #define SHObject_Base_Impl(type)	\
-	const std::string& type::Type()				{ static const std::string t = typeid(type).name(); return t; } \
-	uint64_t type::TypeId()						{ static const uint64_t id = GenerateId(); return id; }
-}
\ No newline at end of file
+	static_assert(std::is_base_of_v<type::SHObjectBase, type>, "SHObject_Base names the wrong base class"); \
+	const std::string& type::Type()				{ static const std::string t { ::ShadowEngine::TypeName<type>() }; return t; } \
+	const ::ShadowEngine::TypeInfo& type::StaticTypeInfo() { \
+		static constexpr auto ancestors = ::ShadowEngine::detail::Ancestors<type>(); \
+		static constexpr ::ShadowEngine::TypeInfo info { \
+			type::TypeId(), ::ShadowEngine::TypeName<type>(), sizeof(type), &::ShadowEngine::detail::Construct<type>, type::TypeDepth(), ancestors.data(), \
+			::ShadowEngine::detail::FieldsOf<type>() \
+		}; \
+		return info; \
+	} \
+	static const ::ShadowEngine::TypeRegistrar<type> SHObject_Concat(shTypeRegistrar_, __LINE__);
+
+	/**
+	 * \brief Macro to declare that a class reflects its fields. Add it to the class, next to SHObject_Base.
+	 * The fields themselves are listed with SHObject_Fields_Impl, from Serialization.h.
+	 * \param type The type of the class
+	 */
+#define SHObject_Fields(type) \
+public: \
+	using SHObjectFieldsOwner = type; \
+	static const ::ShadowEngine::FieldLayout& Fields(); \
+private:
+}
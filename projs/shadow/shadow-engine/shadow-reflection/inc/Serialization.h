@@ -0,0 +1,250 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "SHObject.h"
+
+namespace ShadowEngine {
+
+	/**
+	 * \brief Reads back data written by the Serializer, throwing if it runs past the end.
+	 */
+	class ByteReader {
+	public:
+		explicit ByteReader(std::span<const std::byte> data) : cursor(data.data()), end(data.data() + data.size()) {}
+
+		void Read(void* into, size_t size) {
+			if (static_cast<size_t>(end - cursor) < size)
+				throw std::runtime_error("Serialized data is truncated");
+			std::memcpy(into, cursor, size);
+			cursor += size;
+		}
+
+		template<typename T>
+		T Read() {
+			T value;
+			Read(&value, sizeof(T));
+			return value;
+		}
+
+		size_t Remaining() const { return end - cursor; }
+
+	private:
+		const std::byte* cursor;
+		const std::byte* end;
+	};
+
+	using ByteWriter = std::vector<std::byte>;
+
+	inline void WriteBytes(ByteWriter& out, const void* data, size_t size) {
+		const auto* bytes = static_cast<const std::byte*>(data);
+		out.insert(out.end(), bytes, bytes + size);
+	}
+
+	/**
+	 * \brief Describes one reflected member of a class.
+	 */
+	struct FieldInfo {
+		std::string_view name;
+		size_t offset;
+		size_t size;
+		size_t align;
+		uint64_t typeId;
+		/// Whether the field can be saved by copying its bytes.
+		bool trivial;
+		/// How to save and load fields that are not trivial. Unused for trivial fields.
+		void (*save)(const void* field, ByteWriter& out);
+		void (*load)(void* field, ByteReader& in);
+	};
+
+	/**
+	 * \brief The reflected fields of a class, and the plan for serializing them.
+	 * Trivially copyable fields with nothing between them, not even padding, are merged into a single copy,
+	 * so only the fields that really need it (strings, vectors, nested objects) are visited one at a time.
+	 */
+	class FieldLayout {
+	public:
+		/**
+		 * \brief One step of serialization; either a raw copy of a byte range, or a single non-trivial field.
+		 */
+		struct Step {
+			size_t offset;
+			size_t size;
+			const FieldInfo* field;		// nullptr for a raw copy
+		};
+
+		/**
+		 * \param fields The reflected fields of the class
+		 * \param base The fields of the reflected base class, saved before these. May be null.
+		 */
+		API FieldLayout(std::initializer_list<FieldInfo> fields, const FieldLayout* base);
+
+		// Steps point into the field list.
+		FieldLayout(const FieldLayout&) = delete;
+		FieldLayout& operator=(const FieldLayout&) = delete;
+
+		const std::vector<FieldInfo>& GetFields() const { return fields; }
+		const std::vector<Step>& GetSteps() const { return steps; }
+		const FieldLayout* GetBase() const { return base; }
+
+		/**
+		 * \brief A hash of every field's name, offset and size.
+		 * Data is only loaded back into a layout with the same hash.
+		 */
+		uint64_t GetHash() const { return hash; }
+
+	private:
+		std::vector<FieldInfo> fields;
+		std::vector<Step> steps;
+		const FieldLayout* base;
+		uint64_t hash;
+	};
+
+	/**
+	 * \brief Generic binary serialization driven by reflected fields.
+	 */
+	class Serializer {
+	public:
+		/**
+		 * \brief Append the reflected fields of the object to the output.
+		 */
+		API static void Save(const FieldLayout& layout, const void* object, ByteWriter& out);
+		/**
+		 * \brief Read the reflected fields of the object back.
+		 */
+		API static void Load(const FieldLayout& layout, void* object, ByteReader& in);
+
+		/**
+		 * \brief Save the reflected state of an object, along with its type and layout so it can be checked on load.
+		 * Throws if the object's type does not reflect its fields.
+		 */
+		API static ByteWriter Snapshot(const SHObject& object);
+		/**
+		 * \brief Load a snapshot back into an object of the same type.
+		 * Throws if the snapshot is of a different type or layout.
+		 */
+		API static void Restore(SHObject& object, std::span<const std::byte> data);
+	};
+
+	namespace detail {
+		template<typename T>
+		concept Reflected = HasFields<T>;
+
+		template<typename T>
+		struct IsVector : std::false_type {};
+		template<typename T, typename A>
+		struct IsVector<std::vector<T, A>> : std::true_type {};
+
+		template<typename T>
+		constexpr bool Trivial = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !Reflected<T>;
+
+		/**
+		 * \brief How to save and load a value of type T.
+		 */
+		template<typename T>
+		struct Codec {
+			static void Save(const T& value, ByteWriter& out) {
+				if constexpr (Trivial<T>) {
+					WriteBytes(out, &value, sizeof(T));
+				} else if constexpr (Reflected<T>) {
+					Serializer::Save(T::Fields(), &value, out);
+				} else if constexpr (std::is_same_v<T, std::string>) {
+					const uint64_t length = value.size();
+					WriteBytes(out, &length, sizeof(length));
+					WriteBytes(out, value.data(), value.size());
+				} else if constexpr (IsVector<T>::value) {
+					using Element = typename T::value_type;
+					const uint64_t count = value.size();
+					WriteBytes(out, &count, sizeof(count));
+					if constexpr (Trivial<Element>)
+						WriteBytes(out, value.data(), value.size() * sizeof(Element));
+					else
+						for (const auto& element : value)
+							Codec<Element>::Save(element, out);
+				} else {
+					static_assert(Trivial<T>, "This field type cannot be serialized; reflect it, or leave it out");
+				}
+			}
+
+			static void Load(T& value, ByteReader& in) {
+				if constexpr (Trivial<T>) {
+					in.Read(&value, sizeof(T));
+				} else if constexpr (Reflected<T>) {
+					Serializer::Load(T::Fields(), &value, in);
+				} else if constexpr (std::is_same_v<T, std::string>) {
+					const auto length = in.Read<uint64_t>();
+					if (length > in.Remaining())
+						throw std::runtime_error("Serialized data is truncated");
+					value.resize(length);
+					in.Read(value.data(), length);
+				} else if constexpr (IsVector<T>::value) {
+					using Element = typename T::value_type;
+					const auto count = in.Read<uint64_t>();
+					if constexpr (Trivial<Element>) {
+						if (count > in.Remaining() / sizeof(Element))
+							throw std::runtime_error("Serialized data is truncated");
+						value.resize(count);
+						in.Read(value.data(), count * sizeof(Element));
+					} else {
+						value.clear();
+						value.resize(count);
+						for (auto& element : value)
+							Codec<Element>::Load(element, in);
+					}
+				}
+			}
+		};
+
+		template<typename T>
+		FieldInfo MakeField(std::string_view name, size_t offset) {
+			return {
+				name, offset, sizeof(T), alignof(T), TypeIdOf<T>(), Trivial<T>,
+				[](const void* field, ByteWriter& out) { Codec<T>::Save(*static_cast<const T*>(field), out); },
+				[](void* field, ByteReader& in) { Codec<T>::Load(*static_cast<T*>(field), in); }
+			};
+		}
+
+		template<typename T>
+		const FieldLayout* BaseFields() {
+			if constexpr (requires { typename T::SHObjectBase; }) {
+				if constexpr (HasFields<typename T::SHObjectBase>)
+					return &T::SHObjectBase::Fields();
+			}
+			return nullptr;
+		}
+	}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SHObject_Offsetof_Begin _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define SHObject_Offsetof_End _Pragma("GCC diagnostic pop")
+#else
+#define SHObject_Offsetof_Begin
+#define SHObject_Offsetof_End
+#endif
+
+	/**
+	 * \brief Names one member of the class for SHObject_Fields_Impl.
+	 */
+#define SH_FIELD(name) ::ShadowEngine::detail::MakeField<decltype(SHSelf::name)>(#name, offsetof(SHSelf, name))
+
+	/**
+	 * \brief Macro to list the reflected fields of a class. This should be added to the source file of the class.
+	 * Fields of a reflected base class are included automatically.
+	 * \param type The type of the class
+	 * \param ... SH_FIELD(member) for each member to reflect
+	 */
+#define SHObject_Fields_Impl(type, ...) \
+	const ::ShadowEngine::FieldLayout& type::Fields() { \
+		using SHSelf = type; \
+		SHObject_Offsetof_Begin \
+		static const ::ShadowEngine::FieldLayout layout { { __VA_ARGS__ }, ::ShadowEngine::detail::BaseFields<SHSelf>() }; \
+		SHObject_Offsetof_End \
+		return layout; \
+	}
+}
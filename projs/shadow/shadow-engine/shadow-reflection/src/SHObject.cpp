@@ -1,6 +1,70 @@
 #include "../inc/SHObject.h"
 
-uint64_t ShadowEngine::SHObject::GenerateId() noexcept {
-    static uint64_t count = 0;
-    return ++count;
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace ShadowEngine {
+
+    struct Registry {
+        std::mutex lock;
+        // The infos are owned by their modules, so they stay put however the map rehashes.
+        std::unordered_map<uint64_t, const TypeInfo*> types;
+    };
+
+    // Types register themselves during static initialization, so the registry has to be constructed on first use.
+    static Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    const TypeInfo& SHObject::StaticTypeInfo() {
+        static constexpr uint64_t ancestors[] { SHObject::TypeId() };
+        static constexpr TypeInfo info { SHObject::TypeId(), TypeName<SHObject>(), sizeof(SHObject), nullptr, 0, ancestors, nullptr };
+        return info;
+    }
+
+    void TypeRegistry::Register(const TypeInfo& info) {
+        auto& reg = registry();
+        std::scoped_lock guard(reg.lock);
+
+        auto [it, inserted] = reg.types.try_emplace(info.id, &info);
+        if (inserted) return;
+
+        // The same type can be registered again when a module is reloaded; the new definition wins.
+        if (it->second->name == info.name) {
+            it->second = &info;
+            return;
+        }
+
+        throw std::runtime_error("Type ID collision between " + std::string(it->second->name) + " and " + std::string(info.name));
+    }
+
+    void TypeRegistry::Unregister(const TypeInfo& info) {
+        auto& reg = registry();
+        std::scoped_lock guard(reg.lock);
+
+        auto it = reg.types.find(info.id);
+        if (it != reg.types.end() && it->second == &info)
+            reg.types.erase(it);
+    }
+
+    const TypeInfo* TypeRegistry::Find(uint64_t id) {
+        auto& reg = registry();
+        std::scoped_lock guard(reg.lock);
+
+        auto it = reg.types.find(id);
+        return it == reg.types.end() ? nullptr : it->second;
+    }
+
+    const TypeInfo* TypeRegistry::Find(std::string_view name) {
+        return Find(shadowutil::fnv1a64(name));
+    }
+
+    SHObject* TypeRegistry::Create(uint64_t id) {
+        const TypeInfo* info = Find(id);
+        if (info == nullptr || info->factory == nullptr)
+            return nullptr;
+        return info->factory();
+    }
 }
@@ -0,0 +1,99 @@
+#include "../inc/Serialization.h"
+
+#include <algorithm>
+
+namespace ShadowEngine {
+
+    template<typename T>
+    static uint64_t hashValue(const T& value, uint64_t hash) {
+        return shadowutil::fnv1a64(std::string_view(reinterpret_cast<const char*>(&value), sizeof(T)), hash);
+    }
+
+    FieldLayout::FieldLayout(std::initializer_list<FieldInfo> list, const FieldLayout* base) : fields(list), base(base) {
+        std::sort(fields.begin(), fields.end(), [](const FieldInfo& a, const FieldInfo& b) { return a.offset < b.offset; });
+
+        hash = base != nullptr ? base->hash : shadowutil::fnvOffset;
+        for (const auto& field : fields) {
+            hash = shadowutil::fnv1a64(field.name, hash);
+            hash = hashValue(field.offset, hash);
+            hash = hashValue(field.size, hash);
+            hash = hashValue(field.typeId, hash);
+        }
+
+        for (const auto& field : fields) {
+            if (!field.trivial) {
+                steps.push_back({ field.offset, field.size, &field });
+                continue;
+            }
+
+            // A trivial field joins the previous copy only if it starts right where that copy ends.
+            // Padding between them may hold an unreflected member, which must be left alone.
+            if (!steps.empty() && steps.back().field == nullptr) {
+                auto& last = steps.back();
+                if (last.offset + last.size == field.offset) {
+                    last.size += field.size;
+                    continue;
+                }
+            }
+
+            steps.push_back({ field.offset, field.size, nullptr });
+        }
+    }
+
+    void Serializer::Save(const FieldLayout& layout, const void* object, ByteWriter& out) {
+        if (layout.GetBase() != nullptr)
+            Save(*layout.GetBase(), object, out);
+
+        const auto* bytes = static_cast<const std::byte*>(object);
+        for (const auto& step : layout.GetSteps()) {
+            if (step.field == nullptr)
+                WriteBytes(out, bytes + step.offset, step.size);
+            else
+                step.field->save(bytes + step.offset, out);
+        }
+    }
+
+    void Serializer::Load(const FieldLayout& layout, void* object, ByteReader& in) {
+        if (layout.GetBase() != nullptr)
+            Load(*layout.GetBase(), object, in);
+
+        auto* bytes = static_cast<std::byte*>(object);
+        for (const auto& step : layout.GetSteps()) {
+            if (step.field == nullptr)
+                in.Read(bytes + step.offset, step.size);
+            else
+                step.field->load(bytes + step.offset, in);
+        }
+    }
+
+    ByteWriter Serializer::Snapshot(const SHObject& object) {
+        const TypeInfo& info = object.GetTypeInfo();
+        if (info.fields == nullptr)
+            throw std::runtime_error("Cannot snapshot " + std::string(info.name) + "; it does not reflect its fields");
+
+        const FieldLayout& layout = info.fields();
+        const uint64_t hash = layout.GetHash();
+
+        ByteWriter out;
+        WriteBytes(out, &info.id, sizeof(info.id));
+        WriteBytes(out, &hash, sizeof(hash));
+        Save(layout, &object, out);
+        return out;
+    }
+
+    void Serializer::Restore(SHObject& object, std::span<const std::byte> data) {
+        const TypeInfo& info = object.GetTypeInfo();
+        if (info.fields == nullptr)
+            throw std::runtime_error("Cannot restore " + std::string(info.name) + "; it does not reflect its fields");
+
+        const FieldLayout& layout = info.fields();
+        ByteReader in(data);
+
+        if (in.Read<uint64_t>() != info.id)
+            throw std::runtime_error("Snapshot is not of type " + std::string(info.name));
+        if (in.Read<uint64_t>() != layout.GetHash())
+            throw std::runtime_error("Snapshot of " + std::string(info.name) + " was taken with a different field layout");
+
+        Load(layout, &object, in);
+    }
+}
@@ -0,0 +1,154 @@
+#include "catch2/catch.hpp"
+#include "Serialization.h"
+
+namespace serialization_tests {
+
+    struct Point {
+        SHObject_Fields(Point)
+    public:
+        float x = 0;
+        float y = 0;
+    };
+
+    class Everything : public ShadowEngine::SHObject {
+        SHObject_Base(Everything, ShadowEngine::SHObject)
+        SHObject_Fields(Everything)
+    public:
+        int count = 0;
+        double scale = 0;
+        std::string name;
+        std::vector<int> numbers;
+        std::vector<std::string> tags;
+        Point origin;
+    };
+
+    class Derived : public Everything {
+        SHObject_Base(Derived, Everything)
+        SHObject_Fields(Derived)
+    public:
+        uint16_t extra = 0;
+    };
+
+    // Only a and b are reflected; secret sits in the padding between them.
+    class Padded : public ShadowEngine::SHObject {
+        SHObject_Base(Padded, ShadowEngine::SHObject)
+        SHObject_Fields(Padded)
+    public:
+        char a = 0;
+        char secret = 0;
+        int b = 0;
+    };
+
+    class Unreflected : public ShadowEngine::SHObject {
+        SHObject_Base(Unreflected, ShadowEngine::SHObject)
+    };
+}
+
+using namespace serialization_tests;
+
+SHObject_Fields_Impl(Point, SH_FIELD(x), SH_FIELD(y))
+
+SHObject_Base_Impl(Everything)
+SHObject_Fields_Impl(Everything, SH_FIELD(count), SH_FIELD(scale), SH_FIELD(name), SH_FIELD(numbers), SH_FIELD(tags), SH_FIELD(origin))
+
+SHObject_Base_Impl(Derived)
+SHObject_Fields_Impl(Derived, SH_FIELD(extra))
+
+SHObject_Base_Impl(Padded)
+SHObject_Fields_Impl(Padded, SH_FIELD(a), SH_FIELD(b))
+
+SHObject_Base_Impl(Unreflected)
+
+using ShadowEngine::Serializer;
+
+TEST_CASE("Every kind of field survives a snapshot", "[serialization]") {
+    Derived saved;
+    saved.count = 42;
+    saved.scale = 2.5;
+    saved.name = "fox";
+    saved.numbers = { 1, 2, 3 };
+    saved.tags = { "a", "", "long tag" };
+    saved.origin = { 1.5f, -3.0f };
+    saved.extra = 7;
+
+    const auto snapshot = Serializer::Snapshot(saved);
+
+    Derived loaded;
+    loaded.numbers = { 9, 9, 9, 9, 9 };
+    Serializer::Restore(loaded, snapshot);
+
+    REQUIRE(loaded.count == 42);
+    REQUIRE(loaded.scale == 2.5);
+    REQUIRE(loaded.name == "fox");
+    REQUIRE(loaded.numbers == std::vector<int> { 1, 2, 3 });
+    REQUIRE(loaded.tags == std::vector<std::string> { "a", "", "long tag" });
+    REQUIRE(loaded.origin.x == 1.5f);
+    REQUIRE(loaded.origin.y == -3.0f);
+    REQUIRE(loaded.extra == 7);
+}
+
+TEST_CASE("Adjacent trivial fields are copied together", "[serialization]") {
+    const auto& steps = Point::Fields().GetSteps();
+    REQUIRE(steps.size() == 1);
+    REQUIRE(steps[0].field == nullptr);
+    REQUIRE(steps[0].size == 2 * sizeof(float));
+}
+
+TEST_CASE("Unreflected members between reflected fields are left alone", "[serialization]") {
+    // Regression: a and b used to be merged into one copy, because b starts at a's end rounded up to b's alignment.
+    REQUIRE(Padded::Fields().GetSteps().size() == 2);
+
+    Padded saved;
+    saved.a = 'a';
+    saved.secret = 'x';
+    saved.b = 1234;
+    const auto snapshot = Serializer::Snapshot(saved);
+
+    Padded loaded;
+    loaded.secret = 'y';
+    Serializer::Restore(loaded, snapshot);
+
+    REQUIRE(loaded.a == 'a');
+    REQUIRE(loaded.b == 1234);
+    REQUIRE(loaded.secret == 'y');
+}
+
+TEST_CASE("Corrupt snapshots are rejected", "[serialization]") {
+    Everything saved;
+    saved.name = "truncated";
+    saved.numbers = { 1, 2, 3, 4 };
+    const auto snapshot = Serializer::Snapshot(saved);
+
+    SECTION("Truncated") {
+        for (size_t length : { size_t(0), size_t(12), snapshot.size() / 2, snapshot.size() - 1 }) {
+            Everything loaded;
+            REQUIRE_THROWS(Serializer::Restore(loaded, std::span(snapshot).first(length)));
+        }
+    }
+
+    SECTION("Of another type") {
+        Derived loaded;
+        REQUIRE_THROWS(Serializer::Restore(loaded, snapshot));
+    }
+
+    SECTION("With a different layout") {
+        auto changed = snapshot;
+        changed[8] ^= std::byte { 1 };
+        Everything loaded;
+        REQUIRE_THROWS(Serializer::Restore(loaded, changed));
+    }
+
+    SECTION("With a length longer than the data") {
+        // The string's length comes straight after the header, count and scale.
+        auto changed = snapshot;
+        const uint64_t huge = ~uint64_t(0);
+        std::memcpy(changed.data() + 16 + sizeof(int) + sizeof(double), &huge, sizeof(huge));
+        Everything loaded;
+        REQUIRE_THROWS(Serializer::Restore(loaded, changed));
+    }
+}
+
+TEST_CASE("Types that don't reflect their fields can't be snapshot", "[serialization]") {
+    Unreflected object;
+    REQUIRE_THROWS(Serializer::Snapshot(object));
+}
@@ -0,0 +1,73 @@
+#include "catch2/catch.hpp"
+#include "SHObject.h"
+
+using ShadowEngine::TypeInfo;
+using ShadowEngine::TypeRegistry;
+
+namespace type_registry_tests {
+
+    class Widget : public ShadowEngine::SHObject {
+        SHObject_Base(Widget, ShadowEngine::SHObject)
+    };
+
+    SHObject_Base_Impl(Widget)
+
+    // A module's copy of a type's info, as a reloaded module has its own.
+    TypeInfo moduleCopy(const TypeInfo& info) {
+        return info;
+    }
+
+    TEST_CASE("Types register themselves when their module loads", "[registry]") {
+        REQUIRE(TypeRegistry::Find(Widget::TypeId()) == &Widget::StaticTypeInfo());
+        REQUIRE(TypeRegistry::Find(Widget::StaticTypeInfo().name) == &Widget::StaticTypeInfo());
+
+        const auto object = std::unique_ptr<ShadowEngine::SHObject>(TypeRegistry::Create(Widget::TypeId()));
+        REQUIRE(object != nullptr);
+        REQUIRE(object->GetTypeId() == Widget::TypeId());
+        REQUIRE(TypeRegistry::Create(12345) == nullptr);
+    }
+
+    TEST_CASE("An unloading module leaves the entry of the module that replaced it", "[registry]") {
+        const TypeInfo& original = Widget::StaticTypeInfo();
+        const TypeInfo reloaded = moduleCopy(original);
+
+        // The reloaded module registers before the old one unloads.
+        TypeRegistry::Register(reloaded);
+        REQUIRE(TypeRegistry::Find(Widget::TypeId()) == &reloaded);
+        TypeRegistry::Unregister(original);
+        REQUIRE(TypeRegistry::Find(Widget::TypeId()) == &reloaded);
+
+        TypeRegistry::Unregister(reloaded);
+        REQUIRE(TypeRegistry::Find(Widget::TypeId()) == nullptr);
+
+        // Put things back for the other tests.
+        TypeRegistry::Register(original);
+        REQUIRE(TypeRegistry::Find(Widget::TypeId()) == &original);
+    }
+
+    TEST_CASE("Looked up infos stay put while other types come and go", "[registry]") {
+        const TypeInfo* found = TypeRegistry::Find(Widget::TypeId());
+        REQUIRE(found != nullptr);
+
+        static constexpr uint64_t ancestors[] { 0 };
+        std::vector<std::string> names;
+        std::vector<TypeInfo> others;
+        for (int i = 0; i < 1000; i++) names.push_back("type_registry_tests::Other" + std::to_string(i));
+        for (const auto& name : names)
+            others.push_back({ shadowutil::fnv1a64(name), name, 0, nullptr, 0, ancestors, nullptr });
+
+        for (const auto& info : others) TypeRegistry::Register(info);
+        REQUIRE(TypeRegistry::Find(Widget::TypeId()) == found);
+        REQUIRE(found->name == Widget::StaticTypeInfo().name);
+        for (const auto& info : others) TypeRegistry::Unregister(info);
+        REQUIRE(TypeRegistry::Find(others[0].id) == nullptr);
+        REQUIRE(TypeRegistry::Find(Widget::TypeId()) == found);
+    }
+
+    TEST_CASE("Different types with the same ID are refused", "[registry]") {
+        static constexpr uint64_t ancestors[] { 0 };
+        const TypeInfo impostor { Widget::TypeId(), "type_registry_tests::Impostor", 0, nullptr, 0, ancestors, nullptr };
+        REQUIRE_THROWS_WITH(TypeRegistry::Register(impostor), Catch::Contains("collision"));
+        REQUIRE(TypeRegistry::Find(Widget::TypeId()) == &Widget::StaticTypeInfo());
+    }
+}
@@ -2,6 +2,12 @@
 
 #include "vlkx/render/shader/Pipeline.h"
 #include "Loader.h"
+#include "CookedMesh.h"
+#include "MeshBounds.h"
+#include "MeshLod.h"
+#include "Meshlet.h"
+#include "MeshQuantizer.h"
+#include <glm/glm.hpp>
 #include "vlkx/render/render_pass/GenericRenderPass.h"
 #include "vlkx/vulkan/abstraction/Descriptor.h"
 
@@ -18,6 +24,14 @@ namespace vlkxtemp {
         using BindingPoints = std::map<TextureType, uint32_t>;
         using TextureSource = vlkx::RefCountedTexture::ImageLocation;
         using TextureSources = std::map<TextureType, std::vector<TextureSource>>;
+        using VertexLayout = CookedMesh::VertexLayout;
+
+        // How a model's vertices are spread across bindings. Split positions sit alone in binding 0, so that a pass
+        //  which only needs depth fetches nothing else; the rest of each vertex moves to binding 1.
+        enum class VertexStreams {
+            Interleaved,
+            SplitPositions
+        };
 
         class ModelResource {
         public:
@@ -25,28 +39,55 @@ namespace vlkxtemp {
             virtual void load(ModelBuilder* builder) const = 0;
         };
 
+        // An OBJ file. It is cooked into a .smesh beside it on first load, and read from that while it is up to date.
+        // Packed vertices need a shader that unpacks them; see Geo::VertexPacked.
+        // The cooked file keeps the levels of detail the settings made. Tighter settings later trim them, but looser ones
+        //  only take effect once it is cooked again.
         class SingleMeshModel : public ModelResource {
         public:
-            SingleMeshModel(std::string&& path, int indexBase, TextureSources&& sources)
-                : objFile(std::move(path)), objIndexBase(indexBase), textureSources(std::move(sources)) {}
+            SingleMeshModel(std::string&& path, int indexBase, TextureSources&& sources, VertexLayout layout = VertexLayout::VertexAll,
+                            VertexStreams streams = VertexStreams::Interleaved, const LodSettings& lods = {})
+                : objFile(std::move(path)), objIndexBase(indexBase), textureSources(std::move(sources)), vertexLayout(layout), vertexStreams(streams),
+                  lodSettings(lods) {}
 
             void load(ModelBuilder* builder) const override;
         private:
             const std::string objFile;
             const int objIndexBase;
             const TextureSources textureSources;
+            const VertexLayout vertexLayout;
+            const VertexStreams vertexStreams;
+            const LodSettings lodSettings;
+        };
+
+        // A cooked .smesh file, with the same textures for every mesh in it. Its vertices are drawn in the layout they were cooked in.
+        // Its levels of detail were made when it was cooked; the settings can only trim them.
+        class CookedMeshModel : public ModelResource {
+        public:
+            CookedMeshModel(std::string&& path, TextureSources&& sources, VertexStreams streams = VertexStreams::Interleaved, const LodSettings& lods = {})
+                : meshFile(std::move(path)), textureSources(std::move(sources)), vertexStreams(streams), lodSettings(lods) {}
+
+            void load(ModelBuilder* builder) const override;
+        private:
+            const std::string meshFile;
+            const TextureSources textureSources;
+            const VertexStreams vertexStreams;
+            const LodSettings lodSettings;
         };
 
+        // A binary glTF (.glb) file, with a mesh per primitive; see ModelLoader. Its textures are found in textureDir.
         class MultiMeshModel : public ModelResource {
         public:
-            MultiMeshModel(std::string&& modelDir, std::string&& textureDir)
-                : models(std::move(modelDir)), textures(std::move(textureDir)) {}
+            MultiMeshModel(std::string&& modelFile, std::string&& textureDir, VertexStreams streams = VertexStreams::Interleaved, const LodSettings& lods = {})
+                : model(std::move(modelFile)), textures(std::move(textureDir)), vertexStreams(streams), lodSettings(lods) {}
 
             void load(ModelBuilder* builder) const override;
 
         private:
-            const std::string models;
+            const std::string model;
             const std::string textures;
+            const VertexStreams vertexStreams;
+            const LodSettings lodSettings;
         };
 
         struct ModelPushConstant {
@@ -61,6 +102,14 @@ namespace vlkxtemp {
 
         using Descriptors = std::vector<std::unique_ptr<vlkx::StaticDescriptor>>;
 
+        // What choosing a mesh's level of detail, and culling it or its meshlets, needs to know about it.
+        struct MeshDetail {
+            MeshBounds bounds;
+            std::vector<LodLevel> levels;
+            Geo::VertexPacked::Dequantization dequantization;     // Unused unless the vertices are packed
+            std::vector<Meshlet> meshlets;                        // Of the full level; empty if it is always drawn whole
+        };
+
         ModelBuilder(std::string&& name, int frames, float aspect, const ModelResource& resource);
 
         ModelBuilder(const ModelBuilder&) = delete;
@@ -74,16 +123,26 @@ namespace vlkxtemp {
         ModelBuilder& pushStage(VkShaderStageFlags stage);
         ModelBuilder& pushConstant(const vlkx::PushConstant* constant, uint32_t offset);
         ModelBuilder& shader(VkShaderStageFlagBits stage, std::string&& file);
+        // Declare only the position to the pipeline, for depth prepasses and shadows. Other attributes are never fetched;
+        //  with split streams, nothing but positions is read at all.
+        ModelBuilder& positionsOnly();
 
         std::unique_ptr<Model> build();
 
     private:
         std::vector<Descriptors> createDescs() const;
+        void setVertices(std::vector<vlkx::PerVertexBuffer::NoShareMeta::PerMesh>&& meshes, VertexLayout layout, VertexStreams streams);
+        void loadCooked(const CookedMesh& mesh, const TextureSources& sources, VertexStreams streams, const LodSettings& lods);
+        void addMeshTextures(const TextureSources& sources);
 
         const int frames;
         const float aspectRatio;
 
         std::unique_ptr<vlkx::StaticPerVertexBuffer> vertexBuffer;
+        VertexLayout vertexLayout = VertexLayout::VertexAll;
+        std::vector<uint32_t> streamStrides;
+        bool onlyPositions = false;
+        std::vector<MeshDetail> details;
         std::vector<TexturePerMesh> textures;
         TexturePerMesh sharedTextures;
         BindingPoints bindPoints;
@@ -99,34 +158,74 @@ namespace vlkxtemp {
     class Model {
     public:
 
+        // Where the camera is, and how much of the screen one unit covers, for choosing levels of detail.
+        struct LodView {
+            glm::vec3 eye;
+            float pixelsPerUnit;    // Pixels covered by one unit, one unit away from the eye
+
+            // For a vertical field of view in degrees, as PerspectiveCamera has.
+            static LodView perspective(const glm::vec3& eye, float fov, float screenHeight);
+        };
+
+        // Where the camera is, and what it can see, for culling meshlets.
+        struct ClusterView {
+            glm::vec3 eye;
+            glm::mat4 viewProjection;
+        };
+
         Model(const Model&) = delete;
         Model& operator=(const Model&) = delete;
 
         void update(bool opaque, const VkExtent2D& frame, VkSampleCountFlagBits samples, const vlkx::RenderPass& pass, uint32_t subpass, bool flipY = true);
+
+        // Choose the level of detail of each mesh for one instance, from how large its bounding sphere appears.
+        // The choice only changes once it is clearly better, so an instance hovering at a boundary doesn't flicker.
+        // Instances that are never given a level draw at full detail.
+        void selectLod(const LodView& view, const glm::mat4& transform, uint32_t instance = 0);
+        // Cull the meshlets of each mesh's full level for one instance, leaving those inside the frustum that face the eye.
+        // Call it again whenever the camera or the transform moves. Instances that are never culled draw every meshlet.
+        void cullClusters(const ClusterView& view, const glm::mat4& transform, uint32_t instance = 0);
         void draw(const VkCommandBuffer& commands, int frame, uint32_t instances) const;
 
+        // Bounds in model space, around every mesh or around one.
+        const MeshBounds& getBounds() const { return bounds; }
+        const MeshBounds& getBounds(size_t mesh) const { return details[mesh].bounds; }
+        // Bounds around every mesh of an instance placed by the given transform.
+        MeshBounds getBounds(const glm::mat4& transform) const { return transformBounds(bounds, transform); }
+
     private:
         friend std::unique_ptr<Model> ModelBuilder::build();
         using Descriptors = ModelBuilder::Descriptors;
         using ModelPushConstant = ModelBuilder::ModelPushConstant;
         using TexturePerMesh = ModelBuilder::TexturePerMesh;
+        using MeshDetail = ModelBuilder::MeshDetail;
 
         Model(float aspectRatio,
               std::unique_ptr<vlkx::StaticPerVertexBuffer>&& vertexBuffer,
+              uint32_t vertexStreams,
+              std::vector<MeshDetail>&& details,
+              const MeshBounds& bounds,
               std::vector<vlkx::PerInstanceVertexBuffer*>&& perInstanceBuffers,
               std::optional<ModelPushConstant>&& pushConstants,
+              std::optional<VkPushConstantRange> dequantizeRange,
               TexturePerMesh&& sharedTextures,
               std::vector<TexturePerMesh>&& textures,
               std::vector<Descriptors>&& descriptors,
               std::unique_ptr<vlkx::GraphicsPipelineBuilder>&& pipelineBuilder)
-              : aspectRatio(aspectRatio), vertexBuffer(std::move(vertexBuffer)), perInstanceBuffers(std::move(perInstanceBuffers)),
-                pushConstants(std::move(pushConstants)), sharedTextures(std::move(sharedTextures)), textures(std::move(textures)),
+              : aspectRatio(aspectRatio), vertexBuffer(std::move(vertexBuffer)), vertexStreams(vertexStreams), details(std::move(details)), bounds(bounds), perInstanceBuffers(std::move(perInstanceBuffers)),
+                pushConstants(std::move(pushConstants)), dequantizeRange(dequantizeRange), sharedTextures(std::move(sharedTextures)), textures(std::move(textures)),
                 descriptors(std::move(descriptors)), pipelineBuilder(std::move(pipelineBuilder)) {}
 
         const float aspectRatio;
         const std::unique_ptr<vlkx::StaticPerVertexBuffer> vertexBuffer;
+        const uint32_t vertexStreams;     // Instance buffers bind after these
+        const std::vector<MeshDetail> details;
+        const MeshBounds bounds;
+        std::vector<std::vector<size_t>> lodChosen;     // By instance, then mesh
+        std::vector<std::optional<std::vector<std::vector<uint32_t>>>> clustersVisible;     // By instance, then mesh; unset if never culled
         const std::vector<vlkx::PerInstanceVertexBuffer*> perInstanceBuffers;
         const std::optional<ModelPushConstant> pushConstants;
+        const std::optional<VkPushConstantRange> dequantizeRange;   // Where each mesh's Dequantization is pushed, if its vertices are packed
         const TexturePerMesh sharedTextures;
         const std::vector<TexturePerMesh> textures;
         const std::vector<Descriptors> descriptors;
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <shadow/util/File.h>
+#include "vlkx/render/Geometry.h"
+#include "MeshBounds.h"
+#include "MeshLod.h"
+#include "Meshlet.h"
+#include "MeshQuantizer.h"
+
+namespace vlkxtemp {
+
+    // A .smesh file: meshes converted ahead of time into exactly the layout the GPU buffers use,
+    //  so that loading one is a copy out of the mapped file with no per-vertex work.
+    //
+    // The file is a Header, then a Range for each mesh, then the LodLevels of every mesh, then the Meshlets of every mesh,
+    //  then the indices of every mesh, then the vertices of every mesh. The index and vertex payloads each start on a 16-byte boundary.
+    // Everything is little-endian. Each mesh's indices count from its own first vertex, and hold all of its levels.
+    // Indices are 16-bit when every mesh is small enough for them, otherwise 32-bit.
+    class CookedMesh {
+    public:
+        static constexpr uint32_t currentVersion = 5;
+        static constexpr size_t payloadAlignment = 16;
+
+        enum class VertexLayout : uint32_t {
+            VertexAll = 1,      // Geo::VertexAll
+            Packed = 2          // Geo::VertexPacked, quantized across each mesh's bounds
+        };
+
+        struct Header {
+            char magic[4];              // "SMSH"
+            uint32_t version;
+            VertexLayout layout;
+            uint32_t vertexStride;
+            uint32_t indexSize;         // Bytes per index
+            uint32_t meshCount;
+            uint64_t indexOffset;       // From the start of the file
+            uint64_t indexBytes;
+            uint64_t vertexOffset;
+            uint64_t vertexBytes;
+            uint32_t lodCount;          // Across all meshes
+            uint32_t meshletCount;      // Across all meshes
+        };
+
+        struct Range {
+            uint32_t firstIndex;
+            uint32_t indexCount;
+            uint32_t firstVertex;
+            uint32_t vertexCount;
+            uint32_t firstLod;
+            uint32_t lodCount;          // At least one; the first is the full mesh
+            uint32_t firstMeshlet;
+            uint32_t meshletCount;      // Splitting up the first level; zero if the mesh is drawn whole
+            QuantizationBounds quantization;    // What packed vertices are spread across. Filled in for every layout
+            float center[3];                    // Of a sphere around every vertex
+            float radius;
+        };
+
+        // One mesh to write.
+        struct Mesh {
+            std::span<const uint32_t> indices;
+            std::span<const Geo::VertexAll> vertices;
+            std::span<const LodLevel> lods;         // Empty if the mesh has no levels but the full one
+            std::span<const Meshlet> meshlets;      // Of the full level, if it was split up
+        };
+
+        // Open a cooked mesh, from the VFS if it is mounted there, otherwise from disk. Throws if it is malformed.
+        // Uncompressed entries and files are read in place; a compressed entry is decoded into memory of its own.
+        explicit CookedMesh(const std::string& path);
+
+        CookedMesh(const CookedMesh&) = delete;
+        CookedMesh& operator=(const CookedMesh&) = delete;
+
+        size_t meshCount() const { return ranges.size(); }
+        const Range& range(size_t mesh) const { return ranges[mesh]; }
+        MeshBounds bounds(size_t mesh) const;
+        VertexLayout layout() const { return header->layout; }
+        uint32_t indexSize() const { return header->indexSize; }
+
+        // Views into the file; valid as long as this is.
+        // The index and vertex types must match indexSize() and layout(); they are told apart by size.
+        template <typename Index>
+        std::span<const Index> indices(size_t mesh) const {
+            if (sizeof(Index) != header->indexSize)
+                throw std::runtime_error("Cooked mesh indices are " + std::to_string(header->indexSize) + " bytes, not " + std::to_string(sizeof(Index)));
+            const auto* all = reinterpret_cast<const Index*>(bytes.data() + header->indexOffset);
+            return { all + ranges[mesh].firstIndex, ranges[mesh].indexCount };
+        }
+
+        template <typename Vertex>
+        std::span<const Vertex> vertices(size_t mesh) const {
+            if (sizeof(Vertex) != header->vertexStride)
+                throw std::runtime_error("Cooked mesh vertices are " + std::to_string(header->vertexStride) + " bytes, not " + std::to_string(sizeof(Vertex)));
+            const auto* all = reinterpret_cast<const Vertex*>(bytes.data() + header->vertexOffset);
+            return { all + ranges[mesh].firstVertex, ranges[mesh].vertexCount };
+        }
+
+        std::span<const LodLevel> lods(size_t mesh) const;
+        std::span<const Meshlet> meshlets(size_t mesh) const;
+
+        // Cook meshes into a file, packing their vertices into the given layout.
+        // The file is replaced in one step, so a reader never sees half of it.
+        static void write(const std::string& path, const std::vector<Mesh>& meshes, VertexLayout layout = VertexLayout::VertexAll);
+
+    private:
+        std::optional<shadowutil::MappedFile> file;     // Unset if the data belongs to the VFS
+        std::vector<std::byte> decoded;                 // A compressed VFS entry, decompressed
+        std::span<const std::byte> bytes;
+        const Header* header;
+        std::span<const Range> ranges;
+        std::span<const LodLevel> levels;
+        std::span<const Meshlet> clusters;
+    };
+}
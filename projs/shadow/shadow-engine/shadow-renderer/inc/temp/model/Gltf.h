@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <shadow/util/File.h>
+#include <shadow/util/Json.h>
+
+namespace vlkxtemp {
+
+    // A binary glTF 2.0 file (.glb): a JSON chunk describing the scene, then a BIN chunk holding the data it refers to.
+    // The file is mapped and its JSON parsed once. Buffer views and accessors are views straight into the BIN chunk,
+    //  valid as long as this is.
+    // Only the GLB's own buffer is supported; buffers in other files, and sparse accessors, are not.
+    class BinaryGltf {
+    public:
+        enum class ComponentType : uint32_t {
+            Byte = 5120,
+            UnsignedByte = 5121,
+            Short = 5122,
+            UnsignedShort = 5123,
+            UnsignedInt = 5125,
+            Float = 5126
+        };
+
+        // Elements of one type, laid out in the BIN chunk.
+        struct Accessor {
+            std::span<const std::byte> data;    // From the start of the first element to the end of the last
+            size_t count;
+            size_t stride;                      // Bytes from one element to the next
+            ComponentType componentType;
+            uint32_t components;                // 1 for SCALAR, up to 16 for MAT4
+            bool normalized;
+        };
+
+        // An image, either beside the file or inside it.
+        struct Image {
+            std::string_view uri;               // Relative to the file; empty if the image is embedded
+            std::span<const std::byte> data;    // The encoded image, if embedded
+            std::string_view mimeType;
+        };
+
+        // Open a .glb, from the VFS if it is mounted there, otherwise from disk. Throws if it is malformed.
+        explicit BinaryGltf(const std::string& path);
+
+        BinaryGltf(const BinaryGltf&) = delete;
+        BinaryGltf& operator=(const BinaryGltf&) = delete;
+
+        const shadowutil::JsonValue& json() const { return document; }
+
+        std::span<const std::byte> bufferView(size_t index) const;
+        Accessor accessor(size_t index) const;
+        Image image(size_t index) const;
+
+        // Read the first `components` values of each element as floats, converting integers as the accessor says.
+        // Element i is written to `out + i * outStride` bytes, so the values can go straight into a vertex.
+        static void readFloats(const Accessor& accessor, std::byte* out, size_t outStride, uint32_t components);
+
+        // Read scalar indices, widened to 32 bits.
+        static void readIndices(const Accessor& accessor, uint32_t* out);
+
+    private:
+        std::string path;
+        std::optional<shadowutil::MappedFile> file;     // Unset if the data belongs to the VFS
+        std::span<const std::byte> binary;
+        shadowutil::JsonValue document;
+    };
+}
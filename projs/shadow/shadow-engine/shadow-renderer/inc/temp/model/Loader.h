@@ -2,9 +2,12 @@
 #include <string>
 #include <vector>
 #include "vlkx/render/Geometry.h"
+#include "MeshBounds.h"
 
 namespace vlkxtemp {
 
+    // A mesh read from an OBJ file, with every face as triangles.
+    // Corners that share a position, texture coordinate and normal become one vertex.
     struct Wavefront {
         Wavefront(std::string_view path, size_t base);
         Wavefront(const Wavefront&) = delete;
@@ -13,6 +16,7 @@ namespace vlkxtemp {
 
         std::vector<uint32_t> indices;
         std::vector<Geo::VertexAll> vertices;
+        MeshBounds bounds;
     };
 
     class ModelLoader {
@@ -26,6 +30,7 @@ namespace vlkxtemp {
         };
 
         struct TextureData {
+            TextureData(std::string path, TextureType type) : path(std::move(path)), type(type) {}
             TextureData(TextureData&&) noexcept = default;
             TextureData& operator=(TextureData&&) noexcept = default;
 
@@ -41,17 +46,24 @@ namespace vlkxtemp {
             std::vector<Geo::VertexAll> vertices;
             std::vector<uint32_t> indices;
             std::vector<TextureData> textures;
+            MeshBounds bounds;      // Where the scene places the mesh
         };
 
+        // Load every triangle primitive of a binary glTF (.glb) file as its own mesh, placed where the default scene puts it.
+        // Textures are looked for under the given directory; images embedded in the file are extracted there on first load.
+        // Base color textures become Diffuse, and metallic-roughness textures Specular.
         ModelLoader(const std::string& model, const std::string& textures);
 
         ModelLoader(const ModelLoader&) = delete;
         ModelLoader& operator=(const ModelLoader&) = delete;
 
         const std::vector<MeshData>& getMeshes() const { return meshes; }
+        // Around every mesh.
+        const MeshBounds& getBounds() const { return bounds; }
 
     private:
 
         std::vector<MeshData> meshes;
+        MeshBounds bounds {};
     };
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <span>
+#include "vlkx/render/Geometry.h"
+
+namespace vlkxtemp {
+
+    // A box along the axes and a sphere, each around every vertex of a mesh or a group of meshes.
+    // The box is the tighter fit; the sphere is cheaper to test against, and stays the same shape under rotation.
+    struct MeshBounds {
+        float min[3];
+        float max[3];
+        float center[3];        // Of the sphere
+        float radius;
+    };
+
+    // The sphere is centered on the box. Bounds of no vertices are all zero.
+    MeshBounds computeBounds(std::span<const Geo::VertexAll> vertices);
+
+    // The box around both boxes, and the smallest sphere around both spheres.
+    MeshBounds mergeBounds(const MeshBounds& a, const MeshBounds& b);
+
+    // Bounds around bounds that have been moved by a transform, as for one instance of a model.
+    // The box is the tightest around the transformed box (Arvo 1990). The sphere grows by the largest scale on any axis,
+    //  which covers any mix of translation, rotation and scale, but not shear.
+    MeshBounds transformBounds(const MeshBounds& bounds, const glm::mat4& transform);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "vlkx/render/Geometry.h"
+
+namespace vlkxtemp {
+
+    // One level of detail of a mesh: a run of its indices, drawn with the same vertices as every other level.
+    // Level 0 is the full mesh; each level after it is coarser.
+    struct LodLevel {
+        uint32_t firstIndex;    // Relative to the mesh's own first index
+        uint32_t indexCount;
+        float error;            // How far this level strays from the full mesh, in model units
+    };
+
+    struct LodSettings {
+        uint32_t maxLevels = 4;         // Including the full mesh
+        float reduction = 0.5f;         // Each level aims for this fraction of the triangles of the one before
+        float maxError = 0.05f;         // Stop once a level would stray further than this fraction of the mesh's radius
+    };
+
+    // Simplify a mesh into a chain of levels and append each level's indices after the full mesh's.
+    // Each level is optimized for the vertex cache on its own. The chain stops early once simplifying stops paying off.
+    std::vector<LodLevel> generateLods(std::vector<uint32_t>& indices, std::span<const Geo::VertexAll> vertices, const LodSettings& settings = {});
+
+    // The first of a chain of levels, made earlier, that the settings still allow: no more than maxLevels, and none past
+    //  maxError of a mesh of the given radius. How far each level was reduced is fixed when it is made, so that is not checked.
+    std::span<const LodLevel> limitLods(std::span<const LodLevel> levels, float radius, const LodSettings& settings);
+
+    // Choose which level to draw, given how many pixels one model unit covers at the mesh, and the level chosen last time.
+    // A level is close enough when its error covers at most `pixelError` pixels. Moving to a coarser level requires it
+    //  to be close enough by a margin of `hysteresis`, so a mesh sitting at the boundary doesn't flicker between the two.
+    size_t selectLod(std::span<const LodLevel> levels, float pixelsPerUnit, size_t current, float pixelError = 1, float hysteresis = 0.25f);
+}
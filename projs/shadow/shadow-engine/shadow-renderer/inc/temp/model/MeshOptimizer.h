@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "vlkx/render/Geometry.h"
+
+namespace vlkxtemp {
+
+    // How well an index order uses the GPU's post-transform vertex cache, simulated as a FIFO.
+    struct VertexCacheStats {
+        float acmr = 0;     // Average cache miss ratio: vertex shader runs per triangle. 3 is worst; about 0.5 is ideal
+        float atvr = 0;     // Average transform to vertex ratio: vertex shader runs per vertex. 1 is ideal
+    };
+
+    // Cache statistics before and after optimizeMesh.
+    struct MeshOptimizationReport {
+        VertexCacheStats before;
+        VertexCacheStats after;
+    };
+
+    // The cache size the optimizations aim at. Most hardware has at least this many entries, and doing well on a
+    //  small cache does well on a larger one too.
+    constexpr uint32_t vertexCacheSize = 16;
+
+    VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = vertexCacheSize);
+
+    // Reorder triangles so that each one reuses vertices that are still in the cache (Tipsify; Sander et al. 2007).
+    void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize = vertexCacheSize);
+
+    // Reorder clusters of triangles so that the ones facing outwards draw first, which lets early depth testing
+    //  reject more of what is behind them. Expects indices already optimized for the cache; clusters are only split
+    //  where that costs less than `threshold` times the current cache miss ratio.
+    void optimizeOverdraw(std::span<uint32_t> indices, std::span<const Geo::VertexAll> vertices, float threshold = 1.05f, uint32_t cacheSize = vertexCacheSize);
+
+    // Reorder vertices into the order the indices first use them, so that fetching them walks memory forwards.
+    // Vertices that no index uses are dropped.
+    void optimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<Geo::VertexAll>& vertices);
+
+    // All of the above, in the order they need to run.
+    MeshOptimizationReport optimizeMesh(std::vector<uint32_t>& indices, std::vector<Geo::VertexAll>& vertices);
+
+    // Remove triangles by collapsing edges, cheapest first by quadric error (Garland & Heckbert 1997), until at most
+    //  `targetIndexCount` indices are left or the next collapse would move the surface further than `maxError`.
+    // Collapses only move a vertex onto a neighbour, so the result indexes the same vertices.
+    // Open borders and UV or normal seams only collapse along themselves, and the points where they meet never move.
+    // `error`, if given, receives how far the surface moved, in the same units as the positions.
+    std::vector<uint32_t> simplifyMesh(std::span<const uint32_t> indices, std::span<const Geo::VertexAll> vertices,
+                                       size_t targetIndexCount, float maxError, float* error = nullptr);
+}
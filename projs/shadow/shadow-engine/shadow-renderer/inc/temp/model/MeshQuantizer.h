@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "vlkx/render/Geometry.h"
+
+namespace vlkxtemp {
+
+    // The boxes that packed positions and texture coordinates are spread across.
+    struct QuantizationBounds {
+        float min[3];
+        float max[3];
+        float textureMin[2];
+        float textureMax[2];
+    };
+
+    QuantizationBounds quantizationBounds(std::span<const Geo::VertexAll> vertices);
+
+    // Pack vertices into Geo::VertexPacked. Positions and texture coordinates are rounded to the nearest of 65536
+    //  steps across the bounds, so a position is off by at most 1/131070 of the box's size on each axis.
+    std::vector<Geo::VertexPacked> packVertices(std::span<const Geo::VertexAll> vertices, const QuantizationBounds& bounds);
+
+    Geo::VertexPacked::Dequantization dequantization(const QuantizationBounds& bounds);
+
+    // Whether 16-bit indices can address every vertex of a mesh.
+    constexpr bool fitsShortIndices(size_t vertexCount) { return vertexCount <= 65536; }
+
+    // Narrow indices to 16 bits. They must already fit.
+    std::vector<uint16_t> narrowIndices(std::span<const uint32_t> indices);
+}
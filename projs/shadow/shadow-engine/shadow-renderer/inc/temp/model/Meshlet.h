@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "vlkx/render/Geometry.h"
+
+namespace vlkxtemp {
+
+    // What culling a meshlet needs to know about it, in model space.
+    struct MeshletBounds {
+        float center[3];
+        float radius;           // Of a sphere around every vertex of the meshlet
+        float coneAxis[3];      // The average direction its triangles face
+        float coneCutoff;       // Sine of the widest angle between the axis and any triangle's normal; 1 if too wide to cull with
+    };
+
+    // A small cluster of a mesh's triangles. Its indices are contiguous, so it can be drawn on its own.
+    struct Meshlet {
+        uint32_t firstIndex;    // Relative to the mesh's own first index
+        uint32_t indexCount;
+        MeshletBounds bounds;
+    };
+
+    struct MeshletSettings {
+        uint32_t maxVertices = 64;
+        uint32_t maxTriangles = 124;
+    };
+
+    // Whether a mesh has enough triangles that culling it in meshlets saves more than the culling costs.
+    constexpr bool worthMeshlets(size_t indexCount) { return indexCount / 3 >= 4096; }
+
+    // Split triangles into meshlets and reorder the indices so that each meshlet's are contiguous.
+    // Each meshlet grows from a seed across the neighbouring triangles that add the fewest new vertices, preferring those
+    //  that face the same way, so that its sphere stays small and its cone narrow.
+    // Meshlets keep the order of the triangles they start from, and each is reordered for the vertex cache, so indices
+    //  from optimizeMesh lose as little of their cache and overdraw order as meshlets allow.
+    std::vector<Meshlet> buildMeshlets(std::span<uint32_t> indices, std::span<const Geo::VertexAll> vertices, const MeshletSettings& settings = {});
+
+    // The camera, in the model space of the meshlets being culled.
+    struct MeshletView {
+        float planes[6][4];     // Normalized, facing inwards: a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+        float eye[3];
+        bool cones;             // Whether to cull by normal cones, which only hold if the model isn't scaled unevenly
+    };
+
+    // Append the index of every meshlet that may be visible: those at least partly inside the frustum and not facing
+    //  wholly away from the eye. The indices are in order, so meshlets next to each other can be drawn together.
+    void cullMeshlets(std::span<const Meshlet> meshlets, const MeshletView& view, std::vector<uint32_t>* visible);
+}
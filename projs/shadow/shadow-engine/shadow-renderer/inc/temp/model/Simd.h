@@ -0,0 +1,8 @@
+#pragma once
+
+// SSE2 is part of every x86-64 processor, so 64-bit builds always have it. Code that uses it keeps a scalar path for
+//  everything else.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define VLKX_SSE2 1
+#endif
@@ -2,6 +2,7 @@
 
 #include <vulkan/vulkan.h>
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #define GLM_FORCE_RADIAN
@@ -77,6 +78,49 @@ namespace Geo {
         }
     };
 
+    // VertexAll packed into half the space. The GPU unpacks each attribute to floats as it fetches it, but positions
+    //  and texture coordinates come out in 0..1 across the mesh's bounds; the vertex shader scales them back with the
+    //  mesh's Dequantization:
+    //      position = in_pos * d.positionScale.xyz + d.positionOffset.xyz;
+    //      uv = in_uv * d.texture.xy + d.texture.zw;
+    // Normals are octahedral (Cigolle et al. 2014); unfold them with:
+    //      vec3 n = vec3(in_normal, 1 - abs(in_normal.x) - abs(in_normal.y));
+    //      float t = max(-n.z, 0);
+    //      n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0)));
+    //      normal = normalize(n);
+    struct VertexPacked {
+        uint16_t position[4];   // Unsigned normalized XYZ across the mesh's bounding box. W is padding.
+        int16_t normal[2];      // Signed normalized octahedral unit vector.
+        uint16_t texture[2];    // Unsigned normalized u/v across the mesh's texture coordinate bounds.
+
+        // How to turn one mesh's packed values back into model space. Laid out for a push constant.
+        struct Dequantization {
+            glm::vec4 positionScale;    // XYZ; W unused
+            glm::vec4 positionOffset;   // XYZ; W unused
+            glm::vec4 texture;          // Scale in XY, offset in ZW
+        };
+
+        // How fast should vertex data be read from RAM?
+        static VkVertexInputBindingDescription getBindingDesc() {
+            VkVertexInputBindingDescription desc = {};
+            desc.binding = 0;
+            desc.stride = sizeof(VertexPacked);
+            desc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+            return desc;
+        }
+
+        // How should vertexes be handled?
+        // Locations match VertexAll's, so a shader only needs to change how it unpacks them.
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDesc() {
+            return {
+                    { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, static_cast<uint32_t>(offsetof(VertexPacked, position)) },
+                    { 0, 1, VK_FORMAT_R16G16_SNORM, static_cast<uint32_t>(offsetof(VertexPacked, normal)) },
+                    { 0, 2, VK_FORMAT_R16G16_UNORM, static_cast<uint32_t>(offsetof(VertexPacked, texture)) }
+            };
+        }
+    };
+
 	// Contains data about a given Mesh.
 	class Mesh {
 	public:
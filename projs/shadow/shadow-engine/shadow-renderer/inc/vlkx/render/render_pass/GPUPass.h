@@ -2,8 +2,10 @@
 
 #include <vulkan/vulkan.h>
 #include "vlkx/vulkan/abstraction/ImageUsage.h"
+#include <map>
 #include <string>
 #include <functional>
+#include <shadow/util/StringId.h>
 #include <memory>
 #include "GenericRenderPass.h"
 
@@ -12,6 +14,7 @@ namespace vlkx {
     /**
      * The common base class for rendering and computing passes that run on the GPU.
      * Provides some utility methods for handling attachment metadata between subpasses.
+     * Images are identified by the StringId of their name.
      */
     class CommonPass {
     public:
@@ -24,14 +27,14 @@ namespace vlkx {
         virtual ~CommonPass() = default;
 
         // Get the image layout of the given image at the start of this pass
-        VkImageLayout getInitialLayout(const std::string& name) const;
+        VkImageLayout getInitialLayout(shadowutil::StringId name) const;
         // Get the image layout of the given image at the end of this pass
-        VkImageLayout getFinalLayout(const std::string& name) const;
+        VkImageLayout getFinalLayout(shadowutil::StringId name) const;
         // Get the image layout of the given image before the given subpass starts
-        VkImageLayout getSubpassLayout(const std::string& name, int subpass) const;
+        VkImageLayout getSubpassLayout(shadowutil::StringId name, int subpass) const;
 
         // Update the state of the given image's usage tracker.
-        void update(const std::string& name, MultiImageTracker& tracker) const;
+        void update(shadowutil::StringId name, MultiImageTracker& tracker) const;
 
     protected:
         /**
@@ -45,26 +48,26 @@ namespace vlkx {
         };
 
         // Add the usage of an image in the pass to its' tracker.
-        void addUsage(std::string&& name, UsageTracker&& tracker);
+        void addUsage(shadowutil::StringId name, UsageTracker&& tracker);
 
         // Get the full history of the image's usages up to this rendering pass.
-        const UsageTracker& getHistory(const std::string& name) const;
+        const UsageTracker& getHistory(shadowutil::StringId name) const;
 
         // Get the usage of an image at the start of the given pass.
-        const ImageUsage* getUsage(const std::string& name, int pass) const;
+        const ImageUsage* getUsage(shadowutil::StringId name, int pass) const;
 
         // Retrieve image usage data, but only if the image is barriered at the given pass.
-        std::optional<Usages> checkForSync(const std::string& name, int pass) const;
+        std::optional<Usages> checkForSync(shadowutil::StringId name, int pass) const;
 
         // Validate that the subpass is valid for the given image.
         // The meaning of includeVirtual is defined by the child implementation.
-        void validate(int pass, const std::string& image, bool includeVirtual) const;
+        void validate(int pass, shadowutil::StringId image, bool includeVirtual) const;
 
         int getVirtualInitial() const { return -1; }
         int getVirtualFinal() const { return numPasses; }
 
     protected:
-        std::map<std::string, UsageTracker> usageHistory;
+        std::map<shadowutil::StringId, UsageTracker> usageHistory;
         const int numPasses;
     };
 
@@ -102,12 +105,12 @@ namespace vlkx {
          * @param ops optional; uses the static defaults if not present.
          * @return the index into the VkAttachmentDescriptions.
          */
-        int add(const std::string& name, UsageTracker&& history, LocationGetter&& getter, const std::optional<RenderPassBuilder::Attachment::OpsType> ops = std::nullopt);
+        int add(shadowutil::StringId name, UsageTracker&& history, LocationGetter&& getter, const std::optional<RenderPassBuilder::Attachment::OpsType> ops = std::nullopt);
 
         #define fluent GraphicsPass&
 
         // Specifies that the source image will be resolved to the single destination at the given pass.
-        fluent addMultisample(const std::string& source, const std::string& dest, int pass);
+        fluent addMultisample(shadowutil::StringId source, shadowutil::StringId dest, int pass);
 
         // Build a RenderPassBuilder with the information provided so far.
         std::unique_ptr<RenderPassBuilder> build(int framebuffers);
@@ -117,7 +120,7 @@ namespace vlkx {
             int index;
             LocationGetter getter;
             vlkx::RenderPassBuilder::Attachment::OpsType ops;
-            std::map<int, std::string> multisample;
+            std::map<int, shadowutil::StringId> multisample;
         };
 
         void setAttachments();
@@ -139,7 +142,7 @@ namespace vlkx {
          * @param userOps operations to use for the image, as an optional override.
          * @return the ColorOps to use for the given attachment.
          */
-        RenderPassBuilder::Attachment::OpsType getOps(const std::string& name, const UsageTracker& history, const std::optional<RenderPassBuilder::Attachment::OpsType>& userOps) const;
+        RenderPassBuilder::Attachment::OpsType getOps(shadowutil::StringId name, const UsageTracker& history, const std::optional<RenderPassBuilder::Attachment::OpsType>& userOps) const;
 
         /**
          * Get the usage type of the image.
@@ -149,7 +152,7 @@ namespace vlkx {
          * @param history the history of the image's usages in the GPU.
          * @return whether the image is a RenderTarget or a DepthStencil buffer.
          */
-        ImageUsage::Type getUsageType(const std::string& name, const UsageTracker& history) const;
+        ImageUsage::Type getUsageType(shadowutil::StringId name, const UsageTracker& history) const;
 
         /**
          * Ensure that the image is used as type at subpass in its' history.
@@ -175,9 +178,9 @@ namespace vlkx {
          * Ensure that the image's usages are compatible with a render pass.
          * For example, compute shader linear buffers cannot be used as render targets, etc.
          */
-        void verifyHistory(const std::string& image, const UsageTracker& history) const;
+        void verifyHistory(shadowutil::StringId image, const UsageTracker& history) const;
 
-        std::map<std::string, AttachmentMeta> metas;
+        std::map<shadowutil::StringId, AttachmentMeta> metas;
         std::unique_ptr<vlkx::RenderPassBuilder> builder;
 
     };
@@ -203,10 +206,7 @@ namespace vlkx {
          * @param history the usage history of the image
          * @return the ComputePass instance, for chaining.
          */
-        fluent add(std::string&& name, UsageTracker&& history);
-        fluent add(const std::string& name, UsageTracker&& history) {
-            return add(std::string(name), std::move(history));
-        }
+        fluent add(shadowutil::StringId name, UsageTracker&& history);
 
         /**
          * Run computeOps, insert memory barriers to transition used images into the appropriate format.
@@ -218,7 +218,7 @@ namespace vlkx {
          * @param images the list of images that were used in the compute pass
          * @param computeOps the compute functions to upload to the GPU
          */
-        void execute(const VkCommandBuffer& commands, uint32_t queueFamily, const std::map<std::string, const VkImage*>& images, const std::vector<std::function<void()>>& computeOps) const;
+        void execute(const VkCommandBuffer& commands, uint32_t queueFamily, const std::map<shadowutil::StringId, const VkImage*>& images, const std::vector<std::function<void()>>& computeOps) const;
 
         /**
          * Insert a memory barrier, to transition the layout of the image from the previous to the curent.
@@ -237,6 +237,6 @@ namespace vlkx {
          * @param name the name of the image being checked
          * @param history the usage history of the image/
          */
-        void verify(const std::string& name, const UsageTracker& history) const;
+        void verify(shadowutil::StringId name, const UsageTracker& history) const;
     };
 }
\ No newline at end of file
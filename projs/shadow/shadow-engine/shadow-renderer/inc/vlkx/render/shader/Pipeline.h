@@ -26,8 +26,12 @@ namespace vlkx {
 
         const VkShaderModule& operator*() const { return shader; }
 
+        // The size of the SPIR-V code, for RefCounter's retention budget.
+        size_t memorySize() const { return codeSize; }
+
     private:
         VkShaderModule shader;
+        size_t codeSize;
     };
 
     class PipelineBuilder {
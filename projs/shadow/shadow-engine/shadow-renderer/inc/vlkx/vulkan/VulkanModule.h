@@ -13,7 +13,7 @@
 namespace vlkx { class ScreenRenderPassManager; }
 
 class VulkanModule : public ShadowEngine::RendererModule {
-    SHObject_Base(VulkanModule);
+    SHObject_Base(VulkanModule, ShadowEngine::RendererModule)
 public:
 
     VulkanModule();
@@ -2,6 +2,7 @@
 
 #include <vulkan/vulkan.h>
 #include <vlkx/vulkan/VulkanDevice.h>
+#include <span>
 #include <variant>
 #include <vector>
 #include "vlkx/vulkan/Tools.h"
@@ -91,7 +92,7 @@ namespace vlkx {
 
         // Get attributes of vertexes in the buffer
         // Location will start from "start"
-        // Binding will not be set
+        // Binding is the stream the attribute is read from; 0 unless the buffer has several
         std::vector<VkVertexInputAttributeDescription> getAttrs(uint32_t start) const;
 
         // Draw these vertexes without a buffer per vertex.
@@ -154,16 +155,25 @@ namespace vlkx {
         // Interprets the layout of data in containers (vector, etc)
         struct VertexDataMeta {
             template <typename C>
-            VertexDataMeta(const C& cont, int unitsPerMesh) : data(cont.data()), unitsPerMesh(unitsPerMesh), sizePerMesh(sizeof(cont[0]) * unitsPerMesh) {}
+            VertexDataMeta(const C& cont, int unitsPerMesh) : data(cont.data()), unitsPerMesh(unitsPerMesh), sizePerUnit(sizeof(cont[0])), sizePerMesh(sizeof(cont[0]) * unitsPerMesh) {}
 
             template <typename C>
             VertexDataMeta(const C& cont) : VertexDataMeta(cont, static_cast<int>(cont.size())) {}
 
+            VertexDataMeta(const void* data, int unitsPerMesh, size_t sizePerUnit) : data(data), unitsPerMesh(unitsPerMesh), sizePerUnit(sizePerUnit), sizePerMesh(sizePerUnit * unitsPerMesh) {}
+
             const void* data;
             int unitsPerMesh;
+            size_t sizePerUnit;     // For indices, picks 16 or 32 bit indexing
             size_t sizePerMesh;
         };
 
+        // A run of one mesh's indices that can be drawn on its own, such as one of its levels of detail.
+        struct IndexRange {
+            uint32_t first;     // Relative to the mesh's first index
+            uint32_t count;
+        };
+
         // Interface for buffer data.
         class BufferDataMeta {
         public:
@@ -205,6 +215,9 @@ namespace vlkx {
             struct PerMesh {
                 VertexDataMeta indices;
                 VertexDataMeta vertices;
+                std::vector<IndexRange> ranges;     // Empty to draw all of the indices as one range
+                std::vector<VertexDataMeta> streams;    // More vertex data, bound to the bindings after the vertices'
+                std::vector<IndexRange> clusters;       // Smaller runs that can be culled one by one; see drawClusters
             };
 
             explicit NoShareMeta(std::vector<PerMesh>&& perMesh) : perMeshMeta(std::move(perMesh)) {}
@@ -219,7 +232,19 @@ namespace vlkx {
         PerVertexBuffer& operator=(const PerVertexBuffer&) = delete;
 
         // Render mesh a given number of times, into a recording buffer.
-        void draw(const VkCommandBuffer& buffer, uint32_t bind, int index, uint32_t instances) const;
+        // Every stream of the mesh is bound, starting at the given binding; a pipeline only fetches the ones it declares.
+        // Indexed meshes draw the given range of their indices; the instances drawn start from firstInstance.
+        void draw(const VkCommandBuffer& buffer, uint32_t bind, int index, uint32_t instances, size_t range = 0, uint32_t firstInstance = 0) const;
+
+        // Render some of a mesh's clusters, given by their index in order. Clusters that follow each other in the index
+        //  buffer are drawn together.
+        void drawClusters(const VkCommandBuffer& buffer, uint32_t bind, int index, uint32_t instances, std::span<const uint32_t> clusters, uint32_t firstInstance = 0) const;
+
+        // How many ranges of indices a mesh has. Always at least one.
+        size_t rangeCount(int index) const;
+
+        // How many bindings a mesh's vertex streams take up. Always at least one.
+        size_t streamCount(int index) const;
 
     protected:
         using VertexBuffer::VertexBuffer;
@@ -237,9 +262,11 @@ namespace vlkx {
         // Stores vertex and index data for buffers with both
         struct MeshDataIndex {
             struct Info {
-                uint32_t indexCount;
+                std::vector<IndexRange> ranges;
+                VkIndexType indexType;
                 VkDeviceSize indexStart;
-                VkDeviceSize vertexStart;
+                std::vector<VkDeviceSize> vertexStarts;     // One per stream
+                std::vector<IndexRange> clusters;
             };
 
             std::vector<Info> info;
@@ -248,6 +275,8 @@ namespace vlkx {
         std::variant<MeshDataNoIndex, MeshDataIndex>* getInfo() { return &meshDataInfo; }
 
     private:
+        // Bind a mesh's indices and every stream of its vertices.
+        void bindIndexed(const VkCommandBuffer& buffer, uint32_t bind, const MeshDataIndex::Info& meshInfo) const;
 
         std::variant<MeshDataNoIndex, MeshDataIndex> meshDataInfo;
     };
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <vector>
+#include <shadow/util/SmallVector.h>
 #include <vulkan/vulkan.h>
 #include <temp/model/Loader.h>
 #include <vlkx/vulkan/VulkanModule.h>
@@ -11,8 +12,9 @@ namespace vlkx {
     class Descriptor {
     public:
         using TextureType = vlkxtemp::ModelLoader::TextureType;
-        using BufferInfos = std::map<uint32_t, std::vector<VkDescriptorBufferInfo>>;
-        using ImageInfos = std::map<uint32_t, std::vector<VkDescriptorImageInfo>>;
+        // Infos for each binding point. Bindings rarely hold more than a few descriptors, so they are kept inline.
+        using BufferInfos = std::map<uint32_t, shadowutil::SmallVector<VkDescriptorBufferInfo, 4>>;
+        using ImageInfos = std::map<uint32_t, shadowutil::SmallVector<VkDescriptorImageInfo, 4>>;
 
         struct Meta {
             struct Binding {
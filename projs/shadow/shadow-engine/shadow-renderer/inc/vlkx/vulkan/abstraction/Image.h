@@ -5,7 +5,7 @@
 #include <shadow/util/RefCounter.h>
 #include "Buffer.h"
 #include <array>
-
+#include <memory>
 #include <utility>
 
 namespace vlkx {
@@ -30,13 +30,13 @@ namespace vlkx {
         uint32_t getChannels() const { return dimensions.channels; }
 
         std::vector<void*> getData() const {
-            if (type == Type::Single) return { (void*) data };
+            if (type == Type::Single) return { (void*) data.get() };
             std::vector<void*> dataPtrs;
             dataPtrs.reserve(6);
 
             size_t offset = 0;
             for (size_t i = 0; i < 6; i++) {
-                dataPtrs.emplace_back((char*) data + offset);
+                dataPtrs.emplace_back((char*) data.get() + offset);
                 offset += dimensions.getSize();
             }
 
@@ -45,12 +45,13 @@ namespace vlkx {
 
         int getLayers() const { return type == Type::Single ? 1 : 6; }
 
-        ImageDescriptor(Type t, const Dimension& d, const void* ptr) : type(t), dimensions(d), data(ptr) {}
+        // The descriptor shares ownership of the pixels; the deleter frees them however they were allocated.
+        ImageDescriptor(Type t, const Dimension& d, std::shared_ptr<const char> pixels) : type(t), dimensions(d), data(std::move(pixels)) {}
 
     private:
         Type type;
         Dimension dimensions;
-        const void* data;
+        std::shared_ptr<const char> data;
 
     };
 
@@ -102,10 +103,11 @@ namespace vlkx {
         static VkDescriptorType getLinearType() { return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
 
         static ImageDescriptor loadSingleFromDisk(std::string path, bool flipY);
-        // The following are left unimplemented intentionally.
-        //static ImageDescriptor loadSingleFromVFS(std::string path, bool flipY);
+        // Load from the mounted packages and directories (see shadowutil::VFS).
+        // Uncompressed textures cooked into a package are returned in place, so they are only valid while the package is mounted.
+        static ImageDescriptor loadSingleFromVFS(std::string path, bool flipY);
         static ImageDescriptor loadCubeFromDisk(const std::string& directory, const std::array<std::string, 6>& files, bool flipY);
-        //static ImageDescriptor loadCubeFromVFS(std::string directory, const std::array<std::string, 6>& files, bool flipY);
+        static ImageDescriptor loadCubeFromVFS(std::string directory, const std::array<std::string, 6>& files, bool flipY);
 
         virtual ImageUsage getUsage() const { return ImageUsage {}; }
 
@@ -204,6 +206,9 @@ namespace vlkx {
         ImageUsage getUsage() const override {
             return ImageUsage::sampledFragment();
         }
+
+        // The size of the image's GPU allocation, for RefCounter's retention budget.
+        size_t memorySize() const;
     private:
         class TextureBuffer : public ImageBuffer {
         public:
@@ -2,7 +2,9 @@
 
 #include <optional>
 #include <map>
+#include <shadow/util/FlatHashMap.h>
 #include <string>
+#include <shadow/util/StringId.h>
 #include <vector>
 #include <stdexcept>
 
@@ -210,8 +212,8 @@ namespace vlkx {
             return *this;
         }
 
-        fluent addMultisample(int pass, std::string_view name) {
-            multisamples.insert( { pass, std::string(name) } );
+        fluent addMultisample(int pass, shadowutil::StringId name) {
+            multisamples.insert( { pass, name } );
             return add(pass, ImageUsage::multisample());
         }
 
@@ -250,7 +252,7 @@ namespace vlkx {
         std::map<int, ImageUsage> usageAtSubpass;
         ImageUsage initialUsage;
         std::optional<ImageUsage> finalUsage;
-        std::map<int, std::string> multisamples;
+        std::map<int, shadowutil::StringId> multisamples;
     };
 
     /**
@@ -267,31 +269,27 @@ namespace vlkx {
         #undef fluent
         #define fluent MultiImageTracker&
 
-        fluent track(std::string&& name, const ImageUsage& usage) {
-            images.insert( { std::move(name), usage } );
+        fluent track(shadowutil::StringId name, const ImageUsage& usage) {
+            images.insert( { name, usage } );
             return *this;
         }
 
-        fluent track(const std::string& name, const ImageUsage& usage) {
-            return track(std::string(name), usage);
-        }
-
-        fluent update(const std::string& name, const ImageUsage& usage) {
+        fluent update(shadowutil::StringId name, const ImageUsage& usage) {
             auto iter = images.find(name);
             iter->second = usage;
             return *this;
         }
 
-        [[nodiscard]] bool isTracking(const std::string& image) const {
+        [[nodiscard]] bool isTracking(shadowutil::StringId image) const {
             return images.contains(image);
         }
 
-        [[nodiscard]] const ImageUsage& get(const std::string& image) const {
+        [[nodiscard]] const ImageUsage& get(shadowutil::StringId image) const {
             return images.at(image);
         }
 
     private:
-        std::map<std::string, ImageUsage> images;
+        shadowutil::FlatHashMap<shadowutil::StringId, ImageUsage> images;
 
     };
 }
\ No newline at end of file
@@ -60,14 +60,16 @@ namespace vlkx {
     }
 
     ShaderModule::ShaderModule(const std::string &path) {
-        const shadowutil::FileData* file = shadowutil::loadFile(path);
+        // The mapping is page aligned, which satisfies Vulkan's requirement that code is aligned to 4 bytes.
+        const shadowutil::MappedFile file = shadowutil::loadFile(path);
         const VkShaderModuleCreateInfo module {
             VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            nullptr, 0, file->size, reinterpret_cast<const uint32_t*>(file->data.data())
+            nullptr, 0, file.size(), reinterpret_cast<const uint32_t*>(file.data().data())
         };
 
         if (vkCreateShaderModule(VulkanModule::getInstance()->getDevice()->logical, &module, nullptr, &shader) != VK_SUCCESS)
             throw std::runtime_error("Unable to create shader module");
+        codeSize = file.size();
     }
 
     PipelineBuilder::PipelineBuilder(std::optional<int> maxCache) {
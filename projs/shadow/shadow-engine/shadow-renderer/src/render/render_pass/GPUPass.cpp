@@ -13,7 +13,7 @@ namespace vlkx {
         pass->access |= usage.getAccessFlags();
     }
 
-    void CommonPass::addUsage(std::string &&name, UsageTracker &&tracker) {
+    void CommonPass::addUsage(shadowutil::StringId name, UsageTracker &&tracker) {
         for (const auto& pair : tracker.getUsageMap())
             validate(pair.first, name, false);
 
@@ -21,38 +21,38 @@ namespace vlkx {
         if (tracker.getFinalUsage().has_value())
             tracker.add(getVirtualFinal(), tracker.getFinalUsage().value());
 
-        usageHistory.emplace(std::move(name), std::move(tracker));
+        usageHistory.emplace(name, std::move(tracker));
     }
 
-    VkImageLayout CommonPass::getInitialLayout(const std::string &name) const {
+    VkImageLayout CommonPass::getInitialLayout(shadowutil::StringId name) const {
         return getHistory(name).getUsageMap().begin()->second.getLayout();
     }
 
-    VkImageLayout CommonPass::getFinalLayout(const std::string &name) const {
+    VkImageLayout CommonPass::getFinalLayout(shadowutil::StringId name) const {
         return getHistory(name).getUsageMap().rbegin()->second.getLayout();
     }
 
-    VkImageLayout CommonPass::getSubpassLayout(const std::string &name, int subpass) const {
+    VkImageLayout CommonPass::getSubpassLayout(shadowutil::StringId name, int subpass) const {
         validate(subpass, name, false);
         return getUsage(name, subpass)->getLayout();
     }
 
-    void CommonPass::update(const std::string &name, MultiImageTracker &tracker) const {
+    void CommonPass::update(shadowutil::StringId name, MultiImageTracker &tracker) const {
         tracker.update(name, getHistory(name).getUsageMap().rbegin()->second);
     }
 
-    const UsageTracker& CommonPass::getHistory(const std::string &name) const {
+    const UsageTracker& CommonPass::getHistory(shadowutil::StringId name) const {
         return usageHistory.at(name);
     }
 
-    const ImageUsage* CommonPass::getUsage(const std::string &name, int pass) const {
+    const ImageUsage* CommonPass::getUsage(shadowutil::StringId name, int pass) const {
         validate(pass, name, true);
         const UsageTracker& history = getHistory(name);
         const auto iter = history.getUsageMap().find(pass);
         return iter != history.getUsageMap().end() ? &iter->second : nullptr;
     }
 
-    std::optional<CommonPass::Usages> CommonPass::checkForSync(const std::string &name, int pass) const {
+    std::optional<CommonPass::Usages> CommonPass::checkForSync(shadowutil::StringId name, int pass) const {
         validate(pass, name, true);
         const UsageTracker& history = getHistory(name);
         const auto currIter = history.getUsageMap().find(pass);
@@ -70,7 +70,7 @@ namespace vlkx {
         return CommonPass::Usages { prevSubpass, &prevUsage, &currUsage };
     }
 
-    void CommonPass::validate(int pass, const std::string &image, bool includeVirtual) const {
+    void CommonPass::validate(int pass, shadowutil::StringId image, bool includeVirtual) const {
         if (includeVirtual) {
             if (!(pass >= getVirtualInitial() && pass <= getVirtualFinal()))
                 throw std::runtime_error("Subpass out of range.");
@@ -80,14 +80,14 @@ namespace vlkx {
         }
     }
 
-    int GraphicsPass::add(const std::string &name, UsageTracker &&history, std::function<int(int)> &&getter,
+    int GraphicsPass::add(shadowutil::StringId name, UsageTracker &&history, std::function<int(int)> &&getter,
                            const std::optional<RenderPassBuilder::Attachment::OpsType> ops) {
         verifyHistory(name, history);
 
         const std::optional<int> needsGetter = getFirstRenderTarget(history);
         if (needsGetter.has_value()) {
             if (getter == nullptr)
-                throw std::runtime_error("Image " + name + " is used as a render target without a location getter.");
+                throw std::runtime_error("Image " + name.str() + " is used as a render target without a location getter.");
         } else {
             getter = nullptr;
         }
@@ -105,41 +105,41 @@ namespace vlkx {
                 }
         );
 
-        addUsage(std::string(name), std::move(history));
+        addUsage(name, std::move(history));
         return attachmentLocation;
     }
 
-    GraphicsPass& GraphicsPass::addMultisample(const std::string &source, const std::string &dest, int pass) {
+    GraphicsPass& GraphicsPass::addMultisample(shadowutil::StringId source, shadowutil::StringId dest, int pass) {
         validate(pass, source, false);
 
         const auto source_iter = usageHistory.find(source);
         if (source_iter == usageHistory.end())
-            throw std::runtime_error("Usage history not found for source image " + source);
+            throw std::runtime_error("Usage history not found for source image " + source.str());
 
         const UsageTracker& source_history = source_iter->second;
         if (!verifyImageUsage(source_history, pass, ImageUsage::Type::RenderTarget))
-            throw std::runtime_error("Usage type for source image " + source + " must be render target.");
+            throw std::runtime_error("Usage type for source image " + source.str() + " must be render target.");
 
         const auto dest_iter = usageHistory.find(dest);
         if (dest_iter == usageHistory.end())
-            throw std::runtime_error("Usage history not found for destination image " + dest);
+            throw std::runtime_error("Usage history not found for destination image " + dest.str());
 
         const UsageTracker& dest_history = dest_iter->second;
         if (!verifyImageUsage(dest_history, pass, ImageUsage::Type::Multisample))
-            throw std::runtime_error("Usage type for destination image " + dest + " must be multisample");
+            throw std::runtime_error("Usage type for destination image " + dest.str() + " must be multisample");
 
         auto& targetMap = metas[source].multisample;
         const bool inserted = targetMap.insert( { pass, dest }).second;
 
         if (!inserted)
-            throw std::runtime_error("Image " + source + " is already bound to a multisample.");
+            throw std::runtime_error("Image " + source.str() + " is already bound to a multisample.");
 
         return *this;
     }
 
     void GraphicsPass::setAttachments() {
         for (const auto& pair : usageHistory) {
-            const std::string& name = pair.first;
+            const shadowutil::StringId name = pair.first;
             const AttachmentMeta& meta = metas[name];
             builder->setAttachment(meta.index, { meta.ops, getInitialLayout(name), getFinalLayout(name) } );
         }
@@ -153,7 +153,7 @@ namespace vlkx {
 
             // Verify all images used, the long way around.
             for (const auto& pair : usageHistory) {
-                const std::string& name = pair.first;
+                const shadowutil::StringId name = pair.first;
                 const ImageUsage* history = getUsage(name, pass);
                 if (history == nullptr)
                     continue;
@@ -167,7 +167,7 @@ namespace vlkx {
                         const int location = meta.getter(pass);
                         const auto iter = meta.multisample.find(pass);
                         if (iter != meta.multisample.end()) {
-                            const std::string& target = iter->second;
+                            const shadowutil::StringId target = iter->second;
                             const ImageUsage* targetUsage = getUsage(target, pass);
                             if (targetUsage == nullptr)
                                 throw std::runtime_error("Expected target image to have a usage");
@@ -256,7 +256,7 @@ namespace vlkx {
         return std::nullopt;
     }
 
-    RenderPassBuilder::Attachment::OpsType GraphicsPass::getOps(const std::string &name, const UsageTracker &history,
+    RenderPassBuilder::Attachment::OpsType GraphicsPass::getOps(shadowutil::StringId name, const UsageTracker &history,
                                                                  const std::optional<RenderPassBuilder::Attachment::OpsType> &userOps) const {
         const ImageUsage::Type type = getUsageType(name, history);
 
@@ -279,7 +279,7 @@ namespace vlkx {
         }
     }
 
-    ImageUsage::Type GraphicsPass::getUsageType(const std::string &name, const UsageTracker &history) const {
+    ImageUsage::Type GraphicsPass::getUsageType(shadowutil::StringId name, const UsageTracker &history) const {
         ImageUsage::Type prev = ImageUsage::Type::DontCare;
 
         for (const auto& pair : history.getUsageMap()) {
@@ -292,12 +292,12 @@ namespace vlkx {
             if (prev == ImageUsage::Type::DontCare) {
                 prev = type;
             } else if (type != prev) {
-                throw std::runtime_error("Inconsistent usage type specified for " + name);
+                throw std::runtime_error("Inconsistent usage type specified for " + name.str());
             }
         }
 
         if (prev == ImageUsage::Type::DontCare)
-            throw std::runtime_error("Image " + name + " has no usages.");
+            throw std::runtime_error("Image " + name.str() + " has no usages.");
 
         return prev;
     }
@@ -307,22 +307,22 @@ namespace vlkx {
         return iter != history.getUsageMap().end() && iter->second.getType() == type;
     }
 
-    void GraphicsPass::verifyHistory(const std::string &image, const UsageTracker &history) const {
+    void GraphicsPass::verifyHistory(shadowutil::StringId image, const UsageTracker &history) const {
         for (const auto& pair : history.getUsageMap()) {
             const ImageUsage::Type type = pair.second.getType();
             if (type != ImageUsage::Type::RenderTarget && type != ImageUsage::Type::DepthStencil && type != ImageUsage::Type::Multisample)
-                throw std::runtime_error("Invalid usage of " + image + " at subpass " + std::to_string(pair.first));
+                throw std::runtime_error("Invalid usage of " + image.str() + " at subpass " + std::to_string(pair.first));
         }
     }
 
-    ComputePass &ComputePass::add(std::string &&name, UsageTracker &&history) {
+    ComputePass &ComputePass::add(shadowutil::StringId name, UsageTracker &&history) {
         verify(name, history);
-        addUsage(std::move(name), std::move(history));
+        addUsage(name, std::move(history));
         return *this;
     }
 
     void ComputePass::execute(const VkCommandBuffer &commands, uint32_t queueFamily,
-                              const std::map<std::string, const VkImage*> &images,
+                              const std::map<shadowutil::StringId, const VkImage*> &images,
                               const std::vector<std::function<void()>>& computeOps) const {
 
         if (computeOps.size() != numPasses)
@@ -333,13 +333,13 @@ namespace vlkx {
 
         for (int pass = 0; pass < numPasses; ++pass) {
             for (const auto& pair : usageHistory) {
-                const std::string& image = pair.first;
+                const shadowutil::StringId image = pair.first;
                 const auto usage = checkForSync(image, pass);
                 if (!usage.has_value()) continue;
 
                 const auto iter = images.find(image);
                 if (iter == images.end())
-                    throw std::runtime_error("Image " + image + " not provided");
+                    throw std::runtime_error("Image " + image.str() + " not provided");
 
                 barrier(commands, queueFamily, *iter->second, usage.value().lastUsage, usage.value().currentUsage);
             }
@@ -384,7 +384,7 @@ namespace vlkx {
         );
     }
 
-    void ComputePass::verify(const std::string &name, const UsageTracker &history) const {
+    void ComputePass::verify(shadowutil::StringId name, const UsageTracker &history) const {
         for (const auto& pair : history.getUsageMap()) {
             const ImageUsage::Type type = pair.second.getType();
             if (type != ImageUsage::Type::LinearAccess && type != ImageUsage::Type::Sampled && type != ImageUsage::Type::Transfer)
@@ -158,11 +158,11 @@ namespace vlkx {
     }
 
     fluent RenderPassBuilder::setAttachment(int idx, const Attachment &attachment) {
-        if (idx > clearValues.size())
+        if (idx >= clearValues.size())
             clearValues.resize(idx + 1);
         clearValues.at(idx) = createClearFor(attachment);
 
-        if (idx > attachmentDescriptors.size())
+        if (idx >= attachmentDescriptors.size())
             attachmentDescriptors.resize(idx + 1);
         attachmentDescriptors.at(idx) = buildAttachment(attachment);
 
@@ -1,4 +1,13 @@
 #include "temp/model/Builder.h"
+#include "temp/model/MeshOptimizer.h"
+#include <glm/gtc/matrix_access.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <limits>
+#include <spdlog/spdlog.h>
 
 namespace vlkxtemp {
     using namespace vlkx;
@@ -42,16 +51,117 @@ namespace vlkxtemp {
         return ranges;
     }
 
+    std::vector<PerVertexBuffer::IndexRange> indexRanges(std::span<const LodLevel> levels) {
+        std::vector<PerVertexBuffer::IndexRange> ranges;
+        ranges.reserve(levels.size());
+        for (const auto& level : levels)
+            ranges.push_back({ level.firstIndex, level.indexCount });
+        return ranges;
+    }
+
+    std::vector<PerVertexBuffer::IndexRange> clusterRanges(std::span<const Meshlet> meshlets) {
+        std::vector<PerVertexBuffer::IndexRange> ranges;
+        ranges.reserve(meshlets.size());
+        for (const auto& meshlet : meshlets)
+            ranges.push_back({ meshlet.firstIndex, meshlet.indexCount });
+        return ranges;
+    }
+
     VkVertexInputBindingDescription getBinding(uint32_t stride, bool instancing) {
         return VkVertexInputBindingDescription{ 0, stride,instancing ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX, };
     }
 
-    void setVertexInput(const PerVertexBuffer& buffer, const std::vector<PerInstanceVertexBuffer*>& instanceBuffers, GraphicsPipelineBuilder* builder) {
+    std::vector<VkVertexInputAttributeDescription> getAttributes(ModelBuilder::VertexLayout layout) {
+        return layout == ModelBuilder::VertexLayout::Packed ? Geo::VertexPacked::getAttributeDesc() : Geo::VertexAll::getAttributeDesc();
+    }
+
+    uint32_t getStride(ModelBuilder::VertexLayout layout) {
+        return layout == ModelBuilder::VertexLayout::Packed ? sizeof(Geo::VertexPacked) : sizeof(VertexAll);
+    }
+
+    // Where each attribute of an interleaved vertex goes once the position is moved into a stream of its own.
+    // Each attribute's binding names its stream, and its offset is within that stream.
+    struct StreamSplit {
+        std::vector<VkVertexInputAttributeDescription> attributes;
+        std::vector<uint32_t> sizes;        // Bytes of each attribute, up to the next one
+        std::vector<uint32_t> strides;      // Of each stream
+    };
+
+    // Attributes must be in the order they sit in the vertex, with the position at location 0.
+    StreamSplit splitPositions(const std::vector<VkVertexInputAttributeDescription>& interleaved, uint32_t stride) {
+        StreamSplit split { interleaved, {}, { 0, 0 } };
+        for (size_t i = 0; i < interleaved.size(); i++) {
+            const uint32_t end = i + 1 < interleaved.size() ? interleaved[i + 1].offset : stride;
+            auto& attribute = split.attributes[i];
+            attribute.binding = attribute.location == 0 ? 0 : 1;
+            attribute.offset = split.strides[attribute.binding];
+            split.sizes.push_back(end - interleaved[i].offset);
+            split.strides[attribute.binding] += split.sizes.back();
+        }
+        return split;
+    }
+
+    // Copy interleaved vertices out into the streams of a split, one after the other in `copy`.
+    std::vector<PerVertexBuffer::VertexDataMeta> splitVertices(const PerVertexBuffer::VertexDataMeta& vertices, const std::vector<VkVertexInputAttributeDescription>& interleaved,
+                                                               const StreamSplit& split, std::vector<std::byte>* copy) {
+        const size_t count = vertices.unitsPerMesh;
+        copy->resize(vertices.sizePerMesh);
+
+        std::byte* streams[2] = { copy->data(), copy->data() + count * split.strides[0] };
+        const auto* source = static_cast<const std::byte*>(vertices.data);
+        for (size_t vertex = 0; vertex < count; vertex++) {
+            for (size_t i = 0; i < interleaved.size(); i++) {
+                const auto& attribute = split.attributes[i];
+                std::memcpy(streams[attribute.binding] + vertex * split.strides[attribute.binding] + attribute.offset,
+                            source + vertex * vertices.sizePerUnit + interleaved[i].offset, split.sizes[i]);
+            }
+        }
+
+        return {
+            PerVertexBuffer::VertexDataMeta { streams[0], static_cast<int>(count), split.strides[0] },
+            PerVertexBuffer::VertexDataMeta { streams[1], static_cast<int>(count), split.strides[1] }
+        };
+    }
+
+    // Narrowed indices and packed vertices, kept alive until the vertex buffer has copied them.
+    struct UploadCopies {
+        std::vector<uint16_t> indices;
+        std::vector<Geo::VertexPacked> vertices;
+    };
+
+    // Meshes with few enough vertices always get 16-bit indices; vertices are packed only if asked.
+    VertexData::PerMesh uploadMesh(std::span<const uint32_t> indices, std::span<const VertexAll> vertices, ModelBuilder::VertexLayout layout,
+                                   std::vector<PerVertexBuffer::IndexRange>&& ranges, std::vector<PerVertexBuffer::IndexRange>&& clusters, UploadCopies* copies) {
+        if (fitsShortIndices(vertices.size()))
+            copies->indices = narrowIndices(indices);
+        if (layout == ModelBuilder::VertexLayout::Packed)
+            copies->vertices = packVertices(vertices, quantizationBounds(vertices));
+
+        return {
+            copies->indices.empty() ? PerVertexBuffer::VertexDataMeta { indices } : PerVertexBuffer::VertexDataMeta { copies->indices },
+            copies->vertices.empty() ? PerVertexBuffer::VertexDataMeta { vertices } : PerVertexBuffer::VertexDataMeta { copies->vertices },
+            std::move(ranges), {}, std::move(clusters)
+        };
+    }
+
+    // Instance attributes are placed after every vertex attribute, and instance bindings after every stream, whether or
+    //  not the pipeline reads them all; that keeps them in the same place for every pipeline drawing the model.
+    void setVertexInput(const PerVertexBuffer& buffer, const std::vector<uint32_t>& strides, bool positionsOnly,
+                        const std::vector<PerInstanceVertexBuffer*>& instanceBuffers, GraphicsPipelineBuilder* builder) {
         uint32_t start = 0;
         auto attributes = buffer.getAttrs(start);
         start += attributes.size();
 
-        builder->addVertex(0, Geo::VertexAll::getBindingDesc(), std::move(attributes));
+        // The position is always the first attribute.
+        if (positionsOnly)
+            attributes.resize(1);
+
+        const uint32_t streams = positionsOnly ? 1 : static_cast<uint32_t>(strides.size());
+        for (uint32_t stream = 0; stream < streams; stream++) {
+            std::vector<VkVertexInputAttributeDescription> streamAttributes;
+            std::copy_if(attributes.begin(), attributes.end(), std::back_inserter(streamAttributes), [&](const auto& attribute) { return attribute.binding == stream; });
+            builder->addVertex(stream, getBinding(strides[stream], false), std::move(streamAttributes));
+        }
 
         for (size_t i = 0; i < instanceBuffers.size(); i++) {
             if (instanceBuffers[i] == nullptr)
@@ -60,42 +170,143 @@ namespace vlkxtemp {
             start += instanceAttrs.size();
 
             auto instanceBinding = getBinding(instanceBuffers[i]->getSize(), true);
-            builder->addVertex(i + 1, std::move(instanceBinding), std::move(instanceAttrs));
+            builder->addVertex(strides.size() + i, std::move(instanceBinding), std::move(instanceAttrs));
         }
     }
 
     void ModelBuilder::SingleMeshModel::load(ModelBuilder* builder) const {
-        const Wavefront obj(objFile, objIndexBase);
-        VertexData vertices {
-                {{
-                    PerVertexBuffer::VertexDataMeta { obj.indices },
-                    PerVertexBuffer::VertexDataMeta { obj.vertices }
-                }}
-        };
+        // Index bases other than 1 are rare enough not to be worth a cache of their own.
+        const std::string cooked = std::filesystem::path(objFile).replace_extension(".smesh").string();
+        std::error_code objError, cookedError;
+        const auto objTime = std::filesystem::last_write_time(objFile, objError);
+        const bool cacheable = !objError && objIndexBase == 1;
+        const bool fresh = cacheable && std::filesystem::last_write_time(cooked, cookedError) >= objTime && !cookedError;
+
+        if (fresh) {
+            try {
+                const CookedMesh mesh(cooked);
+                if (mesh.layout() == vertexLayout) {
+                    builder->loadCooked(mesh, textureSources, vertexStreams, lodSettings);
+                    return;
+                }
+            } catch (const std::exception& e) {
+                spdlog::warn("Ignoring cooked mesh " + cooked + ": " + e.what());
+            }
+        }
 
-        builder->vertexBuffer = std::make_unique<StaticPerVertexBuffer>(std::move(vertices), Geo::VertexAll::getAttributeDesc());
+        Wavefront obj(objFile, objIndexBase);
+        const auto report = optimizeMesh(obj.indices, obj.vertices);
+        const auto levels = generateLods(obj.indices, obj.vertices, lodSettings);
+        // Coarser levels are only drawn far away, where there is too little of them to be worth culling in pieces.
+        const auto meshlets = worthMeshlets(levels[0].indexCount)
+                ? buildMeshlets(std::span(obj.indices).first(levels[0].indexCount), obj.vertices) : std::vector<Meshlet> {};
+        spdlog::info("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} levels of detail, {} meshlets", objFile,
+                     report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr, levels.size(), meshlets.size());
+
+        UploadCopies copies;
+        builder->setVertices({ uploadMesh(obj.indices, obj.vertices, vertexLayout, indexRanges(levels), clusterRanges(meshlets), &copies) }, vertexLayout, vertexStreams);
+        builder->details.push_back({ obj.bounds, levels, dequantization(quantizationBounds(obj.vertices)), meshlets });
+        builder->addMeshTextures(textureSources);
+
+        if (cacheable) {
+            try {
+                CookedMesh::write(cooked, { { obj.indices, obj.vertices, levels, meshlets } }, vertexLayout);
+            } catch (const std::exception& e) {
+                spdlog::warn("Unable to cache cooked mesh " + cooked + ": " + e.what());
+            }
+        }
+    }
 
-        auto& meshTexs = builder->textures;
-        meshTexs.push_back({});
-        for (const auto& pair : textureSources) {
+    void ModelBuilder::CookedMeshModel::load(ModelBuilder* builder) const {
+        builder->loadCooked(CookedMesh(meshFile), textureSources, vertexStreams, lodSettings);
+    }
+
+    void ModelBuilder::setVertices(std::vector<VertexData::PerMesh>&& meshes, VertexLayout layout, VertexStreams streams) {
+        auto attributes = getAttributes(layout);
+        const uint32_t stride = getStride(layout);
+        vertexLayout = layout;
+
+        if (streams == VertexStreams::Interleaved) {
+            streamStrides = { stride };
+            vertexBuffer = std::make_unique<StaticPerVertexBuffer>(VertexData { std::move(meshes) }, std::move(attributes));
+            return;
+        }
+
+        const StreamSplit split = splitPositions(attributes, stride);
+        std::vector<std::vector<std::byte>> copies(meshes.size());
+        for (size_t i = 0; i < meshes.size(); i++) {
+            auto separated = splitVertices(meshes[i].vertices, attributes, split, &copies[i]);
+            meshes[i].vertices = separated[0];
+            meshes[i].streams = { separated[1] };
+        }
+
+        streamStrides = split.strides;
+        vertexBuffer = std::make_unique<StaticPerVertexBuffer>(VertexData { std::move(meshes) }, std::vector(split.attributes));
+    }
+
+    // Each mesh's indices and vertices are copied straight out of the mapped file into the staging buffer,
+    //  unless the vertices have to be split into streams first.
+    void ModelBuilder::loadCooked(const CookedMesh& mesh, const TextureSources& sources, VertexStreams streams, const LodSettings& lods) {
+        const bool shortIndices = mesh.indexSize() == sizeof(uint16_t);
+        const bool packed = mesh.layout() == VertexLayout::Packed;
+
+        std::vector<VertexData::PerMesh> data;
+        data.reserve(mesh.meshCount());
+        for (size_t i = 0; i < mesh.meshCount(); i++) {
+            const auto levels = limitLods(mesh.lods(i), mesh.bounds(i).radius, lods);
+            data.push_back({
+                shortIndices ? PerVertexBuffer::VertexDataMeta { mesh.indices<uint16_t>(i) } : PerVertexBuffer::VertexDataMeta { mesh.indices<uint32_t>(i) },
+                packed ? PerVertexBuffer::VertexDataMeta { mesh.vertices<Geo::VertexPacked>(i) } : PerVertexBuffer::VertexDataMeta { mesh.vertices<VertexAll>(i) },
+                indexRanges(levels), {}, clusterRanges(mesh.meshlets(i))
+            });
+
+            details.push_back({ mesh.bounds(i), { levels.begin(), levels.end() }, dequantization(mesh.range(i).quantization), { mesh.meshlets(i).begin(), mesh.meshlets(i).end() } });
+        }
+
+        setVertices(std::move(data), mesh.layout(), streams);
+
+        for (size_t i = 0; i < mesh.meshCount(); i++)
+            addMeshTextures(sources);
+    }
+
+    void ModelBuilder::addMeshTextures(const TextureSources& sources) {
+        textures.push_back({});
+        for (const auto& pair : sources) {
             const auto type = (size_t)pair.first;
-            const auto& sources = pair.second;
+            const auto& typeSources = pair.second;
 
-            meshTexs.back()[type].reserve(sources.size());
-            for (const auto& source : sources)
-                meshTexs.back()[type].push_back({createTex(source)});
+            textures.back()[type].reserve(typeSources.size());
+            for (const auto& source : typeSources)
+                textures.back()[type].push_back({createTex(source)});
         }
     }
 
     void ModelBuilder::MultiMeshModel::load(ModelBuilder* builder) const {
-        const ModelLoader loader(models, textures);
+        const ModelLoader loader(model, textures);
+        const size_t count = loader.getMeshes().size();
         std::vector<VertexData::PerMesh> data;
-        data.reserve(loader.getMeshes().size());
-
-        for (const auto& mesh : loader.getMeshes())
-            data.push_back({ PerVertexBuffer::VertexDataMeta { mesh.indices }, PerVertexBuffer::VertexDataMeta { mesh.vertices } });
+        std::vector<UploadCopies> copies(count);
+        // Each primitive is optimized in a copy of its own, which has to outlive the upload.
+        std::vector<std::vector<uint32_t>> indices(count);
+        std::vector<std::vector<VertexAll>> vertices(count);
+        data.reserve(count);
+
+        for (size_t i = 0; i < count; i++) {
+            const auto& mesh = loader.getMeshes()[i];
+            indices[i] = mesh.indices;
+            vertices[i] = mesh.vertices;
+            const auto report = optimizeMesh(indices[i], vertices[i]);
+            auto levels = generateLods(indices[i], vertices[i], lodSettings);
+            auto meshlets = worthMeshlets(levels[0].indexCount)
+                    ? buildMeshlets(std::span(indices[i]).first(levels[0].indexCount), vertices[i]) : std::vector<Meshlet> {};
+            spdlog::debug("Optimized mesh {} of {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} levels of detail, {} meshlets", i, model,
+                          report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr, levels.size(), meshlets.size());
+
+            data.push_back(uploadMesh(indices[i], vertices[i], VertexLayout::VertexAll, indexRanges(levels), clusterRanges(meshlets), &copies[i]));
+            builder->details.push_back({ mesh.bounds, std::move(levels), {}, std::move(meshlets) });
+        }
 
-        builder->vertexBuffer = std::make_unique<StaticPerVertexBuffer>(VertexData { std::move(data)}, Geo::VertexAll::getAttributeDesc());
+        builder->setVertices(std::move(data), VertexLayout::VertexAll, vertexStreams);
 
         const auto usages = { ImageUsage::sampledFragment() };
         auto& meshTexs = builder->textures;
@@ -163,6 +374,11 @@ namespace vlkxtemp {
         return *this;
     }
 
+    ModelBuilder& ModelBuilder::positionsOnly() {
+        onlyPositions = true;
+        return *this;
+    }
+
     std::vector<ModelBuilder::Descriptors> ModelBuilder::createDescs() const {
         std::vector<Descriptors> descs(frames);
         auto infos = uniformMeta;
@@ -190,19 +406,33 @@ namespace vlkxtemp {
                 throw std::runtime_error("Model sets push constant present but no data.");
 
         auto descs = createDescs();
-        pipelineBuilder->layout(
-                { descs[0][0]->getLayout() },
-                pushConstants.has_value() ? createRanges(pushConstants.value()) : std::vector<VkPushConstantRange> {}
-        );
+        auto ranges = pushConstants.has_value() ? createRanges(pushConstants.value()) : std::vector<VkPushConstantRange> {};
+
+        // Packed vertices take their mesh's Dequantization from just after the model's own push constants.
+        std::optional<VkPushConstantRange> dequantizeRange;
+        if (vertexLayout == VertexLayout::Packed) {
+            uint32_t end = 0;
+            for (const auto& range : ranges)
+                end = std::max(end, range.offset + range.size);
+            const VkShaderStageFlags stage = VK_SHADER_STAGE_VERTEX_BIT | (pushConstants.has_value() ? pushConstants->stage : 0);
+            dequantizeRange = VkPushConstantRange { stage, end, static_cast<uint32_t>(sizeof(Geo::VertexPacked::Dequantization)) };
+            ranges.push_back(*dequantizeRange);
+        }
 
-        setVertexInput(*vertexBuffer, instanceBuffers, pipelineBuilder.get());
+        pipelineBuilder->layout({ descs[0][0]->getLayout() }, std::move(ranges));
+
+        setVertexInput(*vertexBuffer, streamStrides, onlyPositions, instanceBuffers, pipelineBuilder.get());
 
         uniformMeta.clear();
         uniformBufferMeta.clear();
 
+        MeshBounds bounds {};
+        for (size_t i = 0; i < details.size(); i++)
+            bounds = i == 0 ? details[i].bounds : mergeBounds(bounds, details[i].bounds);
+
         return std::unique_ptr<Model> {
             new Model {
-                aspectRatio, std::move(vertexBuffer), std::move(instanceBuffers), std::move(pushConstants),
+                aspectRatio, std::move(vertexBuffer), static_cast<uint32_t>(streamStrides.size()), std::move(details), bounds, std::move(instanceBuffers), std::move(pushConstants), dequantizeRange,
                 std::move(sharedTextures), std::move(textures), std::move(descs), std::move(pipelineBuilder)
             }
         };
@@ -220,19 +450,105 @@ namespace vlkxtemp {
                 .build();
     }
 
+    Model::LodView Model::LodView::perspective(const glm::vec3& eye, float fov, float screenHeight) {
+        return { eye, screenHeight / (2 * std::tan(glm::radians(fov) / 2)) };
+    }
+
+    void Model::selectLod(const LodView& view, const glm::mat4& transform, uint32_t instance) {
+        if (instance >= lodChosen.size())
+            lodChosen.resize(instance + 1, std::vector<size_t>(details.size(), 0));
+
+        // The largest a unit grows along any axis, so the sphere still covers the mesh.
+        const float scale = std::sqrt(std::max({ glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+                                                 glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+                                                 glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2])) }));
+
+        for (size_t mesh = 0; mesh < details.size(); mesh++) {
+            const auto& sphere = details[mesh].bounds;
+            const glm::vec3 center(transform * glm::vec4(sphere.center[0], sphere.center[1], sphere.center[2], 1));
+            const float distance = glm::length(center - view.eye) - sphere.radius * scale;
+
+            // Inside the sphere, nothing less than full detail will do.
+            const float pixelsPerUnit = distance > 0 ? view.pixelsPerUnit * scale / distance : std::numeric_limits<float>::max();
+            lodChosen[instance][mesh] = vlkxtemp::selectLod(details[mesh].levels, pixelsPerUnit, lodChosen[instance][mesh]);
+        }
+    }
+
+    void Model::cullClusters(const ClusterView& view, const glm::mat4& transform, uint32_t instance) {
+        if (instance >= clustersVisible.size())
+            clustersVisible.resize(instance + 1);
+        auto& visible = clustersVisible[instance];
+        if (!visible.has_value())
+            visible.emplace(details.size());
+
+        // Culling happens in model space, where the meshlets' bounds are. The frustum's planes come straight out of the
+        //  combined matrix's rows (Gribb & Hartmann 2001), with depth running from 0 to 1.
+        const glm::mat4 combined = view.viewProjection * transform;
+        const glm::vec4 rows[4] = { glm::row(combined, 0), glm::row(combined, 1), glm::row(combined, 2), glm::row(combined, 3) };
+        const glm::vec4 planes[6] = { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2] };
+
+        MeshletView local {};
+        for (int i = 0; i < 6; i++) {
+            const glm::vec4 plane = planes[i] / glm::length(glm::vec3(planes[i]));
+            for (int axis = 0; axis < 4; axis++)
+                local.planes[i][axis] = plane[axis];
+        }
+
+        const glm::vec3 eye(glm::inverse(transform) * glm::vec4(view.eye, 1));
+        for (int axis = 0; axis < 3; axis++)
+            local.eye[axis] = eye[axis];
+
+        // Scaling one axis more than another bends normals away from the cones they were measured in.
+        const float scales[3] = { glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])) };
+        local.cones = std::abs(scales[0] - scales[1]) <= 0.001f * scales[0] && std::abs(scales[0] - scales[2]) <= 0.001f * scales[0];
+
+        for (size_t mesh = 0; mesh < details.size(); mesh++) {
+            (*visible)[mesh].clear();
+            cullMeshlets(details[mesh].meshlets, local, &(*visible)[mesh]);
+        }
+    }
+
     void Model::draw(const VkCommandBuffer &commands, int frame, uint32_t instances) const {
         pipeline->bind(commands);
 
         for (size_t i = 0; i < perInstanceBuffers.size(); i++)
-            perInstanceBuffers[i]->bind(commands, i + 1, 0);
+            perInstanceBuffers[i]->bind(commands, vertexStreams + i, 0);
 
         if (pushConstants.has_value())
             for (const auto& meta : pushConstants->constants)
                 meta.constants->upload(commands, pipeline->getLayout(), frame, meta.offset, pushConstants->stage);
 
+        const auto levelOf = [&](uint32_t instance, size_t mesh) {
+            return instance < lodChosen.size() ? std::min(lodChosen[instance][mesh], vertexBuffer->rangeCount(mesh) - 1) : 0;
+        };
+
+        // The meshlets an instance kept, if it is drawing a culled full level.
+        const auto clustersOf = [&](uint32_t instance, size_t mesh) -> const std::vector<uint32_t>* {
+            if (details[mesh].meshlets.empty() || levelOf(instance, mesh) != 0 || instance >= clustersVisible.size() || !clustersVisible[instance].has_value())
+                return nullptr;
+            return &(*clustersVisible[instance])[mesh];
+        };
+
         for (size_t mesh = 0; mesh < textures.size(); mesh++) {
             descriptors[frame][mesh]->bind(commands, pipeline->getLayout(), pipeline->getBind());
-            vertexBuffer->draw(commands, 0, mesh, instances);
+            if (dequantizeRange.has_value())
+                vkCmdPushConstants(commands, pipeline->getLayout(), dequantizeRange->stageFlags, dequantizeRange->offset, dequantizeRange->size, &details[mesh].dequantization);
+
+            // Neighbouring instances at the same level share a draw, unless each sees different meshlets.
+            for (uint32_t first = 0; first < instances;) {
+                if (const auto* clusters = clustersOf(first, mesh)) {
+                    vertexBuffer->drawClusters(commands, 0, mesh, 1, *clusters, first);
+                    first++;
+                    continue;
+                }
+
+                const size_t level = levelOf(first, mesh);
+                uint32_t count = 1;
+                while (first + count < instances && levelOf(first + count, mesh) == level && clustersOf(first + count, mesh) == nullptr) count++;
+
+                vertexBuffer->draw(commands, 0, mesh, count, level, first);
+                first += count;
+            }
         }
     }
 }
\ No newline at end of file
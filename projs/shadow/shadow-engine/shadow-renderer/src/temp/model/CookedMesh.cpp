@@ -0,0 +1,238 @@
+#include "temp/model/CookedMesh.h"
+#include <shadow/util/Compression.h>
+#include <shadow/util/Json.h>
+#include <shadow/util/VFS.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace vlkxtemp {
+
+    static_assert(sizeof(CookedMesh::Header) == 64, "CookedMesh::Header is written to disk as-is");
+    static_assert(sizeof(CookedMesh::Range) == 88, "CookedMesh::Range is written to disk as-is");
+    static_assert(sizeof(LodLevel) == 12, "LodLevel is written to disk as-is");
+    static_assert(sizeof(Meshlet) == 40, "Meshlet is written to disk as-is");
+
+    namespace {
+        constexpr char magic[4] = { 'S', 'M', 'S', 'H' };
+
+        uint64_t align(uint64_t offset) {
+            return (offset + CookedMesh::payloadAlignment - 1) & ~uint64_t(CookedMesh::payloadAlignment - 1);
+        }
+
+        uint32_t strideOf(CookedMesh::VertexLayout layout) {
+            switch (layout) {
+                case CookedMesh::VertexLayout::VertexAll: return sizeof(Geo::VertexAll);
+                case CookedMesh::VertexLayout::Packed: return sizeof(Geo::VertexPacked);
+                default: return 0;
+            }
+        }
+
+        // Whether every index of a mesh, its levels of detail included, names one of its own vertices.
+        template <typename Index>
+        bool indicesInRange(const std::byte* payload, const CookedMesh::Range& range) {
+            const auto* indices = reinterpret_cast<const Index*>(payload) + range.firstIndex;
+            Index highest = 0;
+            for (uint32_t i = 0; i < range.indexCount; i++)
+                highest = std::max(highest, indices[i]);
+            return range.indexCount == 0 || highest < range.vertexCount;
+        }
+    }
+
+    CookedMesh::CookedMesh(const std::string& path) {
+        const auto corrupt = [&](const std::string& why) {
+            return std::runtime_error("Cooked mesh " + path + " is invalid: " + why);
+        };
+
+        if (const auto mounted = shadowutil::VFS::get().find(path)) {
+            bytes = mounted->data;
+
+            // Packed with --compress, the entry is a block stream; it is decoded once, here, rather than read in place.
+            const auto compression = mounted->metadata.empty() ? shadowutil::Compression::None
+                : static_cast<shadowutil::Compression>(shadowutil::JsonValue::parse(mounted->metadata).getInt("compression", 1));
+            if (compression == shadowutil::Compression::Blocks) {
+                try {
+                    decoded.resize(shadowutil::decompressedSize(bytes));
+                    shadowutil::decompressBlocks(bytes, decoded);
+                } catch (const std::runtime_error& e) {
+                    throw corrupt(e.what());
+                }
+                bytes = decoded;
+            } else if (compression != shadowutil::Compression::None) {
+                throw corrupt("unsupported compression " + std::to_string(static_cast<uint32_t>(compression)));
+            }
+        } else {
+            file.emplace(path, shadowutil::MappedFile::Access::Sequential);
+            bytes = file->data();
+        }
+
+        if (bytes.size() < sizeof(Header))
+            throw corrupt("too small");
+        if (reinterpret_cast<uintptr_t>(bytes.data()) % alignof(Header) != 0)
+            throw corrupt("not aligned in memory");
+
+        header = reinterpret_cast<const Header*>(bytes.data());
+        if (std::memcmp(header->magic, magic, sizeof(magic)) != 0)
+            throw corrupt("not a cooked mesh");
+        if (header->version != currentVersion)
+            throw corrupt("unsupported version " + std::to_string(header->version));
+        if (strideOf(header->layout) == 0 || header->vertexStride != strideOf(header->layout)
+            || (header->indexSize != sizeof(uint16_t) && header->indexSize != sizeof(uint32_t)))
+            throw corrupt("unsupported vertex layout or index type");
+
+        const uint64_t rangesEnd = sizeof(Header) + uint64_t(header->meshCount) * sizeof(Range);
+        const uint64_t lodsEnd = rangesEnd + uint64_t(header->lodCount) * sizeof(LodLevel);
+        const uint64_t meshletsEnd = lodsEnd + uint64_t(header->meshletCount) * sizeof(Meshlet);
+        const auto fits = [&](uint64_t offset, uint64_t size) {
+            return offset % payloadAlignment == 0 && offset <= bytes.size() && size <= bytes.size() - offset;
+        };
+        if (meshletsEnd > bytes.size() || !fits(header->indexOffset, header->indexBytes) || !fits(header->vertexOffset, header->vertexBytes)
+            || header->indexBytes % header->indexSize != 0 || header->vertexBytes % header->vertexStride != 0)
+            throw corrupt("truncated");
+
+        ranges = { reinterpret_cast<const Range*>(bytes.data() + sizeof(Header)), header->meshCount };
+        levels = { reinterpret_cast<const LodLevel*>(bytes.data() + rangesEnd), header->lodCount };
+        clusters = { reinterpret_cast<const Meshlet*>(bytes.data() + lodsEnd), header->meshletCount };
+
+        const uint64_t totalIndices = header->indexBytes / header->indexSize;
+        const uint64_t totalVertices = header->vertexBytes / header->vertexStride;
+        for (const auto& range : ranges) {
+            if (uint64_t(range.firstIndex) + range.indexCount > totalIndices || uint64_t(range.firstVertex) + range.vertexCount > totalVertices
+                || range.lodCount == 0 || uint64_t(range.firstLod) + range.lodCount > header->lodCount)
+                throw corrupt("mesh range out of bounds");
+            for (const auto& level : levels.subspan(range.firstLod, range.lodCount))
+                if (uint64_t(level.firstIndex) + level.indexCount > range.indexCount)
+                    throw corrupt("level of detail out of bounds");
+            if (uint64_t(range.firstMeshlet) + range.meshletCount > header->meshletCount)
+                throw corrupt("meshlets out of bounds");
+            for (const auto& meshlet : clusters.subspan(range.firstMeshlet, range.meshletCount))
+                if (uint64_t(meshlet.firstIndex) + meshlet.indexCount > range.indexCount)
+                    throw corrupt("meshlet out of bounds");
+
+            const std::byte* payload = bytes.data() + header->indexOffset;
+            if (!(header->indexSize == sizeof(uint16_t) ? indicesInRange<uint16_t>(payload, range) : indicesInRange<uint32_t>(payload, range)))
+                throw corrupt("index out of bounds");
+        }
+    }
+
+    std::span<const LodLevel> CookedMesh::lods(size_t mesh) const {
+        return levels.subspan(ranges[mesh].firstLod, ranges[mesh].lodCount);
+    }
+
+    MeshBounds CookedMesh::bounds(size_t mesh) const {
+        const Range& range = ranges[mesh];
+        MeshBounds bounds {};
+        std::copy_n(range.quantization.min, 3, bounds.min);
+        std::copy_n(range.quantization.max, 3, bounds.max);
+        std::copy_n(range.center, 3, bounds.center);
+        bounds.radius = range.radius;
+        return bounds;
+    }
+
+    std::span<const Meshlet> CookedMesh::meshlets(size_t mesh) const {
+        return clusters.subspan(ranges[mesh].firstMeshlet, ranges[mesh].meshletCount);
+    }
+
+    void CookedMesh::write(const std::string& path, const std::vector<Mesh>& meshes, VertexLayout layout) {
+        const bool shortIndices = std::all_of(meshes.begin(), meshes.end(), [](const Mesh& mesh) { return fitsShortIndices(mesh.vertices.size()); });
+
+        Header header {};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = currentVersion;
+        header.layout = layout;
+        header.vertexStride = strideOf(layout);
+        header.indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+        header.meshCount = static_cast<uint32_t>(meshes.size());
+        if (header.vertexStride == 0)
+            throw std::runtime_error("Unknown vertex layout for cooked mesh " + path);
+
+        std::vector<Range> ranges;
+        std::vector<LodLevel> levels;
+        std::vector<Meshlet> meshlets;
+        ranges.reserve(meshes.size());
+        uint64_t indices = 0, vertices = 0;
+        for (const auto& mesh : meshes) {
+            Range range {};
+            range.firstIndex = static_cast<uint32_t>(indices);
+            range.indexCount = static_cast<uint32_t>(mesh.indices.size());
+            range.firstVertex = static_cast<uint32_t>(vertices);
+            range.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+            range.firstLod = static_cast<uint32_t>(levels.size());
+
+            if (mesh.lods.empty())
+                levels.push_back({ 0, range.indexCount, 0 });
+            else
+                levels.insert(levels.end(), mesh.lods.begin(), mesh.lods.end());
+            range.lodCount = static_cast<uint32_t>(levels.size() - range.firstLod);
+            range.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+            range.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+            meshlets.insert(meshlets.end(), mesh.meshlets.begin(), mesh.meshlets.end());
+            range.quantization = quantizationBounds(mesh.vertices);
+            const MeshBounds bounds = computeBounds(mesh.vertices);
+            std::copy_n(bounds.center, 3, range.center);
+            range.radius = bounds.radius;
+
+            ranges.push_back(range);
+            indices += mesh.indices.size();
+            vertices += mesh.vertices.size();
+        }
+
+        if (indices > std::numeric_limits<uint32_t>::max() || vertices > std::numeric_limits<uint32_t>::max())
+            throw std::runtime_error("Too much geometry to cook into " + path);
+
+        header.lodCount = static_cast<uint32_t>(levels.size());
+        header.meshletCount = static_cast<uint32_t>(meshlets.size());
+        header.indexOffset = align(sizeof(Header) + ranges.size() * sizeof(Range) + levels.size() * sizeof(LodLevel) + meshlets.size() * sizeof(Meshlet));
+        header.indexBytes = indices * header.indexSize;
+        header.vertexOffset = align(header.indexOffset + header.indexBytes);
+        header.vertexBytes = vertices * header.vertexStride;
+
+        // Write beside the destination, then move it into place.
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out)
+                throw std::runtime_error("Unable to write cooked mesh " + path);
+
+            const char zeros[payloadAlignment] {};
+            uint64_t written = 0;
+            const auto write = [&](const void* data, size_t size) {
+                out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                written += size;
+            };
+            const auto pad = [&](uint64_t to) { write(zeros, to - written); };
+
+            write(&header, sizeof(header));
+            write(ranges.data(), ranges.size() * sizeof(Range));
+            write(levels.data(), levels.size() * sizeof(LodLevel));
+            write(meshlets.data(), meshlets.size() * sizeof(Meshlet));
+            pad(header.indexOffset);
+            for (const auto& mesh : meshes) {
+                if (shortIndices) {
+                    const auto narrow = narrowIndices(mesh.indices);
+                    write(narrow.data(), narrow.size() * sizeof(uint16_t));
+                } else {
+                    write(mesh.indices.data(), mesh.indices.size_bytes());
+                }
+            }
+            pad(header.vertexOffset);
+            for (size_t i = 0; i < meshes.size(); i++) {
+                if (layout == VertexLayout::Packed) {
+                    const auto packed = packVertices(meshes[i].vertices, ranges[i].quantization);
+                    write(packed.data(), packed.size() * sizeof(Geo::VertexPacked));
+                } else {
+                    write(meshes[i].vertices.data(), meshes[i].vertices.size_bytes());
+                }
+            }
+
+            out.close();
+            if (!out)
+                throw std::runtime_error("Unable to write cooked mesh " + path);
+        }
+
+        std::filesystem::rename(temporary, path);
+    }
+}
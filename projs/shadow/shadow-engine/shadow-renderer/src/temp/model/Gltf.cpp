@@ -0,0 +1,283 @@
+#include "temp/model/Gltf.h"
+#include "temp/model/Simd.h"
+#include <shadow/util/VFS.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace vlkxtemp {
+
+    namespace {
+        constexpr uint32_t glbMagic = 0x46546C67;       // "glTF"
+        constexpr uint32_t jsonChunk = 0x4E4F534A;      // "JSON"
+        constexpr uint32_t binaryChunk = 0x004E4942;    // "BIN\0"
+
+        uint32_t readU32(std::span<const std::byte> bytes, size_t offset) {
+            uint32_t value;
+            std::memcpy(&value, bytes.data() + offset, sizeof(value));
+            return value;
+        }
+
+        size_t componentSize(BinaryGltf::ComponentType type) {
+            switch (type) {
+                case BinaryGltf::ComponentType::Byte:
+                case BinaryGltf::ComponentType::UnsignedByte: return 1;
+                case BinaryGltf::ComponentType::Short:
+                case BinaryGltf::ComponentType::UnsignedShort: return 2;
+                case BinaryGltf::ComponentType::UnsignedInt:
+                case BinaryGltf::ComponentType::Float: return 4;
+                default: return 0;
+            }
+        }
+
+        uint32_t componentCount(const std::string& type) {
+            if (type == "SCALAR") return 1;
+            if (type == "VEC2") return 2;
+            if (type == "VEC3") return 3;
+            if (type == "VEC4" || type == "MAT2") return 4;
+            if (type == "MAT3") return 9;
+            if (type == "MAT4") return 16;
+            return 0;
+        }
+
+        // What an integer component is multiplied by to become a float. Normalized signed values are clamped to -1
+        //  as well, since both the smallest value and the one above it mean -1.
+        float componentScale(BinaryGltf::ComponentType type, bool normalized) {
+            if (!normalized) return 1;
+            switch (type) {
+                case BinaryGltf::ComponentType::Byte: return 1.0f / 127;
+                case BinaryGltf::ComponentType::UnsignedByte: return 1.0f / 255;
+                case BinaryGltf::ComponentType::Short: return 1.0f / 32767;
+                case BinaryGltf::ComponentType::UnsignedShort: return 1.0f / 65535;
+                case BinaryGltf::ComponentType::UnsignedInt: return 1.0f / 4294967295.0f;
+                default: return 1;
+            }
+        }
+
+        float componentToFloat(const std::byte* in, BinaryGltf::ComponentType type) {
+            switch (type) {
+                case BinaryGltf::ComponentType::Byte: { int8_t v; std::memcpy(&v, in, 1); return v; }
+                case BinaryGltf::ComponentType::UnsignedByte: { uint8_t v; std::memcpy(&v, in, 1); return v; }
+                case BinaryGltf::ComponentType::Short: { int16_t v; std::memcpy(&v, in, 2); return v; }
+                case BinaryGltf::ComponentType::UnsignedShort: { uint16_t v; std::memcpy(&v, in, 2); return v; }
+                case BinaryGltf::ComponentType::UnsignedInt: { uint32_t v; std::memcpy(&v, in, 4); return static_cast<float>(v); }
+                case BinaryGltf::ComponentType::Float: { float v; std::memcpy(&v, in, 4); return v; }
+                default: return 0;
+            }
+        }
+
+        // Convert `count` tightly packed integer components to floats.
+        // Quantized texture coordinates and normals (KHR_mesh_quantization) are almost always 8 or 16 bits, so those
+        //  convert eight or sixteen at a time.
+        void integersToFloats(const std::byte* in, BinaryGltf::ComponentType type, bool normalized, size_t count, float* out) {
+            const float scale = componentScale(type, normalized);
+            const bool clamp = normalized && (type == BinaryGltf::ComponentType::Byte || type == BinaryGltf::ComponentType::Short);
+            size_t i = 0;
+
+#ifdef VLKX_SSE2
+            const __m128 scales = _mm_set1_ps(scale);
+            const __m128 minimum = _mm_set1_ps(clamp ? -1.0f : std::numeric_limits<float>::lowest());
+            const __m128i zero = _mm_setzero_si128();
+            const auto store = [&](__m128i values, float* to) {
+                _mm_storeu_ps(to, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(values), scales), minimum));
+            };
+
+            if (type == BinaryGltf::ComponentType::UnsignedShort || type == BinaryGltf::ComponentType::Short) {
+                const bool isSigned = type == BinaryGltf::ComponentType::Short;
+                for (; i + 8 <= count; i += 8) {
+                    const __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+                    // Signed values go in the top half of each lane, then shift back down to extend their sign.
+                    const __m128i low = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(zero, shorts), 16) : _mm_unpacklo_epi16(shorts, zero);
+                    const __m128i high = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(zero, shorts), 16) : _mm_unpackhi_epi16(shorts, zero);
+                    store(low, out + i);
+                    store(high, out + i + 4);
+                }
+            } else if (type == BinaryGltf::ComponentType::UnsignedByte) {
+                for (; i + 16 <= count; i += 16) {
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                    const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                    const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+                    store(_mm_unpacklo_epi16(low, zero), out + i);
+                    store(_mm_unpackhi_epi16(low, zero), out + i + 4);
+                    store(_mm_unpacklo_epi16(high, zero), out + i + 8);
+                    store(_mm_unpackhi_epi16(high, zero), out + i + 12);
+                }
+            }
+#endif
+
+            const size_t size = componentSize(type);
+            for (; i < count; i++) {
+                const float value = componentToFloat(in + i * size, type) * scale;
+                out[i] = clamp ? std::max(value, -1.0f) : value;
+            }
+        }
+    }
+
+    BinaryGltf::BinaryGltf(const std::string& path) : path(path) {
+        std::span<const std::byte> bytes;
+        if (const auto mounted = shadowutil::VFS::get().find(path)) {
+            bytes = mounted->data;
+        } else {
+            file.emplace(path, shadowutil::MappedFile::Access::Sequential);
+            bytes = file->data();
+        }
+
+        const auto corrupt = [&](const std::string& why) {
+            return std::runtime_error("glTF file " + path + " is invalid: " + why);
+        };
+
+        if (bytes.size() < 20)
+            throw corrupt("too small");
+        if (readU32(bytes, 0) != glbMagic)
+            throw corrupt("not a binary glTF file");
+        if (readU32(bytes, 4) != 2)
+            throw corrupt("unsupported version " + std::to_string(readU32(bytes, 4)));
+
+        const size_t length = std::min<size_t>(readU32(bytes, 8), bytes.size());
+        const size_t jsonLength = readU32(bytes, 12);
+        if (readU32(bytes, 16) != jsonChunk || length < 20 || jsonLength > length - 20)
+            throw corrupt("missing JSON chunk");
+
+        document = shadowutil::JsonValue::parse({ reinterpret_cast<const char*>(bytes.data() + 20), jsonLength });
+
+        // The BIN chunk is optional, and chunks after it are to be ignored.
+        const size_t binaryStart = 20 + ((jsonLength + 3) & ~size_t(3));
+        if (binaryStart + 8 <= length && readU32(bytes, binaryStart + 4) == binaryChunk) {
+            const size_t binaryLength = readU32(bytes, binaryStart);
+            if (binaryLength > length - binaryStart - 8)
+                throw corrupt("truncated BIN chunk");
+            binary = bytes.subspan(binaryStart + 8, binaryLength);
+        }
+    }
+
+    std::span<const std::byte> BinaryGltf::bufferView(size_t index) const {
+        const auto& view = document["bufferViews"][index];
+        if (view["buffer"].asInt() != 0 || document["buffers"][0].find("uri") != nullptr)
+            throw std::runtime_error("glTF file " + path + " refers to data outside of it, which is not supported");
+
+        const auto offset = static_cast<size_t>(view.getInt("byteOffset", 0));
+        const auto length = static_cast<size_t>(view["byteLength"].asInt());
+        if (offset > binary.size() || length > binary.size() - offset)
+            throw std::runtime_error("glTF file " + path + ": buffer view " + std::to_string(index) + " is out of bounds");
+
+        return binary.subspan(offset, length);
+    }
+
+    BinaryGltf::Accessor BinaryGltf::accessor(size_t index) const {
+        const auto& json = document["accessors"][index];
+        const auto fail = [&](const std::string& why) {
+            return std::runtime_error("glTF file " + path + ": accessor " + std::to_string(index) + " " + why);
+        };
+
+        if (json.find("sparse") != nullptr || json.find("bufferView") == nullptr)
+            throw fail("is sparse or has no data, which is not supported");
+
+        Accessor accessor {};
+        accessor.count = static_cast<size_t>(json["count"].asInt());
+        accessor.componentType = static_cast<ComponentType>(json["componentType"].asInt());
+        accessor.components = componentCount(json["type"].asString());
+        accessor.normalized = json.find("normalized") != nullptr && json["normalized"].asBool();
+
+        const size_t elementSize = componentSize(accessor.componentType) * accessor.components;
+        if (elementSize == 0)
+            throw fail("has an unknown type");
+
+        const auto viewIndex = static_cast<size_t>(json["bufferView"].asInt());
+        const auto view = bufferView(viewIndex);
+        accessor.stride = static_cast<size_t>(document["bufferViews"][viewIndex].getInt("byteStride", 0));
+        if (accessor.stride == 0)
+            accessor.stride = elementSize;
+
+        const auto offset = static_cast<size_t>(json.getInt("byteOffset", 0));
+        const size_t span = accessor.count == 0 ? 0 : accessor.stride * (accessor.count - 1) + elementSize;
+        if (accessor.stride < elementSize || offset > view.size() || span > view.size() - offset)
+            throw fail("is out of bounds");
+
+        accessor.data = view.subspan(offset, span);
+        return accessor;
+    }
+
+    BinaryGltf::Image BinaryGltf::image(size_t index) const {
+        const auto& json = document["images"][index];
+        Image image {};
+        if (const auto* uri = json.find("uri"))
+            image.uri = uri->asString();
+        else
+            image.data = bufferView(static_cast<size_t>(json["bufferView"].asInt()));
+
+        if (const auto* mime = json.find("mimeType"))
+            image.mimeType = mime->asString();
+        return image;
+    }
+
+    void BinaryGltf::readFloats(const Accessor& accessor, std::byte* out, size_t outStride, uint32_t components) {
+        components = std::min(components, accessor.components);
+        const size_t size = componentSize(accessor.componentType);
+
+        // Floats only need moving into place.
+        if (accessor.componentType == ComponentType::Float) {
+            for (size_t i = 0; i < accessor.count; i++)
+                std::memcpy(out + i * outStride, accessor.data.data() + i * accessor.stride, components * sizeof(float));
+            return;
+        }
+
+        // Tightly packed integers convert in batches, then scatter into place.
+        if (accessor.stride == size * accessor.components) {
+            constexpr size_t batch = 256;
+            float converted[batch * 16];
+            for (size_t first = 0; first < accessor.count; first += batch) {
+                const size_t count = std::min(batch, accessor.count - first);
+                integersToFloats(accessor.data.data() + first * accessor.stride, accessor.componentType, accessor.normalized, count * accessor.components, converted);
+                for (size_t i = 0; i < count; i++)
+                    std::memcpy(out + (first + i) * outStride, converted + i * accessor.components, components * sizeof(float));
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < accessor.count; i++) {
+            float converted[16];
+            integersToFloats(accessor.data.data() + i * accessor.stride, accessor.componentType, accessor.normalized, components, converted);
+            std::memcpy(out + i * outStride, converted, components * sizeof(float));
+        }
+    }
+
+    void BinaryGltf::readIndices(const Accessor& accessor, uint32_t* out) {
+        const std::byte* in = accessor.data.data();
+        const size_t count = accessor.count;
+        size_t i = 0;
+
+        switch (accessor.componentType) {
+            case ComponentType::UnsignedInt:
+                for (; i < count; i++)
+                    std::memcpy(out + i, in + i * accessor.stride, sizeof(uint32_t));
+                break;
+
+            case ComponentType::UnsignedShort:
+#ifdef VLKX_SSE2
+                if (accessor.stride == sizeof(uint16_t)) {
+                    const __m128i zero = _mm_setzero_si128();
+                    for (; i + 8 <= count; i += 8) {
+                        const __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(shorts, zero));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(shorts, zero));
+                    }
+                }
+#endif
+                for (; i < count; i++) {
+                    uint16_t index;
+                    std::memcpy(&index, in + i * accessor.stride, sizeof(index));
+                    out[i] = index;
+                }
+                break;
+
+            case ComponentType::UnsignedByte:
+                for (; i < count; i++)
+                    out[i] = static_cast<uint8_t>(in[i * accessor.stride]);
+                break;
+
+            default:
+                throw std::runtime_error("glTF indices must be unsigned integers");
+        }
+    }
+}
@@ -1,96 +1,624 @@
 #include "temp/model/Loader.h"
+#include "temp/model/Gltf.h"
+#include <shadow/util/File.h>
+#include <shadow/util/FlatHashMap.h>
+#include <shadow/util/ThreadPool.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
-#include <map>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
-#include <sstream>
 
 namespace vlkxtemp {
 
-    std::vector<std::string> split (std::string_view s, char delim) {
-        std::vector<std::string> result;
-        std::stringstream ss ((std::string(s)));
-        std::string item;
+    namespace {
+        // One corner of a face: which position, texture coordinate and normal it uses.
+        struct VertexKey {
+            uint32_t position;
+            uint32_t texture;
+            uint32_t normal;
 
-        while (std::getline (ss, item, delim)) {
-            result.push_back (item);
-        }
+            bool operator==(const VertexKey&) const = default;
+        };
 
-        return result;
-    }
+        struct VertexKeyHash {
+            size_t operator()(const VertexKey& key) const {
+                return ((uint64_t(key.position) << 32) | key.normal) ^ (uint64_t(key.texture) * 0x9E3779B97F4A7C15ull);
+            }
+        };
 
-    Wavefront::Wavefront(std::string_view path, size_t index_base) {
-        std::ifstream file(std::string(path), std::ios::binary);
+        // Chunks are at least this large; below it, handing out the work costs more than it saves.
+        constexpr size_t minimumChunk = 1 << 20;
 
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> tex_coords;
-        std::map<std::string, uint32_t> loaded_vertices;
+        // Corners are deduplicated in this many independent groups, split by hash.
+        constexpr size_t dedupShards = 64;
 
-        const auto parse_line = [&](std::string_view line) {
-            const size_t non_space = line.find_first_not_of(' ');
-            if (non_space == std::string::npos || line[0] == '#')
-                return;
+        // A relative (negative) index refers back from where it appears. Until the chunk's place in the file is known,
+        //  it is stored counting from the start of the chunk (as a 31-bit signed number), marked with this bit.
+        constexpr uint32_t chunkRelative = 1u << 31;
+
+        // How many of each attribute there are, in a chunk or in the file before it.
+        struct Counts {
+            size_t positions = 0;
+            size_t texCoords = 0;
+            size_t normals = 0;
+        };
 
-            switch (line[non_space]) {
-                case 'v': {
-                    switch (line[non_space + 1]) {
-                        case ' ': {
-                            const auto nums = split(line.substr(non_space + 2), ' ');
-                            positions.emplace_back(stof(nums[0]), stof(nums[1]), stof(nums[2]));
-                            break;
-                        }
-                        case 'n': {
-                            // Normal.
-                            const auto nums = split(line.substr(non_space + 3), ' ');
-                            normals.emplace_back(glm::vec3{stof(nums[0]), stof(nums[1]), stof(nums[2])});
-                            break;
-                        }
-                        case 't': {
-                            // Texture coordinates.
-                            const auto nums = split(line.substr(non_space + 3), ' ');
-                            tex_coords.emplace_back(glm::vec2{stof(nums[0]), stof(nums[1])});
-                            break;
-                        }
-                        default:
-                            throw std::runtime_error("Unexpected symbol " + std::to_string(line[non_space + 1]));
+        // A line-aligned span of the file, and what was read from it.
+        struct Chunk {
+            std::string_view text;
+
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec3> normals;
+            std::vector<glm::vec2> texCoords;
+            // Three per triangle. Indices are 0-based, but not yet checked against the size of the whole file.
+            std::vector<VertexKey> corners;
+
+            Counts before;                  // Attributes in every earlier chunk
+            size_t firstCorner = 0;         // Corners in every earlier chunk
+
+            const char* errorLine = nullptr;
+            std::string error;
+        };
+
+        // Reads one chunk of an OBJ file in place, one statement at a time, without copying any of it.
+        class ChunkParser {
+        public:
+            // With limits, every index is also checked against them, so that an index error can be placed on its line.
+            ChunkParser(Chunk& chunk, size_t indexBase, const Counts* limits = nullptr)
+                : cur(chunk.text.data()), end(chunk.text.data() + chunk.text.size()), lineStart(cur), indexBase(indexBase), limits(limits), chunk(chunk) {}
+
+            void parse() {
+                reserve();
+
+                while (cur < end) {
+                    lineStart = cur;
+                    skipSpace();
+                    if (atLineEnd()) { nextLine(); continue; }
+
+                    const std::string_view keyword = word();
+                    if (keyword == "v") {
+                        const float x = number(), y = number(), z = number();
+                        chunk.positions.emplace_back(x, y, z);
+                    } else if (keyword == "vn") {
+                        const float x = number(), y = number(), z = number();
+                        chunk.normals.emplace_back(x, y, z);
+                    } else if (keyword == "vt") {
+                        const float u = number(), v = number();
+                        chunk.texCoords.emplace_back(u, v);
+                    } else if (keyword == "f") {
+                        face();
+                    } else if (keyword[0] != '#' && !ignored(keyword)) {
+                        throw std::runtime_error("Unexpected statement " + std::string(keyword));
                     }
-                    break;
+
+                    nextLine();
+                }
+            }
+
+            const char* line() const { return lineStart; }
+
+        private:
+            // Count each kind of statement, so that every list is allocated once.
+            void reserve() {
+                size_t counts[4] {};    // v, vn, vt, f
+                for (const char* at = cur; at < end; ) {
+                    if (end - at > 2) {
+                        if (at[0] == 'v' && at[1] == ' ') counts[0]++;
+                        else if (at[0] == 'v' && at[1] == 'n') counts[1]++;
+                        else if (at[0] == 'v' && at[1] == 't') counts[2]++;
+                        else if (at[0] == 'f') counts[3]++;
+                    }
+                    const char* next = static_cast<const char*>(memchr(at, '\n', end - at));
+                    at = next ? next + 1 : end;
+                }
+
+                chunk.positions.reserve(counts[0]);
+                chunk.normals.reserve(counts[1]);
+                chunk.texCoords.reserve(counts[2]);
+                chunk.corners.reserve(counts[3] * 3);
+            }
+
+            // Statements that don't affect the geometry.
+            static bool ignored(std::string_view keyword) {
+                return keyword == "o" || keyword == "g" || keyword == "s" || keyword == "usemtl" || keyword == "mtllib" || keyword == "l" || keyword == "vp";
+            }
+
+            bool atLineEnd() const { return cur == end || *cur == '\n'; }
+
+            void skipSpace() {
+                while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\r')) ++cur;
+            }
+
+            void nextLine() {
+                const char* next = static_cast<const char*>(memchr(cur, '\n', end - cur));
+                cur = next ? next + 1 : end;
+            }
+
+            std::string_view word() {
+                const char* start = cur;
+                while (cur < end && *cur != ' ' && *cur != '\t' && *cur != '\r' && *cur != '\n') ++cur;
+                return { start, size_t(cur - start) };
+            }
+
+            float number() {
+                skipSpace();
+                if (cur < end && *cur == '+') ++cur;
+                float value;
+                const auto [next, error] = std::from_chars(cur, end, value);
+                if (error != std::errc())
+                    throw std::runtime_error("Expected a number");
+                cur = next;
+                return value;
+            }
+
+            // An OBJ index, made 0-based. `seen` is how many of the attribute this chunk has read so far;
+            //  `before` and `limit` are how many are in earlier chunks and in the whole file, where known.
+            uint32_t index(size_t seen, size_t before, size_t limit) {
+                int64_t value;
+                const auto [next, error] = std::from_chars(cur, end, value);
+                if (error != std::errc())
+                    throw std::runtime_error("Expected a vertex index");
+                cur = next;
+
+                if (value < 0) {
+                    if (value < -(int64_t(1) << 30) || (limits && size_t(-value) > seen + before))
+                        throw std::out_of_range("Vertex index " + std::to_string(value) + " out of range");
+                    // -1 is the most recent, which may be in an earlier chunk; then this is negative.
+                    return chunkRelative | (uint32_t(int64_t(seen) + value) & ~chunkRelative);
                 }
-                case 'f': {
-                    for (const auto& seg : split(line.substr(non_space + 2), ' ')) {
-                        const auto iter = loaded_vertices.find(seg);
-                        if (iter != loaded_vertices.end()) {
-                            indices.push_back(iter->second);
-                        } else {
-                            indices.push_back(vertices.size());
-                            loaded_vertices[seg] = vertices.size();
-                            const auto idxs = split(seg, '/');
-                            vertices.push_back(Geo::VertexAll {
-                                    positions.at(stoi(idxs[0]) - index_base),
-                                    normals.at(stoi(idxs[2]) - index_base),
-                                    tex_coords.at(stoi(idxs[1]) - index_base),
-                            });
-                        }
+
+                if (size_t(value) < indexBase || size_t(value) - indexBase >= std::min<size_t>(limit, chunkRelative))
+                    throw std::out_of_range("Vertex index " + std::to_string(value) + " out of range");
+                return static_cast<uint32_t>(value - indexBase);
+            }
+
+            void expect(char c) {
+                if (cur >= end || *cur != c)
+                    throw std::runtime_error(std::string("Expected '") + c + "' in face");
+                ++cur;
+            }
+
+            // A face of position/texture/normal corners. Anything beyond a triangle is split into a fan.
+            void face() {
+                const Counts before = limits ? chunk.before : Counts {};
+                const Counts limit = limits ? *limits : Counts { SIZE_MAX, SIZE_MAX, SIZE_MAX };
+
+                VertexKey first {}, previous {};
+                size_t corners = 0;
+
+                for (skipSpace(); !atLineEnd(); skipSpace()) {
+                    VertexKey key {};
+                    key.position = index(chunk.positions.size(), before.positions, limit.positions);
+                    expect('/');
+                    key.texture = index(chunk.texCoords.size(), before.texCoords, limit.texCoords);
+                    expect('/');
+                    key.normal = index(chunk.normals.size(), before.normals, limit.normals);
+
+                    if (corners == 0) first = key;
+                    if (corners >= 2) {
+                        chunk.corners.push_back(first);
+                        chunk.corners.push_back(previous);
+                        chunk.corners.push_back(key);
                     }
-                    break;
+                    previous = key;
+                    corners++;
                 }
-                default:
-                    throw std::runtime_error("Unexpected symbol in OBJ file: " + std::to_string(line[non_space]));
+
+                if (corners < 3)
+                    throw std::runtime_error("Face has fewer than 3 vertices");
             }
+
+            const char* cur;
+            const char* const end;
+            const char* lineStart;
+            const size_t indexBase;
+            const Counts* const limits;
+            Chunk& chunk;
         };
 
-        std::string line;
-        int line_num = 1;
-        try {
-            for (; std::getline(file, line); ++line_num)
-                parse_line(line);
-        } catch (const std::exception& e) {
-            throw std::runtime_error("Failed to parse obj file, error on line " + std::to_string(line_num) + ": " + line + "; " + e.what());
+        // Split the file into line-aligned chunks of roughly equal size, a few per thread so that they balance out.
+        std::vector<Chunk> split(std::string_view text, size_t threads) {
+            const size_t target = std::max(minimumChunk, text.size() / (threads * 4) + 1);
+
+            std::vector<Chunk> chunks;
+            while (!text.empty()) {
+                size_t size = text.size();
+                if (size > target) {
+                    const size_t newline = text.find('\n', target);
+                    size = newline == std::string_view::npos ? text.size() : newline + 1;
+                }
+
+                chunks.emplace_back().text = text.substr(0, size);
+                text.remove_prefix(size);
+            }
+            return chunks;
+        }
+
+        // Make a chunk's relative indices absolute, now that the chunks before it are counted, and check every index.
+        bool resolve(Chunk& chunk, const Counts& total) {
+            const auto fix = [](uint32_t& index, size_t before, size_t limit) {
+                if (index & chunkRelative) {
+                    const int64_t absolute = int64_t(before) + (int32_t(index << 1) >> 1);
+                    if (absolute < 0) return false;
+                    index = uint32_t(absolute);
+                }
+                return index < limit;
+            };
+
+            bool valid = true;
+            for (auto& corner : chunk.corners) {
+                valid &= fix(corner.position, chunk.before.positions, total.positions);
+                valid &= fix(corner.texture, chunk.before.texCoords, total.texCoords);
+                valid &= fix(corner.normal, chunk.before.normals, total.normals);
+            }
+            return valid;
+        }
+
+        [[noreturn]] void fail(std::string_view text, const char* line, const std::string& error) {
+            const char* lineEnd = static_cast<const char*>(memchr(line, '\n', text.data() + text.size() - line));
+            const size_t number = 1 + std::count(text.data(), line, '\n');
+            throw std::runtime_error("Failed to parse obj file, error on line " + std::to_string(number) + ": "
+                                     + std::string(line, lineEnd ? lineEnd : text.data() + text.size()) + "; " + error);
+        }
+    }
+
+    // The file is read in four passes, each spread across the thread pool:
+    //  1. Chunks are parsed independently, into their own attribute lists and triangulated corners.
+    //  2. A prefix sum over the chunks places each one's attributes in the file, so that the lists can be joined and
+    //     relative indices resolved.
+    //  3. Corners are deduplicated in shards by hash. Each shard sees its corners in file order, so it can record which
+    //     corner first used each (position, texture, normal) triple.
+    //  4. The first corner of each triple becomes a vertex, numbered by another prefix sum.
+    // That numbers vertices in the order they first appear, so the result is the same however the file is split.
+    Wavefront::Wavefront(std::string_view path, size_t index_base) {
+        const shadowutil::MappedFile file = shadowutil::loadFile(std::string(path));
+        const std::string_view text = file.text();
+        auto& pool = shadowutil::ThreadPool::shared();
+
+        std::vector<Chunk> chunks = split(text, pool.size() + 1);
+
+        pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                ChunkParser parser(chunks[i], index_base);
+                try {
+                    parser.parse();
+                } catch (const std::exception& e) {
+                    chunks[i].errorLine = parser.line();
+                    chunks[i].error = e.what();
+                }
+            }
+        });
+
+        for (const auto& chunk : chunks)
+            if (chunk.errorLine) fail(text, chunk.errorLine, chunk.error);
+
+        Counts total;
+        size_t corners = 0;
+        for (auto& chunk : chunks) {
+            chunk.before = total;
+            chunk.firstCorner = corners;
+            total.positions += chunk.positions.size();
+            total.texCoords += chunk.texCoords.size();
+            total.normals += chunk.normals.size();
+            corners += chunk.corners.size();
+        }
+
+        std::vector<glm::vec3> positions(total.positions);
+        std::vector<glm::vec3> normals(total.normals);
+        std::vector<glm::vec2> texCoords(total.texCoords);
+        std::vector<char> valid(chunks.size());
+
+        pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto& chunk = chunks[i];
+                std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.before.positions);
+                std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.before.normals);
+                std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.before.texCoords);
+                valid[i] = resolve(chunk, total);
+            }
+        });
+
+        // A bad index only shows up once the whole file is counted. Parse its chunk again, checking every index,
+        //  to find the line it is on.
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (valid[i]) continue;
+            Chunk retry {};
+            retry.text = chunks[i].text;
+            retry.before = chunks[i].before;
+            ChunkParser parser(retry, index_base, &total);
+            try {
+                parser.parse();
+            } catch (const std::exception& e) {
+                fail(text, parser.line(), e.what());
+            }
+        }
+
+        // Which corner first used the same triple as each corner.
+        const size_t shards = chunks.size() == 1 ? 1 : dedupShards;
+        const auto shardOf = [&](const VertexKey& key) { return VertexKeyHash()(key) * 0x9E3779B97F4A7C15ull >> 58 & (shards - 1); };
+        std::vector<uint32_t> firstUse(corners);
+
+        std::vector<std::vector<std::vector<uint32_t>>> buckets(chunks.size(), std::vector<std::vector<uint32_t>>(shards));
+        pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto& chunkBuckets = buckets[i];
+                for (auto& bucket : chunkBuckets) bucket.reserve(chunks[i].corners.size() / shards * 5 / 4);
+                for (size_t c = 0; c < chunks[i].corners.size(); c++)
+                    chunkBuckets[shardOf(chunks[i].corners[c])].push_back(uint32_t(chunks[i].firstCorner + c));
+            }
+        });
+
+        pool.parallelFor(shards, 1, [&](size_t begin, size_t end) {
+            for (size_t shard = begin; shard < end; shard++) {
+                shadowutil::FlatHashMap<VertexKey, uint32_t, VertexKeyHash> seen;
+                seen.reserve(std::min(corners / shards, total.positions * 2 / shards + 1));
+                for (size_t i = 0; i < chunks.size(); i++) {
+                    const auto& chunk = chunks[i];
+                    for (const uint32_t index : buckets[i][shard])
+                        firstUse[index] = seen.try_emplace(chunk.corners[index - chunk.firstCorner], index).first->second;
+                }
+            }
+        });
+
+        // Number the vertices: a corner that is its own first use becomes the next vertex.
+        std::vector<size_t> firstVertex(chunks.size() + 1);
+        pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const size_t start = chunks[i].firstCorner;
+                size_t count = 0;
+                for (size_t c = start; c < start + chunks[i].corners.size(); c++)
+                    count += firstUse[c] == c;
+                firstVertex[i + 1] = count;
+            }
+        });
+        for (size_t i = 0; i < chunks.size(); i++)
+            firstVertex[i + 1] += firstVertex[i];
+
+        std::vector<uint32_t> vertexOf(corners);
+        vertices.resize(firstVertex.back());
+        indices.resize(corners);
+
+        pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                uint32_t next = uint32_t(firstVertex[i]);
+                const size_t start = chunks[i].firstCorner;
+                for (size_t c = start; c < start + chunks[i].corners.size(); c++) {
+                    if (firstUse[c] != c) continue;
+                    const VertexKey& key = chunks[i].corners[c - start];
+                    vertices[next] = Geo::VertexAll { positions[key.position], normals[key.normal], texCoords[key.texture] };
+                    vertexOf[c] = next++;
+                }
+            }
+        });
+
+        // A corner's first use is never later than itself, so it has been numbered above.
+        pool.parallelFor(corners, 1 << 16, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++)
+                indices[c] = vertexOf[firstUse[c]];
+        });
+
+        bounds = computeBounds(vertices);
+    }
+
+    namespace {
+        // A column-major 4x4 matrix, as glTF stores them.
+        using Transform = std::array<float, 16>;
+
+        constexpr Transform identity { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+        Transform multiply(const Transform& a, const Transform& b) {
+            Transform out {};
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                    for (int k = 0; k < 4; k++)
+                        out[column * 4 + row] += a[k * 4 + row] * b[column * 4 + k];
+            return out;
+        }
+
+        // A node's transform relative to its parent: either a whole matrix, or a translation, rotation and scale.
+        Transform localTransform(const shadowutil::JsonValue& node) {
+            const auto read = [&](std::string_view key, float* out, size_t count) {
+                if (const auto* values = node.find(key))
+                    for (size_t i = 0; i < count; i++)
+                        out[i] = static_cast<float>((*values)[i].asNumber());
+            };
+
+            if (node.find("matrix") != nullptr) {
+                Transform matrix;
+                read("matrix", matrix.data(), matrix.size());
+                return matrix;
+            }
+
+            float t[3] { 0, 0, 0 }, r[4] { 0, 0, 0, 1 }, s[3] { 1, 1, 1 };
+            read("translation", t, 3);
+            read("rotation", r, 4);
+            read("scale", s, 3);
+
+            const float x = r[0], y = r[1], z = r[2], w = r[3];
+            return {
+                (1 - 2 * (y * y + z * z)) * s[0], 2 * (x * y + z * w) * s[0], 2 * (x * z - y * w) * s[0], 0,
+                2 * (x * y - z * w) * s[1], (1 - 2 * (x * x + z * z)) * s[1], 2 * (y * z + x * w) * s[1], 0,
+                2 * (x * z + y * w) * s[2], 2 * (y * z - x * w) * s[2], (1 - 2 * (x * x + y * y)) * s[2], 0,
+                t[0], t[1], t[2], 1
+            };
+        }
+
+        std::array<float, 3> cross(const float* a, const float* b) {
+            return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+        }
+
+        // Move a mesh from its node into model space.
+        // Normals go through the cofactor matrix: the inverse transpose, times the determinant, whose sign is taken
+        //  back out. A mirroring transform turns triangles inside out, so their winding is flipped back.
+        void transformMesh(ModelLoader::MeshData& mesh, const Transform& m) {
+            const auto column0 = cross(&m[4], &m[8]), column1 = cross(&m[8], &m[0]), column2 = cross(&m[0], &m[4]);
+            const float determinant = m[0] * column0[0] + m[1] * column0[1] + m[2] * column0[2];
+            const float sign = determinant < 0 ? -1.0f : 1.0f;
+
+            for (auto& vertex : mesh.vertices) {
+                const float p[3] = { vertex.position[0], vertex.position[1], vertex.position[2] };
+                const float n[3] = { vertex.normal[0], vertex.normal[1], vertex.normal[2] };
+                float normal[3], length = 0;
+                for (int axis = 0; axis < 3; axis++) {
+                    vertex.position[axis] = m[axis] * p[0] + m[4 + axis] * p[1] + m[8 + axis] * p[2] + m[12 + axis];
+                    normal[axis] = sign * (column0[axis] * n[0] + column1[axis] * n[1] + column2[axis] * n[2]);
+                    length += normal[axis] * normal[axis];
+                }
+                length = std::sqrt(length);
+                for (int axis = 0; axis < 3; axis++)
+                    vertex.normal[axis] = length > 0 ? normal[axis] / length : 0;
+            }
+
+            if (determinant < 0)
+                for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+                    std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+        }
+
+        // Where an image can be loaded from. Textures are only ever loaded by path, so an image inside the file is
+        //  written out to the texture directory, and rewritten whenever the file is newer than it.
+        std::string imagePath(const BinaryGltf& gltf, size_t index, const std::string& model, const std::string& textures) {
+            const auto image = gltf.image(index);
+            if (!image.uri.empty()) {
+                if (image.uri.starts_with("data:"))
+                    throw std::runtime_error("glTF file " + model + " embeds an image as a data URI, which is not supported");
+                return textures + "/" + std::string(image.uri);
+            }
+
+            const char* extension = image.mimeType == "image/jpeg" ? ".jpg" : ".png";
+            const std::string path = textures + "/" + std::filesystem::path(model).stem().string() + ".image" + std::to_string(index) + extension;
+
+            std::error_code modelError, imageError;
+            const auto modelTime = std::filesystem::last_write_time(model, modelError);
+            const auto imageTime = std::filesystem::last_write_time(path, imageError);
+            if (!imageError && (modelError || imageTime >= modelTime))
+                return path;
+
+            const std::string temporary = path + ".tmp";
+            {
+                std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char*>(image.data.data()), static_cast<std::streamsize>(image.data.size()));
+                out.close();
+                if (!out)
+                    throw std::runtime_error("Unable to extract image " + path + " from " + model);
+            }
+            std::filesystem::rename(temporary, path);
+            return path;
         }
     }
 
     ModelLoader::ModelLoader(const std::string &model, const std::string &textures) {
+        const BinaryGltf gltf(model);
+        const auto& json = gltf.json();
+
+        std::vector<std::optional<std::string>> images(json.find("images") ? json["images"].asArray().size() : 0);
+        const auto addTexture = [&](MeshData& mesh, const shadowutil::JsonValue* info, TextureType type) {
+            if (info == nullptr) return;
+            const auto image = static_cast<size_t>(json["textures"][(*info)["index"].asInt()]["source"].asInt());
+            if (!images.at(image))
+                images[image] = imagePath(gltf, image, model, textures);
+            mesh.textures.emplace_back(*images[image], type);
+        };
+
+        size_t skipped = 0;
+        const auto addPrimitive = [&](const shadowutil::JsonValue& primitive, const Transform& transform) {
+            if (primitive.getInt("mode", 4) != 4) {
+                skipped++;
+                return;
+            }
+
+            const auto& attributes = primitive["attributes"];
+            const auto positions = gltf.accessor(attributes["POSITION"].asInt());
+
+            // Attributes are read straight from the file into place in each vertex. Missing ones stay zero.
+            MeshData mesh;
+            mesh.vertices.resize(positions.count, Geo::VertexAll { glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), glm::vec2(0, 0) });
+            auto* vertices = reinterpret_cast<std::byte*>(mesh.vertices.data());
+            const auto read = [&](const char* name, const BinaryGltf::Accessor& accessor, size_t offset, uint32_t components) {
+                if (accessor.count != positions.count)
+                    throw std::runtime_error("glTF file " + model + " has a " + name + " attribute of the wrong length");
+                BinaryGltf::readFloats(accessor, vertices + offset, sizeof(Geo::VertexAll), components);
+            };
+
+            read("POSITION", positions, offsetof(Geo::VertexAll, position), 3);
+            if (const auto* normals = attributes.find("NORMAL"))
+                read("NORMAL", gltf.accessor(normals->asInt()), offsetof(Geo::VertexAll, normal), 3);
+            if (const auto* texCoords = attributes.find("TEXCOORD_0"))
+                read("TEXCOORD_0", gltf.accessor(texCoords->asInt()), offsetof(Geo::VertexAll, texture), 2);
+
+            if (const auto* indices = primitive.find("indices")) {
+                const auto accessor = gltf.accessor(indices->asInt());
+                mesh.indices.resize(accessor.count);
+                BinaryGltf::readIndices(accessor, mesh.indices.data());
+                if (std::any_of(mesh.indices.begin(), mesh.indices.end(), [&](uint32_t index) { return index >= positions.count; }))
+                    throw std::runtime_error("glTF file " + model + " has an index out of range");
+            } else {
+                mesh.indices.resize(positions.count);
+                std::iota(mesh.indices.begin(), mesh.indices.end(), 0);
+            }
+            mesh.indices.resize(mesh.indices.size() / 3 * 3);
+
+            if (transform != identity)
+                transformMesh(mesh, transform);
+            mesh.bounds = computeBounds(mesh.vertices);
+            bounds = meshes.empty() ? mesh.bounds : mergeBounds(bounds, mesh.bounds);
+
+            if (const auto* material = primitive.find("material")) {
+                const auto& properties = json["materials"][material->asInt()];
+                if (const auto* pbr = properties.find("pbrMetallicRoughness")) {
+                    addTexture(mesh, pbr->find("baseColorTexture"), TextureType::Diffuse);
+                    addTexture(mesh, pbr->find("metallicRoughnessTexture"), TextureType::Specular);
+                }
+            }
+
+            meshes.push_back(std::move(mesh));
+        };
+
+        const auto addMesh = [&](int64_t index, const Transform& transform) {
+            for (const auto& primitive : json["meshes"][index]["primitives"].asArray())
+                addPrimitive(primitive, transform);
+        };
+
+        if (const auto* scenes = json.find("scenes")) {
+            // Nodes form trees, so no node is visited twice unless the file is malformed.
+            const size_t nodeCount = json.find("nodes") ? json["nodes"].asArray().size() : 0;
+            size_t visited = 0;
+
+            std::vector<std::pair<int64_t, Transform>> pending;
+            const auto push = [&](const shadowutil::JsonValue& nodes, const Transform& parent) {
+                // Backwards, so that nodes come off the stack in file order.
+                for (auto it = nodes.asArray().rbegin(); it != nodes.asArray().rend(); ++it)
+                    pending.emplace_back(it->asInt(), parent);
+            };
+
+            push((*scenes)[json.getInt("scene", 0)]["nodes"], identity);
+            while (!pending.empty()) {
+                const auto [index, parent] = pending.back();
+                pending.pop_back();
+                if (++visited > nodeCount)
+                    throw std::runtime_error("glTF file " + model + " has a cycle in its nodes");
+
+                const auto& node = json["nodes"][index];
+                const Transform transform = multiply(parent, localTransform(node));
+                if (const auto* mesh = node.find("mesh"))
+                    addMesh(mesh->asInt(), transform);
+                if (const auto* children = node.find("children"))
+                    push(*children, transform);
+            }
+        } else if (const auto* list = json.find("meshes")) {
+            for (size_t i = 0; i < list->asArray().size(); i++)
+                addMesh(static_cast<int64_t>(i), identity);
+        }
 
+        if (skipped != 0)
+            spdlog::warn("Skipped {} primitives of {} that are not triangle lists", skipped, model);
     }
-}
\ No newline at end of file
+}
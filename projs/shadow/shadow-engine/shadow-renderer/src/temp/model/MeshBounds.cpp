@@ -0,0 +1,130 @@
+#include "temp/model/MeshBounds.h"
+#include "temp/model/Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace vlkxtemp {
+
+    namespace {
+        static_assert(offsetof(Geo::VertexAll, position) == 0 && sizeof(Geo::VertexAll) >= 4 * sizeof(float),
+                      "A vertex's position must be followed by at least one more float, so it can be loaded as four");
+
+        void boxAround(std::span<const Geo::VertexAll> vertices, float* min, float* max) {
+#ifdef VLKX_SSE2
+            // Each load takes the normal's x along with the position; it is never stored.
+            __m128 low = _mm_loadu_ps(&vertices[0].position[0]), high = low;
+            for (size_t i = 1; i < vertices.size(); i++) {
+                const __m128 position = _mm_loadu_ps(&vertices[i].position[0]);
+                low = _mm_min_ps(low, position);
+                high = _mm_max_ps(high, position);
+            }
+
+            float lanes[4];
+            _mm_storeu_ps(lanes, low);
+            std::copy_n(lanes, 3, min);
+            _mm_storeu_ps(lanes, high);
+            std::copy_n(lanes, 3, max);
+#else
+            for (int axis = 0; axis < 3; axis++)
+                min[axis] = max[axis] = vertices[0].position[axis];
+            for (size_t i = 1; i < vertices.size(); i++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    min[axis] = std::min(min[axis], vertices[i].position[axis]);
+                    max[axis] = std::max(max[axis], vertices[i].position[axis]);
+                }
+            }
+#endif
+        }
+
+        float furthestSquared(std::span<const Geo::VertexAll> vertices, const float* center) {
+            float furthest = 0;
+            size_t i = 0;
+
+#ifdef VLKX_SSE2
+            // Four vertices at a time, turned on their side so that each register holds one axis of all four.
+            const __m128 centerX = _mm_set1_ps(center[0]), centerY = _mm_set1_ps(center[1]), centerZ = _mm_set1_ps(center[2]);
+            __m128 widest = _mm_setzero_ps();
+            for (; i + 4 <= vertices.size(); i += 4) {
+                __m128 x = _mm_loadu_ps(&vertices[i].position[0]);
+                __m128 y = _mm_loadu_ps(&vertices[i + 1].position[0]);
+                __m128 z = _mm_loadu_ps(&vertices[i + 2].position[0]);
+                __m128 unused = _mm_loadu_ps(&vertices[i + 3].position[0]);
+                _MM_TRANSPOSE4_PS(x, y, z, unused);
+
+                const __m128 dx = _mm_sub_ps(x, centerX), dy = _mm_sub_ps(y, centerY), dz = _mm_sub_ps(z, centerZ);
+                widest = _mm_max_ps(widest, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+            }
+
+            float lanes[4];
+            _mm_storeu_ps(lanes, widest);
+            furthest = *std::max_element(lanes, lanes + 4);
+#endif
+
+            for (; i < vertices.size(); i++) {
+                float distance = 0;
+                for (int axis = 0; axis < 3; axis++)
+                    distance += (vertices[i].position[axis] - center[axis]) * (vertices[i].position[axis] - center[axis]);
+                furthest = std::max(furthest, distance);
+            }
+            return furthest;
+        }
+    }
+
+    MeshBounds computeBounds(std::span<const Geo::VertexAll> vertices) {
+        MeshBounds bounds {};
+        if (vertices.empty()) return bounds;
+
+        boxAround(vertices, bounds.min, bounds.max);
+        for (int axis = 0; axis < 3; axis++)
+            bounds.center[axis] = (bounds.min[axis] + bounds.max[axis]) / 2;
+        bounds.radius = std::sqrt(furthestSquared(vertices, bounds.center));
+        return bounds;
+    }
+
+    MeshBounds mergeBounds(const MeshBounds& a, const MeshBounds& b) {
+        MeshBounds merged {};
+        float offset[3], distance = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            merged.min[axis] = std::min(a.min[axis], b.min[axis]);
+            merged.max[axis] = std::max(a.max[axis], b.max[axis]);
+            offset[axis] = b.center[axis] - a.center[axis];
+            distance += offset[axis] * offset[axis];
+        }
+        distance = std::sqrt(distance);
+
+        // Either sphere may already hold the other; otherwise the new one touches the far side of each.
+        const MeshBounds* inside = distance + b.radius <= a.radius ? &a : distance + a.radius <= b.radius ? &b : nullptr;
+        if (inside != nullptr) {
+            std::copy_n(inside->center, 3, merged.center);
+            merged.radius = inside->radius;
+        } else {
+            merged.radius = (distance + a.radius + b.radius) / 2;
+            for (int axis = 0; axis < 3; axis++)
+                merged.center[axis] = a.center[axis] + offset[axis] * (merged.radius - a.radius) / distance;
+        }
+        return merged;
+    }
+
+    MeshBounds transformBounds(const MeshBounds& bounds, const glm::mat4& transform) {
+        MeshBounds placed {};
+        for (int row = 0; row < 3; row++) {
+            placed.min[row] = placed.max[row] = placed.center[row] = transform[3][row];
+            for (int column = 0; column < 3; column++) {
+                const float low = transform[column][row] * bounds.min[column];
+                const float high = transform[column][row] * bounds.max[column];
+                placed.min[row] += std::min(low, high);
+                placed.max[row] += std::max(low, high);
+                placed.center[row] += transform[column][row] * bounds.center[column];
+            }
+        }
+
+        // The largest a unit grows along any axis, so the sphere still covers the mesh.
+        float scale = 0;
+        for (int column = 0; column < 3; column++)
+            scale = std::max(scale, transform[column][0] * transform[column][0] + transform[column][1] * transform[column][1] + transform[column][2] * transform[column][2]);
+
+        placed.radius = bounds.radius * std::sqrt(scale);
+        return placed;
+    }
+}
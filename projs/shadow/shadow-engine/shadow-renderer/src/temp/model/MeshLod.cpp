@@ -0,0 +1,55 @@
+#include "temp/model/MeshLod.h"
+#include "temp/model/MeshBounds.h"
+#include "temp/model/MeshOptimizer.h"
+#include <algorithm>
+
+namespace vlkxtemp {
+
+    std::vector<LodLevel> generateLods(std::vector<uint32_t>& indices, std::span<const Geo::VertexAll> vertices, const LodSettings& settings) {
+        std::vector<LodLevel> levels { { 0, static_cast<uint32_t>(indices.size()), 0 } };
+        const float budget = settings.maxError * computeBounds(vertices).radius;
+
+        std::vector<uint32_t> previous(indices);
+        while (levels.size() < settings.maxLevels) {
+            const size_t target = size_t(float(previous.size() / 3) * settings.reduction) * 3;
+            const float remaining = budget - levels.back().error;
+            if (target == 0 || remaining <= 0) break;
+
+            // Each level is simplified from the one before, so their errors add up.
+            float error;
+            std::vector<uint32_t> next = simplifyMesh(previous, vertices, target, remaining, &error);
+
+            // A level that is barely smaller than the last costs memory without saving any time.
+            if (next.empty() || next.size() > previous.size() * 9 / 10) break;
+
+            optimizeVertexCache(next, vertices.size());
+            levels.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(next.size()), levels.back().error + error });
+            indices.insert(indices.end(), next.begin(), next.end());
+            previous = std::move(next);
+        }
+
+        return levels;
+    }
+
+    std::span<const LodLevel> limitLods(std::span<const LodLevel> levels, float radius, const LodSettings& settings) {
+        const size_t most = std::min<size_t>(levels.size(), std::max(settings.maxLevels, 1u));
+        size_t count = std::min<size_t>(levels.size(), 1);
+        while (count < most && levels[count].error <= settings.maxError * radius) count++;
+        return levels.first(count);
+    }
+
+    size_t selectLod(std::span<const LodLevel> levels, float pixelsPerUnit, size_t current, float pixelError, float hysteresis) {
+        if (levels.empty()) return 0;
+
+        const auto closeEnough = [&](size_t level, float limit) { return levels[level].error * pixelsPerUnit <= limit; };
+        size_t level = std::min(current, levels.size() - 1);
+
+        if (!closeEnough(level, pixelError)) {
+            while (level > 0 && !closeEnough(level, pixelError)) level--;
+        } else {
+            while (level + 1 < levels.size() && closeEnough(level + 1, pixelError * (1 - hysteresis))) level++;
+        }
+
+        return level;
+    }
+}
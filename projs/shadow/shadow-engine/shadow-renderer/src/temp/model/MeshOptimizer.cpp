@@ -0,0 +1,604 @@
+#include "temp/model/MeshOptimizer.h"
+#include <shadow/util/FlatHashMap.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace vlkxtemp {
+
+    namespace {
+        // A FIFO cache, tracked by when each vertex last entered it.
+        class CacheSimulator {
+        public:
+            CacheSimulator(size_t vertexCount, uint32_t size) : entered(vertexCount, 0), size(size), time(size + 1) {}
+
+            // Returns whether the vertex had to be transformed.
+            bool use(uint32_t vertex) {
+                if (time - entered[vertex] <= size) return false;
+                entered[vertex] = time++;
+                return true;
+            }
+
+            // Forget everything, as if starting on an empty cache.
+            void flush() { time += size + 1; }
+
+        private:
+            std::vector<uint32_t> entered;
+            const uint32_t size;
+            uint32_t time;
+        };
+
+        // For each vertex, the triangles that use it.
+        struct Adjacency {
+            Adjacency(std::span<const uint32_t> indices, size_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+                for (const uint32_t vertex : indices) offsets[vertex + 1]++;
+                std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+                std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+                for (size_t i = 0; i < indices.size(); i++)
+                    triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            std::span<const uint32_t> of(uint32_t vertex) const {
+                return { triangles.data() + offsets[vertex], offsets[vertex + 1] - offsets[vertex] };
+            }
+
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> triangles;
+        };
+
+        void checkIndices(std::span<const uint32_t> indices, size_t vertexCount) {
+            if (indices.size() % 3 != 0)
+                throw std::runtime_error("Mesh indices are not a list of triangles");
+            for (const uint32_t vertex : indices)
+                if (vertex >= vertexCount)
+                    throw std::runtime_error("Mesh index " + std::to_string(vertex) + " is out of range");
+        }
+
+        using Vec3 = std::array<float, 3>;
+
+        Vec3 position(const Geo::VertexAll& vertex) {
+            return { vertex.position[0], vertex.position[1], vertex.position[2] };
+        }
+
+        Vec3 sub(const Vec3& a, const Vec3& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+        float dot(const Vec3& a, const Vec3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+        Vec3 cross(const Vec3& a, const Vec3& b) {
+            return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+        }
+
+        // The squared distance to a weighted set of planes, as a symmetric 4x4 matrix.
+        struct Quadric {
+            double xx = 0, xy = 0, xz = 0, xw = 0, yy = 0, yz = 0, yw = 0, zz = 0, zw = 0, ww = 0;
+            double weight = 0;
+
+            static Quadric plane(const Vec3& normal, const Vec3& point, double weight) {
+                const double a = normal[0], b = normal[1], c = normal[2];
+                const double d = -(a * point[0] + b * point[1] + c * point[2]);
+                return { a * a * weight, a * b * weight, a * c * weight, a * d * weight, b * b * weight, b * c * weight,
+                         b * d * weight, c * c * weight, c * d * weight, d * d * weight, weight };
+            }
+
+            Quadric& operator+=(const Quadric& other) {
+                xx += other.xx; xy += other.xy; xz += other.xz; xw += other.xw; yy += other.yy;
+                yz += other.yz; yw += other.yw; zz += other.zz; zw += other.zw; ww += other.ww;
+                weight += other.weight;
+                return *this;
+            }
+
+            // The average squared distance from the point to the planes.
+            double error(const Vec3& p) const {
+                const double x = p[0], y = p[1], z = p[2];
+                const double sum = xx * x * x + 2 * xy * x * y + 2 * xz * x * z + 2 * xw * x
+                                 + yy * y * y + 2 * yz * y * z + 2 * yw * y
+                                 + zz * z * z + 2 * zw * z + ww;
+                return weight > 0 ? std::max(sum, 0.0) / weight : 0;
+            }
+        };
+
+        Vec3 normalize(const Vec3& v) {
+            const float length = std::sqrt(dot(v, v));
+            return length > 0 ? Vec3 { v[0] / length, v[1] / length, v[2] / length } : Vec3 {};
+        }
+
+        struct PositionKey {
+            uint32_t bits[3];
+            bool operator==(const PositionKey& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+        };
+
+        struct PositionKeyHash {
+            size_t operator()(const PositionKey& key) const {
+                const uint64_t mixed = (key.bits[0] * 0x9E3779B97F4A7C15ull) ^ (key.bits[1] * 0xC2B2AE3D27D4EB4Full) ^ (key.bits[2] * 0x165667B19E3779F9ull);
+                return static_cast<size_t>(mixed ^ (mixed >> 29));
+            }
+        };
+
+        uint64_t edgeKey(uint32_t from, uint32_t to) { return uint64_t(from) << 32 | to; }
+    }
+
+    VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+        checkIndices(indices, vertexCount);
+        if (indices.empty()) return {};
+
+        CacheSimulator cache(vertexCount, cacheSize);
+        std::vector<bool> used(vertexCount, false);
+        size_t misses = 0, unique = 0;
+        for (const uint32_t vertex : indices) {
+            misses += cache.use(vertex);
+            if (!used[vertex]) { used[vertex] = true; unique++; }
+        }
+
+        return { float(misses) / float(indices.size() / 3), float(misses) / float(unique) };
+    }
+
+    // Tipsify fans around one vertex at a time, emitting all of its remaining triangles, then moves on to whichever
+    //  vertex those just brought into the cache will still be there after its own triangles are emitted.
+    // When no such vertex exists, it falls back to recently used vertices, then to the next in input order.
+    void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+        checkIndices(indices, vertexCount);
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) return;
+
+        const Adjacency adjacency(indices, vertexCount);
+        std::vector<uint32_t> live(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++)
+            live[v] = static_cast<uint32_t>(adjacency.of(v).size());
+
+        std::vector<uint32_t> entered(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+
+        uint32_t time = cacheSize + 1;
+        uint32_t cursor = 0;
+        int64_t fan = indices[0];
+
+        while (fan >= 0) {
+            candidates.clear();
+            for (const uint32_t triangle : adjacency.of(uint32_t(fan))) {
+                if (emitted[triangle]) continue;
+                emitted[triangle] = true;
+
+                for (int corner = 0; corner < 3; corner++) {
+                    const uint32_t vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    live[vertex]--;
+                    if (time - entered[vertex] > cacheSize)
+                        entered[vertex] = time++;
+                }
+            }
+
+            // Prefer the candidate that has been in the cache longest, as long as fanning around it won't push it out.
+            fan = -1;
+            int64_t best = -1;
+            for (const uint32_t vertex : candidates) {
+                if (live[vertex] == 0) continue;
+                const uint32_t age = time - entered[vertex];
+                const int64_t priority = age + 2 * live[vertex] <= cacheSize ? age : 0;
+                if (priority > best) {
+                    best = priority;
+                    fan = vertex;
+                }
+            }
+
+            if (fan < 0) {
+                while (!deadEnds.empty() && fan < 0) {
+                    const uint32_t vertex = deadEnds.back();
+                    deadEnds.pop_back();
+                    if (live[vertex] > 0) fan = vertex;
+                }
+                while (fan < 0 && cursor < vertexCount) {
+                    if (live[cursor] > 0) fan = cursor;
+                    else cursor++;
+                }
+            }
+        }
+
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    // After Sander et al. 2007 ("Fast triangle reordering for vertex locality and reduced overdraw").
+    // The cache-optimized order is cut into clusters wherever the cache starts from cold, and those are cut again
+    //  wherever the miss ratio so far is already as good as the cluster's overall. Clusters are then drawn in order of
+    //  how far they face out from the middle of the mesh.
+    void optimizeOverdraw(std::span<uint32_t> indices, std::span<const Geo::VertexAll> vertices, float threshold, uint32_t cacheSize) {
+        checkIndices(indices, vertices.size());
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2) return;
+
+        CacheSimulator cache(vertices.size(), cacheSize);
+        const auto misses = [&](size_t triangle) {
+            return cache.use(indices[triangle * 3]) + cache.use(indices[triangle * 3 + 1]) + cache.use(indices[triangle * 3 + 2]);
+        };
+
+        // A triangle that misses on every vertex starts on a cold cache anyway, so splitting there costs nothing.
+        std::vector<size_t> hard;
+        for (size_t triangle = 0; triangle < triangleCount; triangle++)
+            if (misses(triangle) == 3) hard.push_back(triangle);
+        hard.push_back(triangleCount);
+
+        std::vector<size_t> clusters;
+        for (size_t h = 0; h + 1 < hard.size(); h++) {
+            const size_t start = hard[h], end = hard[h + 1];
+
+            cache.flush();
+            size_t clusterMisses = 0;
+            for (size_t triangle = start; triangle < end; triangle++) clusterMisses += misses(triangle);
+            const float limit = float(clusterMisses) / float(end - start) * threshold;
+
+            cache.flush();
+            clusters.push_back(start);
+            size_t runMisses = 0, runTriangles = 0;
+            for (size_t triangle = start; triangle < end; triangle++) {
+                runMisses += misses(triangle);
+                runTriangles++;
+                if (triangle + 1 < end && float(runMisses) / float(runTriangles) <= limit) {
+                    clusters.push_back(triangle + 1);
+                    cache.flush();
+                    runMisses = runTriangles = 0;
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        // Area-weighted centroid and normal of each cluster, and of the whole mesh.
+        const size_t clusterCount = clusters.size() - 1;
+        std::vector<Vec3> centroids(clusterCount, Vec3 {}), normals(clusterCount, Vec3 {});
+        std::vector<float> areas(clusterCount, 0);
+        Vec3 meshCentroid {};
+        float meshArea = 0;
+
+        for (size_t c = 0; c < clusterCount; c++) {
+            for (size_t triangle = clusters[c]; triangle < clusters[c + 1]; triangle++) {
+                const Vec3 a = position(vertices[indices[triangle * 3]]);
+                const Vec3 b = position(vertices[indices[triangle * 3 + 1]]);
+                const Vec3 p = position(vertices[indices[triangle * 3 + 2]]);
+                const Vec3 normal = cross(sub(b, a), sub(p, a));
+                const float area = std::sqrt(dot(normal, normal));
+
+                for (int axis = 0; axis < 3; axis++) {
+                    centroids[c][axis] += (a[axis] + b[axis] + p[axis]) / 3 * area;
+                    normals[c][axis] += normal[axis];
+                }
+                areas[c] += area;
+            }
+
+            for (int axis = 0; axis < 3; axis++) meshCentroid[axis] += centroids[c][axis];
+            meshArea += areas[c];
+        }
+        for (auto& axis : meshCentroid) axis = meshArea > 0 ? axis / meshArea : 0;
+
+        std::vector<float> outwards(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++) {
+            Vec3 centroid = centroids[c];
+            for (auto& axis : centroid) axis = areas[c] > 0 ? axis / areas[c] : 0;
+            const float length = std::sqrt(dot(normals[c], normals[c]));
+            outwards[c] = length > 0 ? dot(sub(centroid, meshCentroid), normals[c]) / length : 0;
+        }
+
+        std::vector<size_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return outwards[a] > outwards[b]; });
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        for (const size_t c : order)
+            output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    void optimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<Geo::VertexAll>& vertices) {
+        checkIndices(indices, vertices.size());
+
+        constexpr uint32_t unused = UINT32_MAX;
+        std::vector<uint32_t> remap(vertices.size(), unused);
+        std::vector<Geo::VertexAll> reordered;
+        reordered.reserve(vertices.size());
+
+        for (uint32_t& index : indices) {
+            if (remap[index] == unused) {
+                remap[index] = static_cast<uint32_t>(reordered.size());
+                reordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        vertices = std::move(reordered);
+    }
+
+    MeshOptimizationReport optimizeMesh(std::vector<uint32_t>& indices, std::vector<Geo::VertexAll>& vertices) {
+        MeshOptimizationReport report;
+        report.before = analyzeVertexCache(indices, vertices.size());
+
+        optimizeVertexCache(indices, vertices.size());
+        optimizeOverdraw(indices, vertices);
+        optimizeVertexFetch(indices, vertices);
+
+        report.after = analyzeVertexCache(indices, vertices.size());
+        return report;
+    }
+
+    // Vertices that share a position are collapsed together, as one point of the surface: each moves onto whichever
+    //  vertex of the destination point it shares an edge with, so the two sides of a seam keep matching.
+    // Each pass picks the cheapest destination for every point that may move, then applies the cheapest of those that
+    //  don't touch each other's triangles. Adjacency is rebuilt between passes.
+    std::vector<uint32_t> simplifyMesh(std::span<const uint32_t> indices, std::span<const Geo::VertexAll> vertices,
+                                       size_t targetIndexCount, float maxError, float* error) {
+        checkIndices(indices, vertices.size());
+        const auto vertexCount = static_cast<uint32_t>(vertices.size());
+        std::vector<uint32_t> result(indices.begin(), indices.end());
+        if (error) *error = 0;
+
+        // Each point is named by its first vertex, and lists all of its vertices.
+        std::vector<uint32_t> point(vertexCount);
+        {
+            shadowutil::FlatHashMap<PositionKey, uint32_t, PositionKeyHash> first;
+            first.reserve(vertexCount);
+            for (uint32_t v = 0; v < vertexCount; v++) {
+                PositionKey key;
+                for (int axis = 0; axis < 3; axis++)
+                    std::memcpy(&key.bits[axis], &vertices[v].position[axis], sizeof(float));
+                point[v] = first.try_emplace(key, v).first->second;
+            }
+        }
+
+        std::vector<uint32_t> memberOffsets(vertexCount + 1, 0), members(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) memberOffsets[point[v] + 1]++;
+        std::partial_sum(memberOffsets.begin(), memberOffsets.end(), memberOffsets.begin());
+        {
+            std::vector<uint32_t> fill(memberOffsets.begin(), memberOffsets.end() - 1);
+            for (uint32_t v = 0; v < vertexCount; v++) members[fill[point[v]]++] = v;
+        }
+        const auto membersOf = [&](uint32_t p) {
+            return std::span<const uint32_t>(members.data() + memberOffsets[p], memberOffsets[p + 1] - memberOffsets[p]);
+        };
+
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t i = 0; i < result.size(); i += 3) {
+            const Vec3 a = position(vertices[result[i]]), b = position(vertices[result[i + 1]]), c = position(vertices[result[i + 2]]);
+            const Vec3 normal = cross(sub(b, a), sub(c, a));
+            const float area = std::sqrt(dot(normal, normal)) / 2;
+            const Quadric plane = Quadric::plane(normalize(normal), a, area);
+            for (int corner = 0; corner < 3; corner++)
+                quadrics[point[result[i + corner]]] += plane;
+        }
+
+        enum class Kind : uint8_t {
+            Manifold,   // Moves anywhere
+            Border,     // Moves along the open border it is on
+            Seam,       // Moves along the seam it is on
+            Locked      // Stays
+        };
+
+        // Collapsing along borders and seams keeps them borders and seams, so what each point is only needs working
+        //  out once, from the directed edges between points and between vertices.
+        // An edge between points with no twin is on a border; one used twice in the same direction means the surface
+        //  is not a manifold there, which this can't reason about. An edge between vertices with no twin, whose points
+        //  do have a twin, is on a seam.
+        std::vector<Kind> kind(vertexCount, Kind::Manifold);
+        {
+            shadowutil::FlatHashMap<uint64_t, uint32_t> pointEdges, vertexEdges;
+            pointEdges.reserve(result.size());
+            vertexEdges.reserve(result.size());
+            for (size_t i = 0; i < result.size(); i += 3) {
+                for (int corner = 0; corner < 3; corner++) {
+                    const uint32_t from = result[i + corner], to = result[i + (corner + 1) % 3];
+                    pointEdges[edgeKey(point[from], point[to])]++;
+                    vertexEdges[edgeKey(from, to)]++;
+                }
+            }
+            const auto hasPointEdge = [&](uint32_t from, uint32_t to) { return pointEdges.find(edgeKey(from, to)) != pointEdges.end(); };
+
+            std::vector<uint8_t> borderEdges(vertexCount, 0), seamEdges(vertexCount, 0);
+            for (const auto& [key, count] : pointEdges) {
+                const auto from = uint32_t(key >> 32), to = uint32_t(key);
+                if (count > 1) kind[from] = kind[to] = Kind::Locked;
+                if (!hasPointEdge(to, from)) { borderEdges[from]++; borderEdges[to]++; }
+            }
+
+            shadowutil::FlatHashMap<uint64_t, bool> seams;
+            for (const auto& [key, count] : vertexEdges) {
+                const auto from = uint32_t(key >> 32), to = uint32_t(key);
+                if (vertexEdges.find(edgeKey(to, from)) == vertexEdges.end() && hasPointEdge(point[to], point[from]))
+                    seams[edgeKey(std::min(point[from], point[to]), std::max(point[from], point[to]))] = true;
+            }
+            for (const auto& [key, unused] : seams) {
+                seamEdges[uint32_t(key >> 32)]++;
+                seamEdges[uint32_t(key)]++;
+            }
+
+            // A point where borders or seams meet or end has nowhere to go that keeps them in shape.
+            for (uint32_t p = 0; p < vertexCount; p++) {
+                if (point[p] != p || kind[p] == Kind::Locked) continue;
+                const bool onBorder = borderEdges[p] > 0, onSeam = seamEdges[p] > 0 || membersOf(p).size() > 1;
+                if (onBorder && onSeam) kind[p] = Kind::Locked;
+                else if (onBorder) kind[p] = borderEdges[p] == 2 ? Kind::Border : Kind::Locked;
+                else if (onSeam) kind[p] = seamEdges[p] == 2 ? Kind::Seam : Kind::Locked;
+            }
+
+            // Borders are held in place by a steep plane through each border edge, at right angles to its triangle.
+            constexpr float borderWeight = 10;
+            for (size_t i = 0; i < result.size(); i += 3) {
+                const Vec3 a = position(vertices[result[i]]), b = position(vertices[result[i + 1]]), c = position(vertices[result[i + 2]]);
+                const Vec3 normal = cross(sub(b, a), sub(c, a));
+                for (int corner = 0; corner < 3; corner++) {
+                    const uint32_t from = point[result[i + corner]], to = point[result[i + (corner + 1) % 3]];
+                    if (hasPointEdge(to, from)) continue;
+                    const Vec3 start = position(vertices[from]);
+                    const Vec3 edge = sub(position(vertices[to]), start);
+                    const Quadric plane = Quadric::plane(normalize(cross(edge, normal)), start, dot(edge, edge) * borderWeight);
+                    quadrics[from] += plane;
+                    quadrics[to] += plane;
+                }
+            }
+        }
+
+        double worst = 0;
+        const double maxSquared = double(maxError) * maxError;
+        std::vector<uint32_t> collapse(vertexCount);
+        std::vector<uint32_t> target(vertexCount);
+        std::vector<double> cost(vertexCount);
+        std::vector<bool> touched(vertexCount);
+        std::vector<uint32_t> candidates;
+        std::vector<std::pair<double, uint32_t>> options;
+
+        while (result.size() > targetIndexCount) {
+            const Adjacency adjacency(result, vertexCount);
+
+            // Whether the current triangles have a vertex of `from` followed by one of `to`, and whether any such edge
+            //  between vertices has no twin going back.
+            struct EdgeUse { bool exists = false, untwinned = false; };
+            const auto edgeUse = [&](uint32_t from, uint32_t to) {
+                EdgeUse use;
+                for (const uint32_t vertex : membersOf(from)) {
+                    for (const uint32_t triangle : adjacency.of(vertex)) {
+                        const uint32_t* corners = &result[triangle * 3];
+                        const int corner = corners[0] == vertex ? 0 : corners[1] == vertex ? 1 : 2;
+                        const uint32_t next = corners[(corner + 1) % 3];
+                        if (point[next] != to) continue;
+
+                        use.exists = true;
+                        bool twinned = false;
+                        for (const uint32_t back : adjacency.of(next)) {
+                            const uint32_t* other = &result[back * 3];
+                            const int at = other[0] == next ? 0 : other[1] == next ? 1 : 2;
+                            if (other[(at + 1) % 3] == vertex) { twinned = true; break; }
+                        }
+                        use.untwinned |= !twinned;
+                    }
+                }
+                return use;
+            };
+            const auto isBorderEdge = [&](uint32_t a, uint32_t b) { return edgeUse(a, b).exists != edgeUse(b, a).exists; };
+            const auto isSeamEdge = [&](uint32_t a, uint32_t b) {
+                const EdgeUse forward = edgeUse(a, b), backward = edgeUse(b, a);
+                return forward.exists && backward.exists && (forward.untwinned || backward.untwinned);
+            };
+
+            // Where each vertex of `from` goes when it moves to `to`: a vertex of `to` that it shares a triangle with.
+            // Fails if some vertex of `from` has no such neighbour, since moving it would need a vertex that doesn't exist.
+            const auto mapOnto = [&](uint32_t from, uint32_t to, bool apply) {
+                for (const uint32_t vertex : membersOf(from)) {
+                    uint32_t destination = UINT32_MAX;
+                    for (const uint32_t triangle : adjacency.of(vertex)) {
+                        for (int corner = 0; corner < 3 && destination == UINT32_MAX; corner++)
+                            if (point[result[triangle * 3 + corner]] == to) destination = result[triangle * 3 + corner];
+                        if (destination != UINT32_MAX) break;
+                    }
+                    if (destination == UINT32_MAX && !adjacency.of(vertex).empty()) return false;
+                    if (apply && destination != UINT32_MAX) collapse[vertex] = destination;
+                }
+                return true;
+            };
+
+            // The cheapest move for every point that may move. Checking a move is dearer than costing it, so each
+            //  point's neighbours are costed first and checked cheapest first.
+            std::fill(target.begin(), target.end(), UINT32_MAX);
+            for (uint32_t from = 0; from < vertexCount; from++) {
+                if (point[from] != from || kind[from] == Kind::Locked) continue;
+
+                options.clear();
+                for (const uint32_t vertex : membersOf(from))
+                    for (const uint32_t triangle : adjacency.of(vertex))
+                        for (int corner = 0; corner < 3; corner++)
+                            if (const uint32_t to = point[result[triangle * 3 + corner]]; to != from)
+                                options.emplace_back(0, to);
+                std::sort(options.begin(), options.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+                options.erase(std::unique(options.begin(), options.end()), options.end());
+
+                for (auto& [moved, to] : options) {
+                    Quadric combined = quadrics[from];
+                    combined += quadrics[to];
+                    moved = combined.error(position(vertices[to]));
+                }
+                std::sort(options.begin(), options.end());
+
+                for (const auto& [moved, to] : options) {
+                    if (moved > maxSquared) break;
+                    if (kind[from] == Kind::Border && !isBorderEdge(from, to)) continue;
+                    if (kind[from] == Kind::Seam && !isSeamEdge(from, to)) continue;
+                    if (!mapOnto(from, to, false)) continue;
+                    target[from] = to;
+                    cost[from] = moved;
+                    break;
+                }
+            }
+
+            candidates.clear();
+            for (uint32_t p = 0; p < vertexCount; p++)
+                if (target[p] != UINT32_MAX) candidates.push_back(p);
+            std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) { return cost[a] < cost[b]; });
+
+            std::iota(collapse.begin(), collapse.end(), 0);
+            std::fill(touched.begin(), touched.end(), false);
+
+            // Each collapse removes about two triangles; stop once enough are gone so cheaper collapses found next
+            //  pass get their turn before dearer ones from this pass.
+            const size_t removable = (result.size() - targetIndexCount) / 3;
+            size_t removed = 0;
+            for (const uint32_t from : candidates) {
+                if (removed >= removable) break;
+                const uint32_t to = target[from];
+                if (touched[from] || touched[to]) continue;
+
+                // Moving must not turn any remaining triangle over.
+                const Vec3 destination = position(vertices[to]);
+                bool flips = false;
+                size_t dropped = 0;
+                for (const uint32_t vertex : membersOf(from)) {
+                    for (const uint32_t triangle : adjacency.of(vertex)) {
+                        const uint32_t* corners = &result[triangle * 3];
+                        if (point[corners[0]] == to || point[corners[1]] == to || point[corners[2]] == to) {
+                            dropped++;
+                            continue;
+                        }
+
+                        Vec3 before[3], after[3];
+                        for (int corner = 0; corner < 3; corner++) {
+                            before[corner] = position(vertices[corners[corner]]);
+                            after[corner] = corners[corner] == vertex ? destination : before[corner];
+                        }
+                        const Vec3 oldNormal = cross(sub(before[1], before[0]), sub(before[2], before[0]));
+                        const Vec3 newNormal = cross(sub(after[1], after[0]), sub(after[2], after[0]));
+                        if (dot(oldNormal, newNormal) <= 0) flips = true;
+                    }
+                }
+                if (flips) continue;
+
+                mapOnto(from, to, true);
+                quadrics[to] += quadrics[from];
+                worst = std::max(worst, cost[from]);
+                removed += dropped;
+                for (const uint32_t vertex : membersOf(from))
+                    for (const uint32_t triangle : adjacency.of(vertex))
+                        for (int corner = 0; corner < 3; corner++)
+                            touched[point[result[triangle * 3 + corner]]] = true;
+            }
+
+
+            size_t kept = 0;
+            for (size_t i = 0; i < result.size(); i += 3) {
+                const uint32_t a = collapse[result[i]], b = collapse[result[i + 1]], c = collapse[result[i + 2]];
+                if (point[a] == point[b] || point[b] == point[c] || point[c] == point[a]) continue;
+                result[kept++] = a;
+                result[kept++] = b;
+                result[kept++] = c;
+            }
+            result.resize(kept);
+
+            // Once a pass barely helps, what is left is close to the error limit, and each pass costs a full sweep.
+            if (removed * 100 < kept / 3) break;
+        }
+
+        if (error) *error = static_cast<float>(std::sqrt(worst));
+        return result;
+    }
+}
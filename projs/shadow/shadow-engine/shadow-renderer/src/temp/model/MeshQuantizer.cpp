@@ -0,0 +1,104 @@
+#include "temp/model/MeshQuantizer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace vlkxtemp {
+
+    namespace {
+        constexpr float unorm16 = 65535;
+        constexpr float snorm16 = 32767;
+
+        // A box with no size on an axis still needs a scale to divide by.
+        float extent(float min, float max) {
+            return max > min ? max - min : 1;
+        }
+
+        uint16_t packUnorm(float value, float min, float max) {
+            const float unit = std::clamp((value - min) / extent(min, max), 0.0f, 1.0f);
+            return static_cast<uint16_t>(std::lround(unit * unorm16));
+        }
+
+        int16_t packSnorm(float value) {
+            return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * snorm16));
+        }
+
+        // Project the unit sphere onto an octahedron, then unfold its lower half over the upper half's corners.
+        void packOctahedral(const glm::vec3& normal, int16_t* out) {
+            const float length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+            if (length == 0) {
+                out[0] = out[1] = 0;
+                return;
+            }
+
+            float x = normal[0] / length, y = normal[1] / length;
+            if (normal[2] < 0) {
+                const float foldedX = (1 - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+                const float foldedY = (1 - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+                x = foldedX;
+                y = foldedY;
+            }
+
+            out[0] = packSnorm(x);
+            out[1] = packSnorm(y);
+        }
+    }
+
+    QuantizationBounds quantizationBounds(std::span<const Geo::VertexAll> vertices) {
+        QuantizationBounds bounds {};
+        if (vertices.empty()) return bounds;
+
+        std::fill(std::begin(bounds.min), std::end(bounds.min), std::numeric_limits<float>::max());
+        std::fill(std::begin(bounds.max), std::end(bounds.max), std::numeric_limits<float>::lowest());
+        std::fill(std::begin(bounds.textureMin), std::end(bounds.textureMin), std::numeric_limits<float>::max());
+        std::fill(std::begin(bounds.textureMax), std::end(bounds.textureMax), std::numeric_limits<float>::lowest());
+        for (const auto& vertex : vertices) {
+            for (int axis = 0; axis < 3; axis++) {
+                bounds.min[axis] = std::min(bounds.min[axis], vertex.position[axis]);
+                bounds.max[axis] = std::max(bounds.max[axis], vertex.position[axis]);
+            }
+            for (int axis = 0; axis < 2; axis++) {
+                bounds.textureMin[axis] = std::min(bounds.textureMin[axis], vertex.texture[axis]);
+                bounds.textureMax[axis] = std::max(bounds.textureMax[axis], vertex.texture[axis]);
+            }
+        }
+
+        return bounds;
+    }
+
+    std::vector<Geo::VertexPacked> packVertices(std::span<const Geo::VertexAll> vertices, const QuantizationBounds& bounds) {
+        std::vector<Geo::VertexPacked> packed(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const auto& vertex = vertices[i];
+            auto& out = packed[i];
+
+            for (int axis = 0; axis < 3; axis++)
+                out.position[axis] = packUnorm(vertex.position[axis], bounds.min[axis], bounds.max[axis]);
+            out.position[3] = 0;
+            packOctahedral(vertex.normal, out.normal);
+            for (int axis = 0; axis < 2; axis++)
+                out.texture[axis] = packUnorm(vertex.texture[axis], bounds.textureMin[axis], bounds.textureMax[axis]);
+        }
+
+        return packed;
+    }
+
+    Geo::VertexPacked::Dequantization dequantization(const QuantizationBounds& bounds) {
+        return {
+            { extent(bounds.min[0], bounds.max[0]), extent(bounds.min[1], bounds.max[1]), extent(bounds.min[2], bounds.max[2]), 0 },
+            { bounds.min[0], bounds.min[1], bounds.min[2], 0 },
+            { extent(bounds.textureMin[0], bounds.textureMax[0]), extent(bounds.textureMin[1], bounds.textureMax[1]), bounds.textureMin[0], bounds.textureMin[1] }
+        };
+    }
+
+    std::vector<uint16_t> narrowIndices(std::span<const uint32_t> indices) {
+        std::vector<uint16_t> narrow(indices.size());
+        for (size_t i = 0; i < indices.size(); i++) {
+            if (indices[i] > std::numeric_limits<uint16_t>::max())
+                throw std::runtime_error("Index " + std::to_string(indices[i]) + " does not fit in 16 bits");
+            narrow[i] = static_cast<uint16_t>(indices[i]);
+        }
+        return narrow;
+    }
+}
@@ -0,0 +1,287 @@
+#include "temp/model/Meshlet.h"
+#include "temp/model/MeshOptimizer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace vlkxtemp {
+
+    namespace {
+        constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+        using Vec3 = std::array<float, 3>;
+
+        Vec3 position(const Geo::VertexAll& vertex) {
+            return { vertex.position[0], vertex.position[1], vertex.position[2] };
+        }
+
+        Vec3 add(const Vec3& a, const Vec3& b) { return { a[0] + b[0], a[1] + b[1], a[2] + b[2] }; }
+        Vec3 sub(const Vec3& a, const Vec3& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+        float dot(const Vec3& a, const Vec3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+        Vec3 cross(const Vec3& a, const Vec3& b) {
+            return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+        }
+
+        // Zero stays zero, for triangles with no area.
+        Vec3 normalize(const Vec3& v) {
+            const float length = std::sqrt(dot(v, v));
+            return length > 0 ? Vec3 { v[0] / length, v[1] / length, v[2] / length } : Vec3 {};
+        }
+
+        // For each vertex, the triangles that use it.
+        struct Adjacency {
+            Adjacency(std::span<const uint32_t> indices, size_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+                for (const uint32_t vertex : indices) offsets[vertex + 1]++;
+                std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+                std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+                for (size_t i = 0; i < indices.size(); i++)
+                    triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            std::span<const uint32_t> of(uint32_t vertex) const {
+                return { triangles.data() + offsets[vertex], offsets[vertex + 1] - offsets[vertex] };
+            }
+
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> triangles;
+        };
+
+        // Each vertex's index, or that of the first vertex at the same position. Vertices split along a normal or UV seam
+        //  weld back together, so a meshlet can grow across the seam.
+        std::vector<uint32_t> weldPositions(std::span<const Geo::VertexAll> vertices) {
+            std::vector<uint32_t> sorted(vertices.size());
+            std::iota(sorted.begin(), sorted.end(), 0);
+            const auto key = [&](uint32_t vertex) { return position(vertices[vertex]); };
+            std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) { return std::make_pair(key(a), a) < std::make_pair(key(b), b); });
+
+            std::vector<uint32_t> welded(vertices.size());
+            for (size_t i = 0; i < sorted.size(); i++)
+                welded[sorted[i]] = i > 0 && key(sorted[i]) == key(sorted[i - 1]) ? welded[sorted[i - 1]] : sorted[i];
+            return welded;
+        }
+
+        // A cone wider than this (cos 84 degrees) would hardly ever be culled, so it isn't tried at all.
+        constexpr float narrowestCone = 0.1f;
+
+        MeshletBounds meshletBounds(std::span<const uint32_t> triangles, std::span<const uint32_t> indices,
+                                    std::span<const Geo::VertexAll> vertices, std::span<const Vec3> normals) {
+            Vec3 min, max;
+            std::fill(min.begin(), min.end(), std::numeric_limits<float>::max());
+            std::fill(max.begin(), max.end(), std::numeric_limits<float>::lowest());
+            Vec3 facing {};
+            for (const uint32_t triangle : triangles) {
+                for (int corner = 0; corner < 3; corner++) {
+                    const Vec3 point = position(vertices[indices[triangle * 3 + corner]]);
+                    for (int axis = 0; axis < 3; axis++) {
+                        min[axis] = std::min(min[axis], point[axis]);
+                        max[axis] = std::max(max[axis], point[axis]);
+                    }
+                }
+                facing = add(facing, normals[triangle]);
+            }
+
+            MeshletBounds bounds {};
+            float furthest = 0;
+            for (int axis = 0; axis < 3; axis++)
+                bounds.center[axis] = (min[axis] + max[axis]) / 2;
+            const Vec3 center { bounds.center[0], bounds.center[1], bounds.center[2] };
+            for (const uint32_t triangle : triangles) {
+                for (int corner = 0; corner < 3; corner++) {
+                    const Vec3 offset = sub(position(vertices[indices[triangle * 3 + corner]]), center);
+                    furthest = std::max(furthest, dot(offset, offset));
+                }
+            }
+            bounds.radius = std::sqrt(furthest);
+
+            // The cone holds every normal; triangles with no area face nowhere and don't widen it.
+            const Vec3 axis = normalize(facing);
+            float closest = 1;
+            for (const uint32_t triangle : triangles)
+                if (dot(normals[triangle], normals[triangle]) > 0)
+                    closest = std::min(closest, dot(axis, normals[triangle]));
+
+            std::copy(axis.begin(), axis.end(), bounds.coneAxis);
+            bounds.coneCutoff = dot(axis, axis) > 0 && closest > narrowestCone ? std::sqrt(1 - closest * closest) : 1;
+            return bounds;
+        }
+    }
+
+    std::vector<Meshlet> buildMeshlets(std::span<uint32_t> indices, std::span<const Geo::VertexAll> vertices, const MeshletSettings& settings) {
+        if (indices.size() % 3 != 0)
+            throw std::runtime_error("Mesh indices are not a list of triangles");
+        for (const uint32_t vertex : indices)
+            if (vertex >= vertices.size())
+                throw std::runtime_error("Mesh index " + std::to_string(vertex) + " is out of range");
+        if (settings.maxVertices < 3 || settings.maxTriangles == 0)
+            throw std::runtime_error("Meshlets must have room for at least one triangle");
+
+        const size_t triangleCount = indices.size() / 3;
+        const std::vector<uint32_t> welded = weldPositions(vertices);
+        std::vector<uint32_t> weldedIndices(indices.size());
+        std::transform(indices.begin(), indices.end(), weldedIndices.begin(), [&](uint32_t vertex) { return welded[vertex]; });
+        const Adjacency adjacency(weldedIndices, vertices.size());
+
+        std::vector<Vec3> normals(triangleCount), centroids(triangleCount);
+        for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+            const Vec3 a = position(vertices[indices[triangle * 3]]);
+            const Vec3 b = position(vertices[indices[triangle * 3 + 1]]);
+            const Vec3 c = position(vertices[indices[triangle * 3 + 2]]);
+            normals[triangle] = normalize(cross(sub(b, a), sub(c, a)));
+            const Vec3 sum = add(add(a, b), c);
+            centroids[triangle] = { sum[0] / 3, sum[1] / 3, sum[2] / 3 };
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> owner(vertices.size(), none);     // The last meshlet each vertex was added to
+        std::vector<uint32_t> order;                            // Triangles, one meshlet after another
+        std::vector<uint32_t> candidates;                       // Triangles touching the meshlet; may repeat
+        std::vector<Meshlet> meshlets;
+        order.reserve(triangleCount);
+        size_t scan = 0;
+
+        // The next triangle in the original order, which is already local after optimizing for the vertex cache.
+        const auto nextInOrder = [&]() {
+            while (scan < triangleCount && emitted[scan]) scan++;
+            return scan < triangleCount ? static_cast<uint32_t>(scan) : none;
+        };
+
+        while (order.size() < triangleCount) {
+            const auto id = static_cast<uint32_t>(meshlets.size());
+            const size_t first = order.size();
+            uint32_t vertexCount = 0;
+            Vec3 facing {}, middle {};
+
+            // Seed from where the last meshlet stopped growing, so neighbouring meshlets stay near each other.
+            uint32_t next = none;
+            for (const uint32_t triangle : candidates) {
+                if (!emitted[triangle]) {
+                    next = triangle;
+                    break;
+                }
+            }
+            if (next == none) next = nextInOrder();
+            candidates.clear();
+
+            while (next != none) {
+                emitted[next] = true;
+                order.push_back(next);
+                for (int corner = 0; corner < 3; corner++) {
+                    const uint32_t vertex = indices[next * 3 + corner];
+                    if (owner[vertex] == id) continue;
+                    owner[vertex] = id;
+                    vertexCount++;
+                    for (const uint32_t neighbour : adjacency.of(weldedIndices[next * 3 + corner]))
+                        if (!emitted[neighbour]) candidates.push_back(neighbour);
+                }
+                facing = add(facing, normals[next]);
+                middle = add(middle, centroids[next]);
+                if (order.size() - first == settings.maxTriangles) break;
+
+                // The neighbour that adds the fewest vertices. Ties go to the nearest, counting those that face away
+                //  from the meshlet as up to twice as far, so meshlets stay round and their cones narrow.
+                const Vec3 axis = normalize(facing);
+                const float triangles = static_cast<float>(order.size() - first);
+                const Vec3 centre { middle[0] / triangles, middle[1] / triangles, middle[2] / triangles };
+                next = none;
+                uint32_t fewest = 4;
+                float nearest = std::numeric_limits<float>::max();
+                size_t kept = 0;
+                for (const uint32_t triangle : candidates) {
+                    if (emitted[triangle]) continue;
+                    candidates[kept++] = triangle;
+
+                    uint32_t added = 0;
+                    for (int corner = 0; corner < 3; corner++)
+                        added += owner[indices[triangle * 3 + corner]] != id;
+                    if (vertexCount + added > settings.maxVertices) continue;
+
+                    const Vec3 offset = sub(centroids[triangle], centre);
+                    const float distance = std::sqrt(dot(offset, offset)) * (1.5f - dot(normals[triangle], axis) / 2);
+                    if (added < fewest || (added == fewest && distance < nearest)) {
+                        next = triangle;
+                        fewest = added;
+                        nearest = distance;
+                    }
+                }
+                candidates.resize(kept);
+
+                // Once its neighbours are used up, a meshlet with room left takes disconnected triangles rather than ending small.
+                if (next == none && vertexCount + 3 <= settings.maxVertices)
+                    next = nextInOrder();
+            }
+
+            const std::span<const uint32_t> triangles(order.data() + first, order.size() - first);
+            meshlets.push_back({ static_cast<uint32_t>(first * 3), static_cast<uint32_t>(triangles.size() * 3), meshletBounds(triangles, indices, vertices, normals) });
+        }
+
+        // The input is expected in optimizeMesh's order, which draws outward-facing clusters first. Meshlets keep
+        //  that order by drawing in the order of their earliest triangle.
+        std::vector<uint32_t> earliest(meshlets.size()), sorted(meshlets.size());
+        for (size_t i = 0; i < meshlets.size(); i++) {
+            const auto begin = order.begin() + meshlets[i].firstIndex / 3;
+            earliest[i] = *std::min_element(begin, begin + meshlets[i].indexCount / 3);
+        }
+        std::iota(sorted.begin(), sorted.end(), 0);
+        std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) { return earliest[a] < earliest[b]; });
+
+        const std::vector<uint32_t> original(indices.begin(), indices.end());
+        std::vector<Meshlet> reordered;
+        reordered.reserve(meshlets.size());
+        std::vector<uint32_t> local(vertices.size(), none), global;
+        size_t written = 0;
+        for (const uint32_t i : sorted) {
+            const auto& meshlet = meshlets[i];
+            const auto out = indices.subspan(written, meshlet.indexCount);
+            for (uint32_t j = 0; j < meshlet.indexCount / 3; j++)
+                std::copy_n(original.begin() + order[meshlet.firstIndex / 3 + j] * 3, 3, out.begin() + j * 3);
+
+            // Growing a meshlet scatters the cache order it was built from, so each is reordered again. The meshlet is
+            //  numbered from 0 while that runs, so it costs no more than the meshlet's own size.
+            global.clear();
+            for (uint32_t& vertex : out) {
+                if (local[vertex] == none) {
+                    local[vertex] = static_cast<uint32_t>(global.size());
+                    global.push_back(vertex);
+                }
+                vertex = local[vertex];
+            }
+            optimizeVertexCache(out, global.size());
+            for (uint32_t& vertex : out) vertex = global[vertex];
+            for (const uint32_t vertex : global) local[vertex] = none;
+
+            reordered.push_back({ static_cast<uint32_t>(written), meshlet.indexCount, meshlet.bounds });
+            written += meshlet.indexCount;
+        }
+
+        return reordered;
+    }
+
+    void cullMeshlets(std::span<const Meshlet> meshlets, const MeshletView& view, std::vector<uint32_t>* visible) {
+        const Vec3 eye { view.eye[0], view.eye[1], view.eye[2] };
+
+        for (size_t i = 0; i < meshlets.size(); i++) {
+            const auto& bounds = meshlets[i].bounds;
+            const Vec3 center { bounds.center[0], bounds.center[1], bounds.center[2] };
+
+            const bool outside = std::any_of(std::begin(view.planes), std::end(view.planes), [&](const float* plane) {
+                return plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3] < -bounds.radius;
+            });
+            if (outside) continue;
+
+            // Every triangle faces away if the eye sits inside the cone's mirror image, however far the sphere reaches
+            //  towards it (from meshoptimizer's meshopt_computeClusterBounds).
+            if (view.cones) {
+                const Vec3 toCenter = sub(center, eye);
+                const Vec3 axis { bounds.coneAxis[0], bounds.coneAxis[1], bounds.coneAxis[2] };
+                if (dot(toCenter, axis) >= bounds.coneCutoff * std::sqrt(dot(toCenter, toCenter)) + bounds.radius) continue;
+            }
+
+            visible->push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
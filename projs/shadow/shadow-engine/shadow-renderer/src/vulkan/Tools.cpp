@@ -1,6 +1,7 @@
 #include <vlkx/vulkan/Tools.h>
 #include <string>
 #include "vlkx/vulkan/abstraction/Commands.h"
+#include <shadow/util/FlightRecorder.h>
 
 API VmaAllocator VkTools::allocator;
 
@@ -87,6 +88,7 @@ VkTools::ManagedBuffer VkTools::createGPUBuffer(VkDeviceSize size, VkBufferUsage
     if (VkResult status = vmaCreateBuffer(allocator, &bufferInfo, &vmaInfo, &buffer.buffer, &buffer.allocation, nullptr); status != VK_SUCCESS)
         throw std::runtime_error("Unable to create GPU buffer: " + std::to_string(status));
 
+    shadowutil::FlightRecorder::recordAllocation("GPU Buffer", size);
     return buffer;
 }
 
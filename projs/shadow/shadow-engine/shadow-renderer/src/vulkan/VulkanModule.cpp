@@ -10,6 +10,8 @@
 #include "core/SDL2Module.h"
 #include "vlkx/render/render_pass/ScreenRenderPass.h"
 #include <vlkx/vulkan/SwapChain.h>
+#include "vlkx/vulkan/abstraction/Image.h"
+#include "vlkx/render/shader/Pipeline.h"
 
 #define CATCH(x) \
     try { x } catch (std::exception& e) { spdlog::error(e.what()); exit(0); }
@@ -89,6 +91,11 @@ void VulkanModule::PreInit() {
 
     CATCH(initVulkan(sdl2module->_window->sdlWindowPtr);)
 
+    // Keep recently used textures and shaders loaded after they're released, so that reloading a level
+    //  (or switching to one that shares assets) doesn't have to upload them again.
+    shadowutil::RefCounter<vlkx::TextureImage>::setRetentionBudget(256 * 1024 * 1024);
+    shadowutil::RefCounter<vlkx::ShaderModule>::setRetentionBudget(4 * 1024 * 1024);
+
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
@@ -252,6 +259,10 @@ void VulkanModule::LateRender(VkCommandBuffer& commands, int frame) {
 }
 
 void VulkanModule::Destroy() {
+    // Anything still cached has to go before the device does.
+    shadowutil::RefCounter<vlkx::TextureImage>::setRetentionBudget(0);
+    shadowutil::RefCounter<vlkx::ShaderModule>::setRetentionBudget(0);
+
     ImGui_ImplVulkan_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
@@ -18,6 +18,20 @@ namespace vlkx {
         vmaUnmapMemory(VulkanModule::getInstance()->getAllocator(), buffer.allocation);
     }
 
+    VkIndexType getIndexType(const PerVertexBuffer::VertexDataMeta& indices) {
+        switch (indices.sizePerUnit) {
+            case sizeof(uint16_t): return VK_INDEX_TYPE_UINT16;
+            case sizeof(uint32_t): return VK_INDEX_TYPE_UINT32;
+            default: throw std::runtime_error("Indices of " + std::to_string(indices.sizePerUnit) + " bytes are not supported");
+        }
+    }
+
+    // Index buffers must start on a multiple of their index size, and attributes read best from aligned vertices.
+    // Once 16-bit indices are in the mix, the sizes before them are no longer multiples of either.
+    VkDeviceSize alignVertexOffset(VkDeviceSize offset) {
+        return (offset + 15) & ~VkDeviceSize(15);
+    }
+
     StagingBuffer::StagingBuffer(const vlkx::Buffer::BulkCopyMeta &copyMeta) : dataSize(copyMeta.length) {
         setBuffer(VkTools::createGPUBuffer(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VulkanModule::getInstance()->getDevice()->logical, VulkanModule::getInstance()->getDevice()->physical));
 
@@ -34,7 +48,7 @@ namespace vlkx {
 
         for (const auto& attr : attributes) {
             descs.push_back(VkVertexInputAttributeDescription {
-                start++, 0, attr.format, attr.offset
+                start++, attr.binding, attr.format, attr.offset
             });
         }
 
@@ -98,13 +112,15 @@ namespace vlkx {
         auto& meshInfos = buffer->meshDataInfo.emplace<MeshDataIndex>().info;
         meshInfos.reserve(meshes);
 
-        VkDeviceSize offset = sharedIndices.sizePerMesh;
+        const VkIndexType indexType = getIndexType(sharedIndices);
+        const VkDeviceSize verticesStart = alignVertexOffset(sharedIndices.sizePerMesh);
+        VkDeviceSize offset = verticesStart;
         for (int i = 0; i < meshes; ++i) {
-            meshInfos.push_back(MeshDataIndex::Info { static_cast<uint32_t>(sharedIndices.unitsPerMesh), 0, offset });
+            meshInfos.push_back(MeshDataIndex::Info { { { 0, static_cast<uint32_t>(sharedIndices.unitsPerMesh) } }, indexType, 0, { offset }, {} });
             offset += perMeshVertex.sizePerMesh;
         }
 
-        return Buffer::BulkCopyMeta { offset, { { sharedIndices.data, sharedIndices.sizePerMesh, 0 }, { perMeshVertex.data, perMeshVertex.sizePerMesh * meshes, sharedIndices.sizePerMesh } } };
+        return Buffer::BulkCopyMeta { offset, { { sharedIndices.data, sharedIndices.sizePerMesh, 0 }, { perMeshVertex.data, perMeshVertex.sizePerMesh * meshes, verticesStart } } };
     }
 
 
@@ -117,33 +133,77 @@ namespace vlkx {
 
         VkDeviceSize offset = 0;
         for (const auto& meta : perMeshMeta) {
-            const size_t indicesSize = meta.indices.sizePerMesh;
-            const size_t verticesSize = meta.vertices.sizePerMesh;
-            const VkDeviceSize verticesOffset = offset + indicesSize;
-
-            meshInfos.push_back(MeshDataIndex::Info { static_cast<uint32_t>(meta.indices.unitsPerMesh), offset, verticesOffset });
-            copyMetas.push_back(Buffer::CopyMeta { meta.indices.data, indicesSize, offset });
-            copyMetas.push_back(Buffer::CopyMeta { meta.vertices.data, verticesSize, verticesOffset });
-
-            offset += indicesSize + verticesSize;
+            auto ranges = meta.ranges.empty() ? std::vector<IndexRange> { { 0, static_cast<uint32_t>(meta.indices.unitsPerMesh) } } : meta.ranges;
+            auto& info = meshInfos.emplace_back(MeshDataIndex::Info { std::move(ranges), getIndexType(meta.indices), offset, {}, meta.clusters });
+            copyMetas.push_back(Buffer::CopyMeta { meta.indices.data, meta.indices.sizePerMesh, offset });
+            offset += meta.indices.sizePerMesh;
+
+            // Each stream after the indices is laid out one after the other.
+            info.vertexStarts.reserve(meta.streams.size() + 1);
+            const auto addStream = [&](const VertexDataMeta& stream) {
+                offset = alignVertexOffset(offset);
+                info.vertexStarts.push_back(offset);
+                copyMetas.push_back(Buffer::CopyMeta { stream.data, stream.sizePerMesh, offset });
+                offset += stream.sizePerMesh;
+            };
+            addStream(meta.vertices);
+            for (const auto& stream : meta.streams)
+                addStream(stream);
+
+            offset = alignVertexOffset(offset);
         }
 
         return Buffer::BulkCopyMeta { offset, std::move(copyMetas) };
     }
 
-    void PerVertexBuffer::draw(const VkCommandBuffer &commands, uint32_t bind, int index, uint32_t instances) const {
+    void PerVertexBuffer::draw(const VkCommandBuffer &commands, uint32_t bind, int index, uint32_t instances, size_t range, uint32_t firstInstance) const {
         if (const auto* meshNoIndex = std::get_if<MeshDataNoIndex>(&meshDataInfo); meshNoIndex != nullptr) {
             const auto& meshInfo = meshNoIndex->info[index];
             vkCmdBindVertexBuffers(commands, bind, 1, &getBuffer(), &meshInfo.vertexStart);
-            vkCmdDraw(commands, meshInfo.vertexCount, instances, 0, 0);
+            vkCmdDraw(commands, meshInfo.vertexCount, instances, 0, firstInstance);
         } else if (const auto* meshIndex = std::get_if<MeshDataIndex>(&meshDataInfo); meshIndex != nullptr) {
             const auto& meshInfo = meshIndex->info[index];
-            vkCmdBindIndexBuffer(commands, getBuffer(), meshInfo.indexStart, VK_INDEX_TYPE_UINT32);
-            vkCmdBindVertexBuffers(commands, bind, 1, &getBuffer(), &meshInfo.vertexStart);
-            vkCmdDrawIndexed(commands, meshInfo.indexCount, instances, 0, 0, 0);
+            const auto& indices = meshInfo.ranges[range];
+            bindIndexed(commands, bind, meshInfo);
+            vkCmdDrawIndexed(commands, indices.count, instances, indices.first, 0, firstInstance);
         }
     }
 
+    void PerVertexBuffer::drawClusters(const VkCommandBuffer &commands, uint32_t bind, int index, uint32_t instances, std::span<const uint32_t> clusters, uint32_t firstInstance) const {
+        const auto* meshIndex = std::get_if<MeshDataIndex>(&meshDataInfo);
+        if (meshIndex == nullptr)
+            throw std::runtime_error("Only indexed meshes have clusters");
+        if (clusters.empty()) return;
+
+        const auto& meshInfo = meshIndex->info[index];
+        bindIndexed(commands, bind, meshInfo);
+        for (size_t i = 0; i < clusters.size();) {
+            const uint32_t first = meshInfo.clusters[clusters[i]].first;
+            uint32_t end = first + meshInfo.clusters[clusters[i]].count;
+            for (i++; i < clusters.size() && meshInfo.clusters[clusters[i]].first == end; i++)
+                end += meshInfo.clusters[clusters[i]].count;
+            vkCmdDrawIndexed(commands, end - first, instances, first, 0, firstInstance);
+        }
+    }
+
+    void PerVertexBuffer::bindIndexed(const VkCommandBuffer &commands, uint32_t bind, const MeshDataIndex::Info &meshInfo) const {
+        vkCmdBindIndexBuffer(commands, getBuffer(), meshInfo.indexStart, meshInfo.indexType);
+        for (size_t stream = 0; stream < meshInfo.vertexStarts.size(); stream++)
+            vkCmdBindVertexBuffers(commands, bind + stream, 1, &getBuffer(), &meshInfo.vertexStarts[stream]);
+    }
+
+    size_t PerVertexBuffer::rangeCount(int index) const {
+        if (const auto* meshIndex = std::get_if<MeshDataIndex>(&meshDataInfo); meshIndex != nullptr)
+            return meshIndex->info[index].ranges.size();
+        return 1;
+    }
+
+    size_t PerVertexBuffer::streamCount(int index) const {
+        if (const auto* meshIndex = std::get_if<MeshDataIndex>(&meshDataInfo); meshIndex != nullptr)
+            return meshIndex->info[index].vertexStarts.size();
+        return 1;
+    }
+
     StaticPerVertexBuffer::StaticPerVertexBuffer(const vlkx::PerVertexBuffer::BufferDataMeta &info,
                                                  std::vector<VkVertexInputAttributeDescription> &&attrs) : PerVertexBuffer(std::move(attrs)) {
         const BulkCopyMeta copy = info.prepareCopy(this);
@@ -1,7 +1,6 @@
 #include "vlkx/vulkan/abstraction/Descriptor.h"
 #include <vulkan/vulkan.h>
 #include <vector>
-#include <map>
 
 using namespace vlkx;
 // Returns 'pointer', assuming 'ExpectedType' and 'ActualType' are the same.
@@ -16,8 +15,9 @@ inline const ExpectedType* getPtr(const ActualType* pointer, std::false_type) {
     return nullptr;
 }
 
-template <typename ExpectedType, typename ValueType>
-const ExpectedType* getPointer(const std::vector<ValueType>& container) {
+template <typename ExpectedType, typename Container>
+const ExpectedType* getPointer(const Container& container) {
+    using ValueType = typename Container::value_type;
     return getPtr<ExpectedType, ValueType>(container.data(), std::is_same<ExpectedType, ValueType>());
 }
 
@@ -85,8 +85,8 @@ VkDescriptorSet allocateSet(const VkDescriptorPool& pool, const VkDescriptorSetL
     return set;
 }
 
-template <typename Type>
-std::vector<VkWriteDescriptorSet> createWrites(const VkDescriptorSet& set, VkDescriptorType type, const std::map<uint32_t, std::vector<Type>>& map) {
+template <typename InfoMap>
+std::vector<VkWriteDescriptorSet> createWrites(const VkDescriptorSet& set, VkDescriptorType type, const InfoMap& map) {
 
     std::vector<VkWriteDescriptorSet> sets;
     sets.reserve(map.size());
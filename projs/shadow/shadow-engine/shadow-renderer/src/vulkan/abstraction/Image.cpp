@@ -6,7 +6,12 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "vlkx/vulkan/VulkanModule.h"
+#include "shadow/util/AsyncIO.h"
+#include "shadow/util/Compression.h"
 #include "shadow/util/File.h"
+#include "shadow/util/Json.h"
+#include "shadow/util/VFS.h"
+#include "shadow/util/FlightRecorder.h"
 
 namespace vlkx {
     struct ImageConfig {
@@ -29,14 +34,21 @@ namespace vlkx {
 
     struct ImageData {
         ImageDescriptor::Dimension dimensions;
-        const char* data;
+        std::shared_ptr<const char> data;
     };
 
-    ImageData loadImage(const std::string& path, int wantedChannels) {
-        shadowutil::FileData* data = shadowutil::loadFile(path);
+    // A buffer for pixels that the engine decodes or copies itself.
+    std::shared_ptr<char> allocatePixels(size_t size) {
+        return std::shared_ptr<char>(new char[size], std::default_delete<char[]>());
+    }
+
+    // Decode an image file (PNG, JPG, etc) that is already in memory.
+    ImageData decodeImage(std::span<const std::byte> encoded, const std::string& path, int wantedChannels) {
+        const auto* bytes = reinterpret_cast<const stbi_uc *>(encoded.data());
+        const int size = static_cast<int>(encoded.size());
         int width, height, channels;
 
-        stbi_uc* stbData = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(data->data.data()), data->size, &width, &height, &channels, wantedChannels);
+        stbi_uc* stbData = stbi_load_from_memory(bytes, size, &width, &height, &channels, wantedChannels);
         if (stbData == nullptr)
             throw std::runtime_error("Unable to read image file " + std::string(path));
 
@@ -47,15 +59,131 @@ namespace vlkx {
 
             case 3: {
                 stbi_image_free(stbData);
-                stbData = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(data->data.data()), data->size, &width, &height, &channels, STBI_rgb_alpha);
+                stbData = stbi_load_from_memory(bytes, size, &width, &height, &channels, STBI_rgb_alpha);
+                if (stbData == nullptr)
+                    throw std::runtime_error("Unable to read image file " + std::string(path));
+                // stb reports the channels in the file, not the ones it expanded to.
+                channels = 4;
                 break;
             }
 
             default:
+                stbi_image_free(stbData);
                 throw std::runtime_error("Trying to load image with unsupported number of channels: " + std::to_string(channels));
         }
 
-        return {{ static_cast<uint32_t>(width), static_cast<uint32_t>(height), static_cast<uint32_t>(channels) },reinterpret_cast<const char *>(stbData) };
+        const std::shared_ptr<const char> pixels(reinterpret_cast<const char*>(stbData), [](const char* data) { stbi_image_free(const_cast<char*>(data)); });
+        return {{ static_cast<uint32_t>(width), static_cast<uint32_t>(height), static_cast<uint32_t>(channels) }, pixels };
+    }
+
+    ImageData loadImage(const std::string& path, int wantedChannels) {
+        const shadowutil::MappedFile file = shadowutil::loadFile(path);
+        return decodeImage(file.data(), path, wantedChannels);
+    }
+
+    // Read several whole files through AsyncIO in one batch, so that they are all in flight at once.
+    // This still blocks until every one is read: the cubemap cannot be built from some of its faces.
+    std::vector<std::vector<std::byte>> readFiles(const std::vector<std::string>& paths) {
+        std::vector<std::vector<std::byte>> contents(paths.size());
+        std::vector<shadowutil::AsyncIO::Request> requests(paths.size());
+        for (size_t i = 0; i < paths.size(); i++) {
+            contents[i].resize(shadowutil::AsyncIO::fileSize(paths[i]));
+            requests[i].path = paths[i];
+            requests[i].into = contents[i];
+        }
+
+        const auto tickets = shadowutil::AsyncIO::get().read(std::move(requests));
+        // Wait for all of them before checking any, so that nothing is still reading into the buffers if one failed.
+        for (const auto& ticket : tickets)
+            ticket.wait();
+
+        for (size_t i = 0; i < paths.size(); i++) {
+            const auto& result = tickets[i].wait();
+            if (result.status != shadowutil::AsyncIO::Status::Complete)
+                throw std::runtime_error("Unable to read image file " + paths[i] + ": " + result.error);
+            contents[i].resize(result.bytes);
+        }
+        return contents;
+    }
+
+    // Read an image out of the VFS.
+    // Textures cooked into a package (VTEX entries) are already raw RGBA. Uncompressed ones are copied out of the package,
+    //  so that the image does not depend on it staying mounted; block compressed ones are decoded across the thread
+    //  pool, straight into the buffer that is returned.
+    // Anything else is decoded like a file on disk.
+    ImageData loadImageFromVFS(const std::string& path, int wantedChannels, bool flipY) {
+        const shadowutil::VFS::File file = shadowutil::VFS::get().open(path);
+        if (file.type != "VTEX")
+            return decodeImage(file.data, path, wantedChannels);
+
+        if (file.version != 1)
+            throw std::runtime_error("Texture " + path + " has unsupported version " + std::to_string(file.version));
+
+        const auto meta = shadowutil::JsonValue::parse(file.metadata);
+        const auto compression = static_cast<shadowutil::Compression>(meta.getInt("compression", 1));
+        const auto format = meta.getInt("format", 1);
+        if (format != 1)
+            throw std::runtime_error("Texture " + path + " uses an unsupported format");
+
+        const ImageDescriptor::Dimension dimensions { static_cast<uint32_t>(meta["width"].asInt()), static_cast<uint32_t>(meta["height"].asInt()), 4 };
+        const size_t row = dimensions.width * 4;
+
+        switch (compression) {
+            case shadowutil::Compression::None: {
+                if (dimensions.getSize() > file.data.size())
+                    throw std::runtime_error("Texture " + path + " is smaller than its dimensions");
+
+                const char* source = reinterpret_cast<const char*>(file.data.data());
+                auto pixels = allocatePixels(dimensions.getSize());
+                if (!flipY) {
+                    memcpy(pixels.get(), source, dimensions.getSize());
+                } else {
+                    for (size_t y = 0; y < dimensions.height; y++)
+                        memcpy(pixels.get() + y * row, source + (dimensions.height - 1 - y) * row, row);
+                }
+                return { dimensions, pixels };
+            }
+
+            case shadowutil::Compression::Blocks: {
+                if (shadowutil::decompressedSize(file.data) != dimensions.getSize())
+                    throw std::runtime_error("Texture " + path + " does not decompress to its dimensions");
+
+                auto pixels = allocatePixels(dimensions.getSize());
+                shadowutil::decompressBlocks(file.data, std::as_writable_bytes(std::span(pixels.get(), dimensions.getSize())));
+                if (flipY) {
+                    std::vector<char> swap(row);
+                    for (size_t y = 0; y < dimensions.height / 2; y++) {
+                        char* top = pixels.get() + y * row;
+                        char* bottom = pixels.get() + (dimensions.height - 1 - y) * row;
+                        memcpy(swap.data(), top, row);
+                        memcpy(top, bottom, row);
+                        memcpy(bottom, swap.data(), row);
+                    }
+                }
+                return { dimensions, pixels };
+            }
+
+            default:
+                throw std::runtime_error("Texture " + path + " uses unsupported compression " + std::to_string(static_cast<uint32_t>(compression)));
+        }
+    }
+
+    // Load the six faces of a cubemap into one buffer, with the given loader, which takes each face's index and path.
+    template<typename Loader>
+    ImageDescriptor loadCube(const std::string& directory, const std::array<std::string, 6>& files, Loader&& load) {
+        auto firstImage = load(0, directory + "/" + files[0]);
+        const ImageDescriptor::Dimension& dim = firstImage.dimensions;
+        auto data = allocatePixels(dim.getSize() * 6);
+        memcpy(data.get(), firstImage.data.get(), dim.getSize());
+        for (size_t i = 1; i < 6; i++) {
+            auto image = load(i, directory + "/" + files[i]);
+            if (!(image.dimensions.width == dim.width && image.dimensions.height == dim.height && image.dimensions.channels == dim.channels))
+                throw std::runtime_error("Image " + std::to_string(i) + "(" + directory + "/" + files[i] + ") has different dimensions from the first image.");
+
+            memcpy(data.get() + i * dim.getSize(), image.data.get(), dim.getSize());
+        }
+
+        return { ImageDescriptor::Type::Cubemap, firstImage.dimensions, data };
     }
 
     std::optional<VkFormat> findFormatWith(const std::vector<VkFormat>& formats, VkFormatFeatureFlags feature) {
@@ -117,21 +245,15 @@ namespace vlkx {
 
     ImageDescriptor Image::loadCubeFromDisk(const std::string& directory, const std::array<std::string, 6> &files,
                                             bool flipY) {
-        stbi_set_flip_vertically_on_load(flipY);
-        auto firstImage = loadImage(directory + "/" + files[0], STBI_default);
-        const ImageDescriptor::Dimension& dim = firstImage.dimensions;
-        char* data = new char[dim.getSize() * 6]; // TODO: Figure out how to make this delete
-        memcpy(data, firstImage.data, dim.getSize());
-        for (size_t i = 1; i < 6; i++) {
-            auto image = loadImage(directory + "/" + files[1], STBI_default);
-            if (!(image.dimensions.width == dim.width && image.dimensions.height == dim.height && image.dimensions.channels == dim.channels))
-                throw std::runtime_error("Image " + std::to_string(i) + "(" + directory + "/" + files[i] + ") has different dimensions from the first image.");
-
-            memcpy(data + i * dim.getSize(), image.data, dim.getSize());
-        }
+        std::vector<std::string> paths;
+        for (const auto& file : files)
+            paths.push_back(directory + "/" + file);
+        const auto encoded = readFiles(paths);
 
+        stbi_set_flip_vertically_on_load(flipY);
+        auto cube = loadCube(directory, files, [&](size_t face, const std::string& path) { return decodeImage(encoded[face], path, STBI_default); });
         stbi_set_flip_vertically_on_load(false);
-        return { ImageDescriptor::Type::Cubemap, firstImage.dimensions, data };
+        return cube;
     }
 
     ImageDescriptor Image::loadSingleFromDisk(std::string path, bool flipY) {
@@ -139,7 +261,22 @@ namespace vlkx {
         auto image = loadImage(std::move(path), STBI_default);
         stbi_set_flip_vertically_on_load(false);
 
-        return { ImageDescriptor::Type::Single, image.dimensions, image.data };
+        return { ImageDescriptor::Type::Single, image.dimensions, std::move(image.data) };
+    }
+
+    ImageDescriptor Image::loadSingleFromVFS(std::string path, bool flipY) {
+        stbi_set_flip_vertically_on_load(flipY);
+        auto image = loadImageFromVFS(path, STBI_default, flipY);
+        stbi_set_flip_vertically_on_load(false);
+
+        return { ImageDescriptor::Type::Single, image.dimensions, std::move(image.data) };
+    }
+
+    ImageDescriptor Image::loadCubeFromVFS(std::string directory, const std::array<std::string, 6>& files, bool flipY) {
+        stbi_set_flip_vertically_on_load(flipY);
+        auto cube = loadCube(directory, files, [flipY](size_t, const std::string& path) { return loadImageFromVFS(path, STBI_default, flipY); });
+        stbi_set_flip_vertically_on_load(false);
+        return cube;
     }
 
     TextureImage::Meta createTextureMeta(const ImageDescriptor& image, const std::vector<ImageUsage>& usages) {
@@ -170,8 +307,10 @@ namespace vlkx {
         allocateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 
         // Allocate + create the image
-        vmaCreateImage(VulkanModule::getInstance()->getAllocator(), &info, &allocateInfo, &image.image, &image.allocation, nullptr);
+        VmaAllocationInfo allocation {};
+        vmaCreateImage(VulkanModule::getInstance()->getAllocator(), &info, &allocateInfo, &image.image, &image.allocation, &allocation);
 
+        shadowutil::FlightRecorder::recordAllocation("GPU Image", allocation.size);
         return image;
     }
 
@@ -309,6 +448,12 @@ namespace vlkx {
         : TextureImage(mipmapping, config, createTextureMeta(image, usages))
     {}
 
+    size_t TextureImage::memorySize() const {
+        VmaAllocationInfo info {};
+        vmaGetAllocationInfo(VulkanModule::getInstance()->getAllocator(), buffer.get().allocation, &info);
+        return info.size;
+    }
+
     TextureImage::TextureBuffer::TextureBuffer(bool mipmaps, const vlkx::TextureImage::Meta &meta) : ImageBuffer() {
         const VkExtent3D extent = expandExtent(meta.getExtent());
         const auto layers = meta.data.size();
@@ -350,21 +495,24 @@ namespace vlkx {
     }
 
     RefCountedTexture::ReferenceCounter RefCountedTexture::get(const vlkx::RefCountedTexture::ImageLocation &location, const std::vector<ImageUsage>& usages, const ImageSampler::Config &config) {
-        bool mips;
-        const std::string* ident;
-        std::unique_ptr<ImageDescriptor> image;
-
         if (const auto* singleTex = std::get_if<std::string>(&location); singleTex != nullptr) {
-            mips = true;
-            ident = singleTex;
-            image = std::make_unique<ImageDescriptor>(Image::loadSingleFromDisk(*singleTex, false));
-        } else if (const auto* cubeTex = std::get_if<CubemapLocation>(&location); cubeTex != nullptr) {
-            mips = false;
-            ident = &cubeTex->directory;
-            image = std::make_unique<ImageDescriptor>(Image::loadCubeFromDisk(cubeTex->directory, cubeTex->files, false));
+            // Only read the file if the texture isn't already loaded.
+            return ReferenceCounter::getOrCreate(*singleTex, [&]() {
+                // Mounted assets take precedence over loose files in the working directory.
+                const ImageDescriptor image = shadowutil::VFS::get().exists(*singleTex)
+                        ? Image::loadSingleFromVFS(*singleTex, false)
+                        : Image::loadSingleFromDisk(*singleTex, false);
+                return std::make_unique<TextureImage>(true, image, usages, config);
+            });
         }
 
-        return ReferenceCounter::get(*ident, mips, config, createTextureMeta(*image, usages));
+        const auto& cubeTex = std::get<CubemapLocation>(location);
+        return ReferenceCounter::getOrCreate(cubeTex.directory, [&]() {
+            const ImageDescriptor image = shadowutil::VFS::get().exists(cubeTex.directory + "/" + cubeTex.files[0])
+                    ? Image::loadCubeFromVFS(cubeTex.directory, cubeTex.files, false)
+                    : Image::loadCubeFromDisk(cubeTex.directory, cubeTex.files, false);
+            return std::make_unique<TextureImage>(false, image, usages, config);
+        });
     }
 
     DepthStencilImage::DepthStencilImage(const VkExtent2D &extent) : Image(extent, findFormatForDepthStencil()), buffer(extent, format) {
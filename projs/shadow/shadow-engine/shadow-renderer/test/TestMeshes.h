@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "vlkx/render/Geometry.h"
+
+// Meshes built in code, for the model tests.
+namespace testmeshes {
+
+    struct Mesh {
+        std::vector<uint32_t> indices;
+        std::vector<Geo::VertexAll> vertices;
+    };
+
+    // A flat square of size x size vertices in the XY plane, one unit apart, facing +Z.
+    inline Mesh grid(uint32_t size) {
+        Mesh mesh;
+        for (uint32_t y = 0; y < size; y++)
+            for (uint32_t x = 0; x < size; x++)
+                mesh.vertices.push_back({ { float(x), float(y), 0 }, { 0, 0, 1 }, { float(x) / float(size - 1), float(y) / float(size - 1) } });
+
+        for (uint32_t y = 1; y < size; y++) {
+            for (uint32_t x = 1; x < size; x++) {
+                const uint32_t a = (y - 1) * size + x - 1, b = a + 1, c = y * size + x, d = c - 1;
+                mesh.indices.insert(mesh.indices.end(), { a, b, c, a, c, d });
+            }
+        }
+        return mesh;
+    }
+
+    // A unit sphere of rings x segments quads, with its triangles facing out.
+    inline Mesh sphere(uint32_t rings, uint32_t segments) {
+        constexpr float pi = 3.14159265f;
+        Mesh mesh;
+        for (uint32_t r = 0; r <= rings; r++) {
+            const float theta = pi * float(r) / float(rings);
+            for (uint32_t s = 0; s <= segments; s++) {
+                const float phi = 2 * pi * float(s) / float(segments);
+                const glm::vec3 p { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+                mesh.vertices.push_back({ p, p, { float(s) / float(segments), float(r) / float(rings) } });
+            }
+        }
+
+        for (uint32_t r = 0; r < rings; r++) {
+            for (uint32_t s = 0; s < segments; s++) {
+                const uint32_t a = r * (segments + 1) + s, b = a + 1, c = a + segments + 1, d = c + 1;
+                mesh.indices.insert(mesh.indices.end(), { a, b, c, b, d, c });
+            }
+        }
+        return mesh;
+    }
+}
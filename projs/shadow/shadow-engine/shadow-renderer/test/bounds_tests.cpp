@@ -0,0 +1,125 @@
+#include "catch2/catch.hpp"
+#include "temp/model/MeshBounds.h"
+#include "TestMeshes.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace vlkxtemp;
+
+namespace {
+    MeshBounds sphereBounds(float x, float y, float z, float radius) {
+        return { { x - radius, y - radius, z - radius }, { x + radius, y + radius, z + radius }, { x, y, z }, radius };
+    }
+
+    bool holds(const MeshBounds& outer, const MeshBounds& inner) {
+        float distance = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            if (inner.min[axis] < outer.min[axis] || inner.max[axis] > outer.max[axis]) return false;
+            distance += (inner.center[axis] - outer.center[axis]) * (inner.center[axis] - outer.center[axis]);
+        }
+        return std::sqrt(distance) + inner.radius <= outer.radius * 1.0001f;
+    }
+}
+
+TEST_CASE("Bounds fit every vertex, however many there are", "[bounds]") {
+    // Counts either side of a multiple of four, since vertices are taken four at a time where possible.
+    const auto count = GENERATE(range(1, 10));
+    std::vector<Geo::VertexAll> vertices;
+    for (int i = 0; i < count; i++) {
+        const float f = float(i);
+        vertices.push_back({ { f * 2 - 5, std::sin(f) * 3, f == 4 ? 9.0f : -f }, { 100, 100, 100 }, {} });
+    }
+
+    const auto bounds = computeBounds(vertices);
+    float furthest = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        const auto [low, high] = std::minmax_element(vertices.begin(), vertices.end(),
+                                                     [&](const auto& a, const auto& b) { return a.position[axis] < b.position[axis]; });
+        REQUIRE(bounds.min[axis] == low->position[axis]);
+        REQUIRE(bounds.max[axis] == high->position[axis]);
+        REQUIRE(bounds.center[axis] == (bounds.min[axis] + bounds.max[axis]) / 2);
+    }
+    for (const auto& vertex : vertices) {
+        float distance = 0;
+        for (int axis = 0; axis < 3; axis++)
+            distance += (vertex.position[axis] - bounds.center[axis]) * (vertex.position[axis] - bounds.center[axis]);
+        furthest = std::max(furthest, distance);
+    }
+    REQUIRE(bounds.radius == Approx(std::sqrt(furthest)));
+}
+
+TEST_CASE("Bounds of a mesh", "[bounds]") {
+    const auto sphere = computeBounds(testmeshes::sphere(16, 32).vertices);
+    for (int axis = 0; axis < 3; axis++) {
+        REQUIRE(sphere.center[axis] == Approx(0).margin(1e-5));
+        REQUIRE(sphere.min[axis] == Approx(-1).margin(0.02));
+        REQUIRE(sphere.max[axis] == Approx(1).margin(0.02));
+    }
+    REQUIRE(sphere.radius == Approx(1).margin(1e-5));
+
+    const auto empty = computeBounds({});
+    REQUIRE(empty.radius == 0);
+    REQUIRE(empty.min[0] == 0);
+    REQUIRE(empty.max[2] == 0);
+}
+
+TEST_CASE("Merged bounds hold both", "[bounds]") {
+    SECTION("Apart") {
+        const auto a = sphereBounds(0, 0, 0, 1), b = sphereBounds(10, 0, 0, 2);
+        const auto merged = mergeBounds(a, b);
+        REQUIRE(holds(merged, a));
+        REQUIRE(holds(merged, b));
+        REQUIRE(merged.radius == Approx(6.5f));
+        REQUIRE(merged.center[0] == Approx(5.5f));
+        REQUIRE(merged.min[0] == -1);
+        REQUIRE(merged.max[0] == 12);
+    }
+
+    SECTION("One inside the other") {
+        const auto big = sphereBounds(1, 1, 1, 10), small = sphereBounds(2, 3, 1, 1);
+        for (const auto& merged : { mergeBounds(big, small), mergeBounds(small, big) }) {
+            REQUIRE(merged.radius == big.radius);
+            REQUIRE(std::equal(merged.center, merged.center + 3, big.center));
+        }
+    }
+
+    SECTION("The same") {
+        const auto a = sphereBounds(3, -2, 5, 4);
+        const auto merged = mergeBounds(a, a);
+        REQUIRE(merged.radius == a.radius);
+        REQUIRE(std::equal(merged.center, merged.center + 3, a.center));
+    }
+}
+
+TEST_CASE("Transformed bounds follow the transform", "[bounds]") {
+    const MeshBounds box { { -1, -2, -3 }, { 1, 2, 3 }, { 0, 0, 0 }, std::sqrt(14.0f) };
+
+    SECTION("Moved") {
+        glm::mat4 transform(1.0f);
+        transform[3][0] = 10;
+        transform[3][2] = -5;
+        const auto placed = transformBounds(box, transform);
+        REQUIRE(placed.min[0] == 9);
+        REQUIRE(placed.max[0] == 11);
+        REQUIRE(placed.min[2] == -8);
+        REQUIRE(placed.center[0] == 10);
+        REQUIRE(placed.center[2] == -5);
+        REQUIRE(placed.radius == Approx(box.radius));
+    }
+
+    SECTION("Turned a quarter around Z and scaled unevenly") {
+        glm::mat4 transform(0.0f);
+        transform[0][1] = 1;    // X goes to Y
+        transform[1][0] = -3;   // Y goes to -X, three times as long
+        transform[2][2] = 2;
+        transform[3][3] = 1;
+        const auto placed = transformBounds(box, transform);
+        REQUIRE(placed.min[0] == -6);
+        REQUIRE(placed.max[0] == 6);
+        REQUIRE(placed.min[1] == -1);
+        REQUIRE(placed.max[1] == 1);
+        REQUIRE(placed.min[2] == -6);
+        REQUIRE(placed.max[2] == 6);
+        REQUIRE(placed.radius == Approx(box.radius * 3));
+    }
+}
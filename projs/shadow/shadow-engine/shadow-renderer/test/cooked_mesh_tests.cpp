@@ -0,0 +1,265 @@
+#include "catch2/catch.hpp"
+#include "temp/model/CookedMesh.h"
+#include "TestMeshes.h"
+#include <shadow/util/Compression.h>
+#include <shadow/util/VFS.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using vlkxtemp::CookedMesh;
+
+namespace {
+    namespace fs = std::filesystem;
+
+    std::string temp(const std::string& name) {
+        return (fs::temp_directory_path() / ("shadow-smesh-" + name)).string();
+    }
+
+    std::string read(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return { std::istreambuf_iterator<char>(in), {} };
+    }
+
+    std::string writeFile(const std::string& name, const std::string& contents) {
+        const std::string path = temp(name);
+        std::ofstream(path, std::ios::binary) << contents;
+        return path;
+    }
+
+    // Two meshes, the first with levels of detail and meshlets of hand-made ranges.
+    std::string cook(const std::string& name, CookedMesh::VertexLayout layout, const testmeshes::Mesh& big = testmeshes::grid(20)) {
+        static const auto small = testmeshes::sphere(4, 6);
+        static const std::vector<vlkxtemp::LodLevel> levels { { 0, 600, 0 }, { 600, 60, 0.5f } };
+        static const std::vector<vlkxtemp::Meshlet> meshlets { { 0, 300, {} }, { 300, 300, {} } };
+
+        std::vector<uint32_t> withLevel = small.indices;
+        withLevel.insert(withLevel.end(), withLevel.begin(), withLevel.begin() + 60);
+        REQUIRE(small.indices.size() == 144);
+
+        const std::string path = temp(name);
+        CookedMesh::write(path, {
+            { withLevel, small.vertices, {}, {} },
+            { big.indices, big.vertices, levels, meshlets },
+        }, layout);
+        return path;
+    }
+
+    // A package holding one asset, laid out as documented on VFS::mountPackage, with its payload 16-byte aligned.
+    std::string package(const std::string& name, const std::string& path, const std::string& metadata, const std::string& payload) {
+        std::string out = "0S1V/\r\n";
+        const std::string prefix = "A/" + path + "|";
+        std::string paddedMetadata = metadata;
+        for (size_t size = 0;; paddedMetadata += ' ') {
+            size = 16 + paddedMetadata.size() + payload.size();
+            const size_t payloadStart = out.size() + prefix.size() + std::to_string(size).size() + 1 + 16 + paddedMetadata.size();
+            if (payloadStart % 16 == 0) break;
+        }
+
+        std::string body = "SMSH";
+        const uint32_t fields[3] = { 1, uint32_t(paddedMetadata.size()), uint32_t(payload.size()) };
+        body.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+        body += paddedMetadata + payload;
+        out += prefix + std::to_string(body.size()) + "|" + body + "\r\n";
+        return writeFile(name, out);
+    }
+
+    template <typename T>
+    T peek(const std::string& file, size_t offset) {
+        T value;
+        std::memcpy(&value, file.data() + offset, sizeof(value));
+        return value;
+    }
+
+    template <typename T>
+    void poke(std::string& file, size_t offset, T value) {
+        std::memcpy(file.data() + offset, &value, sizeof(value));
+    }
+}
+
+TEST_CASE("Cooked meshes read back what was written", "[smesh]") {
+    const auto layout = GENERATE(CookedMesh::VertexLayout::VertexAll, CookedMesh::VertexLayout::Packed);
+    const auto grid = testmeshes::grid(20);
+    const CookedMesh mesh(cook("roundtrip.smesh", layout, grid));
+
+    REQUIRE(mesh.meshCount() == 2);
+    REQUIRE(mesh.layout() == layout);
+    REQUIRE(mesh.indexSize() == sizeof(uint16_t));
+
+    REQUIRE(mesh.range(0).indexCount == 204);
+    REQUIRE(mesh.lods(0).size() == 1);
+    REQUIRE(mesh.lods(0)[0].indexCount == 204);
+    REQUIRE(mesh.meshlets(0).empty());
+
+    REQUIRE(mesh.lods(1).size() == 2);
+    REQUIRE(mesh.lods(1)[1].firstIndex == 600);
+    REQUIRE(mesh.lods(1)[1].error == 0.5f);
+    REQUIRE(mesh.meshlets(1).size() == 2);
+    REQUIRE(mesh.meshlets(1)[1].firstIndex == 300);
+
+    const auto indices = mesh.indices<uint16_t>(1);
+    REQUIRE(std::equal(indices.begin(), indices.end(), grid.indices.begin(), grid.indices.end()));
+    REQUIRE_THROWS(mesh.indices<uint32_t>(1));
+
+    const auto bounds = mesh.bounds(1);
+    REQUIRE(bounds.min[0] == 0);
+    REQUIRE(bounds.max[1] == 19);
+    REQUIRE(bounds.radius == Approx(std::sqrt(2 * 9.5f * 9.5f)));
+
+    if (layout == CookedMesh::VertexLayout::VertexAll) {
+        const auto vertices = mesh.vertices<Geo::VertexAll>(1);
+        REQUIRE(vertices.size() == grid.vertices.size());
+        REQUIRE(std::memcmp(vertices.data(), grid.vertices.data(), vertices.size_bytes()) == 0);
+    } else {
+        const auto vertices = mesh.vertices<Geo::VertexPacked>(1);
+        REQUIRE(vertices.size() == grid.vertices.size());
+        // The last vertex is the far corner of the box.
+        REQUIRE(vertices.back().position[0] == 65535);
+        REQUIRE(vertices.back().position[1] == 65535);
+        REQUIRE(vertices.front().position[0] == 0);
+        REQUIRE_THROWS(mesh.vertices<Geo::VertexAll>(1));
+    }
+}
+
+TEST_CASE("Cooked meshes switch to 32-bit indices when a mesh needs them", "[smesh]") {
+    const CookedMesh mesh(cook("wide.smesh", CookedMesh::VertexLayout::Packed, testmeshes::grid(300)));
+    REQUIRE(mesh.indexSize() == sizeof(uint32_t));
+    REQUIRE(mesh.indices<uint32_t>(1).back() == 300 * 300 - 2);
+    REQUIRE(mesh.indices<uint32_t>(0).size() == 204);
+}
+
+TEST_CASE("Cooked meshes load from the VFS, compressed or not", "[smesh]") {
+    const std::string cooked = read(cook("packed.smesh", CookedMesh::VertexLayout::Packed));
+    const auto bytes = std::as_bytes(std::span(cooked.data(), cooked.size()));
+    const auto stream = shadowutil::compressBlocks(bytes, 1024);
+    const std::string compressed(reinterpret_cast<const char*>(stream.data()), stream.size());
+
+    auto& vfs = shadowutil::VFS::get();
+    const auto mounted = [&](const std::string& name, const std::string& metadata, const std::string& payload) {
+        const std::string path = package(name, "mesh.smesh", metadata, payload);
+        vfs.mountPackage(path, "smesh-test", 100);
+        return path;
+    };
+
+    SECTION("Stored") {
+        const auto path = mounted("stored.vxp", R"({"compression":1})", cooked);
+        {
+            const CookedMesh mesh("smesh-test/mesh.smesh");
+            REQUIRE(mesh.meshCount() == 2);
+            REQUIRE(mesh.vertices<Geo::VertexPacked>(1).size() == 400);
+        }
+        vfs.unmount(path);
+    }
+
+    SECTION("Compressed") {
+        const auto path = mounted("compressed.vxp", R"({"compression":2})", compressed);
+        {
+            const CookedMesh mesh("smesh-test/mesh.smesh");
+            REQUIRE(mesh.meshCount() == 2);
+            REQUIRE(mesh.lods(1).size() == 2);
+            REQUIRE(mesh.vertices<Geo::VertexPacked>(1).size() == 400);
+        }
+        vfs.unmount(path);
+    }
+
+    SECTION("Damaged compressed") {
+        std::string damaged = compressed;
+        poke(damaged, 16, uint32_t(0xffffffff));
+        const auto path = mounted("damaged.vxp", R"({"compression":2})", damaged);
+        REQUIRE_THROWS_WITH(CookedMesh("smesh-test/mesh.smesh"), Catch::Contains("is invalid"));
+        vfs.unmount(path);
+    }
+
+    SECTION("Unknown compression") {
+        const auto path = mounted("unknown.vxp", R"({"compression":7})", cooked);
+        REQUIRE_THROWS_WITH(CookedMesh("smesh-test/mesh.smesh"), Catch::Contains("unsupported compression 7"));
+        vfs.unmount(path);
+    }
+}
+
+TEST_CASE("Malformed cooked meshes are rejected", "[smesh]") {
+    const std::string good = read(cook("good.smesh", CookedMesh::VertexLayout::VertexAll));
+    const auto rejects = [](std::string bytes, const std::string& why) {
+        REQUIRE_THROWS_WITH(CookedMesh(writeFile("bad.smesh", bytes)), Catch::Contains(why));
+    };
+
+    // Offsets into the Header and the first Range.
+    constexpr size_t version = 4, layout = 8, indexSize = 16, meshCount = 20, indexOffset = 24, lodCount = 56;
+    constexpr size_t range = 64, firstLod = range + 16, meshletCount = range + 28;
+
+    SECTION("Truncated") {
+        for (size_t length : { size_t(0), size_t(63), size_t(64), size_t(200), good.size() / 2, good.size() - 1 })
+            REQUIRE_THROWS(CookedMesh(writeFile("bad.smesh", good.substr(0, length))));
+    }
+
+    SECTION("Header") {
+        std::string bad = good;
+        bad[0] = 'X';
+        rejects(bad, "not a cooked mesh");
+
+        bad = good;
+        poke(bad, version, CookedMesh::currentVersion + 1);
+        rejects(bad, "unsupported version");
+
+        bad = good;
+        poke(bad, layout, uint32_t(9));
+        rejects(bad, "unsupported vertex layout");
+
+        bad = good;
+        poke(bad, indexSize, uint32_t(3));
+        rejects(bad, "unsupported vertex layout or index type");
+
+        bad = good;
+        poke(bad, meshCount, uint32_t(1) << 30);
+        rejects(bad, "truncated");
+
+        bad = good;
+        poke(bad, indexOffset, uint64_t(8));
+        rejects(bad, "truncated");
+
+        bad = good;
+        poke(bad, lodCount, uint32_t(1));
+        rejects(bad, "out of bounds");
+    }
+
+    SECTION("Ranges") {
+        std::string bad = good;
+        poke(bad, range + 4, uint32_t(1) << 20);
+        rejects(bad, "mesh range out of bounds");
+
+        bad = good;
+        poke(bad, firstLod, uint32_t(3));
+        rejects(bad, "mesh range out of bounds");
+
+        bad = good;
+        poke(bad, meshletCount, uint32_t(5));
+        rejects(bad, "meshlets out of bounds");
+    }
+
+    SECTION("Indices") {
+        // Each mesh's indices count from its own first vertex, so one past its last vertex is out, even where the file
+        //  holds more vertices after it.
+        const auto index = [&](size_t mesh, uint32_t i) {
+            return peek<uint64_t>(good, indexOffset) + (peek<uint32_t>(good, range + mesh * sizeof(CookedMesh::Range)) + i) * sizeof(uint16_t);
+        };
+        const auto vertices = [&](size_t mesh) { return peek<uint32_t>(good, range + mesh * sizeof(CookedMesh::Range) + 12); };
+        REQUIRE(vertices(0) < vertices(1));
+
+        std::string bad = good;
+        poke(bad, index(0, 0), uint16_t(vertices(0)));
+        rejects(bad, "index out of bounds");
+
+        // The last index of the first mesh is in its coarser level.
+        bad = good;
+        poke(bad, index(0, 203), uint16_t(vertices(0)));
+        rejects(bad, "index out of bounds");
+
+        bad = good;
+        poke(bad, index(1, 17), uint16_t(vertices(1)));
+        rejects(bad, "index out of bounds");
+
+        bad = good;
+        poke(bad, index(1, 17), uint16_t(vertices(1) - 1));
+        REQUIRE_NOTHROW(CookedMesh(writeFile("bad.smesh", bad)));
+    }
+}
@@ -0,0 +1,318 @@
+#include "catch2/catch.hpp"
+#include "temp/model/Gltf.h"
+#include "temp/model/Loader.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+
+using vlkxtemp::BinaryGltf;
+using vlkxtemp::ModelLoader;
+using Type = BinaryGltf::ComponentType;
+
+namespace {
+    namespace fs = std::filesystem;
+
+    std::string writeTemp(const std::string& name, const std::string& contents) {
+        const auto path = fs::temp_directory_path() / ("shadow-gltf-" + name);
+        std::ofstream(path, std::ios::binary) << contents;
+        return path.string();
+    }
+
+    template <typename T>
+    void append(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // A .glb of a JSON chunk and an optional BIN chunk, each padded to four bytes as the format requires.
+    std::string glb(std::string json, std::string binary, uint32_t version = 2) {
+        while (json.size() % 4) json += ' ';
+        while (binary.size() % 4) binary += '\0';
+
+        std::string out;
+        append(out, uint32_t(0x46546C67));
+        append(out, version);
+        append(out, uint32_t(12 + 8 + json.size() + (binary.empty() ? 0 : 8 + binary.size())));
+        append(out, uint32_t(json.size()));
+        append(out, uint32_t(0x4E4F534A));
+        out += json;
+        if (!binary.empty()) {
+            append(out, uint32_t(binary.size()));
+            append(out, uint32_t(0x004E4942));
+            out += binary;
+        }
+        return out;
+    }
+
+    // Lays data out in a BIN chunk, a buffer view for each piece, and describes it to build a .glb around.
+    struct Builder {
+        // A buffer view of the given values, starting on a four byte boundary.
+        template <typename T>
+        size_t view(const std::vector<T>& values, size_t stride = 0) {
+            while (binary.size() % 4) binary += '\0';
+            std::string json = "{\"buffer\":0,\"byteOffset\":" + std::to_string(binary.size()) + ",\"byteLength\":" + std::to_string(values.size() * sizeof(T));
+            if (stride) json += ",\"byteStride\":" + std::to_string(stride);
+            views.push_back(json + "}");
+            binary.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+            return views.size() - 1;
+        }
+
+        size_t accessor(size_t view, Type type, const char* shape, size_t count, size_t offset = 0, bool normalized = false) {
+            accessors.push_back("{\"bufferView\":" + std::to_string(view) + ",\"byteOffset\":" + std::to_string(offset)
+                + ",\"componentType\":" + std::to_string(uint32_t(type)) + ",\"type\":\"" + shape + "\",\"count\":" + std::to_string(count)
+                + (normalized ? ",\"normalized\":true}" : "}"));
+            return accessors.size() - 1;
+        }
+
+        // The whole file, with `rest` added to the top level of the JSON.
+        std::string build(const std::string& rest = "") const {
+            const auto list = [](const std::vector<std::string>& items) {
+                std::string out;
+                for (const auto& item : items) out += (out.empty() ? "" : ",") + item;
+                return "[" + out + "]";
+            };
+            std::string json = "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":" + std::to_string(binary.size()) + "}]"
+                + ",\"bufferViews\":" + list(views) + ",\"accessors\":" + list(accessors);
+            if (!rest.empty()) json += "," + rest;
+            return glb(json + "}", binary);
+        }
+
+        std::string write(const std::string& name, const std::string& rest = "") const {
+            return writeTemp(name, build(rest));
+        }
+
+        std::string binary;
+        std::vector<std::string> views;
+        std::vector<std::string> accessors;
+    };
+
+    // One primitive, of the given attribute accessors, listed without a scene.
+    std::string mesh(const std::string& attributes, int indices = -1) {
+        return "\"meshes\":[{\"primitives\":[{\"attributes\":{" + attributes + "}" + (indices >= 0 ? ",\"indices\":" + std::to_string(indices) : "") + "}]}]";
+    }
+
+    // Three vertices of a triangle facing +Z, wound anticlockwise.
+    const std::vector<float> trianglePositions { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+    const std::vector<float> triangleNormals { 0, 0, 1, 0, 0, 1, 0, 0, 1 };
+
+    std::vector<float> convert(const Builder& builder, size_t accessor, uint32_t components) {
+        const BinaryGltf gltf(builder.write("convert.glb"));
+        const auto view = gltf.accessor(accessor);
+        std::vector<float> out(view.count * components);
+        BinaryGltf::readFloats(view, reinterpret_cast<std::byte*>(out.data()), components * sizeof(float), components);
+        return out;
+    }
+
+    // The face normal of the first triangle, from its winding.
+    glm::vec3 faceNormal(const ModelLoader::MeshData& mesh) {
+        const auto& a = mesh.vertices[mesh.indices[0]].position;
+        const auto& b = mesh.vertices[mesh.indices[1]].position;
+        const auto& c = mesh.vertices[mesh.indices[2]].position;
+        const glm::vec3 u { b.x - a.x, b.y - a.y, b.z - a.z }, v { c.x - a.x, c.y - a.y, c.z - a.z };
+        return { u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x };
+    }
+}
+
+TEST_CASE("Malformed GLB containers are rejected", "[gltf]") {
+    Builder builder;
+    builder.view(trianglePositions);
+    const std::string good = builder.build();
+    REQUIRE_NOTHROW(BinaryGltf(writeTemp("good.glb", good)));
+
+    const auto rejects = [](const std::string& bytes, const std::string& why) {
+        REQUIRE_THROWS_WITH(BinaryGltf(writeTemp("bad.glb", bytes)), Catch::Contains(why));
+    };
+    const auto poke = [&](size_t offset, uint32_t value) {
+        std::string bad = good;
+        std::memcpy(bad.data() + offset, &value, sizeof(value));
+        return bad;
+    };
+    const uint32_t jsonLength = [&] { uint32_t v; std::memcpy(&v, good.data() + 12, 4); return v; }();
+    const size_t binary = 20 + jsonLength;
+
+    rejects(good.substr(0, 19), "too small");
+    rejects(poke(0, 0x46546C68), "not a binary glTF file");
+    rejects(glb("{}", "", 1), "unsupported version 1");
+    rejects(poke(16, 0x4E4F534B), "missing JSON chunk");
+    rejects(poke(12, uint32_t(good.size())), "missing JSON chunk");
+    // The length in the header is trusted only as far as the file goes, and no further.
+    rejects(poke(8, 19), "missing JSON chunk");
+    rejects(poke(binary, uint32_t(good.size())), "truncated BIN chunk");
+    rejects(good.substr(0, good.size() - 4), "truncated BIN chunk");
+}
+
+TEST_CASE("Buffer views and accessors must lie inside the BIN chunk", "[gltf]") {
+    Builder builder;
+    const auto view = builder.view(trianglePositions);
+
+    SECTION("Buffer view") {
+        builder.views.push_back("{\"buffer\":0,\"byteOffset\":4,\"byteLength\":" + std::to_string(builder.binary.size()) + "}");
+        builder.views.push_back("{\"buffer\":0,\"byteOffset\":" + std::to_string(builder.binary.size() + 4) + ",\"byteLength\":0}");
+        const BinaryGltf gltf(builder.write("views.glb"));
+        REQUIRE(gltf.bufferView(view).size() == trianglePositions.size() * sizeof(float));
+        REQUIRE_THROWS_WITH(gltf.bufferView(1), Catch::Contains("buffer view 1 is out of bounds"));
+        REQUIRE_THROWS_WITH(gltf.bufferView(2), Catch::Contains("buffer view 2 is out of bounds"));
+    }
+
+    SECTION("Accessor") {
+        builder.accessor(view, Type::Float, "VEC3", 3);
+        builder.accessor(view, Type::Float, "VEC3", 4);
+        builder.accessor(view, Type::Float, "VEC3", 3, 4);
+        builder.accessor(view, Type::Float, "VEC3", 2, 12);
+        builder.accessor(view, Type::Float, "VEC4", 3);
+        const BinaryGltf gltf(builder.write("accessors.glb"));
+
+        REQUIRE(gltf.accessor(0).count == 3);
+        REQUIRE(gltf.accessor(3).count == 2);
+        for (size_t bad : { 1, 2, 4 })
+            REQUIRE_THROWS_WITH(gltf.accessor(bad), Catch::Contains("accessor " + std::to_string(bad) + " is out of bounds"));
+    }
+
+    SECTION("Stride smaller than an element") {
+        builder.views.push_back("{\"buffer\":0,\"byteLength\":36,\"byteStride\":8}");
+        builder.accessor(1, Type::Float, "VEC3", 2);
+        const BinaryGltf gltf(builder.write("stride.glb"));
+        REQUIRE_THROWS_WITH(gltf.accessor(0), Catch::Contains("out of bounds"));
+    }
+}
+
+TEST_CASE("Interleaved attributes are read with their view's stride", "[gltf]") {
+    // Position, normal, then a padded pair of normalized texture coordinates, per vertex.
+    struct Vertex {
+        float position[3];
+        float normal[3];
+        uint16_t texture[2];
+        uint16_t padding[2];
+    };
+    std::vector<Vertex> vertices;
+    for (uint16_t i = 0; i < 5; i++)
+        vertices.push_back({ { float(i), float(i * 2), float(i * 3) }, { 0, float(i % 2), float(1 - i % 2) }, { uint16_t(i * 1000), uint16_t(65535 - i) }, { 0xdead, 0xbeef } });
+
+    Builder builder;
+    const auto view = builder.view(vertices, sizeof(Vertex));
+    builder.accessor(view, Type::Float, "VEC3", vertices.size(), offsetof(Vertex, position));
+    builder.accessor(view, Type::Float, "VEC3", vertices.size(), offsetof(Vertex, normal));
+    builder.accessor(view, Type::UnsignedShort, "VEC2", vertices.size(), offsetof(Vertex, texture), true);
+    const ModelLoader loader(builder.write("interleaved.glb", mesh("\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2")), fs::temp_directory_path().string());
+
+    REQUIRE(loader.getMeshes().size() == 1);
+    const auto& loaded = loader.getMeshes()[0];
+    REQUIRE(loaded.vertices.size() == vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const auto& v = loaded.vertices[i];
+        REQUIRE(v.position.x == vertices[i].position[0]);
+        REQUIRE(v.position.y == vertices[i].position[1]);
+        REQUIRE(v.position.z == vertices[i].position[2]);
+        REQUIRE(v.normal.y == vertices[i].normal[1]);
+        REQUIRE(v.normal.z == vertices[i].normal[2]);
+        REQUIRE(v.texture.x == Approx(vertices[i].texture[0] / 65535.0f));
+        REQUIRE(v.texture.y == Approx(vertices[i].texture[1] / 65535.0f));
+    }
+    // Without indices, the vertices are drawn in order.
+    REQUIRE(loaded.indices == std::vector<uint32_t> { 0, 1, 2 });
+}
+
+TEST_CASE("Integer attributes convert to floats, normalized or not", "[gltf]") {
+    std::mt19937 random(42);
+    const auto values = [&]<typename T>(size_t count, std::initializer_list<T> extremes) {
+        std::vector<T> out(extremes);
+        std::uniform_int_distribution<int64_t> any(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+        while (out.size() < count) out.push_back(static_cast<T>(any(random)));
+        return out;
+    };
+
+    // Element counts that leave some over after the eight or sixteen at a time, and one that spans two batches.
+    const auto shorts = values(13 * 3, { int16_t(-32768), int16_t(-32767), int16_t(0), int16_t(32767), int16_t(1) });
+    const auto bytes = values(11 * 3, { int8_t(-128), int8_t(-127), int8_t(0), int8_t(127), int8_t(-1) });
+    const auto unsignedBytes = values(300 * 2, { uint8_t(0), uint8_t(255), uint8_t(128) });
+    const auto unsignedShorts = values(7 * 2, { uint16_t(0), uint16_t(65535) });
+
+    Builder builder;
+    builder.accessor(builder.view(shorts), Type::Short, "VEC3", 13, 0, true);
+    builder.accessor(builder.view(bytes), Type::Byte, "VEC3", 11, 0, true);
+    builder.accessor(builder.view(unsignedBytes), Type::UnsignedByte, "VEC2", 300, 0, true);
+    builder.accessor(builder.view(unsignedShorts), Type::UnsignedShort, "VEC2", 7, 0, true);
+    builder.accessor(3, Type::UnsignedShort, "VEC2", 7);
+    builder.accessor(0, Type::Short, "VEC3", 13);
+
+    const auto check = [](const std::vector<float>& converted, const auto& raw, float scale, bool clamp) {
+        REQUIRE(converted.size() == raw.size());
+        for (size_t i = 0; i < raw.size(); i++) {
+            const float expected = clamp ? std::max(float(raw[i]) * scale, -1.0f) : float(raw[i]) * scale;
+            REQUIRE(converted[i] == Approx(expected).margin(1e-6));
+        }
+    };
+    check(convert(builder, 0, 3), shorts, 1.0f / 32767, true);
+    check(convert(builder, 1, 3), bytes, 1.0f / 127, true);
+    check(convert(builder, 2, 2), unsignedBytes, 1.0f / 255, false);
+    check(convert(builder, 3, 2), unsignedShorts, 1.0f / 65535, false);
+    check(convert(builder, 4, 2), unsignedShorts, 1, false);
+    check(convert(builder, 5, 3), shorts, 1, false);
+
+    // Both of the smallest normalized values mean -1, and the largest means 1.
+    const auto normalizedShorts = convert(builder, 0, 3);
+    REQUIRE(normalizedShorts[0] == -1);
+    REQUIRE(normalizedShorts[1] == -1);
+    REQUIRE(normalizedShorts[3] == 1);
+    const auto normalizedBytes = convert(builder, 1, 3);
+    REQUIRE(normalizedBytes[0] == -1);
+    REQUIRE(normalizedBytes[1] == -1);
+    REQUIRE(normalizedBytes[3] == 1);
+}
+
+TEST_CASE("Narrow indices are widened, and must name a vertex", "[gltf]") {
+    // Six vertices, in a row.
+    std::vector<float> positions;
+    for (int i = 0; i < 6; i++) positions.insert(positions.end(), { float(i), float(i % 2), 0 });
+
+    const std::vector<uint8_t> byteIndices { 0, 1, 2, 2, 1, 3, 2, 3, 4, 4, 3, 5 };
+    const std::vector<uint16_t> shortIndices { 0, 1, 2, 2, 1, 3, 2, 3, 4, 4, 3, 5, 5, 4, 0 };
+    const std::vector<uint16_t> outOfRange { 0, 1, 2, 2, 1, 6 };
+
+    Builder builder;
+    builder.accessor(builder.view(positions), Type::Float, "VEC3", 6);
+    builder.accessor(builder.view(byteIndices), Type::UnsignedByte, "SCALAR", byteIndices.size());
+    builder.accessor(builder.view(shortIndices), Type::UnsignedShort, "SCALAR", shortIndices.size());
+    builder.accessor(builder.view(outOfRange), Type::UnsignedShort, "SCALAR", outOfRange.size());
+
+    const auto load = [&](int indices) {
+        return ModelLoader(builder.write("indices.glb", mesh("\"POSITION\":0", indices)), fs::temp_directory_path().string()).getMeshes()[0].indices;
+    };
+    REQUIRE(load(1) == std::vector<uint32_t>(byteIndices.begin(), byteIndices.end()));
+    REQUIRE(load(2) == std::vector<uint32_t>(shortIndices.begin(), shortIndices.end()));
+    REQUIRE_THROWS_WITH(load(3), Catch::Contains("index out of range"));
+}
+
+TEST_CASE("A mirroring node flips the winding of its meshes", "[gltf]") {
+    const std::vector<uint16_t> indices { 0, 1, 2 };
+    Builder builder;
+    builder.accessor(builder.view(trianglePositions), Type::Float, "VEC3", 3);
+    builder.accessor(builder.view(triangleNormals), Type::Float, "VEC3", 3);
+    builder.accessor(builder.view(indices), Type::UnsignedShort, "SCALAR", 3);
+
+    const auto load = [&](const std::string& node) {
+        const std::string scene = mesh("\"POSITION\":0,\"NORMAL\":1", 2) + ",\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0," + node + "}]";
+        return std::make_unique<ModelLoader>(builder.write("mirror.glb", scene), fs::temp_directory_path().string());
+    };
+
+    // Each triangle's winding must keep facing the way its normals do, however the node transforms it.
+    for (const char* node : { "\"scale\":[2,2,2]", "\"scale\":[-1,1,1]", "\"scale\":[1,1,-1]", "\"matrix\":[-1,0,0,0,0,1,0,0,0,0,1,0,5,0,0,1]",
+                              "\"scale\":[-1,-1,1]", "\"rotation\":[0,1,0,0]" }) {
+        INFO(node);
+        const auto loader = load(node);
+        REQUIRE(loader->getMeshes().size() == 1);
+        const auto& loaded = loader->getMeshes()[0];
+        const auto face = faceNormal(loaded);
+        const auto& normal = loaded.vertices[0].normal;
+        REQUIRE(face.x * normal.x + face.y * normal.y + face.z * normal.z > 0);
+
+        const bool mirrored = std::string(node) == "\"scale\":[-1,1,1]" || std::string(node) == "\"scale\":[1,1,-1]"
+            || std::string(node).starts_with("\"matrix\"");
+        REQUIRE(loaded.indices == (mirrored ? std::vector<uint32_t> { 0, 2, 1 } : std::vector<uint32_t> { 0, 1, 2 }));
+    }
+
+    const auto mirrored = load("\"matrix\":[-1,0,0,0,0,1,0,0,0,0,1,0,5,0,0,1]");
+    REQUIRE(mirrored->getMeshes()[0].vertices[1].position.x == 4);
+}
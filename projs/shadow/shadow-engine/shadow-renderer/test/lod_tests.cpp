@@ -0,0 +1,138 @@
+#include "catch2/catch.hpp"
+#include "temp/model/MeshBounds.h"
+#include "temp/model/MeshLod.h"
+#include "TestMeshes.h"
+
+using namespace vlkxtemp;
+
+namespace {
+    // Every level lies inside the index buffer, is made of whole, non-degenerate triangles of the mesh's own vertices,
+    //  and is smaller than the one before.
+    void requireWellFormed(std::span<const LodLevel> levels, std::span<const uint32_t> indices, size_t vertexCount) {
+        REQUIRE(levels[0].firstIndex == 0);
+        REQUIRE(levels[0].error == 0);
+        for (size_t i = 0; i < levels.size(); i++) {
+            const auto& level = levels[i];
+            REQUIRE(level.indexCount % 3 == 0);
+            REQUIRE(uint64_t(level.firstIndex) + level.indexCount <= indices.size());
+            if (i > 0) {
+                REQUIRE(level.firstIndex == levels[i - 1].firstIndex + levels[i - 1].indexCount);
+                REQUIRE(level.indexCount <= levels[i - 1].indexCount * 9 / 10);
+                REQUIRE(level.error >= levels[i - 1].error);
+            }
+
+            size_t bad = 0;
+            const auto triangles = indices.subspan(level.firstIndex, level.indexCount);
+            for (size_t t = 0; t < triangles.size(); t += 3) {
+                bad += triangles[t] >= vertexCount || triangles[t + 1] >= vertexCount || triangles[t + 2] >= vertexCount;
+                bad += triangles[t] == triangles[t + 1] || triangles[t + 1] == triangles[t + 2] || triangles[t] == triangles[t + 2];
+            }
+            REQUIRE(bad == 0);
+        }
+    }
+}
+
+TEST_CASE("LODs of a flat mesh are cheap, so every level is made", "[lod]") {
+    auto mesh = testmeshes::grid(33);
+    const auto original = mesh.indices;
+    const float radius = computeBounds(mesh.vertices).radius;
+
+    const auto levels = generateLods(mesh.indices, mesh.vertices);
+    REQUIRE(levels.size() == 4);
+    requireWellFormed(levels, mesh.indices, mesh.vertices.size());
+
+    // The full level is left as it was.
+    REQUIRE(levels[0].indexCount == original.size());
+    REQUIRE(std::equal(original.begin(), original.end(), mesh.indices.begin()));
+    // Only cutting the corners of the border costs anything.
+    REQUIRE(levels.back().error <= LodSettings().maxError * radius);
+}
+
+TEST_CASE("LODs of a curved mesh stay within the error budget", "[lod]") {
+    auto mesh = testmeshes::sphere(32, 64);
+    const float radius = computeBounds(mesh.vertices).radius;
+
+    LodSettings settings;
+    settings.maxLevels = 8;
+    settings.maxError = 0.05f;
+    const auto levels = generateLods(mesh.indices, mesh.vertices, settings);
+
+    REQUIRE(levels.size() >= 2);
+    requireWellFormed(levels, mesh.indices, mesh.vertices.size());
+    REQUIRE(levels.back().error > 0);
+    REQUIRE(levels.back().error <= settings.maxError * radius);
+}
+
+TEST_CASE("LOD generation respects its limits", "[lod]") {
+    SECTION("One level only") {
+        auto mesh = testmeshes::sphere(16, 32);
+        const auto size = mesh.indices.size();
+        LodSettings settings;
+        settings.maxLevels = 1;
+        REQUIRE(generateLods(mesh.indices, mesh.vertices, settings).size() == 1);
+        REQUIRE(mesh.indices.size() == size);
+    }
+
+    SECTION("No error allowed on a curved surface") {
+        auto mesh = testmeshes::sphere(16, 32);
+        LodSettings settings;
+        settings.maxError = 0;
+        REQUIRE(generateLods(mesh.indices, mesh.vertices, settings).size() == 1);
+    }
+
+    SECTION("A single triangle") {
+        testmeshes::Mesh mesh { { 0, 1, 2 }, { { { 0, 0, 0 }, {}, {} }, { { 1, 0, 0 }, {}, {} }, { { 0, 1, 0 }, {}, {} } } };
+        REQUIRE(generateLods(mesh.indices, mesh.vertices).size() == 1);
+    }
+}
+
+TEST_CASE("LOD selection picks the coarsest level that is close enough, with hysteresis", "[lod]") {
+    const std::vector<LodLevel> levels { { 0, 300, 0 }, { 300, 150, 0.01f }, { 450, 75, 0.04f }, { 525, 30, 0.2f } };
+
+    // Errors in pixels are error * pixelsPerUnit. One pixel is allowed, less the hysteresis to move to a coarser level.
+    REQUIRE(selectLod(levels, 1000, 0) == 0);
+    REQUIRE(selectLod(levels, 50, 0) == 1);
+    REQUIRE(selectLod(levels, 10, 0) == 2);
+    REQUIRE(selectLod(levels, 1, 0) == 3);
+
+    // Level 1 at 90 pixels per unit is 0.9 pixels off: close enough to stay on, but not to move down to.
+    REQUIRE(selectLod(levels, 90, 1) == 1);
+    REQUIRE(selectLod(levels, 90, 0) == 0);
+    REQUIRE(selectLod(levels, 70, 0) == 1);
+
+    // Moving closer goes back up as far as needed at once.
+    REQUIRE(selectLod(levels, 200, 3) == 0);
+
+    // A current level past the end counts as the last.
+    REQUIRE(selectLod(levels, 1, 99) == 3);
+    REQUIRE(selectLod(levels, 10, 99) == 2);
+    REQUIRE(selectLod({}, 10, 2) == 0);
+}
+
+TEST_CASE("Levels made earlier are trimmed to tighter settings", "[lod]") {
+    const std::vector<LodLevel> levels { { 0, 300, 0 }, { 300, 150, 0.01f }, { 450, 75, 0.04f }, { 525, 30, 0.2f } };
+
+    // The defaults allow four levels, of up to 5% of the radius.
+    REQUIRE(limitLods(levels, 10, {}).size() == 4);
+    REQUIRE(limitLods(levels, 1, {}).size() == 3);
+
+    LodSettings settings;
+    settings.maxLevels = 2;
+    const auto trimmed = limitLods(levels, 10, settings);
+    REQUIRE(trimmed.size() == 2);
+    REQUIRE(trimmed.data() == levels.data());
+
+    // The full mesh is always kept, whatever the settings.
+    settings.maxLevels = 0;
+    REQUIRE(limitLods(levels, 10, settings).size() == 1);
+    settings = {};
+    settings.maxError = 0;
+    REQUIRE(limitLods(levels, 10, settings).size() == 1);
+    REQUIRE(limitLods({}, 10, settings).empty());
+
+    // Looser settings cannot add levels that were never made.
+    settings = {};
+    settings.maxLevels = 8;
+    settings.maxError = 1;
+    REQUIRE(limitLods(levels, 10, settings).size() == 4);
+}
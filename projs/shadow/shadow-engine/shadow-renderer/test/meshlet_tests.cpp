@@ -0,0 +1,155 @@
+#include "catch2/catch.hpp"
+#include "temp/model/Meshlet.h"
+#include "temp/model/MeshOptimizer.h"
+#include "TestMeshes.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <set>
+
+using namespace vlkxtemp;
+
+namespace {
+    using Triangle = std::array<uint32_t, 3>;
+
+    std::vector<Triangle> triangles(std::span<const uint32_t> indices) {
+        std::vector<Triangle> out;
+        for (size_t i = 0; i < indices.size(); i += 3)
+            out.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    // A box around everything in the tests, looked at from `eye`.
+    MeshletView view(glm::vec3 eye, bool cones, float size = 1000) {
+        MeshletView view {
+            { { 1, 0, 0, size }, { -1, 0, 0, size }, { 0, 1, 0, size }, { 0, -1, 0, size }, { 0, 0, 1, size }, { 0, 0, -1, size } },
+            { eye.x, eye.y, eye.z },
+            cones
+        };
+        return view;
+    }
+}
+
+TEST_CASE("Meshlets hold every triangle once, within their limits", "[meshlet]") {
+    auto mesh = GENERATE(testmeshes::sphere(40, 80), testmeshes::grid(90));
+    optimizeMesh(mesh.indices, mesh.vertices);
+    const auto before = mesh.indices;
+
+    const MeshletSettings settings;
+    const auto meshlets = buildMeshlets(mesh.indices, mesh.vertices, settings);
+    REQUIRE(triangles(mesh.indices) == triangles(before));
+
+    uint32_t next = 0;
+    size_t outOfBounds = 0, wideCones = 0;
+    for (const auto& meshlet : meshlets) {
+        REQUIRE(meshlet.firstIndex == next);
+        REQUIRE(meshlet.indexCount % 3 == 0);
+        REQUIRE(meshlet.indexCount > 0);
+        REQUIRE(meshlet.indexCount / 3 <= settings.maxTriangles);
+        next += meshlet.indexCount;
+
+        const auto indices = std::span(mesh.indices).subspan(meshlet.firstIndex, meshlet.indexCount);
+        REQUIRE(std::set<uint32_t>(indices.begin(), indices.end()).size() <= settings.maxVertices);
+
+        const auto& b = meshlet.bounds;
+        for (const uint32_t vertex : indices) {
+            const auto& p = mesh.vertices[vertex].position;
+            const float dx = p.x - b.center[0], dy = p.y - b.center[1], dz = p.z - b.center[2];
+            outOfBounds += std::sqrt(dx * dx + dy * dy + dz * dz) > b.radius * 1.0001f + 1e-5f;
+        }
+
+        // Every triangle faces within the cone.
+        if (b.coneCutoff < 1) {
+            const float cosine = std::sqrt(1 - b.coneCutoff * b.coneCutoff);
+            for (size_t t = 0; t < indices.size(); t += 3) {
+                const auto& a = mesh.vertices[indices[t]].position;
+                const auto e1 = mesh.vertices[indices[t + 1]].position - a, e2 = mesh.vertices[indices[t + 2]].position - a;
+                const glm::vec3 n { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+                const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+                if (length == 0) continue;
+                wideCones += (n.x * b.coneAxis[0] + n.y * b.coneAxis[1] + n.z * b.coneAxis[2]) / length < cosine - 1e-4f;
+            }
+        }
+    }
+    REQUIRE(next == mesh.indices.size());
+    REQUIRE(outOfBounds == 0);
+    REQUIRE(wideCones == 0);
+}
+
+TEST_CASE("Meshlets keep the order the optimizer chose as far as they can", "[meshlet]") {
+    auto mesh = testmeshes::sphere(64, 128);
+    optimizeMesh(mesh.indices, mesh.vertices);
+    const auto first = triangles(std::span(mesh.indices).first(3));
+    const float optimized = analyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr;
+
+    const auto meshlets = buildMeshlets(mesh.indices, mesh.vertices);
+
+    // What draws first still does.
+    const auto firstMeshlet = triangles(std::span(mesh.indices).first(meshlets[0].indexCount));
+    REQUIRE(std::binary_search(firstMeshlet.begin(), firstMeshlet.end(), first[0]));
+
+    // No meshlet shares vertices with another, so some reuse is lost, but each is still ordered for the cache.
+    const float clustered = analyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr;
+    REQUIRE(clustered <= optimized * 1.3f);
+    for (const auto& meshlet : meshlets) {
+        std::vector<uint32_t> indices(mesh.indices.begin() + meshlet.firstIndex, mesh.indices.begin() + meshlet.firstIndex + meshlet.indexCount);
+        const float acmr = analyzeVertexCache(indices, mesh.vertices.size()).acmr;
+        optimizeVertexCache(indices, mesh.vertices.size());
+        REQUIRE(acmr <= analyzeVertexCache(indices, mesh.vertices.size()).acmr * 1.1f);
+    }
+}
+
+TEST_CASE("Meshlets are culled by the frustum and by which way they face", "[meshlet]") {
+    // A flat grid faces +Z, so every meshlet's cone is narrow.
+    auto mesh = testmeshes::grid(64);
+    const auto meshlets = buildMeshlets(mesh.indices, mesh.vertices);
+    REQUIRE(meshlets.size() > 1);
+    for (const auto& meshlet : meshlets)
+        REQUIRE(meshlet.bounds.coneCutoff < 0.01f);
+
+    std::vector<uint32_t> visible;
+    SECTION("In front") {
+        cullMeshlets(meshlets, view({ 32, 32, 50 }, true), &visible);
+        REQUIRE(visible.size() == meshlets.size());
+        REQUIRE(std::is_sorted(visible.begin(), visible.end()));
+    }
+
+    SECTION("Behind") {
+        cullMeshlets(meshlets, view({ 32, 32, -50 }, true), &visible);
+        REQUIRE(visible.empty());
+
+        cullMeshlets(meshlets, view({ 32, 32, -50 }, false), &visible);
+        REQUIRE(visible.size() == meshlets.size());
+    }
+
+    SECTION("Outside the frustum") {
+        // Only x >= 40 is inside.
+        auto halfway = view({ 32, 32, 50 }, false);
+        halfway.planes[0][3] = -40;
+        cullMeshlets(meshlets, halfway, &visible);
+        REQUIRE_FALSE(visible.empty());
+        REQUIRE(visible.size() < meshlets.size());
+        for (const uint32_t i : visible)
+            REQUIRE(meshlets[i].bounds.center[0] + meshlets[i].bounds.radius >= 40);
+    }
+}
+
+TEST_CASE("Meshlets reject what they can't split", "[meshlet]") {
+    auto mesh = testmeshes::grid(4);
+    REQUIRE(buildMeshlets({}, mesh.vertices).empty());
+
+    auto shortList = mesh.indices;
+    shortList.pop_back();
+    REQUIRE_THROWS_WITH(buildMeshlets(shortList, mesh.vertices), Catch::Contains("not a list of triangles"));
+
+    auto outOfRange = mesh.indices;
+    outOfRange[4] = 16;
+    REQUIRE_THROWS_WITH(buildMeshlets(outOfRange, mesh.vertices), Catch::Contains("16 is out of range"));
+
+    REQUIRE_THROWS(buildMeshlets(mesh.indices, mesh.vertices, { 2, 124 }));
+    REQUIRE_THROWS(buildMeshlets(mesh.indices, mesh.vertices, { 64, 0 }));
+
+    REQUIRE_FALSE(worthMeshlets(4095 * 3));
+    REQUIRE(worthMeshlets(4096 * 3));
+}
@@ -0,0 +1,122 @@
+#include "catch2/catch.hpp"
+#include "temp/model/Loader.h"
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+
+using vlkxtemp::Wavefront;
+
+namespace {
+    std::string writeTemp(const std::string& name, const std::string& contents) {
+        const auto path = std::filesystem::temp_directory_path() / ("shadow-obj-" + name);
+        std::ofstream(path, std::ios::binary) << contents;
+        return path.string();
+    }
+
+    // Big enough to be split into at least four chunks.
+    constexpr size_t gridSize = 220;
+
+    // A grid of size x size vertices, each with its own position, texture coordinate and normal.
+    // Each row of vertices is followed by the quads between it and the row before, so that relative indices
+    //  stay small. The file is several MiB, so it is parsed in several chunks.
+    struct Grid {
+        explicit Grid(size_t size, bool relative) {
+            for (size_t y = 0; y < size; y++) {
+                for (size_t x = 0; x < size; x++) {
+                    text += "v " + std::to_string(x) + " " + std::to_string(y) + " 0\n";
+                    text += "vt " + std::to_string(x) + " " + std::to_string(y) + "\n";
+                    text += "vn 0 0 1\n";
+                }
+                if (y == 0) continue;
+
+                const size_t written = (y + 1) * size;
+                const auto corner = [&](size_t cx, size_t cy) {
+                    const size_t index = cy * size + cx;
+                    const std::string i = relative ? std::to_string(int64_t(index) - int64_t(written)) : std::to_string(index + 1);
+                    return i + "/" + i + "/" + i;
+                };
+                for (size_t x = 1; x < size; x++) {
+                    text += "f " + corner(x - 1, y - 1) + " " + corner(x, y - 1) + " " + corner(x, y) + " " + corner(x - 1, y) + "\n";
+                    triangles.push_back({ x - 1.f, y - 1.f, x + 0.f, y - 1.f, x + 0.f, y + 0.f });
+                    triangles.push_back({ x - 1.f, y - 1.f, x + 0.f, y + 0.f, x - 1.f, y + 0.f });
+                }
+            }
+        }
+
+        std::string text;
+        std::vector<std::array<float, 6>> triangles;    // x and y of each corner
+    };
+
+    void requireMatches(const Wavefront& mesh, const Grid& grid) {
+        REQUIRE(mesh.indices.size() == grid.triangles.size() * 3);
+        size_t wrong = 0;
+        for (size_t t = 0; t < grid.triangles.size(); t++) {
+            for (size_t c = 0; c < 3; c++) {
+                const auto& vertex = mesh.vertices[mesh.indices[t * 3 + c]];
+                wrong += vertex.position.x != grid.triangles[t][c * 2] || vertex.position.y != grid.triangles[t][c * 2 + 1]
+                         || vertex.texture.x != vertex.position.x || vertex.normal.z != 1;
+            }
+        }
+        REQUIRE(wrong == 0);
+    }
+}
+
+TEST_CASE("OBJ faces are triangulated and their corners deduplicated", "[obj]") {
+    const auto path = writeTemp("quad.obj",
+        "# A quad and a triangle that shares an edge with it\r\n"
+        "o quad\r\n"
+        "v 0 0 0\r\nv 1 0 0\r\nv 1 1 0\r\nv 0 1 0\r\nv +2 -0.5 1e0\r\n"
+        "vt 0 0\r\nvt 1 1\r\n"
+        "vn 0 0 1\r\n"
+        "s off\r\n"
+        "f 1/1/1 2/1/1 3/2/1 4/2/1\r\n"
+        "f 2/1/1\t3/2/1 -1/-1/-1   \r\n");
+    const Wavefront mesh(path, 1);
+
+    REQUIRE(mesh.indices == std::vector<uint32_t> { 0, 1, 2, 0, 2, 3, 1, 2, 4 });
+    REQUIRE(mesh.vertices.size() == 5);
+    REQUIRE(mesh.vertices[4].position.x == 2);
+    REQUIRE(mesh.vertices[4].position.y == -0.5f);
+    REQUIRE(mesh.vertices[4].texture.x == 1);
+    REQUIRE(mesh.bounds.max[0] == 2);
+    REQUIRE(mesh.bounds.min[1] == -0.5f);
+}
+
+TEST_CASE("OBJ files split into chunks parse the same as whole ones", "[obj]") {
+    const Grid absolute(gridSize, false);
+    const Grid relative(gridSize, true);
+    REQUIRE(absolute.text.size() > 4 << 20);
+
+    const Wavefront fromAbsolute(writeTemp("absolute.obj", absolute.text), 1);
+    const Wavefront fromRelative(writeTemp("relative.obj", relative.text), 1);
+
+    requireMatches(fromAbsolute, absolute);
+    // Vertices are numbered in the order they are first used, wherever the chunks fall.
+    REQUIRE(fromRelative.indices == fromAbsolute.indices);
+    REQUIRE(fromRelative.vertices.size() == gridSize * gridSize);
+}
+
+TEST_CASE("OBJ errors name the line they are on", "[obj]") {
+    const auto fails = [](const std::string& name, const std::string& text, const std::string& line) {
+        REQUIRE_THROWS_WITH(Wavefront(writeTemp(name, text), 1), Catch::Contains("error on line " + line + ":"));
+    };
+
+    fails("statement.obj", "v 0 0 0\nbogus 1\n", "2");
+    fails("number.obj", "v 0 0 0\nv 0 x 0\n", "2");
+    fails("short.obj", "v 0 0 0\nvt 0 0\nvn 0 0 1\nf 1/1/1 1/1/1\n", "4");
+    fails("separator.obj", "v 0 0 0\nvt 0 0\nvn 0 0 1\nf 1//1 1//1 1//1\n", "4");
+    fails("zero.obj", "v 0 0 0\nvt 0 0\nvn 0 0 1\nf 0/1/1 1/1/1 1/1/1\n", "4");
+    fails("before.obj", "v 0 0 0\nvt 0 0\nvn 0 0 1\nf -2/1/1 1/1/1 1/1/1\n", "4");
+
+    // Past the end of the file, which is only known once every chunk is counted.
+    const Grid grid(gridSize, false);
+    const auto lines = std::to_string(std::count(grid.text.begin(), grid.text.end(), '\n') + 1);
+    fails("past.obj", grid.text + "f 1/1/1 2/2/2 99999999/3/3\n", lines);
+}
+
+TEST_CASE("OBJ indices can start from 0", "[obj]") {
+    const Wavefront mesh(writeTemp("base.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\nf 0/0/0 1/0/0 2/0/0\n"), 0);
+    REQUIRE(mesh.indices == std::vector<uint32_t> { 0, 1, 2 });
+    REQUIRE(mesh.vertices[2].position.y == 1);
+}
@@ -0,0 +1,146 @@
+#include "catch2/catch.hpp"
+#include "temp/model/MeshOptimizer.h"
+#include "TestMeshes.h"
+#include <algorithm>
+#include <array>
+#include <random>
+
+using namespace vlkxtemp;
+
+namespace {
+    using Triangle = std::array<uint32_t, 3>;
+    using Vertex = std::array<float, 8>;
+    using VertexTriangle = std::array<Vertex, 3>;
+
+    // Triangles turned to start at their lowest index, which keeps their winding, then sorted.
+    std::vector<Triangle> triangles(std::span<const uint32_t> indices) {
+        std::vector<Triangle> out;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            Triangle t { indices[i], indices[i + 1], indices[i + 2] };
+            std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+            out.push_back(t);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    // The same, by what the vertices hold rather than where they are, for passes that move vertices around.
+    std::vector<VertexTriangle> triangles(std::span<const uint32_t> indices, std::span<const Geo::VertexAll> vertices) {
+        const auto value = [&](uint32_t index) {
+            const auto& v = vertices[index];
+            return Vertex { v.position.x, v.position.y, v.position.z, v.normal.x, v.normal.y, v.normal.z, v.texture.x, v.texture.y };
+        };
+
+        std::vector<VertexTriangle> out;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            VertexTriangle t { value(indices[i]), value(indices[i + 1]), value(indices[i + 2]) };
+            std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+            out.push_back(t);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    // The same triangles in a random order, as an exporter that does not care about the cache might leave them.
+    testmeshes::Mesh shuffled(testmeshes::Mesh mesh) {
+        std::vector<Triangle> list;
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            list.push_back({ mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2] });
+        std::shuffle(list.begin(), list.end(), std::mt19937(1234));
+
+        mesh.indices.clear();
+        for (const auto& t : list)
+            mesh.indices.insert(mesh.indices.end(), t.begin(), t.end());
+        return mesh;
+    }
+
+    std::vector<testmeshes::Mesh> meshes() {
+        return { testmeshes::grid(40), testmeshes::sphere(24, 48), shuffled(testmeshes::grid(40)), shuffled(testmeshes::sphere(24, 48)) };
+    }
+}
+
+TEST_CASE("The cache statistics count what a FIFO cache would do", "[optimize]") {
+    // Two triangles sharing an edge: four vertices transformed for two triangles.
+    const std::vector<uint32_t> quad { 0, 1, 2, 2, 1, 3 };
+    const auto stats = analyzeVertexCache(quad, 4);
+    REQUIRE(stats.acmr == 2);
+    REQUIRE(stats.atvr == 1);
+
+    // With room for only one vertex, only the vertex repeated straight away is reused.
+    REQUIRE(analyzeVertexCache(quad, 4, 1).acmr == 2.5f);
+    REQUIRE(analyzeVertexCache({}, 0).acmr == 0);
+}
+
+TEST_CASE("Reordering for the cache keeps every triangle and its winding", "[optimize]") {
+    for (auto mesh : meshes()) {
+        const auto before = triangles(mesh.indices);
+        const auto acmr = analyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr;
+
+        optimizeVertexCache(mesh.indices, mesh.vertices.size());
+        REQUIRE(triangles(mesh.indices) == before);
+        REQUIRE(analyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr <= acmr);
+    }
+}
+
+TEST_CASE("Reordering for overdraw keeps every triangle and its winding", "[optimize]") {
+    for (auto mesh : meshes()) {
+        const auto original = analyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr;
+        optimizeVertexCache(mesh.indices, mesh.vertices.size());
+        const auto before = triangles(mesh.indices);
+        const auto acmr = analyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr;
+
+        optimizeOverdraw(mesh.indices, mesh.vertices);
+        REQUIRE(triangles(mesh.indices) == before);
+        // The threshold holds for each cluster on a cold cache; across the whole mesh the clusters' new neighbours
+        //  cost a little more, but nowhere near what the cache pass saved.
+        const auto after = analyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr;
+        REQUIRE(after <= acmr * 1.1f);
+        REQUIRE(after < original);
+    }
+}
+
+TEST_CASE("Vertices are fetched in the order they are first used, and unused ones dropped", "[optimize]") {
+    for (auto mesh : meshes()) {
+        // A few vertices that nothing draws, between and after the ones that are.
+        const size_t used = mesh.vertices.size();
+        mesh.vertices.insert(mesh.vertices.begin() + 10, 3, Geo::VertexAll { { 100, 100, 100 }, {}, {} });
+        for (auto& index : mesh.indices)
+            if (index >= 10) index += 3;
+        mesh.vertices.push_back({ { -100, 0, 0 }, {}, {} });
+
+        const auto before = triangles(mesh.indices, mesh.vertices);
+        optimizeVertexFetch(mesh.indices, mesh.vertices);
+
+        REQUIRE(mesh.vertices.size() == used);
+        REQUIRE(triangles(mesh.indices, mesh.vertices) == before);
+
+        uint32_t next = 0;
+        size_t outOfOrder = 0;
+        for (const uint32_t index : mesh.indices) {
+            if (index == next) next++;
+            else outOfOrder += index > next;
+        }
+        REQUIRE(outOfOrder == 0);
+        REQUIRE(next == used);
+    }
+}
+
+TEST_CASE("Optimizing a mesh never makes its cache use worse", "[optimize]") {
+    const auto all = meshes();
+    for (size_t i = 0; i < all.size(); i++) {
+        auto mesh = all[i];
+        const auto before = triangles(mesh.indices, mesh.vertices);
+
+        const auto report = optimizeMesh(mesh.indices, mesh.vertices);
+        REQUIRE(triangles(mesh.indices, mesh.vertices) == before);
+        REQUIRE(report.after.acmr <= report.before.acmr);
+        REQUIRE(report.after.acmr == analyzeVertexCache(mesh.indices, mesh.vertices.size()).acmr);
+        REQUIRE(report.after.atvr == Approx(analyzeVertexCache(mesh.indices, mesh.vertices.size()).atvr));
+
+        // Shuffled triangles start far from ideal, and end close to it.
+        if (i >= 2) {
+            REQUIRE(report.before.acmr > 1.5f);
+            REQUIRE(report.after.acmr < 0.8f);
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#include "catch2/catch.hpp"
+#include "temp/model/MeshQuantizer.h"
+#include "TestMeshes.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace vlkxtemp;
+
+namespace {
+    // What a shader does with a packed vertex, as described on Geo::VertexPacked.
+    glm::vec3 position(const Geo::VertexPacked& vertex, const Geo::VertexPacked::Dequantization& d) {
+        glm::vec3 out;
+        for (int axis = 0; axis < 3; axis++)
+            out[axis] = float(vertex.position[axis]) / 65535 * d.positionScale[axis] + d.positionOffset[axis];
+        return out;
+    }
+
+    glm::vec2 texture(const Geo::VertexPacked& vertex, const Geo::VertexPacked::Dequantization& d) {
+        return { float(vertex.texture[0]) / 65535 * d.texture.x + d.texture.z, float(vertex.texture[1]) / 65535 * d.texture.y + d.texture.w };
+    }
+
+    glm::vec3 normal(const Geo::VertexPacked& vertex) {
+        const float x = std::max(float(vertex.normal[0]) / 32767, -1.0f), y = std::max(float(vertex.normal[1]) / 32767, -1.0f);
+        glm::vec3 n { x, y, 1 - std::abs(x) - std::abs(y) };
+        if (n.z < 0) {
+            n.x = (1 - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+            n.y = (1 - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+        }
+        const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        return { n.x / length, n.y / length, n.z / length };
+    }
+}
+
+TEST_CASE("Quantization bounds cover every vertex", "[quantize]") {
+    const std::vector<Geo::VertexAll> vertices {
+        { { -1, 2, 3 }, {}, { 0.5f, -1 } },
+        { { 4, -5, 6 }, {}, { 2, 0.25f } },
+        { { 0, 0, -7 }, {}, { 1, 1 } },
+    };
+    const auto bounds = quantizationBounds(vertices);
+    REQUIRE(bounds.min[0] == -1);
+    REQUIRE(bounds.min[1] == -5);
+    REQUIRE(bounds.min[2] == -7);
+    REQUIRE(bounds.max[0] == 4);
+    REQUIRE(bounds.max[1] == 2);
+    REQUIRE(bounds.max[2] == 6);
+    REQUIRE(bounds.textureMin[0] == 0.5f);
+    REQUIRE(bounds.textureMin[1] == -1);
+    REQUIRE(bounds.textureMax[0] == 2);
+    REQUIRE(bounds.textureMax[1] == 1);
+
+    const auto empty = quantizationBounds({});
+    REQUIRE(empty.min[0] == 0);
+    REQUIRE(empty.max[0] == 0);
+}
+
+TEST_CASE("Packed vertices unpack to within one step of where they were", "[quantize]") {
+    const auto mesh = testmeshes::sphere(24, 48);
+    const auto bounds = quantizationBounds(mesh.vertices);
+    const auto packed = packVertices(mesh.vertices, bounds);
+    const auto d = dequantization(bounds);
+    REQUIRE(packed.size() == mesh.vertices.size());
+
+    float worstPosition[3] = {}, worstTexture[2] = {}, worstNormal = 0;
+    for (size_t i = 0; i < packed.size(); i++) {
+        const auto& original = mesh.vertices[i];
+        const auto p = position(packed[i], d);
+        const auto t = texture(packed[i], d);
+        const auto n = normal(packed[i]);
+        for (int axis = 0; axis < 3; axis++)
+            worstPosition[axis] = std::max(worstPosition[axis], std::abs(p[axis] - original.position[axis]));
+        for (int axis = 0; axis < 2; axis++)
+            worstTexture[axis] = std::max(worstTexture[axis], std::abs(t[axis] - original.texture[axis]));
+        for (int axis = 0; axis < 3; axis++)
+            worstNormal = std::max(worstNormal, std::abs(n[axis] - original.normal[axis]));
+        REQUIRE(packed[i].position[3] == 0);
+    }
+
+    // Half a step, and a little for float rounding.
+    for (int axis = 0; axis < 3; axis++)
+        REQUIRE(worstPosition[axis] <= (bounds.max[axis] - bounds.min[axis]) / 131070 * 1.01f);
+    for (int axis = 0; axis < 2; axis++)
+        REQUIRE(worstTexture[axis] <= (bounds.textureMax[axis] - bounds.textureMin[axis]) / 131070 * 1.01f);
+    // 16-bit octahedral normals are good to a few thousandths of a degree.
+    REQUIRE(worstNormal < 1e-4f);
+}
+
+TEST_CASE("Octahedral normals survive every direction, including the folded half", "[quantize]") {
+    const std::vector<glm::vec3> directions {
+        { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 },
+        { 0.577350f, 0.577350f, -0.577350f }, { -0.577350f, -0.577350f, -0.577350f }, { 0.6f, -0.8f, 0 },
+    };
+    for (const auto& direction : directions) {
+        const Geo::VertexAll vertex { {}, direction, {} };
+        const auto n = normal(packVertices(std::span(&vertex, 1), quantizationBounds(std::span(&vertex, 1)))[0]);
+        REQUIRE(n.x == Approx(direction.x).margin(1e-4));
+        REQUIRE(n.y == Approx(direction.y).margin(1e-4));
+        REQUIRE(n.z == Approx(direction.z).margin(1e-4));
+    }
+
+    // A missing normal packs as something, rather than as NaN.
+    const Geo::VertexAll zero { {}, {}, {} };
+    const auto packed = packVertices(std::span(&zero, 1), quantizationBounds(std::span(&zero, 1)));
+    REQUIRE(packed[0].normal[0] == 0);
+    REQUIRE(packed[0].normal[1] == 0);
+}
+
+TEST_CASE("A mesh that is flat on an axis still packs", "[quantize]") {
+    const auto mesh = testmeshes::grid(10);
+    const auto bounds = quantizationBounds(mesh.vertices);
+    const auto packed = packVertices(mesh.vertices, bounds);
+    const auto d = dequantization(bounds);
+
+    REQUIRE(d.positionScale[2] == 1);
+    for (size_t i = 0; i < packed.size(); i++) {
+        const auto p = position(packed[i], d);
+        REQUIRE_FALSE(std::isnan(p.z));
+        REQUIRE(p.z == 0);
+        REQUIRE(p.x == Approx(mesh.vertices[i].position.x).margin(1e-3));
+    }
+}
+
+TEST_CASE("Indices narrow to 16 bits only when they fit", "[quantize]") {
+    REQUIRE(fitsShortIndices(0));
+    REQUIRE(fitsShortIndices(65536));
+    REQUIRE_FALSE(fitsShortIndices(65537));
+
+    const std::vector<uint32_t> fits { 0, 1, 65535 };
+    REQUIRE(narrowIndices(fits) == std::vector<uint16_t> { 0, 1, 65535 });
+    REQUIRE(narrowIndices({}).empty());
+
+    const std::vector<uint32_t> tooBig { 0, 65536, 1 };
+    REQUIRE_THROWS_WITH(narrowIndices(tooBig), Catch::Contains("65536"));
+}
@@ -0,0 +1,113 @@
+// Times the flat containers against the std containers they replace.
+// Build the shadow-utility-bench target in a Release build, and run it with no arguments.
+
+#include <shadow/util/FlatHashMap.h>
+#include <shadow/util/FlatMap.h>
+#include <shadow/util/SmallVector.h>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // Keeps the optimizer from removing work whose result is never used.
+    volatile uint64_t sink;
+
+    template<typename F>
+    double milliseconds(F&& work) {
+        const auto start = std::chrono::steady_clock::now();
+        work();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(const char* name, const char* stdName, double stdTime, const char* flatName, double flatTime) {
+        std::printf("%-34s %-14s %6.0fms   %-16s %6.0fms\n", name, stdName, stdTime, flatName, flatTime);
+    }
+
+    std::vector<uint64_t> randomKeys(size_t count, uint64_t seed) {
+        std::mt19937_64 random(seed);
+        std::vector<uint64_t> keys(count);
+        for (auto& key : keys) key = random();
+        return keys;
+    }
+
+    template<typename Map>
+    double timeInserts(const std::vector<uint64_t>& keys) {
+        return milliseconds([&]() {
+            Map map;
+            for (size_t i = 0; i < keys.size(); i++) map[keys[i]] = i;
+            sink = map.size();
+        });
+    }
+
+    template<typename Map>
+    double timeLookups(const std::vector<uint64_t>& keys, const std::vector<uint32_t>& order) {
+        Map map;
+        for (size_t i = 0; i < keys.size(); i++) map[keys[i]] = i;
+        return milliseconds([&]() {
+            uint64_t sum = 0;
+            for (const auto index : order) sum += map.find(keys[index])->second;
+            sink = sum;
+        });
+    }
+
+    template<typename Map>
+    double timeIteration(const std::vector<uint64_t>& keys, size_t passes) {
+        Map map;
+        for (size_t i = 0; i < keys.size(); i++) map[keys[i]] = i;
+        return milliseconds([&]() {
+            uint64_t sum = 0;
+            for (size_t pass = 0; pass < passes; pass++)
+                for (const auto& [key, value] : map) sum += key ^ value;
+            sink = sum;
+        });
+    }
+
+    template<typename Vector>
+    double timeSmallVectors(size_t count) {
+        return milliseconds([&]() {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < count; i++) {
+                Vector vector;
+                for (uint64_t j = 0; j < 3; j++) vector.push_back(i + j);
+                sum += vector[2];
+            }
+            sink = sum;
+        });
+    }
+
+    std::vector<uint32_t> randomOrder(size_t count, size_t range, uint64_t seed) {
+        std::mt19937 random(seed);
+        std::vector<uint32_t> order(count);
+        for (auto& index : order) index = static_cast<uint32_t>(random() % range);
+        return order;
+    }
+}
+
+int main() {
+    using namespace shadowutil;
+
+    const auto large = randomKeys(64 * 1024, 1);
+    const auto largeOrder = randomOrder(4 * 1024 * 1024, large.size(), 2);
+    report("64k u64 keys, 4M random lookups:",
+           "unordered_map", timeLookups<std::unordered_map<uint64_t, uint64_t>>(large, largeOrder),
+           "FlatHashMap", timeLookups<FlatHashMap<uint64_t, uint64_t>>(large, largeOrder));
+    report("64k inserts:",
+           "unordered_map", timeInserts<std::unordered_map<uint64_t, uint64_t>>(large),
+           "FlatHashMap", timeInserts<FlatHashMap<uint64_t, uint64_t>>(large));
+
+    const auto small = randomKeys(16, 3);
+    const auto smallOrder = randomOrder(4 * 1024 * 1024, small.size(), 4);
+    report("16-entry map, 4M lookups:",
+           "std::map", timeLookups<std::map<uint64_t, uint64_t>>(small, smallOrder),
+           "FlatMap", timeLookups<FlatMap<uint64_t, uint64_t>>(small, smallOrder));
+    report("16-entry map, iterate:",
+           "std::map", timeIteration<std::map<uint64_t, uint64_t>>(small, 1024 * 1024),
+           "FlatMap", timeIteration<FlatMap<uint64_t, uint64_t>>(small, 1024 * 1024));
+
+    report("1M 3-element vectors:",
+           "std::vector", timeSmallVectors<std::vector<uint64_t>>(1024 * 1024),
+           "SmallVector<4>", timeSmallVectors<SmallVector<uint64_t, 4>>(1024 * 1024));
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+
+namespace shadowutil {
+
+    // Reads files in the background, so that assets can stream in while frames keep running.
+    // Reads go straight into memory the caller provides (which may be a mapped staging buffer), so the data is
+    //  never copied after it leaves the kernel.
+    //
+    // On Linux, reads are batched into an io_uring and the kernel completes them without any thread blocking.
+    // Elsewhere, or where io_uring is unavailable, a small pool of I/O threads performs blocking reads instead.
+    //
+    // Completion can be observed three ways: polling or waiting on the Ticket, or a callback.
+    // Callbacks run inside poll(), on the thread that calls it; the engine polls once per frame on the main thread,
+    //  so callbacks are free to touch renderer state.
+    class AsyncIO {
+    public:
+        enum class Backend { Auto, IOUring, Threads };
+
+        enum class Status : uint8_t { Pending, Complete, Failed, Cancelled };
+
+        struct Result {
+            Status status = Status::Pending;
+            size_t bytes = 0;           // Bytes read. Less than requested if the file ended first.
+            std::string error;          // Why it failed, if it did
+        };
+
+        using Callback = std::function<void(const Result&)>;
+
+        struct Request {
+            std::string path;
+            std::span<std::byte> into;  // Must stay alive until the read completes or is cancelled
+            uint64_t offset = 0;
+            Priority priority = Priority::Normal;
+            Callback onComplete;        // Optional
+        };
+
+        struct State;
+
+        // A handle to one read in flight.
+        class Ticket {
+        public:
+            Ticket() = default;
+
+            Status status() const;
+            bool done() const { return status() != Status::Pending; }
+
+            // Block until the read finishes, is cancelled or fails.
+            const Result& wait() const;
+
+            // Stop the read if it has not started yet; ask the kernel to abandon it if it has.
+            // A read that is already underway may still complete; check the status afterwards.
+            void cancel();
+
+            explicit operator bool() const { return state != nullptr; }
+
+        private:
+            friend class AsyncIO;
+            Ticket(std::shared_ptr<State> state, AsyncIO* owner) : state(std::move(state)), owner(owner) {}
+
+            std::shared_ptr<State> state;
+            AsyncIO* owner = nullptr;
+        };
+
+        explicit AsyncIO(Backend backend = Backend::Auto);
+
+        AsyncIO(const AsyncIO&) = delete;
+        AsyncIO& operator=(const AsyncIO&) = delete;
+
+        // Cancels everything still queued, and waits for reads already in the kernel to finish.
+        ~AsyncIO();
+
+        Ticket read(Request request);
+
+        // Queue several reads at once. With io_uring, they go to the kernel in a single submission.
+        std::vector<Ticket> read(std::vector<Request> requests);
+
+        // Run the callbacks of reads that have finished since the last poll. Returns how many ran.
+        size_t poll();
+
+        // Which backend ended up being used.
+        Backend getBackend() const;
+
+        // The size of a file, for sizing the buffer to read it into.
+        static uint64_t fileSize(const std::string& path);
+
+        // The engine's shared instance. Created on first use.
+        static AsyncIO& get();
+
+        class Engine;
+    private:
+        void finish(const std::shared_ptr<State>& state, Result result);
+
+        std::unique_ptr<Engine> engine;
+        std::mutex finishedLock;
+        std::vector<std::shared_ptr<State>> finished;
+    };
+}
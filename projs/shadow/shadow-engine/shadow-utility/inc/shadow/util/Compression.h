@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace shadowutil {
+
+    class ThreadPool;
+
+    // The "compression" field of a package entry's metadata.
+    enum class Compression : uint32_t {
+        None = 1,       // The payload is stored as-is
+        Blocks = 2      // The payload is a block stream; see compressBlocks
+    };
+
+    // A byte-oriented LZ77 codec, producing the LZ4 block format.
+    // It trades ratio for speed: decoding runs at memory bandwidth, which is what matters for loading assets.
+    namespace lz {
+        // The largest output compress can produce for an input of this size.
+        size_t compressBound(size_t size);
+
+        // Compress into out, which must be at least compressBound(in.size()) bytes. Returns the bytes written.
+        size_t compress(std::span<const std::byte> in, std::span<std::byte> out);
+
+        // Decompress into out, which must be exactly the original size.
+        // Malformed input throws std::runtime_error; it never reads or writes out of bounds.
+        void decompress(std::span<const std::byte> in, std::span<std::byte> out);
+    }
+
+    // Large payloads are split into independently compressed blocks, so that they can be decoded in parallel.
+    // A block stream is laid out as (all little-endian):
+    //   u64 original size, u32 block size, u32 block count, u32 compressed size of each block, then the blocks.
+    // Every block but the last holds block size bytes of the original. A block whose compressed size equals
+    //  its original size is stored raw, because it did not compress.
+    constexpr uint32_t defaultBlockSize = 128 * 1024;
+
+    // Compress a whole payload into a block stream, using the pool to compress blocks in parallel.
+    std::vector<std::byte> compressBlocks(std::span<const std::byte> in, uint32_t blockSize = defaultBlockSize);
+    std::vector<std::byte> compressBlocks(std::span<const std::byte> in, uint32_t blockSize, ThreadPool& pool);
+
+    // The original size of a block stream.
+    uint64_t decompressedSize(std::span<const std::byte> stream);
+
+    // Decode a block stream straight into out, which must be exactly decompressedSize(stream) bytes.
+    // Blocks are decoded across the pool; the calling thread takes part.
+    void decompressBlocks(std::span<const std::byte> stream, std::span<std::byte> out);
+    void decompressBlocks(std::span<const std::byte> stream, std::span<std::byte> out, ThreadPool& pool);
+}
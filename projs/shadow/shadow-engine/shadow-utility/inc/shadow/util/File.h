@@ -1,13 +1,52 @@
 #pragma once
+#include <cstddef>
+#include <span>
 #include <string>
-#include <vector>
+#include <string_view>
 namespace shadowutil {
 
-    struct FileData {
-        size_t size;
-        std::vector<char> data;
+    // A whole file mapped read-only into memory.
+    // The contents are paged in by the OS as they are touched, rather than copied into a buffer up front.
+    // The mapping starts on a page boundary, so it is suitably aligned for any type.
+    class MappedFile {
+    public:
+        // How the file is going to be read; passed to the OS as a paging hint.
+        enum class Access {
+            Sequential,     // Read front to back once (shaders, images, models). Read-ahead is aggressive.
+            Random          // Jumped around in (archives). Read-ahead is disabled.
+        };
+
+        MappedFile() = default;
+        explicit MappedFile(const std::string& path, Access access = Access::Sequential);
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        std::span<const std::byte> data() const { return { begin, length }; }
+        // The contents, for text formats.
+        std::string_view text() const { return { reinterpret_cast<const char*>(begin), length }; }
+        size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+
+        // Ask the OS to start paging in the given range now, ahead of it being read.
+        void prefetch(size_t offset, size_t bytes) const;
+
+    private:
+        void close();
+
+        const std::byte* begin = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        void* mapping = nullptr;
+#endif
     };
 
+    // Map the file at the given path for reading from front to back, and page all of it in.
+    // Records an AssetLoad event covering the open and the reads.
     // A testing stub; this should be deleted and wired into the asset system once that becomes ready.
-    FileData* loadFile(std::string path);
-}
\ No newline at end of file
+    MappedFile loadFile(const std::string& path);
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace shadowutil {
+
+    // An unordered map that keeps every entry in one flat array, using open addressing with linear probing.
+    // Lookups touch one or two cache lines instead of chasing a bucket's linked list, which is where
+    //  std::unordered_map spends most of its time for small keys.
+    //
+    // Entries are moved when the table grows or when an erase closes the gap behind it,
+    //  so pointers and iterators are invalidated by any insert or erase.
+    // Iteration order is unspecified. Keys must not be changed through an iterator.
+    template<typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+    class FlatHashMap {
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+
+        template<bool Const>
+        class Iterator {
+            using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+        public:
+            using value_type = FlatHashMap::value_type;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::forward_iterator_tag;
+
+            Iterator() = default;
+            Iterator(Map* map, size_t index) : map(map), index(index) { skip(); }
+            // Allow iterator -> const_iterator
+            operator Iterator<true>() const { return { map, index }; }
+
+            reference operator*() const { return map->slots[index]; }
+            pointer operator->() const { return &map->slots[index]; }
+
+            Iterator& operator++() { ++index; skip(); return *this; }
+            Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+
+            bool operator==(const Iterator& other) const { return index == other.index; }
+
+        private:
+            friend class FlatHashMap;
+
+            void skip() { while (index < map->capacity && !map->used[index]) ++index; }
+
+            Map* map = nullptr;
+            size_t index = 0;
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        FlatHashMap() = default;
+
+        // For hashers or comparisons that carry state, eg. a seed.
+        explicit FlatHashMap(const Hash& hash, const Equal& equal = Equal()) : hasher(hash), equal(equal) {}
+
+        FlatHashMap(std::initializer_list<value_type> values) {
+            reserve(values.size());
+            for (const auto& value : values) insert(value);
+        }
+
+        FlatHashMap(const FlatHashMap& other) : hasher(other.hasher), equal(other.equal) {
+            reserve(other.count);
+            for (const auto& value : other) insert(value);
+        }
+
+        FlatHashMap(FlatHashMap&& other) noexcept { swap(other); }
+
+        FlatHashMap& operator=(FlatHashMap other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~FlatHashMap() {
+            clear();
+            release();
+        }
+
+        void swap(FlatHashMap& other) noexcept {
+            std::swap(slots, other.slots);
+            std::swap(used, other.used);
+            std::swap(capacity, other.capacity);
+            std::swap(count, other.count);
+            std::swap(hasher, other.hasher);
+            std::swap(equal, other.equal);
+        }
+
+        iterator begin() { return { this, 0 }; }
+        iterator end() { return { this, capacity }; }
+        const_iterator begin() const { return { this, 0 }; }
+        const_iterator end() const { return { this, capacity }; }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        Hash hash_function() const { return hasher; }
+        Equal key_eq() const { return equal; }
+
+        iterator find(const K& key) {
+            return { this, locate(key) };
+        }
+
+        const_iterator find(const K& key) const {
+            return { this, locate(key) };
+        }
+
+        bool contains(const K& key) const { return locate(key) != capacity; }
+
+        V& at(const K& key) {
+            const size_t index = locate(key);
+            if (index == capacity) throw std::out_of_range("FlatHashMap::at: key not present");
+            return slots[index].second;
+        }
+
+        const V& at(const K& key) const {
+            const size_t index = locate(key);
+            if (index == capacity) throw std::out_of_range("FlatHashMap::at: key not present");
+            return slots[index].second;
+        }
+
+        V& operator[](const K& key) { return try_emplace(key).first->second; }
+        V& operator[](K&& key) { return try_emplace(std::move(key)).first->second; }
+
+        // Insert a value constructed from args, if the key is not already present.
+        // Returns the entry for the key, and whether it was inserted.
+        template<typename KeyArg, typename... Args>
+        std::pair<iterator, bool> try_emplace(KeyArg&& key, Args&&... args) {
+            if (size_t index = locate(key); index != capacity)
+                return { { this, index }, false };
+
+            if ((count + 1) * 4 > capacity * 3)
+                rehash(capacity == 0 ? 8 : capacity * 2);
+
+            const size_t index = probeFree(key);
+            std::construct_at(&slots[index], std::piecewise_construct,
+                              std::forward_as_tuple(std::forward<KeyArg>(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+            used[index] = 1;
+            ++count;
+            return { { this, index }, true };
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(std::move(value.first), std::move(value.second)); }
+
+        template<typename KeyArg, typename... Args>
+        std::pair<iterator, bool> emplace(KeyArg&& key, Args&&... args) {
+            return try_emplace(std::forward<KeyArg>(key), std::forward<Args>(args)...);
+        }
+
+        // Remove the key, returning the number of entries removed.
+        size_t erase(const K& key) {
+            const size_t index = locate(key);
+            if (index == capacity) return 0;
+            eraseAt(index);
+            return 1;
+        }
+
+        void erase(const_iterator iter) { eraseAt(iter.index); }
+
+        void clear() {
+            if constexpr (!std::is_trivially_destructible_v<value_type>)
+                for (size_t i = 0; i < capacity; ++i)
+                    if (used[i]) std::destroy_at(&slots[i]);
+            std::fill(used.begin(), used.end(), 0);
+            count = 0;
+        }
+
+        // Make room for the given number of entries without growing.
+        void reserve(size_t entries) {
+            size_t wanted = 8;
+            while (wanted * 3 < entries * 4) wanted *= 2;
+            if (wanted > capacity) rehash(wanted);
+        }
+
+    private:
+        // Spread the hash over the whole table; std::hash is the identity for integers on most standard libraries.
+        size_t home(const K& key) const {
+            const uint64_t mixed = static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(mixed >> 32) & (capacity - 1);
+        }
+
+        size_t locate(const K& key) const {
+            if (count == 0) return capacity;
+            for (size_t i = home(key); used[i]; i = (i + 1) & (capacity - 1))
+                if (equal(slots[i].first, key)) return i;
+            return capacity;
+        }
+
+        size_t probeFree(const K& key) const {
+            size_t i = home(key);
+            while (used[i]) i = (i + 1) & (capacity - 1);
+            return i;
+        }
+
+        // Remove by shifting later members of the probe run back into the hole, so no tombstones are needed.
+        void eraseAt(size_t hole) {
+            std::destroy_at(&slots[hole]);
+            used[hole] = 0;
+            --count;
+
+            const size_t mask = capacity - 1;
+            for (size_t next = (hole + 1) & mask; used[next]; next = (next + 1) & mask) {
+                // An entry can fill the hole only if its home is not cyclically within (hole, next].
+                const size_t want = home(slots[next].first);
+                const bool reachable = hole <= next ? (hole < want && want <= next) : (hole < want || want <= next);
+                if (reachable) continue;
+
+                std::construct_at(&slots[hole], std::move(slots[next]));
+                std::destroy_at(&slots[next]);
+                used[hole] = 1;
+                used[next] = 0;
+                hole = next;
+            }
+        }
+
+        void rehash(size_t newCapacity) {
+            value_type* oldSlots = slots;
+            std::vector<uint8_t> oldUsed = std::move(used);
+            const size_t oldCapacity = capacity;
+
+            slots = std::allocator<value_type>().allocate(newCapacity);
+            used.assign(newCapacity, 0);
+            capacity = newCapacity;
+
+            for (size_t i = 0; i < oldCapacity; ++i) {
+                if (!oldUsed[i]) continue;
+                const size_t index = probeFree(oldSlots[i].first);
+                std::construct_at(&slots[index], std::move(oldSlots[i]));
+                std::destroy_at(&oldSlots[i]);
+                used[index] = 1;
+            }
+
+            if (oldSlots) std::allocator<value_type>().deallocate(oldSlots, oldCapacity);
+        }
+
+        void release() {
+            if (slots) std::allocator<value_type>().deallocate(slots, capacity);
+            slots = nullptr;
+            used.clear();
+            capacity = 0;
+        }
+
+        value_type* slots = nullptr;
+        std::vector<uint8_t> used;
+        size_t capacity = 0;            // Always zero or a power of two
+        size_t count = 0;
+        [[no_unique_address]] Hash hasher;
+        [[no_unique_address]] Equal equal;
+    };
+}
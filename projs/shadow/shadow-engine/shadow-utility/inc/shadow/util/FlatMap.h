@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace shadowutil {
+
+    // An ordered map stored as a sorted vector of pairs.
+    // For the small maps built once and then mostly read (render pass descriptions, descriptor bindings),
+    //  a binary search over contiguous memory beats walking the nodes of a std::map, and iterating is a linear scan.
+    // Inserting and erasing are linear in the size of the map, so keep it out of large, frequently modified sets.
+    //
+    // Like a vector, any insert or erase invalidates iterators. Keys must not be changed through an iterator.
+    template<typename K, typename V, typename Compare = std::less<K>>
+    class FlatMap {
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+        FlatMap() = default;
+
+        FlatMap(std::initializer_list<value_type> values) {
+            reserve(values.size());
+            for (const auto& value : values) insert(value);
+        }
+
+        iterator begin() { return values.begin(); }
+        iterator end() { return values.end(); }
+        const_iterator begin() const { return values.begin(); }
+        const_iterator end() const { return values.end(); }
+        auto rbegin() { return values.rbegin(); }
+        auto rend() { return values.rend(); }
+        auto rbegin() const { return values.rbegin(); }
+        auto rend() const { return values.rend(); }
+
+        size_t size() const { return values.size(); }
+        bool empty() const { return values.empty(); }
+        void reserve(size_t count) { values.reserve(count); }
+        void clear() { values.clear(); }
+
+        // The first entry whose key is not less than the given key.
+        iterator lower_bound(const K& key) {
+            return std::lower_bound(values.begin(), values.end(), key, [this](const value_type& value, const K& k) { return less(value.first, k); });
+        }
+
+        const_iterator lower_bound(const K& key) const {
+            return std::lower_bound(values.begin(), values.end(), key, [this](const value_type& value, const K& k) { return less(value.first, k); });
+        }
+
+        iterator find(const K& key) {
+            auto iter = lower_bound(key);
+            return iter != values.end() && !less(key, iter->first) ? iter : values.end();
+        }
+
+        const_iterator find(const K& key) const {
+            auto iter = lower_bound(key);
+            return iter != values.end() && !less(key, iter->first) ? iter : values.end();
+        }
+
+        bool contains(const K& key) const { return find(key) != values.end(); }
+
+        V& at(const K& key) {
+            auto iter = find(key);
+            if (iter == values.end()) throw std::out_of_range("FlatMap::at: key not present");
+            return iter->second;
+        }
+
+        const V& at(const K& key) const {
+            auto iter = find(key);
+            if (iter == values.end()) throw std::out_of_range("FlatMap::at: key not present");
+            return iter->second;
+        }
+
+        V& operator[](const K& key) { return try_emplace(key).first->second; }
+
+        // Insert a value constructed from args, if the key is not already present.
+        // Returns the entry for the key, and whether it was inserted.
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+            auto iter = lower_bound(key);
+            if (iter != values.end() && !less(key, iter->first))
+                return { iter, false };
+
+            iter = values.emplace(iter, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+            return { iter, true };
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(value.first, std::move(value.second)); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(const K& key, Args&&... args) {
+            return try_emplace(key, std::forward<Args>(args)...);
+        }
+
+        // Remove the key, returning the number of entries removed.
+        size_t erase(const K& key) {
+            auto iter = find(key);
+            if (iter == values.end()) return 0;
+            values.erase(iter);
+            return 1;
+        }
+
+        iterator erase(const_iterator iter) { return values.erase(iter); }
+
+    private:
+        std::vector<value_type> values;
+        [[no_unique_address]] Compare less;
+    };
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace shadowutil {
+
+    // An always-on record of the last few seconds of engine activity.
+    // Zone timings, allocations and asset loads are written into a fixed-size ring; nothing is allocated, locked or
+    //  formatted on the recording path, so this can be left running in release builds.
+    // When a frame takes longer than the configured budget, the frames leading up to it are written out as a
+    //  Chrome trace file (open with chrome://tracing or ui.perfetto.dev).
+    class FlightRecorder {
+    public:
+        enum class EventType : uint8_t {
+            Zone,       // A named, timed scope
+            Allocation, // A memory allocation of `value` bytes
+            AssetLoad,  // A file read of `value` bytes
+            Frame       // A full frame
+        };
+
+        // A single entry in the ring.
+        // Zone names are static strings, so only the pointer is stored.
+        // Asset paths are not, so the tail of the path is copied into the label.
+        struct alignas(64) Event {
+            std::atomic<uint64_t> sequence;
+            uint64_t start;
+            uint64_t duration;
+            uint64_t value;
+            const char* name;
+            uint32_t frame;
+            uint32_t thread;
+            EventType type;
+            char label[71];
+        };
+
+        struct Config {
+            double budgetMs = 33.3;         // Frames slower than this trigger a trace dump
+            uint32_t historyFrames = 180;   // How many frames before the spike are written out
+            std::string outputDir = "traces";
+            bool enabled = true;
+        };
+
+        // Times the enclosing scope.
+        // Use like lock_guard; `name` must outlive the recorder (ie. a string literal).
+        class Zone {
+        public:
+            explicit Zone(const char* name) : name(name), start(now()) {}
+
+            Zone(const Zone&) = delete;
+            Zone& operator=(const Zone&) = delete;
+
+            ~Zone() { recordZone(name, start, now()); }
+
+        private:
+            const char* name;
+            uint64_t start;
+        };
+
+        static void configure(const Config& config);
+        static const Config& getConfig();
+
+        // Nanoseconds since the recorder was started.
+        static uint64_t now();
+
+        static void recordZone(const char* name, uint64_t start, uint64_t end);
+        static void recordAllocation(const char* name, uint64_t bytes);
+        static void recordAssetLoad(std::string_view path, uint64_t bytes, uint64_t start, uint64_t end);
+
+        // Mark the frame boundaries. Call once per iteration of the main loop.
+        // endFrame checks the frame against the budget, and if it went over, copies out the history and writes the
+        //  trace on another thread.
+        static void beginFrame();
+        static void endFrame();
+
+        // Write every event of the last `frames` frames to the given file.
+        static bool dump(const std::string& path, uint32_t frames);
+
+        static uint32_t getFrame();
+        static double getLastFrameMs();
+        static uint32_t getSpikeCount();
+    };
+}
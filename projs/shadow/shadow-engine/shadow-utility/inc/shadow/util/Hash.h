@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace shadowutil {
+
+    // 64-bit FNV-1a.
+    // Not cryptographic, but stable across compilers, platforms and runs, and usable in constant expressions.
+    // Anything that needs an identifier that survives being written to disk or passed between modules should use this.
+    constexpr uint64_t fnvOffset = 0xcbf29ce484222325ull;
+    constexpr uint64_t fnvPrime = 0x100000001b3ull;
+
+    constexpr uint64_t fnv1a64(std::string_view str, uint64_t hash = fnvOffset) {
+        for (char c : str) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= fnvPrime;
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace shadowutil {
+
+    // A parsed JSON document.
+    // Only meant for the small metadata headers in asset packages and similar; it favours simplicity over speed.
+    // Objects keep their keys in file order, and are searched linearly.
+    class JsonValue {
+    public:
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        using Array = std::vector<JsonValue>;
+        using Object = std::vector<std::pair<std::string, JsonValue>>;
+
+        JsonValue() = default;
+        JsonValue(bool value) : value(value) {}
+        JsonValue(double value) : value(value) {}
+        JsonValue(std::string value) : value(std::move(value)) {}
+        JsonValue(const char* value) : value(std::string(value)) {}
+        JsonValue(Array value) : value(std::move(value)) {}
+        JsonValue(Object value) : value(std::move(value)) {}
+
+        // Parse a whole document. Throws std::runtime_error, with the offset of the problem, if it is malformed.
+        static JsonValue parse(std::string_view text);
+
+        Type type() const { return static_cast<Type>(value.index()); }
+        bool isNull() const { return type() == Type::Null; }
+
+        // These throw if the value is of a different type.
+        bool asBool() const;
+        double asNumber() const;
+        int64_t asInt() const;
+        const std::string& asString() const;
+        const Array& asArray() const;
+        const Object& asObject() const;
+
+        // The member with the given key, or nullptr if this is not an object or has no such member.
+        const JsonValue* find(std::string_view key) const;
+
+        // The member with the given key; throws if it is missing.
+        const JsonValue& operator[](std::string_view key) const;
+        const JsonValue& operator[](size_t index) const { return asArray().at(index); }
+
+        // A numeric member, or the fallback if it is missing.
+        int64_t getInt(std::string_view key, int64_t fallback) const {
+            const JsonValue* member = find(key);
+            return member ? member->asInt() : fallback;
+        }
+
+    private:
+        std::variant<std::monostate, bool, double, std::string, Array, Object> value;
+    };
+}
@@ -1,8 +1,17 @@
 #pragma once
 
-#include <string>
-#include <map>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <optional>
+#include <vector>
+#include "FlatHashMap.h"
+#include "SlotMap.h"
+#include "StringId.h"
 
 namespace shadowutil {
 
@@ -10,9 +19,36 @@ namespace shadowutil {
     // References to this object are counted, and the object will be destructed when there are no references.
     // This allows for automatic, safe and leak-free handling of all kinds of resources.
     // The AutoRelease behaviour can be adjusted.
+    //
+    // Objects can also be kept after their last reference is dropped, for as long as they fit in a retention budget.
+    // Unreferenced objects are evicted least-recently-used first. An object reports its size with a
+    //  `size_t memorySize() const` member; objects without one count as sizeof(ObjectType).
+    //
+    // Safe to use from any thread. Objects are stored in a set of independently locked shards, so loads of different
+    //  objects rarely contend, and each handle holds its entry directly so copies and releases never search the map.
+    // Each shard keeps its entries in a SlotMap; the identifier is only used to find an object the first time.
+    // Identifiers are StringIds, so finding an object never compares strings.
     template <typename ObjectType>
     class RefCounter {
+        struct Entry;
+        using Storage = SlotMap<std::unique_ptr<Entry>>;
+
     public:
+        // Counters for tuning the retention budget.
+        struct Stats {
+            uint64_t hits;          // get() found the object already loaded
+            uint64_t misses;        // get() had to create the object
+            uint64_t evictions;     // Unreferenced objects destroyed to stay in budget
+            size_t cachedBytes;     // Size of the unreferenced objects being kept
+            size_t cachedObjects;
+        };
+
+        // A non-owning reference to a counted object.
+        // Doesn't keep the object alive; once it is destroyed, the handle no longer resolves.
+        struct Weak {
+            typename Storage::Handle slot;
+            uint32_t shard = 0;
+        };
 
         // Preserves ObjectType instances in the current scope.
         // Use like lock_guard; RAII allows precise scoping rules.
@@ -34,88 +70,315 @@ namespace shadowutil {
         // If exists, the object will be passed and reference counter increased.
         // Otherwise, args will be used to create.
         template<typename... Args>
-        static RefCounter get(const std::string& identifier, Args&&... args) {
-            auto iter = getMap().find(identifier);
-            if (iter == getMap().end()) {
-                const auto inserted = getMap().insert(
-                    {
-                        identifier,
-                        typename ObjectPool::CountedObject {
-                            std::make_unique<ObjectType>(std::forward<Args>(args)...), 0
-                        }
-                    }
-                );
-                iter = inserted.first;
+        static RefCounter get(StringId identifier, Args&&... args) {
+            return getOrCreate(identifier, [&]() { return std::make_unique<ObjectType>(std::forward<Args>(args)...); });
+        }
+
+        // As get, but the object is made by calling create(), which must return a std::unique_ptr<ObjectType>.
+        // create is only called if the object does not exist yet, so expensive preparation (eg. reading files) belongs in it.
+        // If several threads ask for the same new object at once, exactly one of them creates it and the rest wait.
+        template<typename Factory>
+        static RefCounter getOrCreate(StringId identifier, Factory&& create) {
+            const uint32_t shardIndex = shardFor(identifier);
+            Shard& shard = objectPool.shards[shardIndex];
+
+            Entry* entry;
+            {
+                std::scoped_lock lock(shard.lock);
+                auto [iter, inserted] = shard.index.try_emplace(identifier);
+                if (inserted) {
+                    auto created = std::make_unique<Entry>(identifier, shardIndex);
+                    entry = created.get();
+                    iter->second = shard.entries.insert(std::move(created));
+                    entry->slot = iter->second;
+                    objectPool.misses.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    entry = shard.entries.get(iter->second)->get();
+                    objectPool.hits.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                // Coming back from zero; it might be sitting in the retention cache.
+                if (entry->references.fetch_add(1, std::memory_order_relaxed) == 0)
+                    uncache(entry);
+            }
+
+            // The shard is unlocked while the object is created, so a slow load doesn't hold up anything else.
+            try {
+                std::call_once(entry->created, [&]() {
+                    entry->obj = create();
+                    entry->bytes = sizeOf(*entry->obj);
+                    entry->ready.store(true, std::memory_order_release);
+                });
+            } catch (...) {
+                // Give up our reference; the next caller will try to create it again.
+                release(entry);
+                throw;
             }
 
-            auto& object = iter->second;
-            ++object.references;
-            return RefCounter { identifier, object.obj.get() };
+            return RefCounter { entry };
         }
 
-        RefCounter(RefCounter&& other) noexcept {
-            identifier = std::move(other.identifier);
-            objectPtr = other.objectPtr;
-            other.identifier.clear();
+        RefCounter(RefCounter&& other) noexcept : entry(other.entry) {
+            other.entry = nullptr;
         }
 
         RefCounter& operator=(RefCounter&& other) noexcept {
-            std::swap(identifier, other.identifier);
-            std::swap(objectPtr, other.objectPtr);
+            std::swap(entry, other.entry);
             return *this;
         }
 
         // When we reach 0 references and there's no auto release system set up, destroy the object.
         ~RefCounter() {
-            if (identifier.empty()) return;
+            if (entry != nullptr)
+                release(entry);
+        }
+
+        // Get a weak reference to this object, to be turned back into a counted one with lock().
+        Weak weak() const {
+            return Weak { entry->slot, entry->shard };
+        }
+
+        // Take a new reference to the object behind a weak reference, if it still exists.
+        static std::optional<RefCounter> lock(const Weak& weak) {
+            if (weak.shard >= shardCount) return std::nullopt;
+            Shard& shard = objectPool.shards[weak.shard];
 
-            const auto iter = getMap().find(identifier);
-            if (--iter->second.references == 0 && objectPool.activePools == 0)
-                getMap().erase(iter);
+            std::scoped_lock lock(shard.lock);
+            auto* slot = shard.entries.get(weak.slot);
+            if (slot == nullptr) return std::nullopt;
+
+            Entry* entry = slot->get();
+            // An entry that is still being created (or whose creation failed) isn't handed out.
+            if (!entry->ready.load(std::memory_order_acquire)) return std::nullopt;
+            if (entry->references.fetch_add(1, std::memory_order_relaxed) == 0)
+                uncache(entry);
+            return RefCounter { entry };
         }
 
         // Smart pointer emulation overloads.
-        const ObjectType* operator->() const { return objectPtr; }
-        const ObjectType& operator*() const { return *objectPtr; }
+        const ObjectType* operator->() const { return entry->obj.get(); }
+        const ObjectType& operator*() const { return *entry->obj; }
+
+        static bool hasAutoRelease() { return objectPool.activePools.load(std::memory_order_relaxed) != 0; }
 
-        static bool hasAutoRelease() { return objectPool.activePools != 0; }
+        // Keep up to this many bytes of unreferenced objects around, in case they're wanted again.
+        // 0 (the default) destroys objects as soon as they're unreferenced, outside of AutoRelease scopes.
+        static void setRetentionBudget(size_t bytes) {
+            objectPool.budget.store(bytes, std::memory_order_relaxed);
+            trim();
+        }
+
+        static size_t getRetentionBudget() { return objectPool.budget.load(std::memory_order_relaxed); }
+
+        static Stats getStats() {
+            std::scoped_lock lock(objectPool.lru.lock);
+            return Stats {
+                objectPool.hits.load(std::memory_order_relaxed),
+                objectPool.misses.load(std::memory_order_relaxed),
+                objectPool.evictions.load(std::memory_order_relaxed),
+                objectPool.lru.bytes,
+                objectPool.lru.count
+            };
+        }
 
     private:
+        static constexpr size_t shardCount = 16;
+
+        struct Entry {
+            Entry(StringId identifier, uint32_t shard) : identifier(identifier), shard(shard) {}
+
+            StringId identifier;
+            uint32_t shard;
+            typename Storage::Handle slot;
+            std::atomic<size_t> references { 0 };
+            std::once_flag created;
+            std::atomic<bool> ready { false };
+            std::unique_ptr<ObjectType> obj;
+            size_t bytes = 0;
+
+            // Position in the retention cache. Guarded by the cache lock.
+            bool cached = false;
+            Entry* newer = nullptr;
+            Entry* older = nullptr;
+        };
+
+        struct Shard {
+            std::mutex lock;
+            Storage entries;
+            FlatHashMap<StringId, typename Storage::Handle> index;
+        };
+
+        // Unreferenced objects being kept in budget, most recently released first.
+        // Lock order is always shard, then cache.
+        struct RetentionCache {
+            std::mutex lock;
+            Entry* newest = nullptr;
+            Entry* oldest = nullptr;
+            size_t bytes = 0;
+            size_t count = 0;
+        };
+
         // The object pool that handles managing and counting objects.
         struct ObjectPool {
-            struct CountedObject {
-                std::unique_ptr<ObjectType> obj;
-                size_t references;
-            };
+            std::array<Shard, shardCount> shards;
+            std::atomic<size_t> activePools { 0 };
 
-            using RefCountMap = std::map<std::string, CountedObject>;
-
-            RefCountMap refCountMap;
-            size_t activePools = 0;
+            RetentionCache lru;
+            std::atomic<size_t> budget { 0 };
+            std::atomic<uint64_t> hits { 0 };
+            std::atomic<uint64_t> misses { 0 };
+            std::atomic<uint64_t> evictions { 0 };
         };
 
-        RefCounter(std::string identifier, const ObjectType* obj) : identifier(std::move(identifier)), objectPtr(obj) {}
+        explicit RefCounter(Entry* entry) : entry(entry) {}
 
-        static void unregisterAutoRelease() {
-            if (--objectPool.activePools == 0) {
-                using CountedObject = typename ObjectPool::CountedObject;
-                static const auto removeZeroRef = [](const std::pair<const std::string, CountedObject> &pair) {
-                    return pair.second.references == 0;
-                };
-                std::erase_if(getMap(), removeZeroRef);
+        static uint32_t shardFor(StringId identifier) {
+            return static_cast<uint32_t>((identifier.value() ^ (identifier.value() >> 32)) % shardCount);
+        }
+
+        static size_t sizeOf(const ObjectType& object) {
+            if constexpr (requires { { object.memorySize() } -> std::convertible_to<size_t>; })
+                return object.memorySize();
+            else
+                return sizeof(ObjectType);
+        }
+
+        // Unlink from the retention cache, if it's in there.
+        static void uncache(Entry* entry) {
+            auto& lru = objectPool.lru;
+            std::scoped_lock lock(lru.lock);
+            if (!entry->cached) return;
+
+            (entry->newer ? entry->newer->older : lru.newest) = entry->older;
+            (entry->older ? entry->older->newer : lru.oldest) = entry->newer;
+            entry->newer = entry->older = nullptr;
+            entry->cached = false;
+            lru.bytes -= entry->bytes;
+            lru.count--;
+        }
+
+        static void cache(Entry* entry) {
+            auto& lru = objectPool.lru;
+            std::scoped_lock lock(lru.lock);
+            if (entry->cached) return;
+
+            entry->older = lru.newest;
+            entry->newer = nullptr;
+            (lru.newest ? lru.newest->newer : lru.oldest) = entry;
+            lru.newest = entry;
+            entry->cached = true;
+            lru.bytes += entry->bytes;
+            lru.count++;
+        }
+
+        // Remove an entry from its shard. The shard must be locked.
+        static void erase(Shard& shard, Entry* entry) {
+            uncache(entry);
+            shard.index.erase(entry->identifier);
+            shard.entries.erase(entry->slot);
+        }
+
+        // An unreferenced entry is cached if there's a budget to keep it in, and destroyed otherwise.
+        // Returns whether the cache needs trimming. The shard must be locked.
+        static bool retire(Shard& shard, Entry* entry) {
+            if (getRetentionBudget() != 0 && entry->ready.load(std::memory_order_acquire)) {
+                cache(entry);
+                return true;
+            }
+
+            erase(shard, entry);
+            return false;
+        }
+
+        // Evict the least recently used entries until the cache fits in the budget.
+        static void trim() {
+            // Victims are picked under the cache lock alone, and destroyed afterwards under their own shard's lock.
+            // They're tracked by slot, so one that has since been destroyed some other way is simply skipped.
+            std::vector<Weak> victims;
+            {
+                auto& lru = objectPool.lru;
+                std::scoped_lock lock(lru.lock);
+                const size_t budget = getRetentionBudget();
+                while (lru.bytes > budget && lru.oldest != nullptr) {
+                    Entry* entry = lru.oldest;
+                    victims.push_back({ entry->slot, entry->shard });
+
+                    lru.oldest = entry->newer;
+                    (lru.oldest ? lru.oldest->older : lru.newest) = nullptr;
+                    entry->newer = entry->older = nullptr;
+                    entry->cached = false;
+                    lru.bytes -= entry->bytes;
+                    lru.count--;
+                }
+            }
+
+            for (const auto& victim : victims) {
+                Shard& shard = objectPool.shards[victim.shard];
+                std::scoped_lock lock(shard.lock);
+                auto* slot = shard.entries.get(victim.slot);
+                if (slot == nullptr) continue;
+
+                Entry* entry = slot->get();
+                bool cached;
+                {
+                    std::scoped_lock cacheLock(objectPool.lru.lock);
+                    cached = entry->cached;
+                }
+
+                // Leave it alone if it was picked up again (and maybe released back into the cache) in the meantime.
+                if (entry->references.load(std::memory_order_relaxed) == 0 && !cached) {
+                    erase(shard, entry);
+                    objectPool.evictions.fetch_add(1, std::memory_order_relaxed);
+                }
             }
         }
 
-        static void registerAutoRelease() { ++objectPool.activePools; }
+        static void release(Entry* entry) {
+            // While this isn't the last reference, the entry can't go away, so no lock is needed.
+            size_t references = entry->references.load(std::memory_order_relaxed);
+            while (references > 1) {
+                if (entry->references.compare_exchange_weak(references, references - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                    return;
+            }
+
+            // Otherwise, take the lock first, so that nothing can take a new reference between the count hitting zero and the erase.
+            bool full = false;
+            {
+                Shard& shard = objectPool.shards[entry->shard];
+                std::scoped_lock lock(shard.lock);
+                if (entry->references.fetch_sub(1, std::memory_order_acq_rel) == 1 && !hasAutoRelease())
+                    full = retire(shard, entry);
+            }
+
+            if (full)
+                trim();
+        }
+
+        static void unregisterAutoRelease() {
+            if (objectPool.activePools.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                bool full = false;
+                for (auto& shard : objectPool.shards) {
+                    std::scoped_lock lock(shard.lock);
+                    // Erasing moves the last entry into the hole, so walk backwards.
+                    for (size_t i = shard.entries.size(); i-- > 0;) {
+                        Entry* entry = shard.entries.get(shard.entries.handleAt(i))->get();
+                        if (entry->references.load(std::memory_order_relaxed) == 0)
+                            full |= retire(shard, entry);
+                    }
+                }
+
+                if (full)
+                    trim();
+            }
+        }
 
-        static typename ObjectPool::RefCountMap& getMap() { return objectPool.refCountMap; }
+        static void registerAutoRelease() { objectPool.activePools.fetch_add(1, std::memory_order_acq_rel); }
 
         static ObjectPool objectPool;
 
-        std::string identifier;
-        const ObjectType* objectPtr;
+        Entry* entry;
     };
 
     template <typename ObjectType>
     typename RefCounter<ObjectType>::ObjectPool RefCounter<ObjectType>::objectPool {};
-}
\ No newline at end of file
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace shadowutil {
+
+    // A container that hands out small, stable handles to the objects placed in it.
+    // Handles are an index and a generation packed into one integer; the generation is bumped whenever a slot is
+    //  reused, so a handle to an erased object is detected instead of silently resolving to whatever replaced it.
+    // Values are kept densely packed in insertion order (until erased), so iterating is a linear walk over a vector.
+    //
+    // HandleType is uint64_t (32 bit index, 32 bit generation) or uint32_t (16 bit index, 16 bit generation).
+    template<typename T, typename HandleType = uint64_t>
+    class SlotMap {
+        static_assert(std::is_same_v<HandleType, uint64_t> || std::is_same_v<HandleType, uint32_t>, "SlotMap handles are 32 or 64 bits");
+
+        using Half = std::conditional_t<std::is_same_v<HandleType, uint64_t>, uint32_t, uint16_t>;
+        static constexpr unsigned halfBits = sizeof(Half) * 8;
+        static constexpr Half noSlot = std::numeric_limits<Half>::max();
+
+    public:
+        struct Handle {
+            HandleType value = 0;
+
+            Half index() const { return static_cast<Half>(value); }
+            Half generation() const { return static_cast<Half>(value >> halfBits); }
+
+            // Generations start at 1, so a default constructed handle never resolves.
+            explicit operator bool() const { return value != 0; }
+            bool operator==(const Handle&) const = default;
+        };
+
+        // Add a value. The returned handle stays valid until the value is erased.
+        template<typename... Args>
+        Handle emplace(Args&&... args) {
+            if (freeHead == noSlot && slots.size() >= noSlot)
+                throw std::length_error("SlotMap is full");
+
+            Half slotIndex;
+            if (freeHead != noSlot) {
+                slotIndex = freeHead;
+                freeHead = slots[slotIndex].dense;
+            } else {
+                slotIndex = static_cast<Half>(slots.size());
+                slots.push_back({ noSlot, 1 });
+            }
+
+            values.emplace_back(std::forward<Args>(args)...);
+            denseToSlot.push_back(slotIndex);
+
+            Slot& slot = slots[slotIndex];
+            slot.dense = static_cast<Half>(values.size() - 1);
+            return make(slotIndex, slot.generation);
+        }
+
+        Handle insert(T value) { return emplace(std::move(value)); }
+
+        // Remove the value, if the handle is still valid.
+        // The last value is moved into its place, so this is constant time.
+        bool erase(Handle handle) {
+            if (!contains(handle)) return false;
+
+            Slot& slot = slots[handle.index()];
+            const Half dense = slot.dense;
+            const Half last = static_cast<Half>(values.size() - 1);
+
+            if (dense != last) {
+                values[dense] = std::move(values[last]);
+                denseToSlot[dense] = denseToSlot[last];
+                slots[denseToSlot[dense]].dense = dense;
+            }
+            values.pop_back();
+            denseToSlot.pop_back();
+
+            // Retire the slot; skip generation 0 on wrap so that the null handle stays invalid.
+            if (++slot.generation == 0) slot.generation = 1;
+            slot.dense = freeHead;
+            freeHead = handle.index();
+            return true;
+        }
+
+        bool contains(Handle handle) const {
+            const Half index = handle.index();
+            return index < slots.size() && slots[index].generation == handle.generation() && handle.generation() != 0;
+        }
+
+        // Resolve a handle; nullptr if it is stale.
+        T* get(Handle handle) {
+            return contains(handle) ? &values[slots[handle.index()].dense] : nullptr;
+        }
+
+        const T* get(Handle handle) const {
+            return contains(handle) ? &values[slots[handle.index()].dense] : nullptr;
+        }
+
+        // The handle of the value at a position in the dense array, for use while iterating.
+        Handle handleAt(size_t dense) const {
+            const Half slotIndex = denseToSlot[dense];
+            return make(slotIndex, slots[slotIndex].generation);
+        }
+
+        void clear() {
+            while (!values.empty())
+                erase(handleAt(values.size() - 1));
+        }
+
+        size_t size() const { return values.size(); }
+        bool empty() const { return values.empty(); }
+
+        void reserve(size_t count) {
+            values.reserve(count);
+            denseToSlot.reserve(count);
+            slots.reserve(count);
+        }
+
+        // Iterate the values directly.
+        auto begin() { return values.begin(); }
+        auto end() { return values.end(); }
+        auto begin() const { return values.begin(); }
+        auto end() const { return values.end(); }
+
+    private:
+        struct Slot {
+            Half dense;         // Position in values; or the next free slot, when this one is free
+            Half generation;
+        };
+
+        static Handle make(Half index, Half generation) {
+            return Handle { static_cast<HandleType>(index) | (static_cast<HandleType>(generation) << halfBits) };
+        }
+
+        std::vector<T> values;
+        std::vector<Half> denseToSlot;
+        std::vector<Slot> slots;
+        Half freeHead = noSlot;
+    };
+}
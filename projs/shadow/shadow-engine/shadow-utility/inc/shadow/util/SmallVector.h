@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace shadowutil {
+
+    // A vector that stores its first N elements inline, only allocating once it grows past them.
+    // Most per-binding and per-subpass lists in the renderer hold one to four elements,
+    //  so keeping them inline avoids an allocation for each and keeps them next to their owner in memory.
+    //
+    // Unlike std::vector, moving a SmallVector that is still inline moves the elements one by one.
+    template<typename T, size_t N>
+    class SmallVector {
+        static_assert(N > 0, "Use std::vector for a vector with no inline storage");
+
+    public:
+        using value_type = T;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        SmallVector() = default;
+
+        SmallVector(std::initializer_list<T> values) {
+            reserve(values.size());
+            for (const auto& value : values) push_back(value);
+        }
+
+        SmallVector(const SmallVector& other) {
+            reserve(other.count);
+            std::uninitialized_copy(other.begin(), other.end(), elements);
+            count = other.count;
+        }
+
+        SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            take(std::move(other));
+        }
+
+        SmallVector& operator=(const SmallVector& other) {
+            if (this != &other) {
+                clear();
+                reserve(other.count);
+                std::uninitialized_copy(other.begin(), other.end(), elements);
+                count = other.count;
+            }
+            return *this;
+        }
+
+        SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            if (this != &other) {
+                clear();
+                release();
+                take(std::move(other));
+            }
+            return *this;
+        }
+
+        ~SmallVector() {
+            clear();
+            release();
+        }
+
+        iterator begin() { return elements; }
+        iterator end() { return elements + count; }
+        const_iterator begin() const { return elements; }
+        const_iterator end() const { return elements + count; }
+
+        T* data() { return elements; }
+        const T* data() const { return elements; }
+
+        size_t size() const { return count; }
+        size_t capacity() const { return space; }
+        bool empty() const { return count == 0; }
+        // Whether the elements are still in the inline buffer.
+        bool isInline() const { return elements == inlineElements(); }
+
+        T& operator[](size_t index) { return elements[index]; }
+        const T& operator[](size_t index) const { return elements[index]; }
+
+        T& at(size_t index) {
+            if (index >= count) throw std::out_of_range("SmallVector::at: index out of range");
+            return elements[index];
+        }
+
+        const T& at(size_t index) const {
+            if (index >= count) throw std::out_of_range("SmallVector::at: index out of range");
+            return elements[index];
+        }
+
+        T& front() { return elements[0]; }
+        const T& front() const { return elements[0]; }
+        T& back() { return elements[count - 1]; }
+        const T& back() const { return elements[count - 1]; }
+
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            if (count == space) {
+                // Construct first; args may refer to an element that is about to move.
+                T value(std::forward<Args>(args)...);
+                grow(space * 2);
+                return *std::construct_at(elements + count++, std::move(value));
+            }
+            return *std::construct_at(elements + count++, std::forward<Args>(args)...);
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        void pop_back() { std::destroy_at(elements + --count); }
+
+        void clear() {
+            std::destroy(begin(), end());
+            count = 0;
+        }
+
+        void reserve(size_t wanted) {
+            if (wanted > space) grow(wanted);
+        }
+
+        void resize(size_t wanted) {
+            if (wanted < count) {
+                std::destroy(elements + wanted, end());
+            } else {
+                reserve(wanted);
+                std::uninitialized_value_construct(elements + count, elements + wanted);
+            }
+            count = wanted;
+        }
+
+    private:
+        T* inlineElements() { return reinterpret_cast<T*>(storage); }
+        const T* inlineElements() const { return reinterpret_cast<const T*>(storage); }
+
+        void grow(size_t wanted) {
+            T* moved = std::allocator<T>().allocate(wanted);
+            std::uninitialized_move(begin(), end(), moved);
+            std::destroy(begin(), end());
+            release();
+            elements = moved;
+            space = wanted;
+        }
+
+        // Free the heap buffer, if there is one. Elements must already be destroyed or moved out.
+        void release() {
+            if (!isInline()) std::allocator<T>().deallocate(elements, space);
+            elements = inlineElements();
+            space = N;
+        }
+
+        // Steal other's elements; this must be empty and inline.
+        void take(SmallVector&& other) {
+            if (other.isInline()) {
+                std::uninitialized_move(other.begin(), other.end(), elements);
+                count = other.count;
+                other.clear();
+            } else {
+                elements = other.elements;
+                space = other.space;
+                count = other.count;
+                other.elements = other.inlineElements();
+                other.space = N;
+                other.count = 0;
+            }
+        }
+
+        alignas(T) std::byte storage[N * sizeof(T)];
+        T* elements = inlineElements();
+        size_t count = 0;
+        size_t space = N;
+    };
+}
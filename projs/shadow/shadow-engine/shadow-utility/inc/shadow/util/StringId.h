@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "Hash.h"
+
+// Debug builds remember the text of every StringId made at runtime, so that str() can show it.
+// Each thread caches what it has recorded, so only the first conversion of a string on a thread takes a lock.
+#ifndef SHADOW_STRINGID_DEBUG
+#  ifdef NDEBUG
+#    define SHADOW_STRINGID_DEBUG 0
+#  else
+#    define SHADOW_STRINGID_DEBUG 1
+#  endif
+#endif
+
+namespace shadowutil {
+
+    // A string reduced to its 64-bit hash, for use as a key.
+    // Comparing and hashing a StringId is a single integer operation, and IDs can be made at compile time:
+    //      constexpr StringId albedo = "albedo"_sid;
+    // The hash is stable, so IDs can be saved to disk and compared across runs.
+    //
+    // The text isn't kept in the ID. A global intern table maps IDs back to their text for debugging;
+    //  use intern() to always record the text, or rely on SHADOW_STRINGID_DEBUG to record every runtime conversion.
+    class StringId {
+    public:
+        constexpr StringId() = default;
+
+        constexpr StringId(std::string_view str) : hash(fnv1a64(str)) {
+#if SHADOW_STRINGID_DEBUG
+            if (!std::is_constant_evaluated())
+                record(hash, str);
+#endif
+        }
+
+        constexpr StringId(const char* str) : StringId(std::string_view(str)) {}
+        StringId(const std::string& str) : StringId(std::string_view(str)) {}
+
+        // Wrap an existing hash, eg. one read back from disk.
+        static constexpr StringId fromHash(uint64_t hash) {
+            StringId id;
+            id.hash = hash;
+            return id;
+        }
+
+        // Hash the string, and record it in the intern table so that str() can find it.
+        // Throws if a different string with the same hash was recorded before.
+        static StringId intern(std::string_view str) {
+            const uint64_t hash = fnv1a64(str);
+            record(hash, str);
+            return fromHash(hash);
+        }
+
+        constexpr uint64_t value() const { return hash; }
+        constexpr bool empty() const { return hash == 0; }
+
+        // The text of the ID, if it was recorded; otherwise the hash, in hex.
+        std::string str() const;
+
+        constexpr bool operator==(const StringId&) const = default;
+        constexpr auto operator<=>(const StringId&) const = default;
+
+    private:
+        static void record(uint64_t hash, std::string_view str);
+
+        uint64_t hash = 0;
+    };
+
+    inline namespace literals {
+        constexpr StringId operator""_sid(const char* str, size_t length) {
+            return StringId::fromHash(fnv1a64(std::string_view(str, length)));
+        }
+    }
+}
+
+template<>
+struct std::hash<shadowutil::StringId> {
+    size_t operator()(const shadowutil::StringId& id) const noexcept { return static_cast<size_t>(id.value()); }
+};
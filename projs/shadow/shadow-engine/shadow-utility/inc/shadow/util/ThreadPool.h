@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace shadowutil {
+
+    // How soon a queued job should run, relative to the others.
+    enum class Priority : uint8_t {
+        Background,     // Streaming ahead of need
+        Normal,
+        Urgent          // Something is waiting on this right now
+    };
+
+    // A fixed set of worker threads that run queued jobs, highest priority first.
+    // Jobs of the same priority run in the order they were submitted.
+    class ThreadPool {
+    public:
+        // 0 threads means one fewer than the number of hardware threads (leaving one for the main thread), at least 1.
+        explicit ThreadPool(size_t threads = 0);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Runs every job that is still queued, then joins the workers.
+        ~ThreadPool();
+
+        void submit(std::function<void()> job, Priority priority = Priority::Normal);
+
+        // Submit a job, getting its result (or exception) back through a future.
+        template<typename F>
+        auto async(F&& job, Priority priority = Priority::Normal) -> std::future<std::invoke_result_t<F>> {
+            using Result = std::invoke_result_t<F>;
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+            auto future = task->get_future();
+            submit([task] { (*task)(); }, priority);
+            return future;
+        }
+
+        // Split [0, count) into chunks of at least `grain` items and run body(begin, end) on each, across the pool.
+        // The calling thread works on chunks too, so this is safe to call from inside a job.
+        // Returns once every chunk is done. If any chunk throws, the first exception is rethrown here.
+        void parallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body);
+
+        size_t size() const { return workers.size(); }
+
+        // A pool shared by the whole engine, for CPU work. Created on first use.
+        static ThreadPool& shared();
+
+    private:
+        void work();
+
+        std::vector<std::thread> workers;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::array<std::deque<std::function<void()>>, 3> queues;   // Indexed by Priority
+        bool stopping = false;
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "File.h"
+#include "FlatHashMap.h"
+#include "StringId.h"
+
+namespace shadowutil {
+
+    // A single namespace of read-only asset files, assembled from packages and loose directories.
+    //
+    // Every source is mounted under a mount point (a path prefix, which may be empty) and with a priority.
+    // Where two sources provide the same path, the higher priority wins; for equal priorities, the later mount wins.
+    // That lets a loose directory of work-in-progress assets override the shipped packages without rebuilding them.
+    //
+    // Mounting builds a single hashed table of every visible path, so opening a file is one lookup.
+    // A package is opened and mapped once, when it is mounted; opening a file inside it costs no system calls at all.
+    //
+    // Paths always use '/' and are matched exactly (case sensitive). "a\b" and "./a/b" are normalized to "a/b".
+    class VFS {
+    public:
+        // A file inside the VFS. The views stay valid until the source it came from is unmounted.
+        struct File {
+            std::string_view type;              // The package entry's four character type tag (eg. VTEX); empty for loose files
+            uint32_t version = 0;               // The package entry's format version
+            std::string_view metadata;          // The package entry's JSON header; empty for loose files
+            std::span<const std::byte> data;    // The payload, or the whole of a loose file
+        };
+
+        VFS() = default;
+        VFS(const VFS&) = delete;
+        VFS& operator=(const VFS&) = delete;
+
+        // Mount a .vxp package.
+        //
+        // A package starts with a "0S1V" header line, followed by entries of the form
+        //   <kind>/<path>|<size>|<type><version><metadata length><payload length><metadata><payload>\r\n
+        // where the three lengths are little-endian u32s, and size counts every byte from the type tag to the end
+        //  of the payload. Only assets (kind 'A') are mounted; they appear as <mount point><path>.
+        // Payloads are returned as stored; an entry whose metadata has "compression":2 holds a block stream
+        //  (see Compression.h), which the caller decodes into its own buffer.
+        void mountPackage(const std::string& path, std::string_view mountPoint = "", int priority = 0);
+
+        // Mount every package named in a .vxi index (one file name per line, relative to the index).
+        void mountIndex(const std::string& path, std::string_view mountPoint = "", int priority = 0);
+
+        // Mount every file under a directory, recursively. Files are only opened when they are first read.
+        void mountDirectory(const std::string& path, std::string_view mountPoint = "", int priority = 0);
+
+        // Remove a source, by the path it was mounted with. Files opened from it are no longer valid.
+        bool unmount(const std::string& path);
+
+        bool exists(std::string_view path) const;
+
+        // Find a file; nullopt if no mounted source has it.
+        std::optional<File> find(std::string_view path) const;
+
+        // Find a file, throwing if it does not exist.
+        File open(std::string_view path) const;
+
+        // How many distinct paths are visible.
+        size_t size() const;
+
+        // Convert a path to the form that mounted files are stored under.
+        static std::string normalize(std::string_view path);
+
+        // The engine's shared instance.
+        static VFS& get();
+
+    private:
+        static StringId key(std::string_view path) { return StringId(normalize(path)); }
+
+        // Where a path resolves to.
+        struct Entry {
+            uint32_t source;        // Index into sources
+            uint32_t file;          // For a directory, index into its files
+            uint64_t payload;       // For a package, the offset of the payload
+            uint64_t payloadSize;
+            uint64_t metadata;      // For a package, the offset of the JSON header
+            uint32_t metadataSize;
+            uint32_t version;
+            char type[4];
+        };
+
+        struct Source {
+            std::string path;
+            int priority;
+            uint64_t order;
+            std::unique_ptr<MappedFile> package;                  // Null for directories
+            std::vector<std::string> files;                         // For directories, the real path of each file
+            std::vector<std::unique_ptr<MappedFile>> mapped;        // For directories, each file once it has been read
+            std::vector<std::pair<StringId, Entry>> entries;
+        };
+
+        void add(std::unique_ptr<Source> source);
+        void rebuild();
+        File resolve(const Entry& entry) const;
+
+        mutable std::shared_mutex lock;
+        mutable std::mutex mapLock;         // Guards Source::mapped; taken while holding lock shared
+        std::vector<std::unique_ptr<Source>> sources;
+        FlatHashMap<StringId, Entry> index;
+        uint64_t mounts = 0;
+    };
+}
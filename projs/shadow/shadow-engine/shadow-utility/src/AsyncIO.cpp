@@ -0,0 +1,503 @@
+#include <shadow/util/AsyncIO.h>
+#include <shadow/util/FlightRecorder.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define SHADOW_HAS_IO_URING 1
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace shadowutil {
+
+    struct AsyncIO::State {
+        explicit State(Request&& request) : request(std::move(request)) {}
+
+        Request request;
+        uint64_t submitted = FlightRecorder::now();
+
+        // Set by whichever of a backend or cancel() gets to the request first.
+        std::atomic<bool> claimed { false };
+
+        std::atomic<Status> status { Status::Pending };
+        std::mutex lock;
+        std::condition_variable changed;
+        Result result;
+
+        // io_uring bookkeeping; only touched under the engine's lock.
+        int fd = -1;
+        size_t transferred = 0;
+        bool cancelRequested = false;
+    };
+
+    // A way of getting reads done. Backends call finish() exactly once for every request they are given.
+    class AsyncIO::Engine {
+    public:
+        explicit Engine(AsyncIO& owner) : owner(owner) {}
+        virtual ~Engine() = default;
+
+        virtual void submit(std::vector<std::shared_ptr<State>> states) = 0;
+        virtual void cancel(const std::shared_ptr<State>& state) = 0;
+        virtual Backend backend() const = 0;
+
+    protected:
+        void finish(const std::shared_ptr<State>& state, Result result) { owner.finish(state, std::move(result)); }
+
+        AsyncIO& owner;
+    };
+
+    namespace {
+
+        using State = AsyncIO::State;
+        using Result = AsyncIO::Result;
+        using Status = AsyncIO::Status;
+
+        Result failed(std::string why) { return { Status::Failed, 0, std::move(why) }; }
+        Result cancelled(size_t bytes = 0) { return { Status::Cancelled, bytes, {} }; }
+        Result succeeded(size_t bytes) { return { Status::Complete, bytes, {} }; }
+
+        // Blocking reads on a few dedicated threads, so that slow disks never hold up the CPU pool.
+        class ThreadEngine final : public AsyncIO::Engine {
+        public:
+            explicit ThreadEngine(AsyncIO& owner) : Engine(owner), pool(4) {}
+
+            ~ThreadEngine() override {
+                // Anything still queued finishes as cancelled when the pool drains it.
+                stopping = true;
+            }
+
+            void submit(std::vector<std::shared_ptr<State>> states) override {
+                for (auto& state : states) {
+                    const Priority priority = state->request.priority;
+                    pool.submit([this, state = std::move(state)] { run(state); }, priority);
+                }
+            }
+
+            void cancel(const std::shared_ptr<State>& state) override {
+                if (!state->claimed.exchange(true))
+                    finish(state, cancelled());
+            }
+
+            AsyncIO::Backend backend() const override { return AsyncIO::Backend::Threads; }
+
+        private:
+            void run(const std::shared_ptr<State>& state) {
+                if (state->claimed.exchange(true))
+                    return;
+                if (stopping) {
+                    finish(state, cancelled());
+                    return;
+                }
+
+                const auto& request = state->request;
+                std::ifstream file(request.path, std::ios::binary);
+                if (!file.is_open()) {
+                    finish(state, failed("Unable to open specified file: " + request.path));
+                    return;
+                }
+
+                // Only seek when asked to, so that pipes and other streams can be read from the start.
+                if (request.offset)
+                    file.seekg(static_cast<std::streamoff>(request.offset));
+                file.read(reinterpret_cast<char*>(request.into.data()), static_cast<std::streamsize>(request.into.size()));
+                if (file.bad()) {
+                    finish(state, failed("Unable to read file: " + request.path));
+                    return;
+                }
+
+                finish(state, succeeded(static_cast<size_t>(file.gcount())));
+            }
+
+            std::atomic<bool> stopping { false };
+            ThreadPool pool;
+        };
+
+#ifdef SHADOW_HAS_IO_URING
+        int uringSetup(unsigned entries, io_uring_params* params) {
+            return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        int uringEnter(int fd, unsigned submit, unsigned wait, unsigned flags) {
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+        }
+
+        // Reads through an io_uring, driven by raw syscalls so that liburing is not a dependency.
+        // Requests wait in per-priority queues until there is room in the ring, so a flood of background streaming
+        //  cannot delay an urgent read by more than the reads already in the kernel.
+        // One thread waits on the completion queue; submission happens on whichever thread calls read().
+        class UringEngine final : public AsyncIO::Engine {
+            // user_data values that are not requests.
+            static constexpr uint64_t wakeTag = 0;
+            static constexpr uint64_t cancelTag = 1;
+
+        public:
+            UringEngine(AsyncIO& owner, unsigned entries) : Engine(owner) {
+                io_uring_params params {};
+                ring = uringSetup(entries, &params);
+                if (ring < 0)
+                    throw std::runtime_error(std::string("io_uring is unavailable: ") + std::strerror(errno));
+
+                // IORING_OP_READ arrived in the same release (5.6) as this feature flag.
+                if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+                    close(ring);
+                    throw std::runtime_error("io_uring is too old to support plain reads");
+                }
+
+                sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+                if (single) sqSize = cqSize = std::max(sqSize, cqSize);
+
+                sqRing = mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+                cqRing = single ? sqRing : mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+                sqeSize = params.sq_entries * sizeof(io_uring_sqe);
+                void* sqeMap = mmap(nullptr, sqeSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+                sqes = static_cast<io_uring_sqe*>(sqeMap);
+                if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqeMap == MAP_FAILED) {
+                    unmap();
+                    close(ring);
+                    throw std::runtime_error("Unable to map the io_uring");
+                }
+
+                auto* sq = static_cast<char*>(sqRing);
+                sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+                sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+                auto* cq = static_cast<char*>(cqRing);
+                cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+                // Keep half the ring free for cancellations and the wake-up, so the completion queue can never overflow.
+                maxInFlight = std::max(1u, params.sq_entries / 2);
+
+                reaper = std::thread([this] { reap(); });
+            }
+
+            ~UringEngine() override {
+                {
+                    std::scoped_lock guard(lock);
+                    stopping = true;
+                    for (auto& queue : pending) {
+                        for (auto& state : queue)
+                            complete(state, cancelled());
+                        queue.clear();
+                    }
+                    for (auto& [key, state] : inFlight)
+                        pushCancel(state.get());
+                    push(IORING_OP_NOP, -1, 0, 0, 0, wakeTag);
+                    flush();
+                }
+
+                reaper.join();
+                unmap();
+                close(ring);
+            }
+
+            void submit(std::vector<std::shared_ptr<State>> states) override {
+                std::scoped_lock guard(lock);
+                for (auto& state : states)
+                    pending[static_cast<size_t>(state->request.priority)].push_back(std::move(state));
+                pump();
+            }
+
+            void cancel(const std::shared_ptr<State>& state) override {
+                std::scoped_lock guard(lock);
+                if (inFlight.contains(state.get())) {
+                    if (!state->cancelRequested) {
+                        state->cancelRequested = true;
+                        pushCancel(state.get());
+                        flush();
+                    }
+                    return;
+                }
+
+                auto& queue = pending[static_cast<size_t>(state->request.priority)];
+                const auto iter = std::find(queue.begin(), queue.end(), state);
+                if (iter != queue.end()) {
+                    queue.erase(iter);
+                    complete(state, cancelled());
+                }
+            }
+
+            AsyncIO::Backend backend() const override { return AsyncIO::Backend::IOUring; }
+
+        private:
+            void push(uint8_t opcode, int fd, uint64_t addr, uint32_t length, uint64_t offset, uint64_t userData) {
+                const unsigned tail = *sqTail;
+                const unsigned index = tail & sqMask;
+                io_uring_sqe& sqe = sqes[index];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = opcode;
+                sqe.fd = fd;
+                sqe.addr = addr;
+                sqe.len = length;
+                sqe.off = offset;
+                sqe.user_data = userData;
+                sqArray[index] = index;
+                __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+            }
+
+            void pushCancel(State* state) {
+                push(IORING_OP_ASYNC_CANCEL, -1, reinterpret_cast<uint64_t>(state), 0, 0, cancelTag);
+            }
+
+            // Hand everything queued in the ring to the kernel.
+            void flush() {
+                unsigned waiting;
+                while ((waiting = *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE)) != 0) {
+                    if (uringEnter(ring, waiting, 0, 0) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                        break;
+                }
+            }
+
+            // Move the most urgent pending reads into the ring, while there is room. Called under the lock.
+            void pump() {
+                while (inFlight.size() < maxInFlight) {
+                    auto queue = std::find_if(pending.rbegin(), pending.rend(), [](const auto& q) { return !q.empty(); });
+                    if (queue == pending.rend()) break;
+
+                    std::shared_ptr<State> state = std::move(queue->front());
+                    queue->pop_front();
+
+                    const auto& request = state->request;
+                    if (state->fd < 0) {
+                        state->fd = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+                        if (state->fd < 0) {
+                            complete(state, failed("Unable to open specified file: " + request.path + " (" + std::strerror(errno) + ")"));
+                            continue;
+                        }
+                    }
+
+                    const size_t remaining = request.into.size() - state->transferred;
+                    if (remaining == 0) {
+                        complete(state, succeeded(state->transferred));
+                        continue;
+                    }
+
+                    push(IORING_OP_READ, state->fd,
+                         reinterpret_cast<uint64_t>(request.into.data() + state->transferred),
+                         static_cast<uint32_t>(std::min<size_t>(remaining, 1u << 30)),
+                         request.offset + state->transferred,
+                         reinterpret_cast<uint64_t>(state.get()));
+                    inFlight.emplace(state.get(), std::move(state));
+                }
+                flush();
+            }
+
+            void reap() {
+                while (true) {
+                    if (uringEnter(ring, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+                        std::this_thread::yield();
+
+                    std::scoped_lock guard(lock);
+                    unsigned head = *cqHead;
+                    const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+                    for (; head != tail; ++head) {
+                        const io_uring_cqe& cqe = cqes[head & cqMask];
+                        if (cqe.user_data != wakeTag && cqe.user_data != cancelTag)
+                            handle(reinterpret_cast<State*>(cqe.user_data), cqe.res);
+                    }
+                    __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+                    if (stopping && inFlight.empty())
+                        return;
+                    pump();
+                }
+            }
+
+            void handle(State* key, int res) {
+                const auto iter = inFlight.find(key);
+                if (iter == inFlight.end()) return;
+                std::shared_ptr<State> state = std::move(iter->second);
+                inFlight.erase(iter);
+
+                if ((res == -EINTR || res == -EAGAIN) && !state->cancelRequested && !stopping) {
+                    pending[static_cast<size_t>(state->request.priority)].push_front(std::move(state));
+                    return;
+                }
+
+                if (res < 0) {
+                    if (res == -ECANCELED || res == -EINTR || res == -EAGAIN)
+                        complete(state, cancelled(state->transferred));
+                    else
+                        complete(state, failed("Unable to read file: " + state->request.path + " (" + std::strerror(-res) + ")"));
+                    return;
+                }
+
+                state->transferred += static_cast<size_t>(res);
+                const bool more = res > 0 && state->transferred < state->request.into.size();
+
+                if (more && (state->cancelRequested || stopping))
+                    complete(state, cancelled(state->transferred));
+                else if (more)
+                    // A short read; continue it ahead of anything new at the same priority.
+                    pending[static_cast<size_t>(state->request.priority)].push_front(std::move(state));
+                else
+                    complete(state, succeeded(state->transferred));
+            }
+
+            void complete(const std::shared_ptr<State>& state, Result result) {
+                if (state->fd >= 0) {
+                    close(state->fd);
+                    state->fd = -1;
+                }
+                finish(state, std::move(result));
+            }
+
+            void unmap() {
+                if (sqes && static_cast<void*>(sqes) != MAP_FAILED) munmap(sqes, sqeSize);
+                if (cqRing != sqRing && cqRing && cqRing != MAP_FAILED) munmap(cqRing, cqSize);
+                if (sqRing && sqRing != MAP_FAILED) munmap(sqRing, sqSize);
+            }
+
+            int ring = -1;
+            void* sqRing = nullptr;
+            void* cqRing = nullptr;
+            size_t sqSize = 0, cqSize = 0, sqeSize = 0;
+
+            unsigned* sqHead = nullptr;
+            unsigned* sqTail = nullptr;
+            unsigned* sqArray = nullptr;
+            unsigned sqMask = 0;
+            io_uring_sqe* sqes = nullptr;
+
+            unsigned* cqHead = nullptr;
+            unsigned* cqTail = nullptr;
+            unsigned cqMask = 0;
+            io_uring_cqe* cqes = nullptr;
+
+            std::mutex lock;
+            std::array<std::deque<std::shared_ptr<State>>, 3> pending;     // Indexed by Priority
+            std::unordered_map<State*, std::shared_ptr<State>> inFlight;
+            unsigned maxInFlight = 0;
+            bool stopping = false;
+            std::thread reaper;
+        };
+#endif
+    }
+
+    AsyncIO::AsyncIO(Backend backend) {
+#ifdef SHADOW_HAS_IO_URING
+        if (backend != Backend::Threads) {
+            try {
+                engine = std::make_unique<UringEngine>(*this, 256);
+            } catch (const std::exception&) {
+                // Commonly blocked inside containers; the thread backend does the same job, just less efficiently.
+                if (backend == Backend::IOUring) throw;
+            }
+        }
+#else
+        if (backend == Backend::IOUring)
+            throw std::runtime_error("io_uring is not available on this platform");
+#endif
+        if (!engine)
+            engine = std::make_unique<ThreadEngine>(*this);
+    }
+
+    AsyncIO::~AsyncIO() {
+        // The backend finishes its outstanding requests on the way out, which needs the rest of this to still exist.
+        engine.reset();
+    }
+
+    AsyncIO::Ticket AsyncIO::read(Request request) {
+        auto state = std::make_shared<State>(std::move(request));
+        engine->submit({ state });
+        return { std::move(state), this };
+    }
+
+    std::vector<AsyncIO::Ticket> AsyncIO::read(std::vector<Request> requests) {
+        std::vector<std::shared_ptr<State>> states;
+        std::vector<Ticket> tickets;
+        states.reserve(requests.size());
+        tickets.reserve(requests.size());
+
+        for (auto& request : requests) {
+            states.push_back(std::make_shared<State>(std::move(request)));
+            tickets.push_back({ states.back(), this });
+        }
+
+        engine->submit(std::move(states));
+        return tickets;
+    }
+
+    void AsyncIO::finish(const std::shared_ptr<State>& state, Result result) {
+        if (result.status == Status::Complete)
+            FlightRecorder::recordAssetLoad(state->request.path, result.bytes, state->submitted, FlightRecorder::now());
+
+        const Status status = result.status;
+        std::unique_lock guard(state->lock);
+        state->result = std::move(result);
+
+        // Queue the callback before publishing the status, so that a poll() after wait() returns always sees it.
+        if (state->request.onComplete) {
+            std::scoped_lock queue(finishedLock);
+            finished.push_back(state);
+        }
+
+        state->status.store(status, std::memory_order_release);
+        guard.unlock();
+        state->changed.notify_all();
+    }
+
+    size_t AsyncIO::poll() {
+        std::vector<std::shared_ptr<State>> ready;
+        {
+            std::scoped_lock guard(finishedLock);
+            ready.swap(finished);
+        }
+
+        for (const auto& state : ready)
+            state->request.onComplete(state->result);
+        return ready.size();
+    }
+
+    AsyncIO::Backend AsyncIO::getBackend() const {
+        return engine->backend();
+    }
+
+    uint64_t AsyncIO::fileSize(const std::string& path) {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(path, error);
+        if (error)
+            throw std::runtime_error("Unable to read the size of file: " + path + " (" + error.message() + ")");
+        return size;
+    }
+
+    AsyncIO& AsyncIO::get() {
+        static AsyncIO instance;
+        return instance;
+    }
+
+    AsyncIO::Status AsyncIO::Ticket::status() const {
+        return state ? state->status.load(std::memory_order_acquire) : Status::Cancelled;
+    }
+
+    const AsyncIO::Result& AsyncIO::Ticket::wait() const {
+        std::unique_lock guard(state->lock);
+        state->changed.wait(guard, [this] { return state->status.load(std::memory_order_acquire) != Status::Pending; });
+        return state->result;
+    }
+
+    void AsyncIO::Ticket::cancel() {
+        if (state && owner && !done())
+            owner->engine->cancel(state);
+    }
+}
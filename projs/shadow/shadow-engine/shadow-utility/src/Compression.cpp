@@ -0,0 +1,291 @@
+#include <shadow/util/Compression.h>
+#include <shadow/util/ThreadPool.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace shadowutil {
+
+    namespace {
+        using u8 = uint8_t;
+
+        // The format needs the last 5 bytes to be literals, and the last match to start 12 bytes before the end.
+        constexpr size_t lastLiterals = 5;
+        constexpr size_t matchLimit = 12;
+        constexpr size_t minMatch = 4;
+        constexpr size_t maxOffset = 65535;
+        constexpr int hashBits = 14;
+
+        uint32_t read32(const u8* at) {
+            uint32_t value;
+            std::memcpy(&value, at, sizeof(value));
+            return value;
+        }
+
+        uint32_t hash(uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32 - hashBits);
+        }
+
+        // A length that does not fit in its nibble continues in bytes of 255, ending with one less than 255.
+        u8* writeLength(u8* op, size_t length) {
+            for (; length >= 255; length -= 255)
+                *op++ = 255;
+            *op++ = static_cast<u8>(length);
+            return op;
+        }
+
+        u8* writeSequence(u8* op, const u8* literals, size_t literalLength, size_t offset, size_t matchLength) {
+            u8* token = op++;
+            *token = static_cast<u8>(std::min<size_t>(literalLength, 15) << 4);
+            if (literalLength >= 15)
+                op = writeLength(op, literalLength - 15);
+            // An empty input has no buffers at all, and memcpy must not be given null.
+            if (literalLength != 0)
+                std::memcpy(op, literals, literalLength);
+            op += literalLength;
+
+            // The final sequence is literals only.
+            if (matchLength == 0)
+                return op;
+
+            *op++ = static_cast<u8>(offset);
+            *op++ = static_cast<u8>(offset >> 8);
+            matchLength -= minMatch;
+            *token |= static_cast<u8>(std::min<size_t>(matchLength, 15));
+            if (matchLength >= 15)
+                op = writeLength(op, matchLength - 15);
+            return op;
+        }
+
+        [[noreturn]] void corrupt(const char* why) {
+            throw std::runtime_error(std::string("Corrupt compressed data: ") + why);
+        }
+
+        size_t readLength(const u8*& ip, const u8* end) {
+            size_t length = 0;
+            u8 byte;
+            do {
+                if (ip >= end) corrupt("truncated length");
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255);
+            return length;
+        }
+
+        // The fixed part of a block stream.
+        struct StreamHeader {
+            uint64_t size;
+            uint32_t blockSize;
+            uint32_t blockCount;
+        };
+        constexpr size_t headerSize = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+        StreamHeader readHeader(std::span<const std::byte> stream) {
+            if (stream.size() < headerSize) corrupt("truncated block stream");
+            StreamHeader header;
+            std::memcpy(&header.size, stream.data(), sizeof(header.size));
+            std::memcpy(&header.blockSize, stream.data() + 8, sizeof(header.blockSize));
+            std::memcpy(&header.blockCount, stream.data() + 12, sizeof(header.blockCount));
+
+            if (header.blockSize == 0 && header.size != 0) corrupt("zero block size");
+            const uint64_t expected = header.size == 0 ? 0 : (header.size + header.blockSize - 1) / header.blockSize;
+            if (header.blockCount != expected) corrupt("wrong block count");
+            if (stream.size() < headerSize + uint64_t(header.blockCount) * sizeof(uint32_t)) corrupt("truncated block table");
+            return header;
+        }
+    }
+
+    size_t lz::compressBound(size_t size) {
+        return size + size / 255 + 16;
+    }
+
+    size_t lz::compress(std::span<const std::byte> in, std::span<std::byte> out) {
+        if (out.size() < compressBound(in.size()))
+            throw std::runtime_error("Compression output buffer is too small");
+
+        const u8* const base = reinterpret_cast<const u8*>(in.data());
+        const u8* const end = base + in.size();
+        const u8* ip = base;
+        const u8* anchor = base;
+        u8* op = reinterpret_cast<u8*>(out.data());
+
+        if (in.size() > matchLimit) {
+            const u8* const lastMatchStart = end - matchLimit;
+            const u8* const lastMatchEnd = end - lastLiterals;
+
+            // Positions of recently seen 4-byte sequences. Stale or colliding entries are caught by comparing bytes.
+            std::array<uint32_t, 1u << hashBits> table {};
+            ip++;
+
+            while (ip <= lastMatchStart) {
+                // Look for a match, striding further the longer nothing matches, so incompressible data is quick.
+                const u8* match = nullptr;
+                size_t misses = 1 << 6;
+                for (const u8* probe = ip; probe <= lastMatchStart; probe += misses++ >> 6) {
+                    const uint32_t sequence = read32(probe);
+                    uint32_t& slot = table[hash(sequence)];
+                    const u8* candidate = base + slot;
+                    slot = static_cast<uint32_t>(probe - base);
+
+                    if (candidate < probe && size_t(probe - candidate) <= maxOffset && read32(candidate) == sequence) {
+                        ip = probe;
+                        match = candidate;
+                        break;
+                    }
+                }
+                if (!match) break;
+
+                // Grow the match backwards over any literals that also match, then forwards as far as allowed.
+                while (ip > anchor && match > base && ip[-1] == match[-1]) { ip--; match--; }
+                size_t length = minMatch;
+                while (ip + length < lastMatchEnd && ip[length] == match[length]) length++;
+
+                op = writeSequence(op, anchor, ip - anchor, ip - match, length);
+                ip += length;
+                anchor = ip;
+
+                if (ip <= lastMatchStart)
+                    table[hash(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - base);
+            }
+        }
+
+        op = writeSequence(op, anchor, end - anchor, 0, 0);
+        return op - reinterpret_cast<u8*>(out.data());
+    }
+
+    void lz::decompress(std::span<const std::byte> in, std::span<std::byte> out) {
+        const u8* ip = reinterpret_cast<const u8*>(in.data());
+        const u8* const end = ip + in.size();
+        u8* const outBegin = reinterpret_cast<u8*>(out.data());
+        u8* const outEnd = outBegin + out.size();
+        u8* op = outBegin;
+
+        while (true) {
+            if (ip >= end) corrupt("truncated sequence");
+            const u8 token = *ip++;
+
+            size_t literals = token >> 4;
+            if (literals == 15) literals += readLength(ip, end);
+            if (literals > size_t(end - ip) || literals > size_t(outEnd - op)) corrupt("literals out of bounds");
+            // Most runs of literals are short; away from the ends of the buffers, copy a fixed 16 bytes regardless.
+            if (literals <= 16 && end - ip >= 16 && outEnd - op >= 16)
+                std::memcpy(op, ip, 16);
+            else if (literals != 0)
+                std::memcpy(op, ip, literals);
+            op += literals;
+            ip += literals;
+
+            if (ip == end) break;
+
+            if (end - ip < 2) corrupt("truncated offset");
+            const size_t offset = ip[0] | (size_t(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > size_t(op - outBegin)) corrupt("offset out of bounds");
+
+            size_t length = token & 15;
+            if (length == 15) length += readLength(ip, end);
+            length += minMatch;
+            if (length > size_t(outEnd - op)) corrupt("match out of bounds");
+
+            // A match may overlap the bytes it produces (a repeating pattern), so copy no more than offset at once.
+            const u8* match = op - offset;
+            u8* const matchEnd = op + length;
+            if (offset >= 8 && size_t(outEnd - op) >= length + 8) {
+                // Room to overshoot: copy whole words, and let the next sequence overwrite the excess.
+                do {
+                    std::memcpy(op, match, 8);
+                    op += 8;
+                    match += 8;
+                } while (op < matchEnd);
+                op = matchEnd;
+            } else {
+                while (op < matchEnd) *op++ = *match++;
+            }
+        }
+
+        if (op != outEnd) corrupt("wrong decompressed size");
+    }
+
+    std::vector<std::byte> compressBlocks(std::span<const std::byte> in, uint32_t blockSize) {
+        return compressBlocks(in, blockSize, ThreadPool::shared());
+    }
+
+    std::vector<std::byte> compressBlocks(std::span<const std::byte> in, uint32_t blockSize, ThreadPool& pool) {
+        if (blockSize == 0)
+            throw std::runtime_error("Block size must not be zero");
+
+        const size_t count = (in.size() + blockSize - 1) / blockSize;
+        std::vector<std::vector<std::byte>> blocks(count);
+
+        pool.parallelFor(count, 1, [&](size_t begin, size_t last) {
+            for (size_t i = begin; i < last; i++) {
+                const auto raw = in.subspan(i * blockSize, std::min<size_t>(blockSize, in.size() - i * blockSize));
+                auto& block = blocks[i];
+                block.resize(lz::compressBound(raw.size()));
+                block.resize(lz::compress(raw, block));
+                if (block.size() >= raw.size())
+                    block.assign(raw.begin(), raw.end());
+            }
+        });
+
+        size_t total = headerSize + count * sizeof(uint32_t);
+        for (const auto& block : blocks) total += block.size();
+
+        std::vector<std::byte> stream(total);
+        const uint64_t size = in.size();
+        const uint32_t blockCount = static_cast<uint32_t>(count);
+        std::memcpy(stream.data(), &size, sizeof(size));
+        std::memcpy(stream.data() + 8, &blockSize, sizeof(blockSize));
+        std::memcpy(stream.data() + 12, &blockCount, sizeof(blockCount));
+
+        std::byte* table = stream.data() + headerSize;
+        std::byte* data = table + count * sizeof(uint32_t);
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t compressed = static_cast<uint32_t>(blocks[i].size());
+            std::memcpy(table + i * sizeof(uint32_t), &compressed, sizeof(compressed));
+            std::memcpy(data, blocks[i].data(), compressed);
+            data += compressed;
+        }
+
+        return stream;
+    }
+
+    uint64_t decompressedSize(std::span<const std::byte> stream) {
+        return readHeader(stream).size;
+    }
+
+    void decompressBlocks(std::span<const std::byte> stream, std::span<std::byte> out) {
+        decompressBlocks(stream, out, ThreadPool::shared());
+    }
+
+    void decompressBlocks(std::span<const std::byte> stream, std::span<std::byte> out, ThreadPool& pool) {
+        const StreamHeader header = readHeader(stream);
+        if (out.size() != header.size)
+            throw std::runtime_error("Decompression output buffer is the wrong size");
+
+        // Find where each block starts, checking the whole table before any work is handed out.
+        std::vector<uint64_t> offsets(header.blockCount + 1);
+        offsets[0] = headerSize + uint64_t(header.blockCount) * sizeof(uint32_t);
+        for (uint32_t i = 0; i < header.blockCount; i++) {
+            uint32_t compressed;
+            std::memcpy(&compressed, stream.data() + headerSize + i * sizeof(uint32_t), sizeof(compressed));
+            offsets[i + 1] = offsets[i] + compressed;
+        }
+        if (offsets.back() > stream.size()) corrupt("blocks run past the end of the stream");
+
+        pool.parallelFor(header.blockCount, 1, [&](size_t begin, size_t last) {
+            for (size_t i = begin; i < last; i++) {
+                const auto block = stream.subspan(offsets[i], offsets[i + 1] - offsets[i]);
+                const uint64_t start = uint64_t(i) * header.blockSize;
+                const auto target = out.subspan(start, std::min<uint64_t>(header.blockSize, header.size - start));
+
+                if (block.size() == target.size())
+                    std::memcpy(target.data(), block.data(), block.size());
+                else
+                    lz::decompress(block, target);
+            }
+        });
+    }
+}
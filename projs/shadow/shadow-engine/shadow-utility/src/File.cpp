@@ -1,26 +1,147 @@
 #include <shadow/util/File.h>
+#include <shadow/util/FlightRecorder.h>
+#include <algorithm>
+#include <stdexcept>
 #include <string>
-#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace shadowutil {
-    FileData* loadFile(std::string path) {
-        // Verify the file
-        std::ifstream file(path, std::ios::binary | std::ios::ate);
 
-        if (!file.is_open())
-            throw std::runtime_error("Unable to open specified file: " + std::string(path));
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path, Access access) {
+        const DWORD flags = access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Unable to open specified file: " + path);
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            throw std::runtime_error("Unable to read the size of file: " + path);
+        }
+
+        // Windows refuses to map an empty file; leave it as an empty view.
+        if (size.QuadPart != 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr)
+                begin = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+            if (begin == nullptr) {
+                if (mapping != nullptr) CloseHandle(mapping);
+                CloseHandle(file);
+                throw std::runtime_error("Unable to map file: " + path);
+            }
+            length = static_cast<size_t>(size.QuadPart);
+        }
+
+        // The view keeps the file open.
+        CloseHandle(file);
+    }
+
+    void MappedFile::prefetch(size_t offset, size_t bytes) const {
+        if (offset >= length) return;
+        WIN32_MEMORY_RANGE_ENTRY range { const_cast<std::byte*>(begin) + offset, std::min(bytes, length - offset) };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+
+    void MappedFile::close() {
+        if (begin != nullptr) UnmapViewOfFile(begin);
+        if (mapping != nullptr) CloseHandle(mapping);
+        begin = nullptr;
+        mapping = nullptr;
+        length = 0;
+    }
+#else
+    MappedFile::MappedFile(const std::string& path, Access access) {
+        const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+            throw std::runtime_error("Unable to open specified file: " + path);
+
+        struct stat info {};
+        if (fstat(file, &info) != 0) {
+            ::close(file);
+            throw std::runtime_error("Unable to read the size of file: " + path);
+        }
+
+        // mmap refuses a zero length; leave it as an empty view.
+        if (info.st_size != 0) {
+            void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(file);
+                throw std::runtime_error("Unable to map file: " + path);
+            }
+
+            begin = static_cast<const std::byte*>(mapped);
+            length = static_cast<size_t>(info.st_size);
+
+            if (access == Access::Sequential) {
+                madvise(mapped, length, MADV_SEQUENTIAL);
+                madvise(mapped, length, MADV_WILLNEED);
+            } else {
+                madvise(mapped, length, MADV_RANDOM);
+            }
+        }
+
+        // The mapping keeps the file open.
+        ::close(file);
+    }
+
+    void MappedFile::prefetch(size_t offset, size_t bytes) const {
+        if (offset >= length) return;
+        // madvise wants a page aligned start.
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t start = offset & ~(page - 1);
+        const size_t end = offset + std::min(bytes, length - offset);
+        madvise(const_cast<std::byte*>(begin) + start, end - start, MADV_WILLNEED);
+    }
+
+    void MappedFile::close() {
+        if (begin != nullptr) munmap(const_cast<std::byte*>(begin), length);
+        begin = nullptr;
+        length = 0;
+    }
+#endif
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            begin = std::exchange(other.begin, nullptr);
+            length = std::exchange(other.length, 0);
+#ifdef _WIN32
+            mapping = std::exchange(other.mapping, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile() { close(); }
 
-        auto* data = new FileData {};
+    MappedFile loadFile(const std::string& path) {
+        const uint64_t start = FlightRecorder::now();
+        MappedFile file(path, MappedFile::Access::Sequential);
 
-        // Read the file's size (opened with At The End, so just tellg the size)
-        size_t size = file.tellg();
-        data->data.resize(size);
-        data->size = size;
-        // Go to the front of the file
-        file.seekg(0);
-        // Read the file into the buffer
-        file.read(data->data.data(), size);
-        file.close();
+        // Every caller reads the whole file, so fault it all in now; otherwise the event would only time the mmap,
+        //  and the reads would be charged to whatever touched the pages first.
+        // 4KiB is the smallest page size on any platform we run on, so this reaches every page. The loads are volatile
+        //  so that they aren't optimized away.
+        const volatile std::byte* bytes = file.data().data();
+        for (size_t offset = 0; offset < file.size(); offset += 4096)
+            (void) bytes[offset];
 
-        return data;
+        FlightRecorder::recordAssetLoad(path, file.size(), start, FlightRecorder::now());
+        return file;
     }
-}
\ No newline at end of file
+}
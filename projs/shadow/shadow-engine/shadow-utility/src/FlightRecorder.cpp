@@ -0,0 +1,235 @@
+#include <shadow/util/FlightRecorder.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <vector>
+
+namespace shadowutil {
+
+    // 16k events * 128 bytes; 2MB is several seconds of a busy frame loop.
+    constexpr size_t ringSize = 1 << 14;
+    constexpr size_t ringMask = ringSize - 1;
+
+    static FlightRecorder::Event ring[ringSize];
+    static std::atomic<uint64_t> head { 0 };
+    static std::atomic<uint32_t> nextThread { 0 };
+
+    static const auto epoch = std::chrono::steady_clock::now();
+    static std::atomic<uint32_t> frame { 0 };
+    static uint64_t frameStart = 0;
+    static double lastFrameMs = 0;
+    static uint32_t spikes = 0;
+    // A sustained slowdown should produce one trace, not one per frame.
+    static uint32_t cooldownUntil = 0;
+
+    // The trace being written after a spike. Its destructor waits, so a trace started just before exit is still finished.
+    static std::future<bool> writing;
+
+    static FlightRecorder::Config& config() {
+        static FlightRecorder::Config conf {};
+        return conf;
+    }
+
+    static uint32_t threadId() {
+        thread_local const uint32_t id = nextThread.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    // Writers follow the seqlock pattern; the sequence is cleared while the slot is being written,
+    //  and set to the (non-zero) claim index once it's complete. Readers discard any slot that changed underneath them.
+    static FlightRecorder::Event& claim(uint64_t& index, FlightRecorder::EventType type, const char* name, uint64_t start, uint64_t duration, uint64_t value) {
+        index = head.fetch_add(1, std::memory_order_relaxed);
+        auto& event = ring[index & ringMask];
+
+        event.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        event.type = type;
+        event.name = name;
+        event.start = start;
+        event.duration = duration;
+        event.value = value;
+        event.frame = frame.load(std::memory_order_relaxed);
+        event.thread = threadId();
+        event.label[0] = '\0';
+        return event;
+    }
+
+    static void publish(FlightRecorder::Event& event, uint64_t index) {
+        event.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    // An event copied out of the ring, to be written out after the ring has moved on.
+    struct Record {
+        FlightRecorder::EventType type;
+        const char* name;
+        uint64_t start;
+        uint64_t duration;
+        uint64_t value;
+        uint32_t frame;
+        uint32_t thread;
+        char label[sizeof(FlightRecorder::Event::label)];
+    };
+
+    static void writeEscaped(std::ofstream& out, const char* str) {
+        for (; *str != '\0'; ++str) {
+            switch (*str) {
+                case '"': out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                default:
+                    if (static_cast<unsigned char>(*str) >= 0x20)
+                        out << *str;
+            }
+        }
+    }
+
+    // The events of the last `frames` frames, copied out of the ring.
+    static std::vector<Record> snapshot(uint32_t frames) {
+        const uint32_t current = frame.load(std::memory_order_relaxed);
+        const uint32_t oldest = current > frames ? current - frames : 0;
+
+        std::vector<Record> events;
+        events.reserve(ringSize);
+
+        for (size_t i = 0; i < ringSize; i++) {
+            const FlightRecorder::Event& slot = ring[i];
+
+            const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before == 0) continue;
+
+            Record copy { slot.type, slot.name, slot.start, slot.duration, slot.value, slot.frame, slot.thread, {} };
+            std::memcpy(copy.label, slot.label, sizeof(copy.label));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+
+            if (copy.frame >= oldest)
+                events.push_back(copy);
+        }
+
+        return events;
+    }
+
+    static bool write(const std::string& path, std::vector<Record> events) {
+        std::sort(events.begin(), events.end(), [](const Record& a, const Record& b) { return a.start < b.start; });
+
+        std::ofstream out(path, std::ios::trunc);
+        if (!out.is_open())
+            return false;
+
+        out << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto& event : events) {
+            if (!first) out << ",\n";
+            first = false;
+
+            const double ts = static_cast<double>(event.start) / 1e3;
+            const double dur = static_cast<double>(event.duration) / 1e3;
+
+            out << "{\"pid\":0,\"tid\":" << event.thread << ",\"ts\":" << std::fixed << ts << ",";
+            switch (event.type) {
+                case FlightRecorder::EventType::Zone:
+                    out << "\"ph\":\"X\",\"dur\":" << dur << ",\"name\":\"";
+                    writeEscaped(out, event.name);
+                    out << "\",\"args\":{\"frame\":" << event.frame << "}}";
+                    break;
+                case FlightRecorder::EventType::Frame:
+                    out << "\"ph\":\"X\",\"dur\":" << dur << ",\"name\":\"Frame " << event.frame << "\"}";
+                    break;
+                case FlightRecorder::EventType::Allocation:
+                    out << "\"ph\":\"i\",\"s\":\"t\",\"name\":\"";
+                    writeEscaped(out, event.name);
+                    out << "\",\"args\":{\"bytes\":" << event.value << "}}";
+                    break;
+                case FlightRecorder::EventType::AssetLoad:
+                    out << "\"ph\":\"X\",\"dur\":" << dur << ",\"name\":\"Load ";
+                    writeEscaped(out, event.label);
+                    out << "\",\"args\":{\"bytes\":" << event.value << "}}";
+                    break;
+            }
+        }
+        out << "\n]}\n";
+
+        return out.good();
+    }
+
+    void FlightRecorder::configure(const Config& conf) { config() = conf; }
+    const FlightRecorder::Config& FlightRecorder::getConfig() { return config(); }
+
+    uint64_t FlightRecorder::now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    uint32_t FlightRecorder::getFrame() { return frame.load(std::memory_order_relaxed); }
+    double FlightRecorder::getLastFrameMs() { return lastFrameMs; }
+    uint32_t FlightRecorder::getSpikeCount() { return spikes; }
+
+    void FlightRecorder::recordZone(const char* name, uint64_t start, uint64_t end) {
+        if (!config().enabled) return;
+        uint64_t index;
+        auto& event = claim(index, EventType::Zone, name, start, end - start, 0);
+        publish(event, index);
+    }
+
+    void FlightRecorder::recordAllocation(const char* name, uint64_t bytes) {
+        if (!config().enabled) return;
+        uint64_t index;
+        auto& event = claim(index, EventType::Allocation, name, now(), 0, bytes);
+        publish(event, index);
+    }
+
+    void FlightRecorder::recordAssetLoad(std::string_view path, uint64_t bytes, uint64_t start, uint64_t end) {
+        if (!config().enabled) return;
+        uint64_t index;
+        auto& event = claim(index, EventType::AssetLoad, nullptr, start, end - start, bytes);
+
+        // Keep the end of the path; the file name is the useful part.
+        const size_t length = std::min(path.size(), sizeof(event.label) - 1);
+        std::memcpy(event.label, path.data() + path.size() - length, length);
+        event.label[length] = '\0';
+
+        publish(event, index);
+    }
+
+    void FlightRecorder::beginFrame() {
+        frameStart = now();
+    }
+
+    void FlightRecorder::endFrame() {
+        const uint64_t end = now();
+        const uint32_t current = frame.load(std::memory_order_relaxed);
+        lastFrameMs = static_cast<double>(end - frameStart) / 1e6;
+
+        const auto& conf = config();
+        if (conf.enabled) {
+            uint64_t index;
+            auto& event = claim(index, EventType::Frame, "Frame", frameStart, end - frameStart, 0);
+            publish(event, index);
+
+            if (lastFrameMs > conf.budgetMs && current >= cooldownUntil) {
+                // Only the copy out of the ring happens here; the file is written on another thread, so a frame that
+                //  was already slow isn't followed by one stalled on the disk.
+                // A spike while the last trace is still being written is counted, but not written.
+                if (!writing.valid() || writing.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                    std::string path = conf.outputDir + "/spike-" + std::to_string(current) + ".json";
+                    writing = std::async(std::launch::async, [dir = conf.outputDir, path = std::move(path), events = snapshot(conf.historyFrames)]() mutable {
+                        std::error_code ignored;
+                        std::filesystem::create_directories(dir, ignored);
+                        return write(path, std::move(events));
+                    });
+                }
+                cooldownUntil = current + conf.historyFrames;
+                ++spikes;
+            }
+        }
+
+        frame.store(current + 1, std::memory_order_relaxed);
+    }
+
+    bool FlightRecorder::dump(const std::string& path, uint32_t frames) {
+        return write(path, snapshot(frames));
+    }
+}
@@ -0,0 +1,225 @@
+#include <shadow/util/Json.h>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace shadowutil {
+
+    namespace {
+        class Parser {
+        public:
+            explicit Parser(std::string_view text) : text(text) {}
+
+            JsonValue document() {
+                JsonValue result = value(0);
+                skipSpace();
+                if (pos != text.size())
+                    fail("Unexpected trailing characters");
+                return result;
+            }
+
+        private:
+            // Deep enough for any real document, shallow enough that a hostile one can't exhaust the stack.
+            static constexpr int maxDepth = 128;
+
+            [[noreturn]] void fail(const std::string& why) const {
+                throw std::runtime_error("Invalid JSON at offset " + std::to_string(pos) + ": " + why);
+            }
+
+            void skipSpace() {
+                while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r'))
+                    ++pos;
+            }
+
+            char peek() {
+                skipSpace();
+                if (pos >= text.size()) fail("Unexpected end of input");
+                return text[pos];
+            }
+
+            void expect(char c) {
+                if (peek() != c) fail(std::string("Expected '") + c + "'");
+                ++pos;
+            }
+
+            bool literal(std::string_view word) {
+                if (text.substr(pos, word.size()) != word) return false;
+                pos += word.size();
+                return true;
+            }
+
+            JsonValue value(int depth) {
+                if (depth > maxDepth) fail("Nested too deeply");
+
+                switch (peek()) {
+                    case '{': return object(depth);
+                    case '[': return array(depth);
+                    case '"': return JsonValue(string());
+                    case 't': if (literal("true")) return JsonValue(true); break;
+                    case 'f': if (literal("false")) return JsonValue(false); break;
+                    case 'n': if (literal("null")) return JsonValue(); break;
+                    default: return JsonValue(number());
+                }
+                fail("Unknown literal");
+            }
+
+            JsonValue object(int depth) {
+                expect('{');
+                JsonValue::Object members;
+                if (peek() == '}') { ++pos; return JsonValue(std::move(members)); }
+
+                while (true) {
+                    if (peek() != '"') fail("Expected a key");
+                    std::string key = string();
+                    expect(':');
+                    members.emplace_back(std::move(key), value(depth + 1));
+
+                    if (peek() == '}') { ++pos; return JsonValue(std::move(members)); }
+                    expect(',');
+                }
+            }
+
+            JsonValue array(int depth) {
+                expect('[');
+                JsonValue::Array elements;
+                if (peek() == ']') { ++pos; return JsonValue(std::move(elements)); }
+
+                while (true) {
+                    elements.push_back(value(depth + 1));
+                    if (peek() == ']') { ++pos; return JsonValue(std::move(elements)); }
+                    expect(',');
+                }
+            }
+
+            double number() {
+                const size_t start = pos;
+                if (pos < text.size() && text[pos] == '-') ++pos;
+                while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E' || text[pos] == '+' || text[pos] == '-'))
+                    ++pos;
+
+                double result = 0;
+                const auto [end, error] = std::from_chars(text.data() + start, text.data() + pos, result);
+                if (error != std::errc() || end != text.data() + pos || pos == start)
+                    fail("Invalid number");
+                return result;
+            }
+
+            uint32_t hex4() {
+                if (pos + 4 > text.size()) fail("Truncated escape");
+                uint32_t code = 0;
+                const auto [end, error] = std::from_chars(text.data() + pos, text.data() + pos + 4, code, 16);
+                if (error != std::errc() || end != text.data() + pos + 4) fail("Invalid escape");
+                pos += 4;
+                return code;
+            }
+
+            static void appendUtf8(std::string& out, uint32_t code) {
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                } else if (code < 0x10000) {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                } else {
+                    out += static_cast<char>(0xF0 | (code >> 18));
+                    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+
+            std::string string() {
+                expect('"');
+                std::string out;
+                while (true) {
+                    if (pos >= text.size()) fail("Unterminated string");
+                    const char c = text[pos++];
+                    if (c == '"') return out;
+                    if (c != '\\') { out += c; continue; }
+
+                    if (pos >= text.size()) fail("Unterminated string");
+                    switch (text[pos++]) {
+                        case '"': out += '"'; break;
+                        case '\\': out += '\\'; break;
+                        case '/': out += '/'; break;
+                        case 'b': out += '\b'; break;
+                        case 'f': out += '\f'; break;
+                        case 'n': out += '\n'; break;
+                        case 'r': out += '\r'; break;
+                        case 't': out += '\t'; break;
+                        case 'u': {
+                            uint32_t code = hex4();
+                            // Surrogate pair
+                            if (code >= 0xD800 && code < 0xDC00 && literal("\\u")) {
+                                const uint32_t low = hex4();
+                                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            appendUtf8(out, code);
+                            break;
+                        }
+                        default: fail("Unknown escape");
+                    }
+                }
+            }
+
+            std::string_view text;
+            size_t pos = 0;
+        };
+
+        [[noreturn]] void wrongType(const char* wanted) {
+            throw std::runtime_error(std::string("JSON value is not ") + wanted);
+        }
+    }
+
+    JsonValue JsonValue::parse(std::string_view text) {
+        return Parser(text).document();
+    }
+
+    bool JsonValue::asBool() const {
+        if (const auto* v = std::get_if<bool>(&value)) return *v;
+        wrongType("a bool");
+    }
+
+    double JsonValue::asNumber() const {
+        if (const auto* v = std::get_if<double>(&value)) return *v;
+        wrongType("a number");
+    }
+
+    int64_t JsonValue::asInt() const {
+        const double number = asNumber();
+        if (number != std::floor(number)) wrongType("an integer");
+        return static_cast<int64_t>(number);
+    }
+
+    const std::string& JsonValue::asString() const {
+        if (const auto* v = std::get_if<std::string>(&value)) return *v;
+        wrongType("a string");
+    }
+
+    const JsonValue::Array& JsonValue::asArray() const {
+        if (const auto* v = std::get_if<Array>(&value)) return *v;
+        wrongType("an array");
+    }
+
+    const JsonValue::Object& JsonValue::asObject() const {
+        if (const auto* v = std::get_if<Object>(&value)) return *v;
+        wrongType("an object");
+    }
+
+    const JsonValue* JsonValue::find(std::string_view key) const {
+        const auto* members = std::get_if<Object>(&value);
+        if (!members) return nullptr;
+        for (const auto& [name, member] : *members)
+            if (name == key) return &member;
+        return nullptr;
+    }
+
+    const JsonValue& JsonValue::operator[](std::string_view key) const {
+        if (const JsonValue* member = find(key)) return *member;
+        throw std::runtime_error("JSON object has no member \"" + std::string(key) + "\"");
+    }
+}
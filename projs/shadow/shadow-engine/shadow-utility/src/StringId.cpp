@@ -0,0 +1,56 @@
+#include <shadow/util/StringId.h>
+
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace shadowutil {
+
+    struct InternTable {
+        std::shared_mutex lock;
+        std::unordered_map<uint64_t, std::string> strings;
+    };
+
+    static InternTable& table() {
+        static InternTable instance;
+        return instance;
+    }
+
+    static std::runtime_error collision(const std::string& known, std::string_view str) {
+        return std::runtime_error("StringId collision between \"" + known + "\" and \"" + std::string(str) + "\"");
+    }
+
+    void StringId::record(uint64_t hash, std::string_view str) {
+        // Each thread remembers the strings it has already recorded, so converting one again takes no lock.
+        // The cache points into the shared table, whose strings never move or go away.
+        thread_local std::unordered_map<uint64_t, const std::string*> recorded;
+        if (const auto iter = recorded.find(hash); iter != recorded.end()) {
+            if (*iter->second != str)
+                throw collision(*iter->second, str);
+            return;
+        }
+
+        auto& interned = table();
+        std::unique_lock lock(interned.lock);
+        const auto [iter, inserted] = interned.strings.try_emplace(hash, str);
+        if (!inserted && iter->second != str)
+            throw collision(iter->second, str);
+        recorded.emplace(hash, &iter->second);
+    }
+
+    std::string StringId::str() const {
+        auto& interned = table();
+        {
+            std::shared_lock lock(interned.lock);
+            const auto iter = interned.strings.find(hash);
+            if (iter != interned.strings.end())
+                return iter->second;
+        }
+
+        char buffer[20];
+        std::snprintf(buffer, sizeof(buffer), "#%016llx", static_cast<unsigned long long>(hash));
+        return buffer;
+    }
+}
@@ -0,0 +1,112 @@
+#include <shadow/util/ThreadPool.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace shadowutil {
+
+    ThreadPool::ThreadPool(size_t threads) {
+        if (threads == 0) {
+            const unsigned hardware = std::thread::hardware_concurrency();
+            threads = hardware > 1 ? hardware - 1 : 1;
+        }
+
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++)
+            workers.emplace_back([this] { work(); });
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::scoped_lock guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    void ThreadPool::submit(std::function<void()> job, Priority priority) {
+        {
+            std::scoped_lock guard(lock);
+            queues[static_cast<size_t>(priority)].push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    void ThreadPool::work() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock guard(lock);
+                const auto ready = [this] {
+                    return stopping || std::any_of(queues.begin(), queues.end(), [](const auto& queue) { return !queue.empty(); });
+                };
+                wake.wait(guard, ready);
+
+                auto queue = std::find_if(queues.rbegin(), queues.rend(), [](const auto& q) { return !q.empty(); });
+                if (queue == queues.rend())
+                    return;     // Stopping, and nothing left to run
+
+                job = std::move(queue->front());
+                queue->pop_front();
+            }
+            job();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+        const size_t chunks = (count + grain - 1) / grain;
+
+        if (chunks == 1) {
+            body(0, count);
+            return;
+        }
+
+        // Shared with the helper jobs, which may only get to run after this call has returned.
+        struct Work {
+            std::atomic<size_t> next { 0 };
+            std::atomic<size_t> finished { 0 };
+            std::mutex lock;
+            std::condition_variable done;
+            std::exception_ptr error;
+        };
+        auto shared = std::make_shared<Work>();
+
+        // Helpers only ever run chunks they claim, and stop as soon as there are none left.
+        const auto run = [shared, count, grain, chunks, &body] {
+            size_t chunk;
+            while ((chunk = shared->next.fetch_add(1)) < chunks) {
+                try {
+                    body(chunk * grain, std::min(count, (chunk + 1) * grain));
+                } catch (...) {
+                    std::scoped_lock guard(shared->lock);
+                    if (!shared->error) shared->error = std::current_exception();
+                }
+
+                if (shared->finished.fetch_add(1) + 1 == chunks) {
+                    std::scoped_lock guard(shared->lock);
+                    shared->done.notify_all();
+                }
+            }
+        };
+
+        const size_t helpers = std::min(workers.size(), chunks - 1);
+        for (size_t i = 0; i < helpers; i++)
+            submit(run, Priority::Urgent);
+
+        run();
+
+        std::unique_lock guard(shared->lock);
+        shared->done.wait(guard, [&] { return shared->finished.load() == chunks; });
+        if (shared->error)
+            std::rethrow_exception(shared->error);
+    }
+
+    ThreadPool& ThreadPool::shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+}
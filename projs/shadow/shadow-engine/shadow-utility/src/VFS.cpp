@@ -0,0 +1,231 @@
+#include <shadow/util/VFS.h>
+#include <shadow/util/FlightRecorder.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+
+namespace shadowutil {
+
+    namespace {
+        uint32_t readU32(const std::byte* at) {
+            // Packages are little-endian, as is every platform the engine runs on.
+            uint32_t value;
+            std::memcpy(&value, at, sizeof(value));
+            return value;
+        }
+
+        std::string mountPrefix(std::string_view mountPoint) {
+            std::string prefix = VFS::normalize(mountPoint);
+            if (!prefix.empty() && prefix.back() != '/')
+                prefix += '/';
+            return prefix;
+        }
+    }
+
+    std::string VFS::normalize(std::string_view path) {
+        std::string out;
+        out.reserve(path.size());
+        for (char c : path) {
+            if (c == '\\') c = '/';
+            // Collapse runs of separators, and drop any at the start.
+            if (c == '/' && (out.empty() || out.back() == '/')) continue;
+            out += c;
+        }
+
+        while (out.starts_with("./"))
+            out.erase(0, 2);
+        return out;
+    }
+
+    void VFS::mountPackage(const std::string& path, std::string_view mountPoint, int priority) {
+        const uint64_t start = FlightRecorder::now();
+
+        auto source = std::make_unique<Source>();
+        source->path = path;
+        source->priority = priority;
+        source->package = std::make_unique<MappedFile>(path, MappedFile::Access::Random);
+
+        const std::span<const std::byte> bytes = source->package->data();
+        const std::string_view text = source->package->text();
+        const std::string prefix = mountPrefix(mountPoint);
+
+        const auto corrupt = [&](const std::string& why) {
+            return std::runtime_error("Package " + path + " is corrupt: " + why);
+        };
+
+        if (!text.starts_with("0S1V"))
+            throw corrupt("missing header");
+        size_t pos = text.find("\r\n");
+        if (pos == std::string_view::npos)
+            throw corrupt("missing header");
+        pos += 2;
+
+        while (pos < text.size()) {
+            // <kind>/<path>|<size>|
+            const size_t nameEnd = text.find('|', pos);
+            const size_t sizeEnd = nameEnd == std::string_view::npos ? nameEnd : text.find('|', nameEnd + 1);
+            if (sizeEnd == std::string_view::npos)
+                throw corrupt("truncated entry at offset " + std::to_string(pos));
+
+            const std::string_view name = text.substr(pos, nameEnd - pos);
+            uint64_t size = 0;
+            const auto [end, error] = std::from_chars(text.data() + nameEnd + 1, text.data() + sizeEnd, size);
+            if (error != std::errc() || end != text.data() + sizeEnd)
+                throw corrupt("bad size for " + std::string(name));
+
+            // <type><version><metadata length><payload length><metadata><payload>
+            const size_t body = sizeEnd + 1;
+            constexpr size_t fixed = 4 + 3 * sizeof(uint32_t);
+            if (size < fixed || body + size > bytes.size())
+                throw corrupt(std::string(name) + " runs past the end of the package");
+
+            Entry entry {};
+            std::memcpy(entry.type, text.data() + body, 4);
+            entry.version = readU32(bytes.data() + body + 4);
+            entry.metadataSize = readU32(bytes.data() + body + 8);
+            entry.payloadSize = readU32(bytes.data() + body + 12);
+            entry.metadata = body + fixed;
+            entry.payload = entry.metadata + entry.metadataSize;
+            if (fixed + entry.metadataSize + entry.payloadSize != size)
+                throw corrupt("sizes of " + std::string(name) + " do not add up");
+
+            if (name.starts_with("A/"))
+                source->entries.emplace_back(StringId::intern(prefix + normalize(name.substr(2))), entry);
+
+            pos = body + size;
+            if (text.substr(pos, 2) == "\r\n") pos += 2;
+        }
+
+        FlightRecorder::recordAssetLoad(path, 0, start, FlightRecorder::now());
+        add(std::move(source));
+    }
+
+    void VFS::mountIndex(const std::string& path, std::string_view mountPoint, int priority) {
+        const MappedFile index(path);
+        const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+        std::string_view text = index.text();
+        while (!text.empty()) {
+            const size_t end = std::min(text.find('\n'), text.size());
+            std::string_view line = text.substr(0, end);
+            text.remove_prefix(std::min(end + 1, text.size()));
+
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+            if (!line.empty())
+                mountPackage((directory / std::string(line)).string(), mountPoint, priority);
+        }
+    }
+
+    void VFS::mountDirectory(const std::string& path, std::string_view mountPoint, int priority) {
+        namespace fs = std::filesystem;
+        if (!fs::is_directory(path))
+            throw std::runtime_error("Unable to mount " + path + ": not a directory");
+
+        auto source = std::make_unique<Source>();
+        source->path = path;
+        source->priority = priority;
+        const std::string prefix = mountPrefix(mountPoint);
+
+        for (const auto& item : fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied)) {
+            if (!item.is_regular_file()) continue;
+
+            Entry entry {};
+            entry.file = static_cast<uint32_t>(source->files.size());
+            source->files.push_back(item.path().string());
+
+            const std::string relative = fs::relative(item.path(), path).generic_string();
+            source->entries.emplace_back(StringId::intern(prefix + normalize(relative)), entry);
+        }
+
+        source->mapped.resize(source->files.size());
+        add(std::move(source));
+    }
+
+    bool VFS::unmount(const std::string& path) {
+        std::unique_lock guard(lock);
+        const auto iter = std::find_if(sources.begin(), sources.end(), [&](const auto& source) { return source->path == path; });
+        if (iter == sources.end()) return false;
+
+        sources.erase(iter);
+        rebuild();
+        return true;
+    }
+
+    void VFS::add(std::unique_ptr<Source> source) {
+        std::unique_lock guard(lock);
+        source->order = mounts++;
+        sources.push_back(std::move(source));
+        rebuild();
+    }
+
+    // Merge every source's entries into the index, lowest priority first so that higher priorities overwrite.
+    void VFS::rebuild() {
+        std::stable_sort(sources.begin(), sources.end(), [](const auto& a, const auto& b) {
+            return a->priority != b->priority ? a->priority < b->priority : a->order < b->order;
+        });
+
+        size_t total = 0;
+        for (const auto& source : sources) total += source->entries.size();
+
+        index.clear();
+        index.reserve(total);
+        for (size_t i = 0; i < sources.size(); i++) {
+            for (const auto& [name, entry] : sources[i]->entries) {
+                Entry& slot = index[name];
+                slot = entry;
+                slot.source = static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    VFS::File VFS::resolve(const Entry& entry) const {
+        Source& source = *sources[entry.source];
+
+        if (source.package) {
+            const std::byte* base = source.package->data().data();
+            return File {
+                std::string_view(entry.type, 4), entry.version,
+                std::string_view(reinterpret_cast<const char*>(base + entry.metadata), entry.metadataSize),
+                std::span<const std::byte>(base + entry.payload, entry.payloadSize)
+            };
+        }
+
+        std::scoped_lock guard(mapLock);
+        auto& mapped = source.mapped[entry.file];
+        if (!mapped)
+            mapped = std::make_unique<MappedFile>(loadFile(source.files[entry.file]));
+        return File { {}, 0, {}, mapped->data() };
+    }
+
+    bool VFS::exists(std::string_view path) const {
+        const StringId id = key(path);
+        std::shared_lock guard(lock);
+        return index.contains(id);
+    }
+
+    std::optional<VFS::File> VFS::find(std::string_view path) const {
+        const StringId id = key(path);
+        std::shared_lock guard(lock);
+        const auto iter = index.find(id);
+        if (iter == index.end()) return std::nullopt;
+        return resolve(iter->second);
+    }
+
+    VFS::File VFS::open(std::string_view path) const {
+        if (auto file = find(path)) return *file;
+        throw std::runtime_error("No mounted file at " + normalize(path));
+    }
+
+    size_t VFS::size() const {
+        std::shared_lock guard(lock);
+        return index.size();
+    }
+
+    VFS& VFS::get() {
+        static VFS instance;
+        return instance;
+    }
+}
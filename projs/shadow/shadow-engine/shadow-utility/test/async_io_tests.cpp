@@ -0,0 +1,264 @@
+#include "catch2/catch.hpp"
+#include <shadow/util/AsyncIO.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using shadowutil::AsyncIO;
+using shadowutil::Priority;
+
+namespace {
+    namespace fs = std::filesystem;
+
+    struct TempDir {
+        explicit TempDir(const std::string& name) : path(fs::temp_directory_path() / ("shadow-asyncio-" + name)) {
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+        ~TempDir() { fs::remove_all(path); }
+
+        std::string write(const std::string& name, std::string_view contents) const {
+            const fs::path file = path / name;
+            std::ofstream(file, std::ios::binary).write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            return file.string();
+        }
+
+        fs::path path;
+    };
+
+    std::string text(std::span<const std::byte> bytes) {
+        return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+    }
+
+    // Every test runs against both backends. io_uring is often blocked inside containers; it is skipped there.
+    std::unique_ptr<AsyncIO> start(AsyncIO::Backend backend) {
+        try {
+            return std::make_unique<AsyncIO>(backend);
+        } catch (const std::exception& e) {
+            WARN("Skipping the io_uring backend: " << e.what());
+            return nullptr;
+        }
+    }
+
+#if !defined(_WIN32)
+    // How many reads each backend has underway at once: half of its 256-entry ring, or one per I/O thread.
+    size_t capacity(const AsyncIO& io) {
+        return io.getBackend() == AsyncIO::Backend::IOUring ? 128 : 4;
+    }
+
+    // A FIFO that nothing is written to until the test says so. Reads of it stay underway, which fills the backend
+    //  and leaves anything submitted afterwards queued behind them.
+    struct Plug {
+        Plug(AsyncIO& io, const fs::path& path) : path(path) {
+            REQUIRE(mkfifo(path.c_str(), 0600) == 0);
+            // Opened for reading too, so that neither this nor the backend's readers block in open().
+            writer = open(path.c_str(), O_RDWR);
+            REQUIRE(writer >= 0);
+
+            for (size_t i = 0; i < capacity(io); i++)
+                tickets.push_back(io.read({ path.string(), bytes[i], 0, Priority::Normal, {} }));
+            // The thread backend takes its reads off the queue in its own time.
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        ~Plug() {
+            release(tickets.size() - released);
+            close(writer);
+        }
+
+        // Let reads of the FIFO through one at a time, so that each frees exactly one slot.
+        void release(size_t count) {
+            for (size_t i = 0; i < count; i++, released++) {
+                REQUIRE(write(writer, "x", 1) == 1);
+                while (std::count_if(tickets.begin(), tickets.end(), [](const auto& t) { return t.done(); }) <= ptrdiff_t(released))
+                    std::this_thread::yield();
+            }
+        }
+
+        fs::path path;
+        int writer = -1;
+        std::byte bytes[128][1] {};
+        std::vector<AsyncIO::Ticket> tickets;
+        size_t released = 0;
+    };
+#endif
+}
+
+TEST_CASE("A batch of reads lands in the caller's buffers", "[asyncio]") {
+    const auto io = start(GENERATE(AsyncIO::Backend::IOUring, AsyncIO::Backend::Threads));
+    if (!io) return;
+    const TempDir dir("batch");
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < 16; i++)
+        paths.push_back(dir.write("file" + std::to_string(i), "contents of file " + std::to_string(i)));
+    const std::string large(300000, 'L');
+    paths.push_back(dir.write("large", large));
+
+    std::vector<std::vector<std::byte>> buffers;
+    std::vector<AsyncIO::Request> requests;
+    for (const auto& path : paths)
+        buffers.emplace_back(AsyncIO::fileSize(path));
+    // One read from part way in, and one with more room than the file has.
+    std::vector<std::byte> tail(4), spare(64);
+    buffers.push_back(std::move(tail));
+    buffers.push_back(std::move(spare));
+
+    for (size_t i = 0; i < paths.size(); i++)
+        requests.push_back({ paths[i], buffers[i], 0, Priority::Normal, {} });
+    requests.push_back({ paths[3], buffers[paths.size()], 14, Priority::Normal, {} });
+    requests.push_back({ paths[5], buffers[paths.size() + 1], 0, Priority::Normal, {} });
+
+    const auto tickets = io->read(std::move(requests));
+    REQUIRE(tickets.size() == paths.size() + 2);
+    for (const auto& ticket : tickets) {
+        const auto& result = ticket.wait();
+        REQUIRE(result.status == AsyncIO::Status::Complete);
+        REQUIRE(result.error.empty());
+    }
+
+    for (int i = 0; i < 16; i++) {
+        REQUIRE(tickets[i].wait().bytes == buffers[i].size());
+        REQUIRE(text(buffers[i]) == "contents of file " + std::to_string(i));
+    }
+    REQUIRE(buffers[16].size() == large.size());
+    REQUIRE(std::all_of(buffers[16].begin(), buffers[16].end(), [](std::byte b) { return b == std::byte('L'); }));
+    REQUIRE(text(buffers[17]) == "le 3");
+    REQUIRE(tickets[18].wait().bytes == 18);
+    REQUIRE(text(std::span(buffers[18]).first(18)) == "contents of file 5");
+}
+
+TEST_CASE("A missing file fails its read", "[asyncio]") {
+    const auto io = start(GENERATE(AsyncIO::Backend::IOUring, AsyncIO::Backend::Threads));
+    if (!io) return;
+    const TempDir dir("missing");
+
+    std::byte buffer[16];
+    AsyncIO::Result seen;
+    const auto ticket = io->read({ (dir.path / "nothing here").string(), buffer, 0, Priority::Normal,
+                                   [&](const AsyncIO::Result& result) { seen = result; } });
+
+    const auto& result = ticket.wait();
+    REQUIRE(result.status == AsyncIO::Status::Failed);
+    REQUIRE(result.bytes == 0);
+    REQUIRE_THAT(result.error, Catch::Contains("nothing here"));
+
+    // Failures are reported through the callback as well.
+    REQUIRE(io->poll() == 1);
+    REQUIRE(seen.status == AsyncIO::Status::Failed);
+}
+
+TEST_CASE("Callbacks only run inside poll", "[asyncio]") {
+    const auto io = start(GENERATE(AsyncIO::Backend::IOUring, AsyncIO::Backend::Threads));
+    if (!io) return;
+    const TempDir dir("poll");
+    const auto path = dir.write("file", "polled");
+
+    const auto caller = std::this_thread::get_id();
+    std::byte buffer[6];
+    int calls = 0;
+    std::thread::id ranOn;
+    const auto ticket = io->read({ path, buffer, 0, Priority::Normal, [&](const AsyncIO::Result& result) {
+        calls++;
+        ranOn = std::this_thread::get_id();
+        REQUIRE(result.status == AsyncIO::Status::Complete);
+        REQUIRE(result.bytes == 6);
+    } });
+
+    REQUIRE(ticket.wait().status == AsyncIO::Status::Complete);
+    REQUIRE(ticket.done());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(calls == 0);
+
+    REQUIRE(io->poll() == 1);
+    REQUIRE(calls == 1);
+    REQUIRE(ranOn == caller);
+    REQUIRE(text(buffer) == "polled");
+
+    REQUIRE(io->poll() == 0);
+    REQUIRE(calls == 1);
+}
+
+#if !defined(_WIN32)
+TEST_CASE("Queued reads can be cancelled", "[asyncio]") {
+    const auto io = start(GENERATE(AsyncIO::Backend::IOUring, AsyncIO::Backend::Threads));
+    if (!io) return;
+    const TempDir dir("cancel");
+    const auto path = dir.write("file", "never read");
+
+    std::vector<AsyncIO::Status> called;
+    std::byte buffers[8][10] {};
+    std::vector<AsyncIO::Ticket> tickets;
+    {
+        Plug plug(*io, dir.path / "plug");
+        for (auto& buffer : buffers)
+            tickets.push_back(io->read({ path, buffer, 0, Priority::Normal,
+                                         [&](const AsyncIO::Result& result) { called.push_back(result.status); } }));
+        for (size_t i = 0; i < tickets.size(); i += 2)
+            tickets[i].cancel();
+
+        // Cancelling a read that has not started finishes it there and then.
+        for (size_t i = 0; i < tickets.size(); i += 2) {
+            REQUIRE(tickets[i].status() == AsyncIO::Status::Cancelled);
+            REQUIRE(tickets[i].wait().bytes == 0);
+        }
+        for (size_t i = 1; i < tickets.size(); i += 2)
+            REQUIRE(tickets[i].status() == AsyncIO::Status::Pending);
+    }
+
+    for (size_t i = 0; i < tickets.size(); i++) {
+        const bool cancelled = i % 2 == 0;
+        REQUIRE(tickets[i].wait().status == (cancelled ? AsyncIO::Status::Cancelled : AsyncIO::Status::Complete));
+        REQUIRE(text(buffers[i]) == (cancelled ? std::string(10, '\0') : "never read"));
+        // Cancelling a finished read changes nothing.
+        tickets[i].cancel();
+        REQUIRE(tickets[i].done());
+    }
+
+    REQUIRE(io->poll() == 8);
+    REQUIRE(std::count(called.begin(), called.end(), AsyncIO::Status::Cancelled) == 4);
+    REQUIRE(std::count(called.begin(), called.end(), AsyncIO::Status::Complete) == 4);
+}
+
+TEST_CASE("Once the backend is full, more urgent reads go first", "[asyncio]") {
+    const auto io = start(GENERATE(AsyncIO::Backend::IOUring, AsyncIO::Backend::Threads));
+    if (!io) return;
+    const TempDir dir("priority");
+    const auto path = dir.write("file", "data");
+
+    std::vector<std::string> order;
+    std::byte buffers[12][4];
+    std::vector<AsyncIO::Ticket> tickets;
+    {
+        Plug plug(*io, dir.path / "plug");
+        // Submitted least urgent first, so that only the queue can put them the other way round.
+        const Priority priorities[] { Priority::Background, Priority::Normal, Priority::Urgent };
+        const char* names[] { "background", "normal", "urgent" };
+        for (int p = 0; p < 3; p++)
+            for (int i = 0; i < 4; i++)
+                tickets.push_back(io->read({ path, buffers[p * 4 + i], 0, priorities[p],
+                                             [&order, name = names[p]](const AsyncIO::Result&) { order.push_back(name); } }));
+        for (const auto& ticket : tickets)
+            REQUIRE(ticket.status() == AsyncIO::Status::Pending);
+
+        // One slot frees up; everything queued goes through it one read at a time.
+        plug.release(1);
+        for (const auto& ticket : tickets)
+            REQUIRE(ticket.wait().status == AsyncIO::Status::Complete);
+    }
+
+    REQUIRE(io->poll() == 12);
+    const std::vector<std::string> expected {
+        "urgent", "urgent", "urgent", "urgent", "normal", "normal", "normal", "normal",
+        "background", "background", "background", "background",
+    };
+    REQUIRE(order == expected);
+}
+#endif
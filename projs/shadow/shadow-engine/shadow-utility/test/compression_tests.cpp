@@ -0,0 +1,167 @@
+#include "catch2/catch.hpp"
+#include <shadow/util/Compression.h>
+#include <shadow/util/ThreadPool.h>
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace shadowutil;
+
+namespace {
+    std::vector<std::byte> bytes(std::string_view text) {
+        const auto view = std::as_bytes(std::span(text.data(), text.size()));
+        return { view.begin(), view.end() };
+    }
+
+    std::vector<std::byte> randomBytes(size_t size, uint32_t seed) {
+        std::mt19937 random(seed);
+        std::vector<std::byte> out(size);
+        for (auto& b : out) b = static_cast<std::byte>(random());
+        return out;
+    }
+
+    // Text with plenty of repeats, at both short and long distances.
+    std::vector<std::byte> repetitive(size_t size) {
+        std::string text;
+        for (size_t i = 0; text.size() < size; i++)
+            text += "vertex " + std::to_string(i % 97) + " " + std::to_string(i % 13) + (i % 5 ? " aaaa\n" : "\n");
+        text.resize(size);
+        return bytes(text);
+    }
+
+    std::vector<std::byte> compress(std::span<const std::byte> in) {
+        std::vector<std::byte> out(lz::compressBound(in.size()));
+        out.resize(lz::compress(in, out));
+        return out;
+    }
+
+    std::vector<std::byte> decompress(std::span<const std::byte> in, size_t size) {
+        std::vector<std::byte> out(size);
+        lz::decompress(in, out);
+        return out;
+    }
+}
+
+TEST_CASE("lz round trips", "[compression]") {
+    const std::vector<std::vector<std::byte>> inputs {
+        {},
+        bytes("x"),
+        bytes("abcabcabcabcabcabcabcabcabcabcabc"),     // A match that overlaps its own output
+        std::vector<std::byte>(1 << 20, std::byte { 0 }),
+        randomBytes(100000, 1),
+        repetitive(70000),                              // Crosses the 64KiB match window
+        repetitive(13),
+    };
+
+    for (const auto& input : inputs) {
+        const auto compressed = compress(input);
+        REQUIRE(compressed.size() <= lz::compressBound(input.size()));
+        REQUIRE(decompress(compressed, input.size()) == input);
+    }
+
+    REQUIRE(compress(inputs[3]).size() < inputs[3].size() / 100);
+    REQUIRE(compress(inputs[5]).size() < inputs[5].size() / 2);
+}
+
+TEST_CASE("lz refuses buffers of the wrong size", "[compression]") {
+    const auto input = repetitive(5000);
+    std::vector<std::byte> small(lz::compressBound(input.size()) - 1);
+    REQUIRE_THROWS(lz::compress(input, small));
+
+    const auto compressed = compress(input);
+    REQUIRE_THROWS(decompress(compressed, input.size() - 1));
+    REQUIRE_THROWS(decompress(compressed, input.size() + 1));
+}
+
+TEST_CASE("lz rejects corrupt input without leaving its buffers", "[compression]") {
+    const auto input = repetitive(20000);
+    const auto compressed = compress(input);
+
+    SECTION("Truncated") {
+        for (size_t length = 0; length < compressed.size(); length += 7)
+            REQUIRE_THROWS(decompress(std::span(compressed).first(length), input.size()));
+    }
+
+    SECTION("Damaged") {
+        // Most damage is detected; the rest must at least stay in bounds, which the sanitizers check.
+        std::mt19937 random(2);
+        for (int trial = 0; trial < 2000; trial++) {
+            auto damaged = compressed;
+            for (int flips = 0; flips < 3; flips++)
+                damaged[random() % damaged.size()] ^= static_cast<std::byte>(1 + random() % 255);
+            try {
+                decompress(damaged, input.size());
+            } catch (const std::runtime_error&) {}
+        }
+    }
+}
+
+TEST_CASE("Block streams round trip", "[compression]") {
+    ThreadPool pool(3);
+    const auto text = repetitive(300000);
+    const auto noise = randomBytes(5000, 3);
+
+    for (const uint32_t blockSize : { 1u, 4096u, 65536u, defaultBlockSize, 1u << 20 }) {
+        const auto stream = compressBlocks(text, blockSize, pool);
+        REQUIRE(decompressedSize(stream) == text.size());
+
+        std::vector<std::byte> out(text.size());
+        decompressBlocks(stream, out, pool);
+        REQUIRE(out == text);
+    }
+
+    // Blocks that don't compress are stored as they are.
+    const auto stored = compressBlocks(noise, 1024, pool);
+    REQUIRE(stored.size() == 16 + 5 * sizeof(uint32_t) + noise.size());
+    std::vector<std::byte> out(noise.size());
+    decompressBlocks(stored, out, pool);
+    REQUIRE(out == noise);
+
+    const auto empty = compressBlocks({}, defaultBlockSize, pool);
+    REQUIRE(decompressedSize(empty) == 0);
+    decompressBlocks(empty, {}, pool);
+
+    REQUIRE_THROWS(compressBlocks(text, 0, pool));
+}
+
+TEST_CASE("Block streams reject corrupt headers and tables", "[compression]") {
+    ThreadPool pool(2);
+    const auto text = repetitive(50000);
+    const auto stream = compressBlocks(text, 8192, pool);
+    std::vector<std::byte> out(text.size());
+
+    const auto patch = [&](size_t offset, auto value) {
+        auto changed = stream;
+        std::memcpy(changed.data() + offset, &value, sizeof(value));
+        return changed;
+    };
+
+    SECTION("Truncated") {
+        for (const size_t length : { size_t(0), size_t(15), size_t(16), size_t(30), stream.size() - 1 }) {
+            const auto cut = std::span(stream).first(length);
+            REQUIRE_THROWS(decompressBlocks(cut, out, pool));
+        }
+    }
+
+    SECTION("Wrong size") {
+        std::vector<std::byte> small(text.size() - 1);
+        REQUIRE_THROWS(decompressBlocks(stream, small, pool));
+        REQUIRE_THROWS(decompressBlocks(patch(0, uint64_t(text.size() + 1)), out, pool));
+    }
+
+    SECTION("Wrong block size or count") {
+        REQUIRE_THROWS(decompressedSize(patch(8, uint32_t(0))));
+        REQUIRE_THROWS(decompressedSize(patch(8, uint32_t(4096))));
+        REQUIRE_THROWS(decompressedSize(patch(12, uint32_t(0xffffffff))));
+    }
+
+    SECTION("Blocks that run past the end") {
+        REQUIRE_THROWS(decompressBlocks(patch(16, uint32_t(0xffffffff)), out, pool));
+    }
+
+    SECTION("A block's size changed") {
+        uint32_t first;
+        std::memcpy(&first, stream.data() + 16, sizeof(first));
+        REQUIRE_THROWS(decompressBlocks(patch(16, first - 1), out, pool));
+    }
+}
@@ -0,0 +1,140 @@
+#include "catch2/catch.hpp"
+#include <shadow/util/FlatHashMap.h>
+#include <shadow/util/FlatMap.h>
+#include <shadow/util/SmallVector.h>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using shadowutil::FlatHashMap;
+using shadowutil::FlatMap;
+using shadowutil::SmallVector;
+
+namespace {
+    // Puts every key in one of a few buckets, so that probe runs are long and erasing has to shift entries back.
+    struct Clumped {
+        size_t operator()(uint64_t key) const { return key % 4; }
+    };
+
+    struct Seeded {
+        uint64_t seed = 0;
+        size_t operator()(uint64_t key) const { return static_cast<size_t>(key ^ seed); }
+    };
+}
+
+TEMPLATE_TEST_CASE("FlatHashMap behaves like std::unordered_map", "[containers]", std::hash<uint64_t>, Clumped) {
+    FlatHashMap<uint64_t, int, TestType> flat;
+    std::unordered_map<uint64_t, int> reference;
+    std::mt19937_64 random(1);
+
+    for (int step = 0; step < 20000; step++) {
+        const uint64_t key = random() % 512;
+        switch (random() % 3) {
+            case 0:
+                REQUIRE(flat.try_emplace(key, step).second == reference.try_emplace(key, step).second);
+                break;
+            case 1:
+                REQUIRE(flat.erase(key) == reference.erase(key));
+                break;
+            case 2:
+                REQUIRE(flat.contains(key) == reference.contains(key));
+                if (reference.contains(key))
+                    REQUIRE(flat.at(key) == reference.at(key));
+                break;
+        }
+        REQUIRE(flat.size() == reference.size());
+    }
+
+    size_t walked = 0;
+    for (const auto& [key, value] : flat) {
+        REQUIRE(reference.at(key) == value);
+        walked++;
+    }
+    REQUIRE(walked == reference.size());
+}
+
+TEST_CASE("FlatHashMap holds values that own memory", "[containers]") {
+    FlatHashMap<std::string, std::string> map;
+    for (int i = 0; i < 1000; i++)
+        map["key " + std::to_string(i)] = std::string(100, static_cast<char>('a' + i % 26));
+    for (int i = 0; i < 1000; i += 2)
+        map.erase("key " + std::to_string(i));
+
+    REQUIRE(map.size() == 500);
+    REQUIRE(map.at("key 1") == std::string(100, 'b'));
+    REQUIRE_FALSE(map.contains("key 2"));
+    REQUIRE_THROWS_AS(map.at("key 2"), std::out_of_range);
+}
+
+TEST_CASE("FlatHashMap copies keep the hasher", "[containers]") {
+    FlatHashMap<uint64_t, int, Seeded> original(Seeded { 0x5eed });
+    for (uint64_t i = 0; i < 100; i++)
+        original[i] = static_cast<int>(i);
+
+    const FlatHashMap<uint64_t, int, Seeded> copy(original);
+    REQUIRE(copy.hash_function().seed == 0x5eed);
+    REQUIRE(copy.size() == 100);
+    for (uint64_t i = 0; i < 100; i++)
+        REQUIRE(copy.at(i) == static_cast<int>(i));
+
+    FlatHashMap<uint64_t, int, Seeded> assigned;
+    assigned = copy;
+    REQUIRE(assigned.hash_function().seed == 0x5eed);
+    REQUIRE(assigned.at(42) == 42);
+}
+
+TEST_CASE("FlatMap stays sorted", "[containers]") {
+    FlatMap<int, std::string> flat;
+    std::map<int, std::string> reference;
+    std::mt19937 random(2);
+
+    for (int step = 0; step < 2000; step++) {
+        const int key = static_cast<int>(random() % 64);
+        if (random() % 4 == 0) {
+            REQUIRE(flat.erase(key) == reference.erase(key));
+        } else {
+            flat[key] = std::to_string(step);
+            reference[key] = std::to_string(step);
+        }
+    }
+
+    REQUIRE(flat.size() == reference.size());
+    auto expected = reference.begin();
+    for (const auto& [key, value] : flat) {
+        REQUIRE(key == expected->first);
+        REQUIRE(value == expected->second);
+        ++expected;
+    }
+}
+
+TEST_CASE("SmallVector moves out of its inline storage when it grows", "[containers]") {
+    SmallVector<std::string, 4> vector;
+    for (int i = 0; i < 4; i++)
+        vector.push_back(std::to_string(i));
+    REQUIRE(vector.isInline());
+
+    vector.push_back("4");
+    REQUIRE_FALSE(vector.isInline());
+    REQUIRE(vector.size() == 5);
+    for (int i = 0; i < 5; i++)
+        REQUIRE(vector[i] == std::to_string(i));
+
+    SmallVector<std::string, 4> copy(vector);
+    REQUIRE(std::equal(copy.begin(), copy.end(), vector.begin(), vector.end()));
+
+    SmallVector<std::string, 4> moved(std::move(copy));
+    REQUIRE(moved.size() == 5);
+    REQUIRE(moved.back() == "4");
+
+    SmallVector<std::string, 4> small { "a", "b" };
+    moved = small;
+    REQUIRE(moved.size() == 2);
+    REQUIRE(moved[1] == "b");
+
+    moved.resize(6);
+    REQUIRE(moved.size() == 6);
+    REQUIRE(moved[5].empty());
+    moved.clear();
+    REQUIRE(moved.empty());
+}
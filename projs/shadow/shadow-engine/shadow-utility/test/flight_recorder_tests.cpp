@@ -0,0 +1,129 @@
+#include "catch2/catch.hpp"
+#include <shadow/util/FlightRecorder.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using shadowutil::FlightRecorder;
+
+namespace {
+    namespace fs = std::filesystem;
+
+    // The recorder is a single process-wide ring, so each test configures it for itself and works out what it
+    //  expects from the frame counter rather than from zero.
+    struct TempDir {
+        explicit TempDir(const std::string& name) : path(fs::temp_directory_path() / ("shadow-flight-" + name)) {
+            fs::remove_all(path);
+        }
+        ~TempDir() { fs::remove_all(path); }
+
+        fs::path path;
+    };
+
+    std::string read(const fs::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return { std::istreambuf_iterator<char>(in), {} };
+    }
+
+    size_t count(const std::string& text, const std::string& part) {
+        size_t found = 0;
+        for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)) found++;
+        return found;
+    }
+
+    // Spike traces are written on another thread; a finished one ends with the closing brackets.
+    std::string waitForTrace(const fs::path& path) {
+        for (int attempt = 0; attempt < 500; attempt++) {
+            const std::string text = read(path);
+            if (text.size() >= 4 && text.compare(text.size() - 4, 4, "\n]}\n") == 0) return text;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return {};
+    }
+
+    void frame(const char* zone, size_t zones = 1) {
+        FlightRecorder::beginFrame();
+        for (size_t i = 0; i < zones; i++) {
+            const uint64_t start = FlightRecorder::now();
+            FlightRecorder::recordZone(zone, start, start + 1000);
+        }
+        FlightRecorder::endFrame();
+    }
+}
+
+TEST_CASE("Dumps hold only the frames asked for", "[flightrecorder]") {
+    const TempDir dir("history");
+    FlightRecorder::configure({ 1e9, 180, dir.path.string(), true });
+
+    for (int i = 0; i < 10; i++) frame("old frame");
+    const uint32_t first = FlightRecorder::getFrame();
+    for (int i = 0; i < 5; i++) frame("recent frame");
+
+    fs::create_directories(dir.path);
+    const auto path = (dir.path / "last.json").string();
+    REQUIRE(FlightRecorder::dump(path, 5));
+    const std::string trace = read(path);
+
+    REQUIRE(count(trace, "\"name\":\"recent frame\"") == 5);
+    REQUIRE(count(trace, "\"name\":\"old frame\"") == 0);
+    for (uint32_t f = first; f < first + 5; f++)
+        REQUIRE(count(trace, "\"name\":\"Frame " + std::to_string(f) + "\"") == 1);
+    REQUIRE(count(trace, "\"name\":\"Frame " + std::to_string(first - 1) + "\"") == 0);
+}
+
+TEST_CASE("The ring keeps the newest events once it wraps around", "[flightrecorder]") {
+    const TempDir dir("wrap");
+    FlightRecorder::configure({ 1e9, 180, dir.path.string(), true });
+
+    // Far more events than the ring holds, spread over a few frames.
+    frame("overwritten", 20000);
+    frame("overwritten", 20000);
+    frame("kept", 1000);
+
+    fs::create_directories(dir.path);
+    const auto path = (dir.path / "wrapped.json").string();
+    REQUIRE(FlightRecorder::dump(path, 10));
+    const std::string trace = read(path);
+
+    REQUIRE(count(trace, "\"name\":\"kept\"") == 1000);
+    REQUIRE(count(trace, "\"name\":\"overwritten\"") > 0);
+    // Every slot of the 16k-event ring is full, of the newest events.
+    REQUIRE(count(trace, "{\"pid\":0,") == size_t(1) << 14);
+}
+
+TEST_CASE("A frame over budget writes one trace of the frames before it", "[flightrecorder]") {
+    const TempDir dir("spike");
+    FlightRecorder::configure({ 50, 4, dir.path.string(), true });
+    const uint32_t spikes = FlightRecorder::getSpikeCount();
+
+    for (int i = 0; i < 3; i++) {
+        FlightRecorder::beginFrame();
+        const uint64_t start = FlightRecorder::now();
+        FlightRecorder::recordZone("before spike", start, start + 1000);
+        FlightRecorder::recordAssetLoad("meshes/before-spike.obj", 4096, start, start + 2000);
+        FlightRecorder::endFrame();
+    }
+
+    // Two slow frames in a row make one trace: the second is inside the first's cooldown.
+    const uint32_t slow = FlightRecorder::getFrame();
+    for (int i = 0; i < 2; i++) {
+        FlightRecorder::beginFrame();
+        {
+            FlightRecorder::Zone zone("slow");
+            std::this_thread::sleep_for(std::chrono::milliseconds(80));
+        }
+        FlightRecorder::endFrame();
+    }
+    REQUIRE(FlightRecorder::getLastFrameMs() > 50);
+    REQUIRE(FlightRecorder::getSpikeCount() == spikes + 1);
+
+    const std::string trace = waitForTrace(dir.path / ("spike-" + std::to_string(slow) + ".json"));
+    REQUIRE_FALSE(trace.empty());
+    REQUIRE(std::distance(fs::directory_iterator(dir.path), fs::directory_iterator()) == 1);
+
+    REQUIRE(count(trace, "\"name\":\"before spike\"") == 3);
+    REQUIRE(count(trace, "\"name\":\"Load meshes/before-spike.obj\",\"args\":{\"bytes\":4096}") == 3);
+    REQUIRE(count(trace, "\"name\":\"slow\"") == 1);
+
+    FlightRecorder::configure({});
+}
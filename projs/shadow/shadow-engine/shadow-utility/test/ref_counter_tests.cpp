@@ -0,0 +1,108 @@
+#include "catch2/catch.hpp"
+#include <shadow/util/RefCounter.h>
+
+namespace {
+    // Each test uses its own Tag, so that it gets a pool (and budget) of its own.
+    template<int Tag>
+    struct Resource {
+        explicit Resource(int value, size_t bytes = 40) : value(value), bytes(bytes) { alive++; }
+        ~Resource() { alive--; }
+
+        size_t memorySize() const { return bytes; }
+
+        int value;
+        size_t bytes;
+        static inline int alive = 0;
+    };
+}
+
+TEST_CASE("RefCounter shares one object between references", "[refcounter]") {
+    using Counter = shadowutil::RefCounter<Resource<0>>;
+    {
+        const auto first = Counter::get("shared", 1);
+        const auto second = Counter::get("shared", 2);
+        REQUIRE(first->value == 1);
+        REQUIRE(second->value == 1);
+        REQUIRE(Resource<0>::alive == 1);
+    }
+    REQUIRE(Resource<0>::alive == 0);
+}
+
+TEST_CASE("RefCounter without a budget destroys unreferenced objects", "[refcounter]") {
+    using Counter = shadowutil::RefCounter<Resource<1>>;
+    Counter::Weak weak;
+    {
+        const auto object = Counter::get("gone", 1);
+        weak = object.weak();
+        REQUIRE(Counter::lock(weak).has_value());
+    }
+    REQUIRE(Resource<1>::alive == 0);
+    REQUIRE_FALSE(Counter::lock(weak).has_value());
+}
+
+TEST_CASE("RefCounter keeps unreferenced objects within its budget", "[refcounter]") {
+    using Counter = shadowutil::RefCounter<Resource<2>>;
+    Counter::setRetentionBudget(100);
+
+    for (int i = 0; i < 2; i++)
+        Counter::get("kept" + std::to_string(i), i);
+    REQUIRE(Resource<2>::alive == 2);
+    REQUIRE(Counter::getStats().cachedBytes == 80);
+
+    // Found again without being created.
+    int created = 0;
+    {
+        const auto again = Counter::getOrCreate("kept0", [&]() { created++; return std::make_unique<Resource<2>>(9); });
+        REQUIRE(again->value == 0);
+        REQUIRE(Counter::getStats().cachedObjects == 1);
+    }
+    REQUIRE(created == 0);
+    REQUIRE(Counter::getStats().hits == 1);
+
+    // Dropping the budget evicts everything that is no longer referenced.
+    Counter::setRetentionBudget(0);
+    REQUIRE(Resource<2>::alive == 0);
+    REQUIRE(Counter::getStats().evictions == 2);
+}
+
+TEST_CASE("RefCounter evicts the least recently released object first", "[refcounter]") {
+    using Counter = shadowutil::RefCounter<Resource<3>>;
+    Counter::setRetentionBudget(100);
+
+    Counter::Weak a, b, c;
+    { const auto object = Counter::get("a", 1); a = object.weak(); }
+    { const auto object = Counter::get("b", 2); b = object.weak(); }
+    // Using a again makes b the oldest.
+    { const auto object = Counter::get("a", 1); }
+    { const auto object = Counter::get("c", 3); c = object.weak(); }
+
+    REQUIRE(Resource<3>::alive == 2);
+    REQUIRE(Counter::lock(a).has_value());
+    REQUIRE_FALSE(Counter::lock(b).has_value());
+    REQUIRE(Counter::lock(c).has_value());
+    REQUIRE(Counter::getStats().evictions == 1);
+
+    Counter::setRetentionBudget(0);
+    REQUIRE(Resource<3>::alive == 0);
+}
+
+TEST_CASE("RefCounter keeps referenced objects however far over budget", "[refcounter]") {
+    using Counter = shadowutil::RefCounter<Resource<4>>;
+    Counter::setRetentionBudget(10);
+
+    const auto big = Counter::get("big", 1, 1000);
+    { const auto small = Counter::get("small", 2, 20); }
+
+    REQUIRE(big->value == 1);
+    REQUIRE(Resource<4>::alive == 1);
+    REQUIRE(Counter::getStats().cachedBytes == 0);
+    Counter::setRetentionBudget(0);
+}
+
+TEST_CASE("RefCounter retries creation after a failed create", "[refcounter]") {
+    using Counter = shadowutil::RefCounter<Resource<5>>;
+    REQUIRE_THROWS(Counter::getOrCreate("flaky", []() -> std::unique_ptr<Resource<5>> { throw std::runtime_error("load failed"); }));
+
+    const auto object = Counter::getOrCreate("flaky", []() { return std::make_unique<Resource<5>>(7); });
+    REQUIRE(object->value == 7);
+}
@@ -0,0 +1,86 @@
+#include "catch2/catch.hpp"
+#include <shadow/util/SlotMap.h>
+#include <memory>
+#include <string>
+
+using shadowutil::SlotMap;
+
+TEST_CASE("SlotMap handles resolve to what was inserted", "[slotmap]") {
+    SlotMap<std::string> map;
+    const auto a = map.insert("a");
+    const auto b = map.emplace(3, 'b');
+
+    REQUIRE(map.size() == 2);
+    REQUIRE(*map.get(a) == "a");
+    REQUIRE(*map.get(b) == "bbb");
+    REQUIRE(a != b);
+}
+
+TEST_CASE("SlotMap detects stale handles", "[slotmap]") {
+    SlotMap<int> map;
+    const auto first = map.insert(1);
+    REQUIRE(map.erase(first));
+    REQUIRE_FALSE(map.erase(first));
+
+    // The slot is reused, with a new generation.
+    const auto second = map.insert(2);
+    REQUIRE(second.index() == first.index());
+    REQUIRE(second.generation() != first.generation());
+    REQUIRE(map.get(first) == nullptr);
+    REQUIRE(*map.get(second) == 2);
+}
+
+TEST_CASE("SlotMap never resolves the null handle", "[slotmap]") {
+    SlotMap<int> map;
+    map.insert(1);
+
+    const SlotMap<int>::Handle null {};
+    REQUIRE_FALSE(null);
+    REQUIRE_FALSE(map.contains(null));
+    REQUIRE(map.get(null) == nullptr);
+}
+
+TEST_CASE("SlotMap keeps values dense through erasure", "[slotmap]") {
+    SlotMap<std::unique_ptr<int>> map;
+    std::vector<SlotMap<std::unique_ptr<int>>::Handle> handles;
+    for (int i = 0; i < 100; i++)
+        handles.push_back(map.insert(std::make_unique<int>(i)));
+
+    for (int i = 0; i < 100; i += 3)
+        REQUIRE(map.erase(handles[i]));
+
+    size_t walked = 0;
+    for (const auto& value : map) {
+        REQUIRE(*value % 3 != 0);
+        walked++;
+    }
+    REQUIRE(walked == map.size());
+
+    // Every surviving handle still finds its own value, wherever it was moved to.
+    for (int i = 0; i < 100; i++) {
+        if (i % 3 == 0)
+            REQUIRE(map.get(handles[i]) == nullptr);
+        else
+            REQUIRE(**map.get(handles[i]) == i);
+    }
+
+    for (size_t dense = 0; dense < map.size(); dense++)
+        REQUIRE(map.get(map.handleAt(dense)) == &*(map.begin() + dense));
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.get(handles[1]) == nullptr);
+}
+
+TEST_CASE("SlotMap with 32 bit handles wraps generations without reaching zero", "[slotmap]") {
+    SlotMap<int, uint32_t> map;
+    auto handle = map.insert(0);
+    bool reachedZero = false;
+    for (int i = 0; i < 70000; i++) {
+        map.erase(handle);
+        handle = map.insert(i);
+        reachedZero |= handle.generation() == 0;
+    }
+    REQUIRE_FALSE(reachedZero);
+    REQUIRE(*map.get(handle) == 69999);
+}
@@ -0,0 +1,39 @@
+#include "catch2/catch.hpp"
+#include <shadow/util/StringId.h>
+#include <thread>
+#include <vector>
+
+using namespace shadowutil::literals;
+using shadowutil::StringId;
+
+TEST_CASE("StringIds made at compile time and at runtime agree", "[stringid]") {
+    constexpr StringId literal = "albedo"_sid;
+    const std::string text = "albedo";
+    REQUIRE(StringId(text) == literal);
+    REQUIRE(StringId("normal") != literal);
+    REQUIRE(StringId().empty());
+}
+
+TEST_CASE("Interned StringIds can be turned back into text", "[stringid]") {
+    const StringId id = StringId::intern("interned name");
+    REQUIRE(id.str() == "interned name");
+    REQUIRE(StringId::fromHash(id.value()).str() == "interned name");
+
+    // Never recorded, so only the hash is known.
+    REQUIRE(StringId::fromHash(0x1234).str() == "#0000000000001234");
+}
+
+TEST_CASE("StringIds can be recorded from many threads at once", "[stringid]") {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([] {
+            for (int repeat = 0; repeat < 3; repeat++)
+                for (int i = 0; i < 200; i++)
+                    StringId::intern("threaded " + std::to_string(i));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(StringId::fromHash(StringId("threaded 7").value()).str() == "threaded 7");
+}
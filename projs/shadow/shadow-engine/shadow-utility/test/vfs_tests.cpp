@@ -0,0 +1,159 @@
+#include "catch2/catch.hpp"
+#include <shadow/util/VFS.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using shadowutil::VFS;
+
+namespace {
+    namespace fs = std::filesystem;
+
+    // A directory of its own for each test, removed afterwards.
+    struct TempDir {
+        explicit TempDir(const std::string& name) : path(fs::temp_directory_path() / ("shadow-vfs-" + name)) {
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+        ~TempDir() { fs::remove_all(path); }
+
+        std::string write(const std::string& name, std::string_view contents) const {
+            const fs::path file = path / name;
+            fs::create_directories(file.parent_path());
+            std::ofstream(file, std::ios::binary).write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            return file.string();
+        }
+
+        fs::path path;
+    };
+
+    void appendU32(std::string& out, uint32_t value) {
+        char bytes[4];
+        std::memcpy(bytes, &value, 4);
+        out.append(bytes, 4);
+    }
+
+    // One entry, in the layout documented on VFS::mountPackage.
+    std::string entry(std::string_view name, std::string_view type, uint32_t version, std::string_view metadata, std::string_view payload) {
+        std::string body(type);
+        appendU32(body, version);
+        appendU32(body, static_cast<uint32_t>(metadata.size()));
+        appendU32(body, static_cast<uint32_t>(payload.size()));
+        body += metadata;
+        body += payload;
+        return std::string(name) + "|" + std::to_string(body.size()) + "|" + body + "\r\n";
+    }
+
+    std::string package(std::initializer_list<std::string> entries) {
+        std::string out = "0S1V/\r\n";
+        for (const auto& e : entries) out += e;
+        return out;
+    }
+
+    std::string contents(const VFS::File& file) {
+        return { reinterpret_cast<const char*>(file.data.data()), file.data.size() };
+    }
+}
+
+TEST_CASE("VFS mounts the assets in a package", "[vfs]") {
+    const TempDir dir("package");
+    const std::string payload("\0\1\2\r\n|binary", 12);
+    const auto path = dir.write("a.vxp", package({
+        entry("A/textures/fox.tex", "VTEX", 1, R"({"width":2})", payload),
+        entry("A/./notes\\readme.txt", "TEXT", 3, "", "hello"),
+        entry("S/scene", "SCNE", 1, "", "not an asset")
+    }));
+
+    VFS vfs;
+    vfs.mountPackage(path, "pkg");
+    REQUIRE(vfs.size() == 2);
+
+    const auto fox = vfs.open("pkg/textures/fox.tex");
+    REQUIRE(fox.type == "VTEX");
+    REQUIRE(fox.version == 1);
+    REQUIRE(fox.metadata == R"({"width":2})");
+    REQUIRE(contents(fox) == payload);
+
+    const auto readme = vfs.open("./pkg\\notes/readme.txt");
+    REQUIRE(readme.version == 3);
+    REQUIRE(contents(readme) == "hello");
+
+    REQUIRE_FALSE(vfs.exists("pkg/scene"));
+    REQUIRE_FALSE(vfs.find("textures/fox.tex").has_value());
+    REQUIRE_THROWS(vfs.open("pkg/missing"));
+}
+
+TEST_CASE("VFS resolves clashes by priority, then by mount order", "[vfs]") {
+    const TempDir dir("priority");
+    const auto first = dir.write("first.vxp", package({ entry("A/a", "TEXT", 1, "", "first"), entry("A/b", "TEXT", 1, "", "first") }));
+    const auto second = dir.write("second.vxp", package({ entry("A/a", "TEXT", 1, "", "second") }));
+    dir.write("loose/b", "loose");
+
+    VFS vfs;
+    vfs.mountDirectory((dir.path / "loose").string(), "", 1);
+    vfs.mountPackage(first);
+    vfs.mountPackage(second);
+
+    REQUIRE(contents(vfs.open("a")) == "second");
+    REQUIRE(contents(vfs.open("b")) == "loose");
+    REQUIRE(vfs.open("b").type.empty());
+
+    // Taking a source away uncovers whatever it was hiding.
+    REQUIRE(vfs.unmount(second));
+    REQUIRE(contents(vfs.open("a")) == "first");
+    REQUIRE(vfs.unmount((dir.path / "loose").string()));
+    REQUIRE(contents(vfs.open("b")) == "first");
+    REQUIRE_FALSE(vfs.unmount(second));
+}
+
+TEST_CASE("VFS mounts every package in an index", "[vfs]") {
+    const TempDir dir("index");
+    dir.write("one.vxp", package({ entry("A/one", "TEXT", 1, "", "1") }));
+    dir.write("two.vxp", package({ entry("A/two", "TEXT", 1, "", "2") }));
+    const auto index = dir.write("index.vxi", "one.vxp\r\n\ntwo.vxp ");
+
+    VFS vfs;
+    vfs.mountIndex(index, "res");
+    REQUIRE(contents(vfs.open("res/one")) == "1");
+    REQUIRE(contents(vfs.open("res/two")) == "2");
+}
+
+TEST_CASE("VFS rejects corrupt packages", "[vfs]") {
+    const TempDir dir("corrupt");
+    const std::string good = entry("A/a", "TEXT", 1, "{}", "payload");
+
+    const auto rejects = [&](const std::string& name, const std::string& bytes, const std::string& why) {
+        VFS vfs;
+        REQUIRE_THROWS_WITH(vfs.mountPackage(dir.write(name, bytes)), Catch::Contains(why));
+        REQUIRE(vfs.size() == 0);
+    };
+
+    SECTION("Without a header") {
+        rejects("empty.vxp", "", "missing header");
+        rejects("wrong.vxp", "1S1V/\r\n" + good, "missing header");
+        rejects("unterminated.vxp", "0S1V/", "missing header");
+    }
+
+    SECTION("Truncated") {
+        const std::string whole = package({ good });
+        for (size_t length = 8; length < whole.size() - 2; length++)
+            rejects("truncated.vxp", whole.substr(0, length), "");
+    }
+
+    SECTION("With a size that isn't a number") {
+        rejects("size.vxp", "0S1V/\r\nA/a|12x|" + good, "bad size");
+        rejects("negative.vxp", "0S1V/\r\nA/a|-1|" + good, "bad size");
+    }
+
+    SECTION("With lengths that disagree with the size") {
+        std::string bad = package({ good });
+        // The payload length is the last of the three u32s after the type tag.
+        const size_t payloadLength = bad.find("TEXT") + 12;
+        bad[payloadLength] = 3;
+        rejects("sizes.vxp", bad, "do not add up");
+
+        bad[payloadLength] = static_cast<char>(0xff);
+        bad[payloadLength + 3] = static_cast<char>(0xff);
+        rejects("huge.vxp", bad, "do not add up");
+    }
+}
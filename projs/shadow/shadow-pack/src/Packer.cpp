@@ -0,0 +1,389 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "Packer.h"
+#include <shadow/util/Compression.h>
+#include <shadow/util/File.h>
+#include <shadow/util/Hash.h>
+#include <shadow/util/Json.h>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace shadowpack {
+
+    namespace {
+        constexpr std::string_view packageHeader = "0S1V/\r\n";
+        constexpr std::string_view checksumPath = "checksums";
+
+        // Type tag, version, metadata length and payload length.
+        constexpr size_t fixedSize = 4 + 3 * sizeof(uint32_t);
+
+        // Below this, a payload is small enough that compressing it saves nothing worth the decode.
+        constexpr size_t minimumCompressed = 16 * 1024;
+
+        // Payloads smaller than the requested alignment are only aligned to this, which satisfies any copy.
+        // Giving each its own page would mostly add padding.
+        constexpr uint32_t smallAlignment = 16;
+
+        struct Cooked {
+            std::string path;
+            char type[4];
+            uint32_t version = 1;
+            std::string metadata;
+            std::vector<std::byte> payload;
+        };
+
+        // One row of the checksum table.
+        struct Checksum {
+            uint64_t offset;
+            uint64_t size;
+            uint64_t hash;
+        };
+
+        // An entry, as read back from a package.
+        struct Entry {
+            char kind;
+            std::string_view path;
+            std::string_view type;
+            uint32_t version;
+            std::string_view metadata;
+            std::span<const std::byte> payload;
+            uint64_t offset;
+        };
+
+        uint64_t checksum(std::span<const std::byte> bytes) {
+            return shadowutil::fnv1a64(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+        }
+
+        uint32_t readU32(const std::byte* at) {
+            uint32_t value;
+            std::memcpy(&value, at, sizeof(value));
+            return value;
+        }
+
+        bool isImage(const fs::path& file) {
+            std::string extension = file.extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+            return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+        }
+
+        Cooked cook(const fs::path& file, std::string path, const BuildOptions& options) {
+            const shadowutil::MappedFile source = shadowutil::loadFile(file.string());
+
+            Cooked out;
+            out.path = std::move(path);
+            std::string fields;     // The metadata after "compression", keeping keys in order
+
+            if (isImage(file)) {
+                int width, height, channels;
+                stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(source.data().data()), static_cast<int>(source.size()),
+                                                        &width, &height, &channels, STBI_rgb_alpha);
+                if (pixels == nullptr)
+                    throw std::runtime_error("Unable to decode image " + file.string() + ": " + stbi_failure_reason());
+
+                const size_t size = size_t(width) * height * 4;
+                out.payload.assign(reinterpret_cast<std::byte*>(pixels), reinterpret_cast<std::byte*>(pixels) + size);
+                stbi_image_free(pixels);
+
+                std::memcpy(out.type, "VTEX", 4);
+                fields = ",\"format\":1,\"height\":" + std::to_string(height) + ",\"size\":" + std::to_string(size) + ",\"width\":" + std::to_string(width);
+            } else {
+                out.payload.assign(source.data().begin(), source.data().end());
+                std::memcpy(out.type, "BLOB", 4);
+                fields = ",\"size\":" + std::to_string(out.payload.size());
+            }
+
+            auto compression = shadowutil::Compression::None;
+            if (options.compress && out.payload.size() >= minimumCompressed) {
+                auto stream = shadowutil::compressBlocks(out.payload, options.blockSize ? options.blockSize : shadowutil::defaultBlockSize);
+                // Only keep it if it saves at least an eighth; otherwise the decode costs more than the read it saves.
+                if (stream.size() < out.payload.size() - out.payload.size() / 8) {
+                    out.payload = std::move(stream);
+                    compression = shadowutil::Compression::Blocks;
+                }
+            }
+
+            out.metadata = "{\"compression\":" + std::to_string(static_cast<uint32_t>(compression)) + fields + "}";
+            return out;
+        }
+
+        // Writes entries, keeping track of where they land.
+        class PackageWriter {
+        public:
+            explicit PackageWriter(const std::string& path) : out(path, std::ios::binary | std::ios::trunc) {
+                if (!out)
+                    throw std::runtime_error("Unable to open " + path + " for writing");
+                write(packageHeader.data(), packageHeader.size());
+            }
+
+            // Write an entry, padding its metadata so that the payload is aligned. Returns the offset of the payload.
+            uint64_t entry(char kind, const Cooked& cooked, uint32_t alignment) {
+                if (cooked.payload.size() > UINT32_MAX || cooked.metadata.size() + alignment > UINT32_MAX)
+                    throw std::runtime_error(cooked.path + " is too large for a package entry");
+
+                // The size field is zero-filled to the width it would need with the most padding, so that the amount of
+                //  padding never changes where the payload starts.
+                const uint64_t unpadded = fixedSize + cooked.metadata.size() + cooked.payload.size();
+                const size_t width = std::to_string(unpadded + alignment - 1).size();
+                const uint64_t headerSize = 2 + cooked.path.size() + 1 + width + 1;
+                const uint64_t payloadStart = offset + headerSize + fixedSize + cooked.metadata.size();
+                const uint64_t padding = (alignment - payloadStart % alignment) % alignment;
+
+                std::string size = std::to_string(unpadded + padding);
+                size.insert(0, width - size.size(), '0');
+                const std::string header = std::string(1, kind) + "/" + cooked.path + "|" + size + "|";
+
+                const uint32_t metadataSize = static_cast<uint32_t>(cooked.metadata.size() + padding);
+                const uint32_t payloadSize = static_cast<uint32_t>(cooked.payload.size());
+                write(header.data(), header.size());
+                write(cooked.type, 4);
+                write(&cooked.version, sizeof(cooked.version));
+                write(&metadataSize, sizeof(metadataSize));
+                write(&payloadSize, sizeof(payloadSize));
+                write(cooked.metadata.data(), cooked.metadata.size());
+                write(std::string(padding, ' ').data(), padding);
+
+                const uint64_t payload = offset;
+                write(cooked.payload.data(), cooked.payload.size());
+                write("\r\n", 2);
+                return payload;
+            }
+
+            uint64_t finish() {
+                out.close();
+                if (!out)
+                    throw std::runtime_error("Unable to finish writing the package");
+                return offset;
+            }
+
+        private:
+            void write(const void* data, size_t size) {
+                out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                offset += size;
+            }
+
+            std::ofstream out;
+            uint64_t offset = 0;
+        };
+
+        // The order file lists one package path per line; anything not listed goes after, by path.
+        std::unordered_map<std::string, size_t> readOrder(const std::string& path) {
+            std::unordered_map<std::string, size_t> ranks;
+            if (path.empty()) return ranks;
+
+            std::ifstream in(path);
+            if (!in)
+                throw std::runtime_error("Unable to read load order " + path);
+
+            std::string line;
+            while (std::getline(in, line)) {
+                std::replace(line.begin(), line.end(), '\\', '/');
+                while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+                if (!line.empty())
+                    ranks.try_emplace(line, ranks.size());
+            }
+            return ranks;
+        }
+
+        void addToIndex(const std::string& index, const std::string& package) {
+            const fs::path directory = fs::absolute(index).parent_path();
+            const std::string name = fs::relative(fs::absolute(package), directory).generic_string();
+
+            std::vector<std::string> lines;
+            if (std::ifstream in(index); in) {
+                std::string line;
+                while (std::getline(in, line)) {
+                    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+                    if (!line.empty()) lines.push_back(line);
+                }
+            }
+            if (std::find(lines.begin(), lines.end(), name) != lines.end())
+                return;
+
+            lines.push_back(name);
+            std::ofstream out(index, std::ios::trunc);
+            for (const auto& line : lines)
+                out << line << "\n";
+            if (!out)
+                throw std::runtime_error("Unable to write index " + index);
+        }
+
+        std::vector<Entry> readEntries(const shadowutil::MappedFile& package, const std::string& path) {
+            const std::string_view text = package.text();
+            const std::span<const std::byte> bytes = package.data();
+            const auto corrupt = [&](const std::string& why) {
+                return std::runtime_error("Package " + path + " is corrupt: " + why);
+            };
+
+            if (!text.starts_with("0S1V"))
+                throw corrupt("missing header");
+            size_t pos = text.find("\r\n");
+            if (pos == std::string_view::npos)
+                throw corrupt("missing header");
+            pos += 2;
+
+            std::vector<Entry> entries;
+            while (pos < text.size()) {
+                const size_t nameEnd = text.find('|', pos);
+                const size_t sizeEnd = nameEnd == std::string_view::npos ? nameEnd : text.find('|', nameEnd + 1);
+                if (sizeEnd == std::string_view::npos || nameEnd - pos < 2)
+                    throw corrupt("truncated entry at offset " + std::to_string(pos));
+
+                uint64_t size = 0;
+                const auto [end, error] = std::from_chars(text.data() + nameEnd + 1, text.data() + sizeEnd, size);
+                const size_t body = sizeEnd + 1;
+                if (error != std::errc() || end != text.data() + sizeEnd || size < fixedSize || body + size > bytes.size())
+                    throw corrupt("bad size at offset " + std::to_string(pos));
+
+                Entry entry;
+                entry.kind = text[pos];
+                entry.path = text.substr(pos + 2, nameEnd - pos - 2);
+                entry.type = text.substr(body, 4);
+                entry.version = readU32(bytes.data() + body + 4);
+                const uint32_t metadataSize = readU32(bytes.data() + body + 8);
+                const uint32_t payloadSize = readU32(bytes.data() + body + 12);
+                if (fixedSize + uint64_t(metadataSize) + payloadSize != size)
+                    throw corrupt("sizes of " + std::string(entry.path) + " do not add up");
+
+                entry.metadata = text.substr(body + fixedSize, metadataSize);
+                entry.offset = body + fixedSize + metadataSize;
+                entry.payload = bytes.subspan(entry.offset, payloadSize);
+                entries.push_back(entry);
+
+                pos = body + size;
+                if (text.substr(pos, 2) == "\r\n") pos += 2;
+            }
+            return entries;
+        }
+
+        uint32_t compressionOf(const Entry& entry) {
+            const auto meta = shadowutil::JsonValue::parse(entry.metadata);
+            return static_cast<uint32_t>(meta.getInt("compression", 1));
+        }
+    }
+
+    void build(const BuildOptions& options) {
+        if (!fs::is_directory(options.input))
+            throw std::runtime_error(options.input + " is not a directory");
+        if (options.alignment == 0 || (options.alignment & (options.alignment - 1)) != 0)
+            throw std::runtime_error("Alignment must be a power of two");
+
+        std::vector<std::pair<fs::path, std::string>> files;
+        for (const auto& item : fs::recursive_directory_iterator(options.input)) {
+            if (item.is_regular_file())
+                files.emplace_back(item.path(), fs::relative(item.path(), options.input).generic_string());
+        }
+
+        const auto ranks = readOrder(options.order);
+        const auto rank = [&](const std::string& path) {
+            const auto iter = ranks.find(path);
+            return iter == ranks.end() ? ranks.size() : iter->second;
+        };
+        std::sort(files.begin(), files.end(), [&](const auto& a, const auto& b) {
+            const size_t rankA = rank(a.second), rankB = rank(b.second);
+            return rankA != rankB ? rankA < rankB : a.second < b.second;
+        });
+
+        if (const fs::path parent = fs::path(options.output).parent_path(); !parent.empty())
+            fs::create_directories(parent);
+        PackageWriter writer(options.output);
+        std::vector<Checksum> checksums;
+        uint64_t original = 0;
+
+        for (const auto& [file, path] : files) {
+            const Cooked cooked = cook(file, path, options);
+            original += fs::file_size(file);
+            const uint32_t alignment = cooked.payload.size() < options.alignment ? std::min(smallAlignment, options.alignment) : options.alignment;
+            checksums.push_back({ writer.entry('A', cooked, alignment), cooked.payload.size(), checksum(cooked.payload) });
+        }
+
+        Cooked table;
+        table.path = checksumPath;
+        std::memcpy(table.type, "VSUM", 4);
+        table.metadata = "{\"algorithm\":\"fnv1a64\",\"count\":" + std::to_string(checksums.size()) + "}";
+        table.payload.resize(checksums.size() * sizeof(Checksum));
+        std::memcpy(table.payload.data(), checksums.data(), table.payload.size());
+        writer.entry('C', table, alignof(Checksum));
+
+        const uint64_t written = writer.finish();
+        if (!options.index.empty())
+            addToIndex(options.index, options.output);
+
+        std::cout << "Packed " << files.size() << " files (" << original << " bytes) into " << options.output
+                  << " (" << written << " bytes)" << std::endl;
+    }
+
+    size_t verify(const std::string& path) {
+        const shadowutil::MappedFile package(path, shadowutil::MappedFile::Access::Sequential);
+        const auto entries = readEntries(package, path);
+
+        const auto table = std::find_if(entries.begin(), entries.end(), [](const Entry& entry) {
+            return entry.kind == 'C' && entry.path == checksumPath && entry.type == "VSUM";
+        });
+        if (table == entries.end()) {
+            std::cerr << path << " has no checksum table" << std::endl;
+            return 1;
+        }
+
+        std::unordered_map<uint64_t, Checksum> checksums;
+        for (size_t i = 0; i + sizeof(Checksum) <= table->payload.size(); i += sizeof(Checksum)) {
+            Checksum row;
+            std::memcpy(&row, table->payload.data() + i, sizeof(row));
+            checksums.emplace(row.offset, row);
+        }
+
+        size_t problems = 0;
+        size_t assets = 0;
+        const auto problem = [&](std::string_view entry, const std::string& what) {
+            std::cerr << entry << ": " << what << std::endl;
+            problems++;
+        };
+
+        for (const auto& entry : entries) {
+            if (entry.kind != 'A') continue;
+            assets++;
+
+            const auto row = checksums.find(entry.offset);
+            if (row == checksums.end())
+                problem(entry.path, "missing from the checksum table");
+            else if (row->second.size != entry.payload.size() || row->second.hash != checksum(entry.payload))
+                problem(entry.path, "checksum mismatch");
+
+            try {
+                if (compressionOf(entry) == static_cast<uint32_t>(shadowutil::Compression::Blocks)) {
+                    std::vector<std::byte> decoded(shadowutil::decompressedSize(entry.payload));
+                    shadowutil::decompressBlocks(entry.payload, decoded);
+                }
+            } catch (const std::exception& e) {
+                problem(entry.path, e.what());
+            }
+        }
+
+        if (assets != checksums.size())
+            problem(path, "checksum table has " + std::to_string(checksums.size()) + " rows for " + std::to_string(assets) + " entries");
+
+        if (problems == 0)
+            std::cout << path << ": " << assets << " entries OK" << std::endl;
+        return problems;
+    }
+
+    void list(const std::string& path) {
+        const shadowutil::MappedFile package(path, shadowutil::MappedFile::Access::Sequential);
+        for (const auto& entry : readEntries(package, path)) {
+            std::cout << entry.kind << " " << entry.type << " v" << entry.version
+                      << "  offset " << entry.offset << "  " << entry.payload.size() << " bytes"
+                      << "  compression " << compressionOf(entry) << "  " << entry.path << std::endl;
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shadowpack {
+
+    struct BuildOptions {
+        std::string input;              // The directory of assets; package paths are relative to this
+        std::string output;             // The .vxp to write
+        std::string index;              // A .vxi to add the package to; empty for none
+        std::string order;              // A file listing package paths in the order they are expected to load
+        uint32_t alignment = 4096;      // Payloads at least this large start on a multiple of it, from the start of the package
+        bool compress = false;          // Block compress payloads that shrink enough to be worth it
+        uint32_t blockSize = 0;         // 0 for shadowutil::defaultBlockSize
+    };
+
+    // Build a package from every file under options.input.
+    //
+    // Images are decoded and stored as raw RGBA VTEX entries, which can be uploaded without further processing.
+    // Everything else is stored as-is, as a BLOB entry. Both keep the path of the file they came from.
+    //
+    // Entries are written in load order: first the paths named in the order file, as listed, then the rest by path,
+    //  so that loading a level reads the package from front to back.
+    // The JSON header of each entry is padded with whitespace so that its payload is aligned, which lets a mapped
+    //  payload be used directly as the source of a GPU copy.
+    // The package ends with a checksum table (a "C/checksums" VSUM entry, which the VFS does not mount) holding the
+    //  offset, size and FNV-1a hash of every payload.
+    void build(const BuildOptions& options);
+
+    // Check every payload of a package against its checksum table, and that compressed payloads decode.
+    // Returns the number of problems, after printing each.
+    size_t verify(const std::string& package);
+
+    // Print the entries of a package.
+    void list(const std::string& package);
+}
@@ -0,0 +1,76 @@
+#include "Packer.h"
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    void usage() {
+        std::cerr <<
+            "Usage:\n"
+            "  shadow-pack build <input directory> <output.vxp> [options]\n"
+            "      --index <file.vxi>    Add the package to an index, creating it if needed\n"
+            "      --order <file>        Package paths, one per line, in the order they are expected to load\n"
+            "      --align <bytes>       Payload alignment, a power of two (default 4096)\n"
+            "      --compress            Block compress payloads where it pays off\n"
+            "      --block-size <bytes>  Size of each compressed block (default 131072)\n"
+            "  shadow-pack verify <package.vxp>\n"
+            "  shadow-pack list <package.vxp>\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    const std::string command = argv[1];
+
+    try {
+        if (command == "verify")
+            return shadowpack::verify(argv[2]) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+        if (command == "list") {
+            shadowpack::list(argv[2]);
+            return EXIT_SUCCESS;
+        }
+
+        if (command != "build" || argc < 4) {
+            usage();
+            return EXIT_FAILURE;
+        }
+
+        shadowpack::BuildOptions options;
+        options.input = argv[2];
+        options.output = argv[3];
+
+        for (int i = 4; i < argc; i++) {
+            const std::string param = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (param == "--compress") {
+                options.compress = true;
+            } else if (param == "--index" && hasValue) {
+                options.index = argv[++i];
+            } else if (param == "--order" && hasValue) {
+                options.order = argv[++i];
+            } else if (param == "--align" && hasValue) {
+                options.alignment = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (param == "--block-size" && hasValue) {
+                options.blockSize = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else {
+                std::cerr << "Unknown option " << param << "\n";
+                usage();
+                return EXIT_FAILURE;
+            }
+        }
+
+        shadowpack::build(options);
+    } catch (const std::exception& e) {
+        std::cerr << "shadow-pack: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -5,7 +5,8 @@
 
 class GameModule : public ShadowEngine::Module {
 
-    SHObject_Base(GameModule)
+    SHObject_Base(GameModule, ShadowEngine::Module)
+    SHObject_Fields(GameModule)
 
     std::string tets = "asdasd";
 public:
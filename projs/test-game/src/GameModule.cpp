@@ -9,11 +9,13 @@
 #include "vlkx/render/render_pass/ScreenRenderPass.h"
 #include "temp/model/Builder.h"
 #include "core/ModuleManager.h"
+#include "Serialization.h"
 
 #define CATCH(x) \
     try { x } catch (std::exception& e) { spdlog::error(e.what()); exit(0); }
 
 SHObject_Base_Impl(GameModule)
+SHObject_Fields_Impl(GameModule, SH_FIELD(tets))
 
 struct Transformation {
     alignas(sizeof(glm::mat4)) glm::mat4 proj_view_model;
@@ -59,12 +61,17 @@ void GameModule::Update(int frame) {
     const glm::mat4 model = glm::rotate(glm::mat4{1.0f},
                                         (elapsed_time / 1000 / 2) * glm::radians(90.0f),
                                         glm::vec3{1.0f, 1.0f, 0.0f});
-    const glm::mat4 view = glm::lookAt(glm::vec3{3.0f}, glm::vec3{0.0f},
+    const glm::vec3 eye {3.0f};
+    const glm::mat4 view = glm::lookAt(eye, glm::vec3{0.0f},
                                        glm::vec3{0.0f, 0.0f, 1.0f});
     const glm::mat4 proj = glm::perspective(
             glm::radians(45.0f), aspectRatio,
             0.1f, 100.0f);
     *trans_constant_->getData<Transformation>(frame) = {proj * view * model};
+
+    const auto extent = ShadowEngine::ModuleManager::getInstance()->renderer->GetRenderExtent();
+    cube_model_->selectLod(vlkxtemp::Model::LodView::perspective(eye, 45.0f, (float) extent.height), model);
+    cube_model_->cullClusters({ eye, proj * view }, model);
 }
 
 void GameModule::Render(VkCommandBuffer& commands, int frame) {